@@ -31,6 +31,7 @@
 #include "file_access_compressed.h"
 
 #include "core/string/print_string.h"
+#include "core/templates/task_scheduler.h"
 
 void FileAccessCompressed::configure(const String &p_magic, Compression::Mode p_mode, uint32_t p_block_size) {
 	magic = p_magic.ascii().get_data();
@@ -62,39 +63,159 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	f = p_base;
 	cmode = (Compression::Mode)f->get_32();
 	block_size = f->get_32();
-	if (block_size == 0) {
-		f = nullptr; // Let the caller to handle the FileAccess object if failed to open as compressed file.
-		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with block size 0, it is corrupted.");
-	}
-	read_total = f->get_32();
-	uint32_t bc = (read_total / block_size) + 1;
-	uint64_t acc_ofs = f->get_position() + bc * 4;
+
+	uint32_t bc = 0;
 	uint32_t max_bs = 0;
-	for (uint32_t i = 0; i < bc; i++) {
-		ReadBlock rb;
-		rb.offset = acc_ofs;
-		rb.csize = f->get_32();
-		acc_ofs += rb.csize;
-		max_bs = MAX(max_bs, rb.csize);
-		read_blocks.push_back(rb);
+
+	if (block_size == 0) {
+		// Block index in the footer. A zero block size makes older versions reject the file.
+		uint32_t version = f->get_32();
+		if (version != FORMAT_VERSION) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_UNRECOGNIZED, "Can't open compressed file '" + p_base->get_path() + "' with unsupported format version " + itos(version) + ".");
+		}
+		block_size = f->get_32();
+		read_total = f->get_64();
+		uint64_t data_ofs = f->get_position();
+		uint64_t length = f->get_length();
+		if (block_size == 0 || length < data_ofs + 12) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "', it is corrupted.");
+		}
+
+		bc = (read_total / block_size) + 1;
+		f->seek(length - 12);
+		uint64_t index_ofs = f->get_64();
+		if (index_ofs < data_ofs || index_ofs + uint64_t(bc) * 4 > length - 12) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with an invalid block index, it is corrupted.");
+		}
+
+		f->seek(index_ofs);
+		uint64_t acc_ofs = data_ofs;
+		read_blocks.resize(bc);
+		for (uint32_t i = 0; i < bc; i++) {
+			ReadBlock &rb = read_blocks.write[i];
+			rb.offset = acc_ofs;
+			rb.csize = f->get_32();
+			acc_ofs += rb.csize;
+			max_bs = MAX(max_bs, rb.csize);
+		}
+		if (acc_ofs > index_ofs) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with blocks overlapping its block index, it is corrupted.");
+		}
+	} else {
+		read_total = f->get_32();
+		bc = (read_total / block_size) + 1;
+		uint64_t acc_ofs = f->get_position() + bc * 4;
+		read_blocks.resize(bc);
+		for (uint32_t i = 0; i < bc; i++) {
+			ReadBlock &rb = read_blocks.write[i];
+			rb.offset = acc_ofs;
+			rb.csize = f->get_32();
+			acc_ofs += rb.csize;
+			max_bs = MAX(max_bs, rb.csize);
+		}
+		if (acc_ofs > f->get_length()) {
+			f = nullptr;
+			ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with blocks past its end, it is corrupted.");
+		}
 	}
 
 	comp_buffer.resize(max_bs);
 	buffer.resize(block_size);
 	read_ptr = buffer.ptrw();
-	f->get_buffer(comp_buffer.ptrw(), read_blocks[0].csize);
 	at_end = false;
 	read_eof = false;
-	read_block_count = bc;
-	read_block_size = read_blocks.size() == 1 ? read_total : block_size;
+	read_corrupt = false;
+	// The last block is empty when the size is a multiple of the block size, it's never read.
+	read_block_count = MAX(1u, uint32_t((read_total + block_size - 1) / block_size));
 
-	Compression::decompress(buffer.ptrw(), read_block_size, comp_buffer.ptr(), read_blocks[0].csize, cmode);
-	read_block = 0;
 	read_pos = 0;
+	if (!_read_block(0)) {
+		f = nullptr;
+		ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "', its first block is corrupted.");
+	}
 
 	return OK;
 }
 
+bool FileAccessCompressed::_read_block(uint32_t p_block) const {
+	const ReadBlock &rb = read_blocks[p_block];
+	if (f->get_position() != rb.offset) {
+		f->seek(rb.offset);
+	}
+	if (f->get_buffer(comp_buffer.ptrw(), rb.csize) != rb.csize) {
+		return false;
+	}
+	// FastLZ pads tiny blocks, so it may return more than was stored.
+	if (Compression::decompress(buffer.ptrw(), block_size, comp_buffer.ptr(), rb.csize, cmode) < int(_get_block_size(p_block))) {
+		return false;
+	}
+	read_block = p_block;
+	read_block_size = _get_block_size(p_block);
+	return true;
+}
+
+void FileAccessCompressed::_fail_read(uint32_t p_block) const {
+	// Reads stop at a corrupted block, as if the file ended there.
+	read_corrupt = true;
+	at_end = true;
+	read_eof = true;
+	ERR_PRINT("Can't decompress block " + itos(p_block) + " of compressed file '" + f->get_path() + "', it is corrupted.");
+}
+
+void FileAccessCompressed::_decompress_block(uint32_t p_index, ParallelDecompress *p_data) const {
+	const uint32_t block = p_data->first_block + p_index;
+	const ReadBlock &rb = read_blocks[block];
+	if (Compression::decompress(p_data->dst + uint64_t(p_index) * block_size, block_size, p_data->src + (rb.offset - p_data->src_offset), rb.csize, cmode) < int(_get_block_size(block))) {
+		p_data->failed.set();
+	}
+}
+
+bool FileAccessCompressed::_decompress_blocks(uint32_t p_first_block, uint32_t p_count, uint8_t *p_dst) const {
+	// Blocks are stored one after the other, so they are read in one go.
+	const ReadBlock &first = read_blocks[p_first_block];
+	const ReadBlock &last = read_blocks[p_first_block + p_count - 1];
+	uint64_t csize = last.offset + last.csize - first.offset;
+	if (uint64_t(parallel_comp_buffer.size()) < csize) {
+		parallel_comp_buffer.resize(csize);
+	}
+	if (f->get_position() != first.offset) {
+		f->seek(first.offset);
+	}
+	if (f->get_buffer(parallel_comp_buffer.ptrw(), csize) != csize) {
+		return false;
+	}
+
+	ParallelDecompress data;
+	data.src = parallel_comp_buffer.ptr();
+	data.src_offset = first.offset;
+	data.dst = p_dst;
+	data.first_block = p_first_block;
+
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	if (scheduler) {
+		scheduler->parallel_for(p_count, this, &FileAccessCompressed::_decompress_block, &data);
+	} else {
+		for (uint32_t i = 0; i < p_count; i++) {
+			_decompress_block(i, &data);
+		}
+	}
+	return !data.failed.is_set();
+}
+
+void FileAccessCompressed::_compress_block(uint32_t p_index, Vector<uint8_t> *p_blocks) const {
+	uint32_t bl = MIN(uint64_t(block_size), write_max - uint64_t(p_index) * block_size);
+	const uint8_t *bp = &write_ptr[uint64_t(p_index) * block_size];
+
+	Vector<uint8_t> &cblock = p_blocks[p_index];
+	cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
+	int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
+	cblock.resize(s);
+}
+
 Error FileAccessCompressed::_open(const String &p_path, int p_mode_flags) {
 	ERR_FAIL_COND_V(p_mode_flags == READ_WRITE, ERR_UNAVAILABLE);
 
@@ -125,8 +246,10 @@ Error FileAccessCompressed::_open(const String &p_path, int p_mode_flags) {
 		char rmagic[5];
 		f->get_buffer((uint8_t *)rmagic, 4);
 		rmagic[4] = 0;
-		if (magic != rmagic || open_after_magic(f) != OK) {
-			memdelete(f);
+		// open_after_magic() clears f when it fails, so the base file is kept here to free it.
+		FileAccess *base = f;
+		if (magic != rmagic || open_after_magic(base) != OK) {
+			memdelete(base);
 			f = nullptr;
 			return ERR_FILE_UNRECOGNIZED;
 		}
@@ -146,38 +269,40 @@ void FileAccessCompressed::close() {
 		CharString mgc = magic.utf8();
 		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //write header 4
 		f->store_32(cmode); //write compression mode 4
+		f->store_32(0); //no block size, marks the indexed format 4
+		f->store_32(FORMAT_VERSION); //format version 4
 		f->store_32(block_size); //write block size 4
-		f->store_32(write_max); //max amount of data written 4
+		f->store_64(write_max); //max amount of data written 8
 		uint32_t bc = (write_max / block_size) + 1;
 
-		for (uint32_t i = 0; i < bc; i++) {
-			f->store_32(0); //compressed sizes, will update later
+		// Blocks are compressed independently, so they are compressed in parallel.
+		Vector<Vector<uint8_t>> blocks;
+		blocks.resize(bc);
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		if (scheduler) {
+			scheduler->parallel_for(bc, this, &FileAccessCompressed::_compress_block, blocks.ptrw());
+		} else {
+			for (uint32_t i = 0; i < bc; i++) {
+				_compress_block(i, blocks.ptrw());
+			}
 		}
 
-		Vector<int> block_sizes;
 		for (uint32_t i = 0; i < bc; i++) {
-			uint32_t bl = i == (bc - 1) ? write_max % block_size : block_size;
-			uint8_t *bp = &write_ptr[i * block_size];
-
-			Vector<uint8_t> cblock;
-			cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-			int s = Compression::compress(cblock.ptrw(), bp, bl, cmode);
-
-			f->store_buffer(cblock.ptr(), s);
-			block_sizes.push_back(s);
+			f->store_buffer(blocks[i].ptr(), blocks[i].size());
 		}
 
-		f->seek(16); //ok write block sizes
+		uint64_t index_ofs = f->get_position();
 		for (uint32_t i = 0; i < bc; i++) {
-			f->store_32(block_sizes[i]);
+			f->store_32(blocks[i].size()); //block index in the footer
 		}
-		f->seek_end();
+		f->store_64(index_ofs);
 		f->store_buffer((const uint8_t *)mgc.get_data(), mgc.length()); //magic at the end too
 
 		buffer.clear();
 
 	} else {
 		comp_buffer.clear();
+		parallel_comp_buffer.clear();
 		buffer.clear();
 		read_blocks.clear();
 	}
@@ -206,12 +331,9 @@ void FileAccessCompressed::seek(uint64_t p_position) {
 			at_end = false;
 			read_eof = false;
 			uint32_t block_idx = p_position / block_size;
-			if (block_idx != read_block) {
-				read_block = block_idx;
-				f->seek(read_blocks[read_block].offset);
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
+			if (block_idx != read_block && !_read_block(block_idx)) {
+				_fail_read(block_idx);
+				return;
 			}
 
 			read_pos = p_position % block_size;
@@ -232,6 +354,8 @@ uint64_t FileAccessCompressed::get_position() const {
 	ERR_FAIL_COND_V_MSG(!f, 0, "File must be opened before use.");
 	if (writing) {
 		return write_pos;
+	} else if (at_end) {
+		return read_total;
 	} else {
 		return (uint64_t)read_block * block_size + read_pos;
 	}
@@ -268,17 +392,14 @@ uint8_t FileAccessCompressed::get_8() const {
 
 	read_pos++;
 	if (read_pos >= read_block_size) {
-		read_block++;
-
-		if (read_block < read_block_count) {
+		if (read_block + 1 < read_block_count) {
 			//read another block of compressed data
-			f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-			Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-			read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-			read_pos = 0;
-
+			if (_read_block(read_block + 1)) {
+				read_pos = 0;
+			} else {
+				_fail_read(read_block + 1);
+			}
 		} else {
-			read_block--;
 			at_end = true;
 		}
 	}
@@ -296,34 +417,59 @@ uint64_t FileAccessCompressed::get_buffer(uint8_t *p_dst, uint64_t p_length) con
 		return 0;
 	}
 
-	for (uint64_t i = 0; i < p_length; i++) {
-		p_dst[i] = read_ptr[read_pos];
-		read_pos++;
-		if (read_pos >= read_block_size) {
-			read_block++;
+	uint64_t copied = 0;
+	while (true) {
+		uint64_t to_copy = MIN(p_length - copied, read_block_size - read_pos);
+		memcpy(p_dst + copied, read_ptr + read_pos, to_copy);
+		copied += to_copy;
+		read_pos += to_copy;
 
-			if (read_block < read_block_count) {
-				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptrw(), read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptrw(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.ptr(), read_blocks[read_block].csize, cmode);
-				read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-				read_pos = 0;
+		if (read_pos < read_block_size) {
+			return copied;
+		}
 
-			} else {
-				read_block--;
-				at_end = true;
-				if (i < p_length - 1) {
-					read_eof = true;
-				}
-				return i;
+		if (read_block + 1 >= read_block_count) {
+			at_end = true;
+			if (copied < p_length) {
+				read_eof = true;
 			}
+			return copied;
+		}
+
+		// Whole blocks before the last one are decompressed straight into the destination.
+		uint64_t whole_blocks = MIN((p_length - copied) / block_size, uint64_t(read_block_count - 2 - read_block));
+		if (whole_blocks >= PARALLEL_MIN_BLOCKS) {
+			uint32_t count = MIN(whole_blocks, uint64_t(PARALLEL_MAX_BLOCKS));
+			if (!_decompress_blocks(read_block + 1, count, p_dst + copied)) {
+				_fail_read(read_block + 1);
+				return copied;
+			}
+			copied += uint64_t(count) * block_size;
+
+			// Keep the last block current, seeking inside it doesn't load it again.
+			memcpy(buffer.ptrw(), p_dst + copied - block_size, block_size);
+			read_block += count;
+			read_block_size = block_size;
+			read_pos = block_size;
+			continue;
 		}
-	}
 
-	return p_length;
+		//read another block of compressed data
+		if (!_read_block(read_block + 1)) {
+			_fail_read(read_block + 1);
+			return copied;
+		}
+		read_pos = 0;
+		if (copied == p_length) {
+			return copied;
+		}
+	}
 }
 
 Error FileAccessCompressed::get_error() const {
+	if (read_corrupt) {
+		return ERR_FILE_CORRUPT;
+	}
 	return read_eof ? ERR_FILE_EOF : OK;
 }
 
@@ -33,8 +33,24 @@
 
 #include "core/io/compression.h"
 #include "core/io/file_access.h"
+#include "core/templates/safe_refcount.h"
 
 class FileAccessCompressed : public FileAccess {
+public:
+	enum {
+		BLOCK_SIZE_DEFAULT = 65536,
+		// Version of the format with the block index in a footer. Files written before it
+		// have the index after the header, and are still read.
+		FORMAT_VERSION = 2,
+	};
+
+private:
+	enum {
+		// Sequential reads spanning at least this many whole blocks decompress them in parallel.
+		PARALLEL_MIN_BLOCKS = 2,
+		PARALLEL_MAX_BLOCKS = 64,
+	};
+
 	Compression::Mode cmode = Compression::MODE_ZSTD;
 	bool writing = false;
 	uint64_t write_pos = 0;
@@ -44,13 +60,23 @@ class FileAccessCompressed : public FileAccess {
 	uint32_t block_size = 0;
 	mutable bool read_eof = false;
 	mutable bool at_end = false;
+	mutable bool read_corrupt = false;
 
 	struct ReadBlock {
 		uint32_t csize;
 		uint64_t offset;
 	};
 
+	struct ParallelDecompress {
+		const uint8_t *src = nullptr;
+		uint64_t src_offset = 0;
+		uint8_t *dst = nullptr;
+		uint32_t first_block = 0;
+		SafeFlag failed;
+	};
+
 	mutable Vector<uint8_t> comp_buffer;
+	mutable Vector<uint8_t> parallel_comp_buffer;
 	uint8_t *read_ptr = nullptr;
 	mutable uint32_t read_block = 0;
 	uint32_t read_block_count = 0;
@@ -63,8 +89,17 @@ class FileAccessCompressed : public FileAccess {
 	mutable Vector<uint8_t> buffer;
 	FileAccess *f = nullptr;
 
+	_FORCE_INLINE_ uint32_t _get_block_size(uint32_t p_block) const {
+		return p_block == read_block_count - 1 ? read_total - uint64_t(p_block) * block_size : block_size;
+	}
+	bool _read_block(uint32_t p_block) const;
+	void _fail_read(uint32_t p_block) const;
+	bool _decompress_blocks(uint32_t p_first_block, uint32_t p_count, uint8_t *p_dst) const;
+	void _decompress_block(uint32_t p_index, ParallelDecompress *p_data) const;
+	void _compress_block(uint32_t p_index, Vector<uint8_t> *p_blocks) const;
+
 public:
-	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = 4096);
+	void configure(const String &p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = BLOCK_SIZE_DEFAULT);
 
 	Error open_after_magic(FileAccess *p_base);
 
@@ -31,7 +31,9 @@
 #include "file_access_pack.h"
 
 #include "core/io/file_access_encrypted.h"
+#include "core/io/marshalls.h"
 #include "core/object/script_language.h"
+#include "core/os/os.h"
 #include "core/version.h"
 
 #include <stdio.h>
@@ -46,7 +48,7 @@ Error PackedData::add_pack(const String &p_path, bool p_replace_files, uint64_t
 	return ERR_FILE_UNRECOGNIZED;
 }
 
-void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted) {
+void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted, const uint8_t *p_mapped) {
 	PathMD5 pmd5(p_path.md5_buffer());
 
 	bool exists = files.has(pmd5);
@@ -60,9 +62,10 @@ void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64
 		pf.md5[i] = p_md5[i];
 	}
 	pf.src = p_src;
+	pf.mapped = p_mapped;
 
 	if (!exists || p_replace_files) {
-		files[pmd5] = pf;
+		files.set(pmd5, pf);
 	}
 
 	if (!exists) {
@@ -72,18 +75,27 @@ void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64
 
 		if (p.find("/") != -1) { //in a subdir
 
-			Vector<String> ds = p.get_base_dir().split("/");
-
-			for (int j = 0; j < ds.size(); j++) {
-				if (!cd->subdirs.has(ds[j])) {
-					PackedDir *pd = memnew(PackedDir);
-					pd->name = ds[j];
-					pd->parent = cd;
-					cd->subdirs[pd->name] = pd;
-					cd = pd;
-				} else {
-					cd = cd->subdirs[ds[j]];
+			String dir_path = p.get_base_dir();
+			if (last_dir && dir_path == last_dir_path) {
+				cd = last_dir;
+			} else {
+				Vector<String> ds = dir_path.split("/");
+
+				for (int j = 0; j < ds.size(); j++) {
+					Map<String, PackedDir *>::Element *E = cd->subdirs.find(ds[j]);
+					if (!E) {
+						PackedDir *pd = memnew(PackedDir);
+						pd->name = ds[j];
+						pd->parent = cd;
+						cd->subdirs[pd->name] = pd;
+						cd = pd;
+					} else {
+						cd = E->get();
+					}
 				}
+
+				last_dir = cd;
+				last_dir_path = dir_path;
 			}
 		}
 		String filename = p_path.get_file();
@@ -94,6 +106,13 @@ void PackedData::add_path(const String &p_pkg_path, const String &p_path, uint64
 	}
 }
 
+void PackedData::reserve_paths(uint32_t p_count) {
+	uint32_t capacity = (files.get_num_elements() + p_count) / 0.9 + 1;
+	if (capacity > files.get_capacity()) {
+		files.reserve(capacity);
+	}
+}
+
 void PackedData::add_pack_source(PackSource *p_source) {
 	if (p_source != nullptr) {
 		sources.push_back(p_source);
@@ -193,6 +212,54 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 
 	int file_count = f->get_32();
 
+	PackedData::get_singleton()->reserve_paths(file_count);
+
+	// Packs stored as regular files are mapped, the files are then read straight from the mapping.
+	MappedPack mapped;
+	if (p_path.find("://") == -1 && OS::get_singleton()->map_file(p_path, mapped.data, mapped.size) == OK) {
+		mapped_packs.push_back(mapped);
+	}
+
+	if (mapped.data && !enc_directory) {
+		// Parse the directory in place rather than field by field through the file.
+		const uint8_t *dir = mapped.data + f->get_position();
+		const uint8_t *dir_end = mapped.data + mapped.size;
+
+		for (int i = 0; i < file_count; i++) {
+			if (dir_end - dir < 4) {
+				break;
+			}
+			uint32_t sl = decode_uint32(dir);
+			dir += 4;
+			if (uint64_t(dir_end - dir) < uint64_t(sl) + 8 + 8 + 16 + 4) {
+				break;
+			}
+
+			// Paths are padded with zeros.
+			int path_length = 0;
+			while (path_length < int(sl) && dir[path_length]) {
+				path_length++;
+			}
+			String path;
+			path.parse_utf8((const char *)dir, path_length);
+			dir += sl;
+
+			uint64_t ofs = file_base + decode_uint64(dir) + p_offset;
+			uint64_t size = decode_uint64(dir + 8);
+			const uint8_t *md5 = dir + 16;
+			uint32_t flags = decode_uint32(dir + 32);
+			dir += 36;
+
+			bool encrypted = flags & PACK_FILE_ENCRYPTED;
+			const uint8_t *data = (!encrypted && ofs + size <= mapped.size) ? mapped.data + ofs : nullptr;
+			PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, p_replace_files, encrypted, data);
+		}
+
+		f->close();
+		memdelete(f);
+		return true;
+	}
+
 	if (enc_directory) {
 		FileAccessEncrypted *fae = memnew(FileAccessEncrypted);
 		if (!fae) {
@@ -233,7 +300,9 @@ bool PackedSourcePCK::try_open_pack(const String &p_path, bool p_replace_files,
 		f->get_buffer(md5, 16);
 		uint32_t flags = f->get_32();
 
-		PackedData::get_singleton()->add_path(p_path, path, ofs + p_offset, size, md5, this, p_replace_files, (flags & PACK_FILE_ENCRYPTED));
+		bool encrypted = flags & PACK_FILE_ENCRYPTED;
+		const uint8_t *data = (mapped.data && !encrypted && ofs + p_offset + size <= mapped.size) ? mapped.data + ofs + p_offset : nullptr;
+		PackedData::get_singleton()->add_path(p_path, path, ofs + p_offset, size, md5, this, p_replace_files, encrypted, data);
 	}
 
 	f->close();
@@ -245,6 +314,12 @@ FileAccess *PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFi
 	return memnew(FileAccessPack(p_path, *p_file));
 }
 
+PackedSourcePCK::~PackedSourcePCK() {
+	for (int i = 0; i < mapped_packs.size(); i++) {
+		OS::get_singleton()->unmap_file(mapped_packs[i].data, mapped_packs[i].size);
+	}
+}
+
 //////////////////////////////////////////////////////////////////
 
 Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
@@ -253,11 +328,17 @@ Error FileAccessPack::_open(const String &p_path, int p_mode_flags) {
 }
 
 void FileAccessPack::close() {
-	f->close();
+	if (f) {
+		f->close();
+	}
+	closed = true;
 }
 
 bool FileAccessPack::is_open() const {
-	return f->is_open();
+	if (pf.mapped) {
+		return !closed;
+	}
+	return f && f->is_open();
 }
 
 void FileAccessPack::seek(uint64_t p_position) {
@@ -267,7 +348,9 @@ void FileAccessPack::seek(uint64_t p_position) {
 		eof = false;
 	}
 
-	f->seek(off + p_position);
+	if (f) {
+		f->seek(off + p_position);
+	}
 	pos = p_position;
 }
 
@@ -293,6 +376,10 @@ uint8_t FileAccessPack::get_8() const {
 		return 0;
 	}
 
+	if (pf.mapped) {
+		return pf.mapped[pos++];
+	}
+
 	pos++;
 	return f->get_8();
 }
@@ -315,14 +402,30 @@ uint64_t FileAccessPack::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
 	if (to_read <= 0) {
 		return 0;
 	}
-	f->get_buffer(p_dst, to_read);
+	if (pf.mapped) {
+		memcpy(p_dst, pf.mapped + pos - p_length, to_read);
+	} else {
+		f->get_buffer(p_dst, to_read);
+	}
 
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_mapped_buffer(uint64_t p_length) const {
+	if (!pf.mapped || eof || pos + p_length > pf.size) {
+		return nullptr;
+	}
+
+	const uint8_t *data = pf.mapped + pos;
+	pos += p_length;
+	return data;
+}
+
 void FileAccessPack::set_big_endian(bool p_big_endian) {
 	FileAccess::set_big_endian(p_big_endian);
-	f->set_big_endian(p_big_endian);
+	if (f) {
+		f->set_big_endian(p_big_endian);
+	}
 }
 
 Error FileAccessPack::get_error() const {
@@ -349,12 +452,20 @@ bool FileAccessPack::file_exists(const String &p_name) {
 }
 
 FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFile &p_file) :
-		pf(p_file),
-		f(FileAccess::open(pf.pack, FileAccess::READ)) {
+		pf(p_file) {
+	pos = 0;
+	eof = false;
+	off = pf.offset;
+
+	if (pf.mapped) {
+		// Read from the mapped pack, no need to open it.
+		return;
+	}
+
+	f = FileAccess::open(pf.pack, FileAccess::READ);
 	ERR_FAIL_COND_MSG(!f, "Can't open pack-referenced file '" + String(pf.pack) + "'.");
 
 	f->seek(pf.offset);
-	off = pf.offset;
 
 	if (pf.encrypted) {
 		FileAccessEncrypted *fae = memnew(FileAccessEncrypted);
@@ -376,8 +487,6 @@ FileAccessPack::FileAccessPack(const String &p_path, const PackedData::PackedFil
 		f = fae;
 		off = 0;
 	}
-	pos = 0;
-	eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
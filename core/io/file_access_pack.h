@@ -36,6 +36,7 @@
 #include "core/string/print_string.h"
 #include "core/templates/list.h"
 #include "core/templates/map.h"
+#include "core/templates/oa_hash_map.h"
 #include "core/templates/set.h"
 
 // Mesh's packed file magic header ("GDPC" in ASCII).
@@ -66,6 +67,7 @@ public:
 		uint8_t md5[16];
 		PackSource *src;
 		bool encrypted;
+		const uint8_t *mapped = nullptr; // Start of the file when the pack is memory mapped.
 	};
 
 private:
@@ -99,12 +101,23 @@ private:
 		}
 	};
 
-	Map<PathMD5, PackedFile> files;
+	struct PathMD5Hasher {
+		static _FORCE_INLINE_ uint32_t hash(const PathMD5 &p_md5) {
+			// Already a hash.
+			return uint32_t(p_md5.a);
+		}
+	};
+
+	OAHashMap<PathMD5, PackedFile, PathMD5Hasher> files;
 
 	Vector<PackSource *> sources;
 
 	PackedDir *root;
 
+	// Files are usually packed directory by directory.
+	PackedDir *last_dir = nullptr;
+	String last_dir_path;
+
 	static PackedData *singleton;
 	bool disabled = false;
 
@@ -112,7 +125,8 @@ private:
 
 public:
 	void add_pack_source(PackSource *p_source);
-	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false); // for PackSource
+	void add_path(const String &p_pkg_path, const String &p_path, uint64_t p_ofs, uint64_t p_size, const uint8_t *p_md5, PackSource *p_src, bool p_replace_files, bool p_encrypted = false, const uint8_t *p_mapped = nullptr); // for PackSource
+	void reserve_paths(uint32_t p_count);
 
 	void set_disabled(bool p_disabled) { disabled = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
@@ -138,9 +152,18 @@ public:
 };
 
 class PackedSourcePCK : public PackSource {
+	struct MappedPack {
+		const uint8_t *data = nullptr;
+		uint64_t size = 0;
+	};
+
+	Vector<MappedPack> mapped_packs;
+
 public:
 	virtual bool try_open_pack(const String &p_path, bool p_replace_files, uint64_t p_offset);
 	virtual FileAccess *get_file(const String &p_path, PackedData::PackedFile *p_file);
+
+	~PackedSourcePCK();
 };
 
 class FileAccessPack : public FileAccess {
@@ -150,7 +173,8 @@ class FileAccessPack : public FileAccess {
 	mutable bool eof;
 	uint64_t off;
 
-	FileAccess *f;
+	FileAccess *f = nullptr;
+	bool closed = false; // Mapped files don't use a FileAccess.
 	virtual Error _open(const String &p_path, int p_mode_flags);
 	virtual uint64_t _get_modified_time(const String &p_file) { return 0; }
 	virtual uint32_t _get_unix_permissions(const String &p_file) { return 0; }
@@ -170,6 +194,7 @@ public:
 	virtual uint8_t get_8() const;
 
 	virtual uint64_t get_buffer(uint8_t *p_dst, uint64_t p_length) const;
+	virtual const uint8_t *get_mapped_buffer(uint64_t p_length) const;
 
 	virtual void set_big_endian(bool p_big_endian);
 
@@ -188,15 +213,15 @@ public:
 
 FileAccess *PackedData::try_open_path(const String &p_path) {
 	PathMD5 pmd5(p_path.md5_buffer());
-	Map<PathMD5, PackedFile>::Element *E = files.find(pmd5);
-	if (!E) {
+	PackedFile *pf = files.lookup_ptr(pmd5);
+	if (!pf) {
 		return nullptr; //not found
 	}
-	if (E->get().offset == 0) {
+	if (pf->offset == 0) {
 		return nullptr; //was erased
 	}
 
-	return E->get().src->get_file(p_path, &E->get());
+	return pf->src->get_file(p_path, pf);
 }
 
 bool PackedData::has_path(const String &p_path) {
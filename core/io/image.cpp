@@ -36,9 +36,16 @@
 #include "core/math/math_funcs.h"
 #include "core/string/print_string.h"
 #include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/task_scheduler.h"
 
 #include <stdio.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGE_SSE2
+#endif
+
 const char *Image::format_names[Image::FORMAT_MAX] = {
 	"Lum8", //luminance
 	"LumAlpha8", //luminance-alpha
@@ -609,6 +616,79 @@ Image::Format Image::get_format() const {
 	return format;
 }
 
+enum {
+	// Passes writing fewer pixels than this run on the calling thread.
+	IMAGE_PARALLEL_MIN_PIXELS = 256 * 256,
+	IMAGE_SLICES_PER_THREAD = 4,
+};
+
+// A scaling or mipmap pass over the rows of an image. Rows are processed in slices,
+// in parallel on the task scheduler when the image is large enough.
+struct ImageRowJob {
+	typedef void (*RowFunc)(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to);
+
+	const uint8_t *src = nullptr;
+	uint8_t *dst = nullptr;
+	uint32_t src_width = 0;
+	uint32_t src_height = 0;
+	uint32_t dst_width = 0;
+	uint32_t dst_height = 0;
+	const void *tables = nullptr; // Data precomputed by the pass, shared by all rows.
+
+	RowFunc func = nullptr;
+	uint32_t rows = 0;
+	uint32_t rows_per_slice = 0;
+
+	void process_slice(uint32_t p_index, void *p_userdata) const {
+		uint32_t from = p_index * rows_per_slice;
+		func(*this, from, MIN(from + rows_per_slice, rows));
+	}
+
+	void run(RowFunc p_func, uint32_t p_rows, uint32_t p_row_pixels) {
+		func = p_func;
+		rows = p_rows;
+
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		if (!scheduler || p_rows < 2 || uint64_t(p_rows) * p_row_pixels < IMAGE_PARALLEL_MIN_PIXELS) {
+			func(*this, 0, p_rows);
+			return;
+		}
+
+		uint32_t slices = MIN(p_rows, (scheduler->get_thread_count() + 1) * IMAGE_SLICES_PER_THREAD);
+		rows_per_slice = (p_rows + slices - 1) / slices;
+		slices = (p_rows + rows_per_slice - 1) / rows_per_slice;
+		scheduler->parallel_for(slices, this, &ImageRowJob::process_slice, (void *)nullptr);
+	}
+
+	ImageRowJob(const uint8_t *p_src, uint8_t *p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height, const void *p_tables = nullptr) {
+		src = p_src;
+		dst = p_dst;
+		src_width = p_src_width;
+		src_height = p_src_height;
+		dst_width = p_dst_width;
+		dst_height = p_dst_height;
+		tables = p_tables;
+	}
+};
+
+#ifdef IMAGE_SSE2
+static _FORCE_INLINE_ __m128i _load_rgba8_epi16(const uint8_t *p_src) {
+	int32_t pixel;
+	memcpy(&pixel, p_src, 4);
+	return _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), _mm_setzero_si128());
+}
+
+static _FORCE_INLINE_ __m128 _load_rgba8_ps(const uint8_t *p_src) {
+	return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_load_rgba8_epi16(p_src), _mm_setzero_si128()));
+}
+
+static _FORCE_INLINE_ void _store_rgba8_epi32(uint8_t *p_dst, __m128i p_value) {
+	__m128i packed = _mm_packus_epi16(_mm_packs_epi32(p_value, p_value), _mm_setzero_si128());
+	int32_t pixel = _mm_cvtsi128_si32(packed);
+	memcpy(p_dst, &pixel, 4);
+}
+#endif
+
 static double _bicubic_interp_kernel(double x) {
 	x = ABS(x);
 
@@ -623,73 +703,50 @@ static double _bicubic_interp_kernel(double x) {
 	return bc;
 }
 
+struct ImageCubicColumn {
+	uint32_t ofs[4]; // Source offsets of the four taps, clamped to the image.
+	double weight[4];
+};
+
 template <int CC, class T>
-static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
-	// get source image size
-	int width = p_src_width;
-	int height = p_src_height;
-	double xfac = (double)width / p_dst_width;
-	double yfac = (double)height / p_dst_height;
-	// coordinates of source points and coefficients
-	double ox, oy, dx, dy, k1, k2;
-	int ox1, oy1, ox2, oy2;
-	// destination pixel values
-	// width and height decreased by 1
-	int ymax = height - 1;
-	int xmax = width - 1;
-	// temporary pointer
-
-	for (uint32_t y = 0; y < p_dst_height; y++) {
+static void _scale_cubic_rows(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to) {
+	const ImageCubicColumn *columns = (const ImageCubicColumn *)p_job.tables;
+	double yfac = (double)p_job.src_height / p_job.dst_height;
+	int ymax = p_job.src_height - 1;
+
+	for (uint32_t y = p_from; y < p_to; y++) {
 		// Y coordinates
-		oy = (double)y * yfac - 0.5f;
-		oy1 = (int)oy;
-		dy = oy - (double)oy1;
+		double oy = (double)y * yfac - 0.5f;
+		int oy1 = (int)oy;
+		double dy = oy - (double)oy1;
 
-		for (uint32_t x = 0; x < p_dst_width; x++) {
-			// X coordinates
-			ox = (double)x * xfac - 0.5f;
-			ox1 = (int)ox;
-			dx = ox - (double)ox1;
+		const T *__restrict rows[4];
+		double k1[4];
+		for (int n = -1; n < 3; n++) {
+			// get Y coefficient
+			k1[n + 1] = _bicubic_interp_kernel(dy - (double)n);
+			int oy2 = CLAMP(oy1 + n, 0, ymax);
+			rows[n + 1] = ((const T *)p_job.src) + oy2 * p_job.src_width * CC;
+		}
 
-			// initial pixel value
+		T *__restrict dst = ((T *)p_job.dst) + y * p_job.dst_width * CC;
 
-			T *__restrict dst = ((T *)p_dst) + (y * p_dst_width + x) * CC;
+		for (uint32_t x = 0; x < p_job.dst_width; x++) {
+			const ImageCubicColumn &column = columns[x];
 
 			double color[CC];
 			for (int i = 0; i < CC; i++) {
 				color[i] = 0;
 			}
 
-			for (int n = -1; n < 3; n++) {
-				// get Y coefficient
-				k1 = _bicubic_interp_kernel(dy - (double)n);
-
-				oy2 = oy1 + n;
-				if (oy2 < 0) {
-					oy2 = 0;
-				}
-				if (oy2 > ymax) {
-					oy2 = ymax;
-				}
-
-				for (int m = -1; m < 3; m++) {
-					// get X coefficient
-					k2 = k1 * _bicubic_interp_kernel((double)m - dx);
-
-					ox2 = ox1 + m;
-					if (ox2 < 0) {
-						ox2 = 0;
-					}
-					if (ox2 > xmax) {
-						ox2 = xmax;
-					}
-
-					// get pixel of original image
-					const T *__restrict p = ((T *)p_src) + (oy2 * p_src_width + ox2) * CC;
+			for (int n = 0; n < 4; n++) {
+				for (int m = 0; m < 4; m++) {
+					double k2 = k1[n] * column.weight[m];
+					const T *__restrict p = rows[n] + column.ofs[m];
 
 					for (int i = 0; i < CC; i++) {
 						if (sizeof(T) == 2) { //half float
-							color[i] = Math::half_to_float(p[i]);
+							color[i] += Math::half_to_float(p[i]) * k2;
 						} else {
 							color[i] += p[i] * k2;
 						}
@@ -706,240 +763,370 @@ static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_
 					dst[i] = color[i];
 				}
 			}
+			dst += CC;
 		}
 	}
 }
 
 template <int CC, class T>
-static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
-	enum {
-		FRAC_BITS = 8,
-		FRAC_LEN = (1 << FRAC_BITS),
-		FRAC_HALF = (FRAC_LEN >> 1),
-		FRAC_MASK = FRAC_LEN - 1
-	};
+static void _scale_cubic(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	// The X taps and coefficients are the same for every row.
+	LocalVector<ImageCubicColumn> columns;
+	columns.resize(p_dst_width);
 
-	for (uint32_t i = 0; i < p_dst_height; i++) {
-		// Add 0.5 in order to interpolate based on pixel center
-		uint32_t src_yofs_up_fp = (i + 0.5) * p_src_height * FRAC_LEN / p_dst_height;
-		// Calculate nearest src pixel center above current, and truncate to get y index
-		uint32_t src_yofs_up = src_yofs_up_fp >= FRAC_HALF ? (src_yofs_up_fp - FRAC_HALF) >> FRAC_BITS : 0;
-		uint32_t src_yofs_down = (src_yofs_up_fp + FRAC_HALF) >> FRAC_BITS;
-		if (src_yofs_down >= p_src_height) {
-			src_yofs_down = p_src_height - 1;
-		}
-		// Calculate distance to pixel center of src_yofs_up
-		uint32_t src_yofs_frac = src_yofs_up_fp & FRAC_MASK;
-		src_yofs_frac = src_yofs_frac >= FRAC_HALF ? src_yofs_frac - FRAC_HALF : src_yofs_frac + FRAC_HALF;
-
-		uint32_t y_ofs_up = src_yofs_up * p_src_width * CC;
-		uint32_t y_ofs_down = src_yofs_down * p_src_width * CC;
-
-		for (uint32_t j = 0; j < p_dst_width; j++) {
-			uint32_t src_xofs_left_fp = (j + 0.5) * p_src_width * FRAC_LEN / p_dst_width;
-			uint32_t src_xofs_left = src_xofs_left_fp >= FRAC_HALF ? (src_xofs_left_fp - FRAC_HALF) >> FRAC_BITS : 0;
-			uint32_t src_xofs_right = (src_xofs_left_fp + FRAC_HALF) >> FRAC_BITS;
-			if (src_xofs_right >= p_src_width) {
-				src_xofs_right = p_src_width - 1;
-			}
-			uint32_t src_xofs_frac = src_xofs_left_fp & FRAC_MASK;
-			src_xofs_frac = src_xofs_frac >= FRAC_HALF ? src_xofs_frac - FRAC_HALF : src_xofs_frac + FRAC_HALF;
+	double xfac = (double)p_src_width / p_dst_width;
+	int xmax = p_src_width - 1;
+
+	for (uint32_t x = 0; x < p_dst_width; x++) {
+		double ox = (double)x * xfac - 0.5f;
+		int ox1 = (int)ox;
+		double dx = ox - (double)ox1;
+
+		for (int m = -1; m < 3; m++) {
+			columns[x].weight[m + 1] = _bicubic_interp_kernel((double)m - dx);
+			columns[x].ofs[m + 1] = CLAMP(ox1 + m, 0, xmax) * CC;
+		}
+	}
+
+	ImageRowJob job(p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height, columns.ptr());
+	job.run(&_scale_cubic_rows<CC, T>, p_dst_height, p_dst_width);
+}
+
+enum {
+	BILINEAR_FRAC_BITS = 8,
+	BILINEAR_FRAC_LEN = (1 << BILINEAR_FRAC_BITS),
+	BILINEAR_FRAC_HALF = (BILINEAR_FRAC_LEN >> 1),
+	BILINEAR_FRAC_MASK = BILINEAR_FRAC_LEN - 1
+};
+
+struct ImageBilinearColumn {
+	uint32_t left; // Source offsets of the two taps.
+	uint32_t right;
+	uint32_t frac; // Weight of the right tap, in 1/BILINEAR_FRAC_LEN.
+};
+
+// Finds the two source pixel centers around destination pixel `p_index` and the distance to the first one.
+static _FORCE_INLINE_ void _bilinear_taps(uint32_t p_index, uint32_t p_src_size, uint32_t p_dst_size, uint32_t &r_first, uint32_t &r_second, uint32_t &r_frac) {
+	// Add 0.5 in order to interpolate based on pixel center
+	uint32_t src_ofs_fp = (p_index + 0.5) * p_src_size * BILINEAR_FRAC_LEN / p_dst_size;
+	// Calculate nearest src pixel center before the current one, and truncate to get the index
+	r_first = src_ofs_fp >= BILINEAR_FRAC_HALF ? (src_ofs_fp - BILINEAR_FRAC_HALF) >> BILINEAR_FRAC_BITS : 0;
+	r_second = (src_ofs_fp + BILINEAR_FRAC_HALF) >> BILINEAR_FRAC_BITS;
+	if (r_second >= p_src_size) {
+		r_second = p_src_size - 1;
+	}
+	// Calculate distance to pixel center of r_first
+	r_frac = src_ofs_fp & BILINEAR_FRAC_MASK;
+	r_frac = r_frac >= BILINEAR_FRAC_HALF ? r_frac - BILINEAR_FRAC_HALF : r_frac + BILINEAR_FRAC_HALF;
+}
+
+#ifdef IMAGE_SSE2
+static void _bilinear_row_rgba8_sse2(const uint8_t *__restrict p_up, const uint8_t *__restrict p_down, uint8_t *__restrict p_dst, const ImageBilinearColumn *p_columns, uint32_t p_width, uint32_t p_yfrac) {
+	// Same fixed point math as the scalar version. The vertical blend goes through floats,
+	// which hold its integer products exactly.
+	const __m128 weight_up = _mm_set1_ps(float(BILINEAR_FRAC_LEN - p_yfrac));
+	const __m128 weight_down = _mm_set1_ps(float(p_yfrac));
+
+	for (uint32_t j = 0; j < p_width; j++) {
+		const ImageBilinearColumn &column = p_columns[j];
+		// (1 - frac, frac) pairs, to weight interleaved (left, right) channels.
+		const __m128i weight_x = _mm_set1_epi32(int32_t((column.frac << 16) | (BILINEAR_FRAC_LEN - column.frac)));
+
+		__m128i up = _mm_madd_epi16(_mm_unpacklo_epi16(_load_rgba8_epi16(p_up + column.left), _load_rgba8_epi16(p_up + column.right)), weight_x);
+		__m128i down = _mm_madd_epi16(_mm_unpacklo_epi16(_load_rgba8_epi16(p_down + column.left), _load_rgba8_epi16(p_down + column.right)), weight_x);
+
+		__m128 interp = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(up), weight_up), _mm_mul_ps(_mm_cvtepi32_ps(down), weight_down));
+		_store_rgba8_epi32(p_dst + j * 4, _mm_srli_epi32(_mm_cvttps_epi32(interp), BILINEAR_FRAC_BITS * 2));
+	}
+}
 
-			src_xofs_left *= CC;
-			src_xofs_right *= CC;
+static void _bilinear_row_rgbaf_sse2(const float *__restrict p_up, const float *__restrict p_down, float *__restrict p_dst, const ImageBilinearColumn *p_columns, uint32_t p_width, uint32_t p_yfrac) {
+	const __m128 yofs_frac = _mm_set1_ps(float(p_yfrac) / BILINEAR_FRAC_LEN);
+
+	for (uint32_t j = 0; j < p_width; j++) {
+		const ImageBilinearColumn &column = p_columns[j];
+		const __m128 xofs_frac = _mm_set1_ps(float(column.frac) / BILINEAR_FRAC_LEN);
+
+		__m128 p00 = _mm_loadu_ps(p_up + column.left);
+		__m128 p10 = _mm_loadu_ps(p_up + column.right);
+		__m128 p01 = _mm_loadu_ps(p_down + column.left);
+		__m128 p11 = _mm_loadu_ps(p_down + column.right);
+
+		__m128 interp_up = _mm_add_ps(p00, _mm_mul_ps(_mm_sub_ps(p10, p00), xofs_frac));
+		__m128 interp_down = _mm_add_ps(p01, _mm_mul_ps(_mm_sub_ps(p11, p01), xofs_frac));
+		_mm_storeu_ps(p_dst + j * 4, _mm_add_ps(interp_up, _mm_mul_ps(_mm_sub_ps(interp_down, interp_up), yofs_frac)));
+	}
+}
+#endif
+
+template <int CC, class T>
+static void _scale_bilinear_rows(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to) {
+	const ImageBilinearColumn *columns = (const ImageBilinearColumn *)p_job.tables;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		uint32_t src_yofs_up;
+		uint32_t src_yofs_down;
+		uint32_t src_yofs_frac;
+		_bilinear_taps(i, p_job.src_height, p_job.dst_height, src_yofs_up, src_yofs_down, src_yofs_frac);
+
+		const T *__restrict src_up = ((const T *)p_job.src) + src_yofs_up * p_job.src_width * CC;
+		const T *__restrict src_down = ((const T *)p_job.src) + src_yofs_down * p_job.src_width * CC;
+		T *__restrict dst = ((T *)p_job.dst) + i * p_job.dst_width * CC;
+
+#ifdef IMAGE_SSE2
+		if (CC == 4 && sizeof(T) == 1) {
+			_bilinear_row_rgba8_sse2((const uint8_t *)src_up, (const uint8_t *)src_down, (uint8_t *)dst, columns, p_job.dst_width, src_yofs_frac);
+			continue;
+		} else if (CC == 4 && sizeof(T) == 4) {
+			_bilinear_row_rgbaf_sse2((const float *)src_up, (const float *)src_down, (float *)dst, columns, p_job.dst_width, src_yofs_frac);
+			continue;
+		}
+#endif
+
+		float yofs_frac = float(src_yofs_frac) / BILINEAR_FRAC_LEN;
+
+		for (uint32_t j = 0; j < p_job.dst_width; j++) {
+			const ImageBilinearColumn &column = columns[j];
 
 			for (uint32_t l = 0; l < CC; l++) {
 				if (sizeof(T) == 1) { //uint8
-					uint32_t p00 = p_src[y_ofs_up + src_xofs_left + l] << FRAC_BITS;
-					uint32_t p10 = p_src[y_ofs_up + src_xofs_right + l] << FRAC_BITS;
-					uint32_t p01 = p_src[y_ofs_down + src_xofs_left + l] << FRAC_BITS;
-					uint32_t p11 = p_src[y_ofs_down + src_xofs_right + l] << FRAC_BITS;
-
-					uint32_t interp_up = p00 + (((p10 - p00) * src_xofs_frac) >> FRAC_BITS);
-					uint32_t interp_down = p01 + (((p11 - p01) * src_xofs_frac) >> FRAC_BITS);
-					uint32_t interp = interp_up + (((interp_down - interp_up) * src_yofs_frac) >> FRAC_BITS);
-					interp >>= FRAC_BITS;
-					p_dst[i * p_dst_width * CC + j * CC + l] = uint8_t(interp);
+					uint32_t interp_up = src_up[column.left + l] * (BILINEAR_FRAC_LEN - column.frac) + src_up[column.right + l] * column.frac;
+					uint32_t interp_down = src_down[column.left + l] * (BILINEAR_FRAC_LEN - column.frac) + src_down[column.right + l] * column.frac;
+					uint32_t interp = interp_up * (BILINEAR_FRAC_LEN - src_yofs_frac) + interp_down * src_yofs_frac;
+					dst[l] = uint8_t(interp >> (BILINEAR_FRAC_BITS * 2));
 				} else if (sizeof(T) == 2) { //half float
+					float xofs_frac = float(column.frac) / BILINEAR_FRAC_LEN;
 
-					float xofs_frac = float(src_xofs_frac) / (1 << FRAC_BITS);
-					float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
-					const T *src = ((const T *)p_src);
-					T *dst = ((T *)p_dst);
-
-					float p00 = Math::half_to_float(src[y_ofs_up + src_xofs_left + l]);
-					float p10 = Math::half_to_float(src[y_ofs_up + src_xofs_right + l]);
-					float p01 = Math::half_to_float(src[y_ofs_down + src_xofs_left + l]);
-					float p11 = Math::half_to_float(src[y_ofs_down + src_xofs_right + l]);
+					float p00 = Math::half_to_float(src_up[column.left + l]);
+					float p10 = Math::half_to_float(src_up[column.right + l]);
+					float p01 = Math::half_to_float(src_down[column.left + l]);
+					float p11 = Math::half_to_float(src_down[column.right + l]);
 
 					float interp_up = p00 + (p10 - p00) * xofs_frac;
 					float interp_down = p01 + (p11 - p01) * xofs_frac;
 					float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
 
-					dst[i * p_dst_width * CC + j * CC + l] = Math::make_half_float(interp);
+					dst[l] = Math::make_half_float(interp);
 				} else if (sizeof(T) == 4) { //float
+					float xofs_frac = float(column.frac) / BILINEAR_FRAC_LEN;
 
-					float xofs_frac = float(src_xofs_frac) / (1 << FRAC_BITS);
-					float yofs_frac = float(src_yofs_frac) / (1 << FRAC_BITS);
-					const T *src = ((const T *)p_src);
-					T *dst = ((T *)p_dst);
-
-					float p00 = src[y_ofs_up + src_xofs_left + l];
-					float p10 = src[y_ofs_up + src_xofs_right + l];
-					float p01 = src[y_ofs_down + src_xofs_left + l];
-					float p11 = src[y_ofs_down + src_xofs_right + l];
+					float p00 = src_up[column.left + l];
+					float p10 = src_up[column.right + l];
+					float p01 = src_down[column.left + l];
+					float p11 = src_down[column.right + l];
 
 					float interp_up = p00 + (p10 - p00) * xofs_frac;
 					float interp_down = p01 + (p11 - p01) * xofs_frac;
 					float interp = interp_up + ((interp_down - interp_up) * yofs_frac);
 
-					dst[i * p_dst_width * CC + j * CC + l] = interp;
+					dst[l] = interp;
 				}
 			}
+			dst += CC;
 		}
 	}
 }
 
 template <int CC, class T>
-static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
-	for (uint32_t i = 0; i < p_dst_height; i++) {
-		uint32_t src_yofs = i * p_src_height / p_dst_height;
-		uint32_t y_ofs = src_yofs * p_src_width * CC;
+static void _scale_bilinear(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	LocalVector<ImageBilinearColumn> columns;
+	columns.resize(p_dst_width);
 
-		for (uint32_t j = 0; j < p_dst_width; j++) {
-			uint32_t src_xofs = j * p_src_width / p_dst_width;
-			src_xofs *= CC;
+	for (uint32_t j = 0; j < p_dst_width; j++) {
+		_bilinear_taps(j, p_src_width, p_dst_width, columns[j].left, columns[j].right, columns[j].frac);
+		columns[j].left *= CC;
+		columns[j].right *= CC;
+	}
 
-			for (uint32_t l = 0; l < CC; l++) {
-				const T *src = ((const T *)p_src);
-				T *dst = ((T *)p_dst);
+	ImageRowJob job(p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height, columns.ptr());
+	job.run(&_scale_bilinear_rows<CC, T>, p_dst_height, p_dst_width);
+}
+
+template <int CC, class T>
+static void _scale_nearest_rows(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to) {
+	const uint32_t *src_xofs = (const uint32_t *)p_job.tables;
+
+	for (uint32_t i = p_from; i < p_to; i++) {
+		uint32_t src_yofs = i * p_job.src_height / p_job.dst_height;
+		const T *src = ((const T *)p_job.src) + src_yofs * p_job.src_width * CC;
+		T *dst = ((T *)p_job.dst) + i * p_job.dst_width * CC;
 
-				T p = src[y_ofs + src_xofs + l];
-				dst[i * p_dst_width * CC + j * CC + l] = p;
+		for (uint32_t j = 0; j < p_job.dst_width; j++) {
+			for (uint32_t l = 0; l < CC; l++) {
+				dst[l] = src[src_xofs[j] + l];
 			}
+			dst += CC;
 		}
 	}
 }
 
+template <int CC, class T>
+static void _scale_nearest(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	LocalVector<uint32_t> src_xofs;
+	src_xofs.resize(p_dst_width);
+	for (uint32_t j = 0; j < p_dst_width; j++) {
+		src_xofs[j] = j * p_src_width / p_dst_width * CC;
+	}
+
+	ImageRowJob job(p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height, src_xofs.ptr());
+	job.run(&_scale_nearest_rows<CC, T>, p_dst_height, p_dst_width);
+}
+
 #define LANCZOS_TYPE 3
 
 static float _lanczos(float p_x) {
 	return Math::abs(p_x) >= LANCZOS_TYPE ? 0 : Math::sincn(p_x) * Math::sincn(p_x / LANCZOS_TYPE);
 }
 
-template <int CC, class T>
-static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
-	int32_t src_width = p_src_width;
-	int32_t src_height = p_src_height;
-	int32_t dst_height = p_dst_height;
-	int32_t dst_width = p_dst_width;
-
-	uint32_t buffer_size = src_height * dst_width * CC;
-	float *buffer = memnew_arr(float, buffer_size); // Store the first pass in a buffer
-
-	{ // FIRST PASS (horizontal)
+// Lanczos weights of every destination pixel along one axis, normalized so they add up to 1.
+struct ImageLanczosWeights {
+	LocalVector<uint32_t> start;
+	LocalVector<uint32_t> count;
+	LocalVector<float> weights; // `stride` weights per destination pixel.
+	uint32_t stride = 0;
 
-		float x_scale = float(src_width) / float(dst_width);
+	void create(int32_t p_src_size, int32_t p_dst_size) {
+		float scale = float(p_src_size) / float(p_dst_size);
 
-		float scale_factor = MAX(x_scale, 1); // A larger kernel is required only when downscaling
+		float scale_factor = MAX(scale, 1); // A larger kernel is required only when downscaling
 		int32_t half_kernel = LANCZOS_TYPE * scale_factor;
 
-		float *kernel = memnew_arr(float, half_kernel * 2);
+		stride = half_kernel * 2;
+		start.resize(p_dst_size);
+		count.resize(p_dst_size);
+		weights.resize(p_dst_size * stride);
 
-		for (int32_t buffer_x = 0; buffer_x < dst_width; buffer_x++) {
+		for (int32_t dst_i = 0; dst_i < p_dst_size; dst_i++) {
 			// The corresponding point on the source image
-			float src_x = (buffer_x + 0.5f) * x_scale; // Offset by 0.5 so it uses the pixel's center
-			int32_t start_x = MAX(0, int32_t(src_x) - half_kernel + 1);
-			int32_t end_x = MIN(src_width - 1, int32_t(src_x) + half_kernel);
-
-			// Create the kernel used by all the pixels of the column
-			for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
-				kernel[target_x - start_x] = _lanczos((target_x + 0.5f - src_x) / scale_factor);
+			float src_i = (dst_i + 0.5f) * scale; // Offset by 0.5 so it uses the pixel's center
+			int32_t start_i = MAX(0, int32_t(src_i) - half_kernel + 1);
+			int32_t end_i = MIN(p_src_size - 1, int32_t(src_i) + half_kernel);
+
+			float *kernel = &weights[dst_i * stride];
+			float weight = 0;
+			for (int32_t target_i = start_i; target_i <= end_i; target_i++) {
+				kernel[target_i - start_i] = _lanczos((target_i + 0.5f - src_i) / scale_factor);
+				weight += kernel[target_i - start_i];
+			}
+			for (int32_t target_i = start_i; target_i <= end_i; target_i++) {
+				kernel[target_i - start_i] /= weight; // Normalize the sum of all the samples
 			}
 
-			for (int32_t buffer_y = 0; buffer_y < src_height; buffer_y++) {
-				float pixel[CC] = { 0 };
-				float weight = 0;
-
-				for (int32_t target_x = start_x; target_x <= end_x; target_x++) {
-					float lanczos_val = kernel[target_x - start_x];
-					weight += lanczos_val;
+			start[dst_i] = start_i;
+			count[dst_i] = end_i - start_i + 1;
+		}
+	}
+};
 
-					const T *__restrict src_data = ((const T *)p_src) + (buffer_y * src_width + target_x) * CC;
+struct ImageLanczosTables {
+	ImageLanczosWeights horizontal;
+	ImageLanczosWeights vertical;
+	float *buffer = nullptr; // Result of the horizontal pass, src_height rows of dst_width pixels.
+};
 
-					for (uint32_t i = 0; i < CC; i++) {
-						if (sizeof(T) == 2) { //half float
-							pixel[i] += Math::half_to_float(src_data[i]) * lanczos_val;
-						} else {
-							pixel[i] += src_data[i] * lanczos_val;
-						}
-					}
+template <int CC, class T>
+static void _scale_lanczos_horizontal_rows(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to) {
+	const ImageLanczosTables *tables = (const ImageLanczosTables *)p_job.tables;
+	const ImageLanczosWeights &horizontal = tables->horizontal;
+
+	for (uint32_t buffer_y = p_from; buffer_y < p_to; buffer_y++) {
+		const T *__restrict src_row = ((const T *)p_job.src) + buffer_y * p_job.src_width * CC;
+		float *__restrict buffer_row = tables->buffer + buffer_y * p_job.dst_width * CC;
+
+		for (uint32_t buffer_x = 0; buffer_x < p_job.dst_width; buffer_x++) {
+			const T *__restrict src_data = src_row + horizontal.start[buffer_x] * CC;
+			const float *kernel = &horizontal.weights[buffer_x * horizontal.stride];
+			uint32_t count = horizontal.count[buffer_x];
+
+#ifdef IMAGE_SSE2
+			if (CC == 4 && (sizeof(T) == 1 || sizeof(T) == 4)) {
+				__m128 pixel = _mm_setzero_ps();
+				for (uint32_t k = 0; k < count; k++) {
+					__m128 value = sizeof(T) == 1 ? _load_rgba8_ps((const uint8_t *)(src_data + k * CC)) : _mm_loadu_ps((const float *)(src_data + k * CC));
+					pixel = _mm_add_ps(pixel, _mm_mul_ps(value, _mm_set1_ps(kernel[k])));
 				}
+				_mm_storeu_ps(buffer_row + buffer_x * CC, pixel);
+				continue;
+			}
+#endif
 
-				float *dst_data = ((float *)buffer) + (buffer_y * dst_width + buffer_x) * CC;
-
+			float pixel[CC] = { 0 };
+			for (uint32_t k = 0; k < count; k++) {
 				for (uint32_t i = 0; i < CC; i++) {
-					dst_data[i] = pixel[i] / weight; // Normalize the sum of all the samples
+					if (sizeof(T) == 2) { //half float
+						pixel[i] += Math::half_to_float(src_data[k * CC + i]) * kernel[k];
+					} else {
+						pixel[i] += src_data[k * CC + i] * kernel[k];
+					}
 				}
 			}
-		}
-
-		memdelete_arr(kernel);
-	} // End of first pass
-
-	{ // SECOND PASS (vertical + result)
-
-		float y_scale = float(src_height) / float(dst_height);
 
-		float scale_factor = MAX(y_scale, 1);
-		int32_t half_kernel = LANCZOS_TYPE * scale_factor;
-
-		float *kernel = memnew_arr(float, half_kernel * 2);
-
-		for (int32_t dst_y = 0; dst_y < dst_height; dst_y++) {
-			float buffer_y = (dst_y + 0.5f) * y_scale;
-			int32_t start_y = MAX(0, int32_t(buffer_y) - half_kernel + 1);
-			int32_t end_y = MIN(src_height - 1, int32_t(buffer_y) + half_kernel);
-
-			for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
-				kernel[target_y - start_y] = _lanczos((target_y + 0.5f - buffer_y) / scale_factor);
+			for (uint32_t i = 0; i < CC; i++) {
+				buffer_row[buffer_x * CC + i] = pixel[i];
 			}
+		}
+	}
+}
 
-			for (int32_t dst_x = 0; dst_x < dst_width; dst_x++) {
-				float pixel[CC] = { 0 };
-				float weight = 0;
-
-				for (int32_t target_y = start_y; target_y <= end_y; target_y++) {
-					float lanczos_val = kernel[target_y - start_y];
-					weight += lanczos_val;
-
-					float *buffer_data = ((float *)buffer) + (target_y * dst_width + dst_x) * CC;
-
-					for (uint32_t i = 0; i < CC; i++) {
-						pixel[i] += buffer_data[i] * lanczos_val;
-					}
-				}
+template <int CC, class T>
+static void _scale_lanczos_vertical_rows(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to) {
+	const ImageLanczosTables *tables = (const ImageLanczosTables *)p_job.tables;
+	const ImageLanczosWeights &vertical = tables->vertical;
+	uint32_t row_size = p_job.dst_width * CC;
+
+	// Whole rows are accumulated at once, so the same loop serves every format.
+	float *pixels = memnew_arr(float, row_size);
+
+	for (uint32_t dst_y = p_from; dst_y < p_to; dst_y++) {
+		const float *kernel = &vertical.weights[dst_y * vertical.stride];
+		const float *buffer_rows = tables->buffer + vertical.start[dst_y] * row_size;
+		uint32_t count = vertical.count[dst_y];
+
+		memset(pixels, 0, row_size * sizeof(float));
+
+		for (uint32_t k = 0; k < count; k++) {
+			const float *__restrict buffer_data = buffer_rows + k * row_size;
+			float lanczos_val = kernel[k];
+			uint32_t n = 0;
+#ifdef IMAGE_SSE2
+			const __m128 weight = _mm_set1_ps(lanczos_val);
+			for (; n + 4 <= row_size; n += 4) {
+				_mm_storeu_ps(pixels + n, _mm_add_ps(_mm_loadu_ps(pixels + n), _mm_mul_ps(_mm_loadu_ps(buffer_data + n), weight)));
+			}
+#endif
+			for (; n < row_size; n++) {
+				pixels[n] += buffer_data[n] * lanczos_val;
+			}
+		}
 
-				T *dst_data = ((T *)p_dst) + (dst_y * dst_width + dst_x) * CC;
+		T *__restrict dst_data = ((T *)p_job.dst) + dst_y * row_size;
 
-				for (uint32_t i = 0; i < CC; i++) {
-					pixel[i] /= weight;
-
-					if (sizeof(T) == 1) { //byte
-						dst_data[i] = CLAMP(Math::fast_ftoi(pixel[i]), 0, 255);
-					} else if (sizeof(T) == 2) { //half float
-						dst_data[i] = Math::make_half_float(pixel[i]);
-					} else { // float
-						dst_data[i] = pixel[i];
-					}
-				}
+		for (uint32_t n = 0; n < row_size; n++) {
+			if (sizeof(T) == 1) { //byte
+				dst_data[n] = CLAMP(Math::fast_ftoi(pixels[n]), 0, 255);
+			} else if (sizeof(T) == 2) { //half float
+				dst_data[n] = Math::make_half_float(pixels[n]);
+			} else { // float
+				dst_data[n] = pixels[n];
 			}
 		}
+	}
+
+	memdelete_arr(pixels);
+}
+
+template <int CC, class T>
+static void _scale_lanczos(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, uint32_t p_src_width, uint32_t p_src_height, uint32_t p_dst_width, uint32_t p_dst_height) {
+	ImageLanczosTables tables;
+	tables.horizontal.create(p_src_width, p_dst_width);
+	tables.vertical.create(p_src_height, p_dst_height);
+	tables.buffer = memnew_arr(float, p_src_height * p_dst_width * CC); // Store the first pass in a buffer
 
-		memdelete_arr(kernel);
-	} // End of second pass
+	ImageRowJob job(p_src, p_dst, p_src_width, p_src_height, p_dst_width, p_dst_height, &tables);
+	job.run(&_scale_lanczos_horizontal_rows<CC, T>, p_src_height, p_dst_width); // FIRST PASS (horizontal)
+	job.run(&_scale_lanczos_vertical_rows<CC, T>, p_dst_height, p_dst_width); // SECOND PASS (vertical + result)
 
-	memdelete_arr(buffer);
+	memdelete_arr(tables.buffer);
 }
 
 static void _overlay(const uint8_t *__restrict p_src, uint8_t *__restrict p_dst, float p_alpha, uint32_t p_width, uint32_t p_height, uint32_t p_pixel_size) {
@@ -1461,20 +1648,53 @@ bool Image::_can_modify(Format p_format) const {
 template <class Component, int CC, bool renormalize,
 		void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
 		void (*renormalize_func)(Component *)>
-static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
-	//fast power of 2 mipmap generation
-	uint32_t dst_w = MAX(p_width >> 1, 1);
-	uint32_t dst_h = MAX(p_height >> 1, 1);
+static void _generate_po2_mipmap_rows(const ImageRowJob &p_job, uint32_t p_from, uint32_t p_to) {
+	const Component *src = (const Component *)p_job.src;
+	uint32_t dst_w = p_job.dst_width;
 
-	int right_step = (p_width == 1) ? 0 : CC;
-	int down_step = (p_height == 1) ? 0 : (p_width * CC);
+	int right_step = (p_job.src_width == 1) ? 0 : CC;
+	int down_step = (p_job.src_height == 1) ? 0 : (p_job.src_width * CC);
 
-	for (uint32_t i = 0; i < dst_h; i++) {
-		const Component *rup_ptr = &p_src[i * 2 * down_step];
+	for (uint32_t i = p_from; i < p_to; i++) {
+		const Component *rup_ptr = &src[i * 2 * down_step];
 		const Component *rdown_ptr = rup_ptr + down_step;
-		Component *dst_ptr = &p_dst[i * dst_w * CC];
+		Component *dst_ptr = ((Component *)p_job.dst) + i * dst_w * CC;
 		uint32_t count = dst_w;
 
+#ifdef IMAGE_SSE2
+		if (CC == 4 && sizeof(Component) == 1 && !renormalize && right_step != 0) {
+			// RGBA8, two destination pixels at a time.
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i round = _mm_set1_epi16(2);
+			for (; count >= 2; count -= 2) {
+				__m128i up = _mm_loadu_si128((const __m128i *)rup_ptr);
+				__m128i down = _mm_loadu_si128((const __m128i *)rdown_ptr);
+				__m128i sum_lo = _mm_add_epi16(_mm_unpacklo_epi8(up, zero), _mm_unpacklo_epi8(down, zero));
+				__m128i sum_hi = _mm_add_epi16(_mm_unpackhi_epi8(up, zero), _mm_unpackhi_epi8(down, zero));
+				// Add each pair of horizontally adjacent pixels.
+				sum_lo = _mm_add_epi16(sum_lo, _mm_srli_si128(sum_lo, 8));
+				sum_hi = _mm_add_epi16(sum_hi, _mm_srli_si128(sum_hi, 8));
+				__m128i average = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sum_lo, sum_hi), round), 2);
+				_mm_storel_epi64((__m128i *)dst_ptr, _mm_packus_epi16(average, zero));
+
+				dst_ptr += CC * 2;
+				rup_ptr += right_step * 4;
+				rdown_ptr += right_step * 4;
+			}
+		} else if (CC == 4 && sizeof(Component) == 4 && !renormalize && right_step != 0) {
+			// RGBAF, one destination pixel at a time.
+			const __m128 quarter = _mm_set1_ps(0.25f);
+			for (; count; count--) {
+				__m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_loadu_ps((const float *)rup_ptr), _mm_loadu_ps((const float *)rup_ptr + CC)), _mm_loadu_ps((const float *)rdown_ptr)), _mm_loadu_ps((const float *)rdown_ptr + CC));
+				_mm_storeu_ps((float *)dst_ptr, _mm_mul_ps(sum, quarter));
+
+				dst_ptr += CC;
+				rup_ptr += right_step * 2;
+				rdown_ptr += right_step * 2;
+			}
+		}
+#endif
+
 		while (count) {
 			count--;
 			for (int j = 0; j < CC; j++) {
@@ -1492,6 +1712,18 @@ static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint3
 	}
 }
 
+template <class Component, int CC, bool renormalize,
+		void (*average_func)(Component &, const Component &, const Component &, const Component &, const Component &),
+		void (*renormalize_func)(Component *)>
+static void _generate_po2_mipmap(const Component *p_src, Component *p_dst, uint32_t p_width, uint32_t p_height) {
+	//fast power of 2 mipmap generation
+	uint32_t dst_w = MAX(p_width >> 1, 1);
+	uint32_t dst_h = MAX(p_height >> 1, 1);
+
+	ImageRowJob job((const uint8_t *)p_src, (uint8_t *)p_dst, p_width, p_height, dst_w, dst_h);
+	job.run(&_generate_po2_mipmap_rows<Component, CC, renormalize, average_func, renormalize_func>, dst_h, dst_w);
+}
+
 void Image::shrink_x2() {
 	ERR_FAIL_COND(data.size() == 0);
 
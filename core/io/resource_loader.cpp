@@ -213,77 +213,274 @@ RES ResourceLoader::_load(const String &p_path, const String &p_original_path, c
 	ERR_FAIL_V_MSG(RES(), "No loader found for resource: " + p_path + ".");
 }
 
-void ResourceLoader::_thread_load_function(void *p_userdata) {
-	ThreadLoadTask &load_task = *(ThreadLoadTask *)p_userdata;
-	load_task.loader_id = Thread::get_caller_id();
-
-	if (load_task.semaphore) {
-		//this is an actual thread, so wait for Ok from semaphore
-		thread_load_semaphore->wait(); //wait until its ok to start loading
+static String _validate_local_path(const String &p_path) {
+	ResourceUID::ID uid = ResourceUID::get_singleton()->text_to_id(p_path);
+	if (uid != ResourceUID::INVALID_ID) {
+		return ResourceUID::get_singleton()->get_id_path(uid);
+	} else if (p_path.is_relative_path()) {
+		return "res://" + p_path;
+	} else {
+		return ProjectSettings::get_singleton()->localize_path(p_path);
 	}
-	load_task.resource = _load(load_task.remapped_path, load_task.remapped_path != load_task.local_path ? load_task.local_path : String(), load_task.type_hint, load_task.cache_mode, &load_task.error, load_task.use_sub_threads, &load_task.progress);
+}
+
+void ResourceLoader::_run_load_task(ThreadLoadTask &p_load_task) {
+	p_load_task.loader_id = Thread::get_caller_id();
+
+	p_load_task.resource = _load(p_load_task.remapped_path, p_load_task.remapped_path != p_load_task.local_path ? p_load_task.local_path : String(), p_load_task.type_hint, p_load_task.cache_mode, &p_load_task.error, p_load_task.use_sub_threads, &p_load_task.progress);
 
-	load_task.progress = 1.0; //it was fully loaded at this point, so force progress to 1.0
+	p_load_task.progress = 1.0; //it was fully loaded at this point, so force progress to 1.0
 
 	thread_load_mutex->lock();
-	if (load_task.error != OK) {
-		load_task.status = THREAD_LOAD_FAILED;
+	if (p_load_task.error != OK) {
+		p_load_task.status = THREAD_LOAD_FAILED;
 	} else {
-		load_task.status = THREAD_LOAD_LOADED;
+		p_load_task.status = THREAD_LOAD_LOADED;
 	}
-	if (load_task.semaphore) {
-		if (load_task.start_next && thread_waiting_count > 0) {
-			thread_waiting_count--;
-			//thread loading count remains constant, this ends but another one begins
-			thread_load_semaphore->post();
-		} else {
-			thread_loading_count--; //no threads waiting, just reduce loading count
-		}
-
-		print_lt("END: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+	p_load_task.stage = THREAD_LOAD_STAGE_DONE;
 
-		for (int i = 0; i < load_task.poll_requests; i++) {
-			load_task.semaphore->post();
+	if (p_load_task.semaphore) {
+		for (int i = 0; i < p_load_task.poll_requests; i++) {
+			p_load_task.semaphore->post();
 		}
-		memdelete(load_task.semaphore);
-		load_task.semaphore = nullptr;
+		memdelete(p_load_task.semaphore);
+		p_load_task.semaphore = nullptr;
 	}
 
-	if (load_task.resource.is_valid()) {
-		load_task.resource->set_path(load_task.local_path);
+	if (p_load_task.resource.is_valid()) {
+		p_load_task.resource->set_path(p_load_task.local_path);
 
-		if (load_task.xl_remapped) {
-			load_task.resource->set_as_translation_remapped(true);
+		if (p_load_task.xl_remapped) {
+			p_load_task.resource->set_as_translation_remapped(true);
 		}
 
 #ifdef TOOLS_ENABLED
 
-		load_task.resource->set_edited(false);
+		p_load_task.resource->set_edited(false);
 		if (timestamp_on_load) {
-			uint64_t mt = FileAccess::get_modified_time(load_task.remapped_path);
+			uint64_t mt = FileAccess::get_modified_time(p_load_task.remapped_path);
 			//printf("mt %s: %lli\n",remapped_path.utf8().get_data(),mt);
-			load_task.resource->set_last_modified_time(mt);
+			p_load_task.resource->set_last_modified_time(mt);
 		}
 #endif
 
 		if (_loaded_callback) {
-			_loaded_callback(load_task.resource, load_task.local_path);
+			_loaded_callback(p_load_task.resource, p_load_task.local_path);
+		}
+	}
+
+	for (uint32_t i = 0; i < p_load_task.dependents.size(); i++) {
+		ThreadLoadTask *dependent = p_load_task.dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0 && dependent->stage == THREAD_LOAD_STAGE_WAITING) {
+			// Finish the resources already started before scanning new ones.
+			dependent->stage = THREAD_LOAD_STAGE_READY;
+			_queue_load_task(dependent, true);
 		}
 	}
+	p_load_task.dependents.clear();
+
+	if (p_load_task.requests == 0) {
+		// Dependency no longer needed by anyone, it was only kept until it finished.
+		_erase_load_task(&p_load_task);
+	}
 
 	thread_load_mutex->unlock();
 }
 
-static String _validate_local_path(const String &p_path) {
-	ResourceUID::ID uid = ResourceUID::get_singleton()->text_to_id(p_path);
-	if (uid != ResourceUID::INVALID_ID) {
-		return ResourceUID::get_singleton()->get_id_path(uid);
-	} else if (p_path.is_relative_path()) {
-		return "res://" + p_path;
+void ResourceLoader::_scan_dependencies(ThreadLoadTask &p_load_task) {
+	// Reading the dependency list is I/O, so it's done without holding the lock.
+	List<String> dependencies;
+	get_dependencies(p_load_task.local_path, &dependencies, true);
+
+	thread_load_mutex->lock();
+
+	for (const String &E : dependencies) {
+		String path = E.get_slice("::", 0);
+		if (path.is_empty()) {
+			continue;
+		}
+		path = _validate_local_path(path);
+		if (path == p_load_task.local_path) {
+			continue;
+		}
+
+		ThreadLoadTask *dependency = thread_load_tasks.getptr(path);
+		if (!dependency) {
+			if (ResourceCache::has(path)) {
+				continue;
+			}
+			String type_hint = E.get_slice_count("::") > 1 ? E.get_slice("::", 1) : String();
+			dependency = _create_load_task(path, type_hint, false, ResourceFormatLoader::CACHE_MODE_REUSE);
+		} else if (p_load_task.dependencies.find(dependency) != -1) {
+			continue;
+		} else if (dependency->stage != THREAD_LOAD_STAGE_DONE && _load_task_depends_on(dependency, &p_load_task)) {
+			// Cyclic dependency, let the loader resolve it as it would when loading without threads.
+			continue;
+		}
+
+		dependency->requests++;
+		p_load_task.dependencies.push_back(dependency);
+		if (dependency->stage != THREAD_LOAD_STAGE_DONE) {
+			dependency->dependents.push_back(&p_load_task);
+			p_load_task.pending_dependencies++;
+		}
+	}
+
+	if (p_load_task.pending_dependencies > 0) {
+		p_load_task.stage = THREAD_LOAD_STAGE_WAITING;
+		thread_load_mutex->unlock();
+		return;
+	}
+
+	p_load_task.stage = THREAD_LOAD_STAGE_RUNNING;
+	thread_load_mutex->unlock();
+
+	_run_load_task(p_load_task);
+}
+
+void ResourceLoader::_thread_load_worker(void *p_userdata) {
+	while (true) {
+		thread_load_semaphore->wait();
+
+		thread_load_mutex->lock();
+		if (thread_load_exit) {
+			thread_load_mutex->unlock();
+			return;
+		}
+		if (thread_load_queue.is_empty()) {
+			// Taken over by a thread waiting for it.
+			thread_load_mutex->unlock();
+			continue;
+		}
+
+		ThreadLoadTask *load_task = thread_load_queue.front()->get();
+		thread_load_queue.pop_front();
+		load_task->queue_element = nullptr;
+
+		print_lt("WORKER: " + load_task->local_path + " / queued: " + itos(thread_load_queue.size()) + " / tasks: " + itos(thread_load_tasks.size()));
+
+		if (load_task->stage == THREAD_LOAD_STAGE_QUEUED) {
+			load_task->stage = THREAD_LOAD_STAGE_SCANNING;
+			thread_load_mutex->unlock();
+			_scan_dependencies(*load_task);
+		} else {
+			load_task->stage = THREAD_LOAD_STAGE_RUNNING;
+			thread_load_mutex->unlock();
+			_run_load_task(*load_task);
+		}
+	}
+}
+
+ResourceLoader::ThreadLoadTask *ResourceLoader::_create_load_task(const String &p_local_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode) {
+	ThreadLoadTask load_task;
+
+	load_task.remapped_path = _path_remap(p_local_path, &load_task.xl_remapped);
+	load_task.local_path = p_local_path;
+	load_task.type_hint = p_type_hint;
+	load_task.cache_mode = p_cache_mode;
+	load_task.use_sub_threads = p_use_sub_threads;
+
+	{ //must check if resource is already loaded before attempting to load it in a thread
+
+		//lock first if possible
+		ResourceCache::lock.read_lock();
+
+		//get ptr
+		Resource **rptr = ResourceCache::resources.getptr(p_local_path);
+
+		if (rptr) {
+			RES res(*rptr);
+			//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
+			if (res.is_valid()) {
+				//referencing is fine
+				load_task.resource = res;
+				load_task.status = THREAD_LOAD_LOADED;
+				load_task.progress = 1.0;
+			}
+		}
+		ResourceCache::lock.read_unlock();
+	}
+
+	thread_load_tasks[p_local_path] = load_task;
+	ThreadLoadTask *task = &thread_load_tasks[p_local_path];
+
+	if (task->resource.is_null()) { //needs to be loaded in thread
+		task->semaphore = memnew(Semaphore);
+		// Only resources shared through the cache can be loaded ahead of the ones using them.
+		if (p_cache_mode == ResourceFormatLoader::CACHE_MODE_REUSE) {
+			task->stage = THREAD_LOAD_STAGE_QUEUED;
+		} else {
+			task->stage = THREAD_LOAD_STAGE_READY;
+		}
+		_queue_load_task(task);
+	}
+
+	return task;
+}
+
+void ResourceLoader::_queue_load_task(ThreadLoadTask *p_load_task, bool p_front) {
+	if (thread_load_workers.is_empty()) {
+		for (int i = 0; i < thread_load_max; i++) {
+			Thread *thread = memnew(Thread);
+			thread->start(_thread_load_worker, nullptr);
+			thread_load_workers.push_back(thread);
+		}
+	}
+
+	if (p_front) {
+		p_load_task->queue_element = thread_load_queue.push_front(p_load_task);
 	} else {
-		return ProjectSettings::get_singleton()->localize_path(p_path);
+		p_load_task->queue_element = thread_load_queue.push_back(p_load_task);
+	}
+	thread_load_semaphore->post();
+}
+
+void ResourceLoader::_release_load_task(ThreadLoadTask *p_load_task) {
+	p_load_task->requests--;
+	// Tasks still loading are erased once they finish.
+	if (p_load_task->requests == 0 && p_load_task->stage == THREAD_LOAD_STAGE_DONE) {
+		_erase_load_task(p_load_task);
 	}
 }
+
+void ResourceLoader::_erase_load_task(ThreadLoadTask *p_load_task) {
+	LocalVector<ThreadLoadTask *> dependencies = p_load_task->dependencies;
+	for (uint32_t i = 0; i < dependencies.size(); i++) {
+		// It may have been loaded before its dependencies when taken over by a waiting thread.
+		dependencies[i]->dependents.erase(p_load_task);
+	}
+
+	thread_load_tasks.erase(String(p_load_task->local_path));
+
+	for (uint32_t i = 0; i < dependencies.size(); i++) {
+		_release_load_task(dependencies[i]);
+	}
+}
+
+bool ResourceLoader::_load_task_depends_on(ThreadLoadTask *p_load_task, ThreadLoadTask *p_dependency) {
+	Set<ThreadLoadTask *> visited;
+	LocalVector<ThreadLoadTask *> stack;
+	stack.push_back(p_load_task);
+
+	while (stack.size()) {
+		ThreadLoadTask *task = stack[stack.size() - 1];
+		stack.resize(stack.size() - 1);
+		if (task == p_dependency) {
+			return true;
+		}
+		if (visited.has(task)) {
+			continue;
+		}
+		visited.insert(task);
+		for (uint32_t i = 0; i < task->dependencies.size(); i++) {
+			stack.push_back(task->dependencies[i]);
+		}
+	}
+
+	return false;
+}
+
 Error ResourceLoader::load_threaded_request(const String &p_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode, const String &p_source_resource) {
 	String local_path = _validate_local_path(p_path);
 
@@ -308,103 +505,50 @@ Error ResourceLoader::load_threaded_request(const String &p_path, const String &
 		}
 	}
 
-	if (thread_load_tasks.has(local_path)) {
-		thread_load_tasks[local_path].requests++;
-		if (!p_source_resource.is_empty()) {
-			thread_load_tasks[p_source_resource].sub_tasks.insert(local_path);
-		}
-		thread_load_mutex->unlock();
-		return OK;
+	ThreadLoadTask *load_task = thread_load_tasks.getptr(local_path);
+	if (!load_task) {
+		load_task = _create_load_task(local_path, p_type_hint, p_use_sub_threads, p_cache_mode);
 	}
+	load_task->requests++;
 
-	{
-		//create load task
-
-		ThreadLoadTask load_task;
-
-		load_task.requests = 1;
-		load_task.remapped_path = _path_remap(local_path, &load_task.xl_remapped);
-		load_task.local_path = local_path;
-		load_task.type_hint = p_type_hint;
-		load_task.cache_mode = p_cache_mode;
-		load_task.use_sub_threads = p_use_sub_threads;
-
-		{ //must check if resource is already loaded before attempting to load it in a thread
-
-			if (load_task.loader_id == Thread::get_caller_id()) {
-				thread_load_mutex->unlock();
-				ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Attempted to load a resource already being loaded from this thread, cyclic reference?");
-			}
-			//lock first if possible
-			ResourceCache::lock.read_lock();
-
-			//get ptr
-			Resource **rptr = ResourceCache::resources.getptr(local_path);
-
-			if (rptr) {
-				RES res(*rptr);
-				//it is possible this resource was just freed in a thread. If so, this referencing will not work and resource is considered not cached
-				if (res.is_valid()) {
-					//referencing is fine
-					load_task.resource = res;
-					load_task.status = THREAD_LOAD_LOADED;
-					load_task.progress = 1.0;
-				}
-			}
-			ResourceCache::lock.read_unlock();
-		}
-
-		if (!p_source_resource.is_empty()) {
-			thread_load_tasks[p_source_resource].sub_tasks.insert(local_path);
-		}
-
-		thread_load_tasks[local_path] = load_task;
+	if (!p_source_resource.is_empty()) {
+		thread_load_tasks[p_source_resource].sub_tasks.insert(local_path);
 	}
 
-	ThreadLoadTask &load_task = thread_load_tasks[local_path];
-
-	if (load_task.resource.is_null()) { //needs to be loaded in thread
+	print_lt("REQUEST: " + local_path + " / queued: " + itos(thread_load_queue.size()) + " / tasks: " + itos(thread_load_tasks.size()));
 
-		load_task.semaphore = memnew(Semaphore);
-		if (thread_loading_count < thread_load_max) {
-			thread_loading_count++;
-			thread_load_semaphore->post(); //we have free threads, so allow one
-		} else {
-			thread_waiting_count++;
-		}
+	thread_load_mutex->unlock();
 
-		print_lt("REQUEST: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
+	return OK;
+}
 
-		load_task.thread = memnew(Thread);
-		load_task.thread->start(_thread_load_function, &thread_load_tasks[local_path]);
-		load_task.loader_id = load_task.thread->get_id();
+void ResourceLoader::_dependency_add_progress(const String &p_path, Set<String> &r_visited, float &r_progress) {
+	if (r_visited.has(p_path)) {
+		return;
 	}
+	r_visited.insert(p_path);
 
-	thread_load_mutex->unlock();
+	const ThreadLoadTask *load_task = thread_load_tasks.getptr(p_path);
+	if (!load_task) {
+		r_progress += 1.0; //assume finished loading it so it no longer exists
+		return;
+	}
 
-	return OK;
+	r_progress += load_task->stage == THREAD_LOAD_STAGE_DONE ? 1.0 : load_task->progress;
+	for (uint32_t i = 0; i < load_task->dependencies.size(); i++) {
+		_dependency_add_progress(load_task->dependencies[i]->local_path, r_visited, r_progress);
+	}
+	for (Set<String>::Element *E = load_task->sub_tasks.front(); E; E = E->next()) {
+		_dependency_add_progress(E->get(), r_visited, r_progress);
+	}
 }
 
 float ResourceLoader::_dependency_get_progress(const String &p_path) {
-	if (thread_load_tasks.has(p_path)) {
-		ThreadLoadTask &load_task = thread_load_tasks[p_path];
-		int dep_count = load_task.sub_tasks.size();
-		if (dep_count > 0) {
-			float dep_progress = 0;
-			for (Set<String>::Element *E = load_task.sub_tasks.front(); E; E = E->next()) {
-				dep_progress += _dependency_get_progress(E->get());
-			}
-			dep_progress /= float(dep_count);
-			dep_progress *= 0.5;
-			dep_progress += load_task.progress * 0.5;
-			return dep_progress;
-		} else {
-			return load_task.progress;
-		}
-
-	} else {
-		return 1.0; //assume finished loading it so it no longer exists
-	}
+	// Every resource in the dependency graph counts once, no matter how many resources use it.
+	Set<String> visited;
+	float progress = 0.0;
+	_dependency_add_progress(p_path, visited, progress);
+	return progress / float(visited.size());
 }
 
 ResourceLoader::ThreadLoadStatus ResourceLoader::load_threaded_get_status(const String &p_path, float *r_progress) {
@@ -441,40 +585,38 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 
 	ThreadLoadTask &load_task = thread_load_tasks[local_path];
 
-	//semaphore still exists, meaning it's still loading, request poll
-	Semaphore *semaphore = load_task.semaphore;
-	if (semaphore) {
-		load_task.poll_requests++;
+	if (load_task.stage == THREAD_LOAD_STAGE_QUEUED || load_task.stage == THREAD_LOAD_STAGE_WAITING || load_task.stage == THREAD_LOAD_STAGE_READY) {
+		// Not picked by a worker yet, load it on this thread instead of blocking on it.
+		// Dependencies still loading are waited for or taken over the same way by the loader.
+		if (load_task.queue_element) {
+			thread_load_queue.erase(load_task.queue_element);
+			load_task.queue_element = nullptr;
+		}
+		load_task.stage = THREAD_LOAD_STAGE_RUNNING;
+
+		thread_load_mutex->unlock();
+		_run_load_task(load_task);
+		thread_load_mutex->lock();
 
-		{
-			// As we got a semaphore, this means we are going to have to wait
-			// until the sub-resource is done loading
-			//
-			// As this thread will become 'blocked' we should "exchange" its
-			// active status with a waiting one, to ensure load continues.
-			//
-			// This ensures loading is never blocked and that is also within
-			// the maximum number of active threads.
-
-			if (thread_waiting_count > 0) {
-				thread_waiting_count--;
-				thread_loading_count++;
-				thread_load_semaphore->post();
-
-				load_task.start_next = false; //do not start next since we are doing it here
+	} else if (load_task.stage != THREAD_LOAD_STAGE_DONE) {
+		if (load_task.loader_id == Thread::get_caller_id()) {
+			thread_load_mutex->unlock();
+			if (r_error) {
+				*r_error = ERR_INVALID_PARAMETER;
 			}
+			ERR_FAIL_V_MSG(RES(), "Attempted to load a resource already being loaded from this thread, cyclic reference?");
+		}
 
-			thread_suspended_count++;
+		//semaphore still exists, meaning it's still loading, request poll
+		Semaphore *semaphore = load_task.semaphore;
+		load_task.poll_requests++;
 
-			print_lt("GET: load count: " + itos(thread_loading_count) + " / wait count: " + itos(thread_waiting_count) + " / suspended count: " + itos(thread_suspended_count) + " / active: " + itos(thread_loading_count - thread_suspended_count));
-		}
+		print_lt("GET: " + local_path + " / queued: " + itos(thread_load_queue.size()) + " / tasks: " + itos(thread_load_tasks.size()));
 
 		thread_load_mutex->unlock();
 		semaphore->wait();
 		thread_load_mutex->lock();
 
-		thread_suspended_count--;
-
 		if (!thread_load_tasks.has(local_path)) { //may have been erased during unlock and this was always an invalid call
 			thread_load_mutex->unlock();
 			if (r_error) {
@@ -489,15 +631,7 @@ RES ResourceLoader::load_threaded_get(const String &p_path, Error *r_error) {
 		*r_error = load_task.error;
 	}
 
-	load_task.requests--;
-
-	if (load_task.requests == 0) {
-		if (load_task.thread) { //thread may not have been used
-			load_task.thread->wait_to_finish();
-			memdelete(load_task.thread);
-		}
-		thread_load_tasks.erase(local_path);
-	}
+	_release_load_task(&load_task);
 
 	thread_load_mutex->unlock();
 
@@ -561,12 +695,14 @@ RES ResourceLoader::load(const String &p_path, const String &p_type_hint, Resour
 		load_task.type_hint = p_type_hint;
 		load_task.cache_mode = p_cache_mode; //ignore
 		load_task.loader_id = Thread::get_caller_id();
+		load_task.stage = THREAD_LOAD_STAGE_RUNNING;
+		load_task.semaphore = memnew(Semaphore);
 
 		thread_load_tasks[local_path] = load_task;
 
 		thread_load_mutex->unlock();
 
-		_thread_load_function(&thread_load_tasks[local_path]);
+		_run_load_task(thread_load_tasks[local_path]);
 
 		return load_threaded_get(p_path, r_error);
 
@@ -1052,13 +1188,24 @@ void ResourceLoader::remove_custom_loaders() {
 void ResourceLoader::initialize() {
 	thread_load_mutex = memnew(Mutex);
 	thread_load_max = OS::get_singleton()->get_processor_count();
-	thread_loading_count = 0;
-	thread_waiting_count = 0;
-	thread_suspended_count = 0;
+	thread_load_exit = false;
 	thread_load_semaphore = memnew(Semaphore);
 }
 
 void ResourceLoader::finalize() {
+	thread_load_mutex->lock();
+	thread_load_exit = true;
+	thread_load_mutex->unlock();
+
+	for (uint32_t i = 0; i < thread_load_workers.size(); i++) {
+		thread_load_semaphore->post();
+	}
+	for (uint32_t i = 0; i < thread_load_workers.size(); i++) {
+		thread_load_workers[i]->wait_to_finish();
+		memdelete(thread_load_workers[i]);
+	}
+	thread_load_workers.clear();
+
 	memdelete(thread_load_mutex);
 	memdelete(thread_load_semaphore);
 }
@@ -1074,11 +1221,10 @@ bool ResourceLoader::timestamp_on_load = false;
 
 Mutex *ResourceLoader::thread_load_mutex = nullptr;
 HashMap<String, ResourceLoader::ThreadLoadTask> ResourceLoader::thread_load_tasks;
+List<ResourceLoader::ThreadLoadTask *> ResourceLoader::thread_load_queue;
+LocalVector<Thread *> ResourceLoader::thread_load_workers;
 Semaphore *ResourceLoader::thread_load_semaphore = nullptr;
-
-int ResourceLoader::thread_loading_count = 0;
-int ResourceLoader::thread_waiting_count = 0;
-int ResourceLoader::thread_suspended_count = 0;
+bool ResourceLoader::thread_load_exit = false;
 int ResourceLoader::thread_load_max = 0;
 
 SelfList<Resource>::List ResourceLoader::remapped_list;
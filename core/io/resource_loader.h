@@ -36,6 +36,7 @@
 #include "core/object/script_language.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
+#include "core/templates/local_vector.h"
 
 class ResourceFormatLoader : public RefCounted {
 	GDCLASS(ResourceFormatLoader, RefCounted);
@@ -127,8 +128,16 @@ private:
 
 	static Ref<ResourceFormatLoader> _find_custom_resource_format_loader(String path);
 
+	enum ThreadLoadStage {
+		THREAD_LOAD_STAGE_QUEUED, // Dependencies not scanned yet.
+		THREAD_LOAD_STAGE_SCANNING,
+		THREAD_LOAD_STAGE_WAITING, // Waiting for its dependencies to load.
+		THREAD_LOAD_STAGE_READY,
+		THREAD_LOAD_STAGE_RUNNING,
+		THREAD_LOAD_STAGE_DONE,
+	};
+
 	struct ThreadLoadTask {
-		Thread *thread = nullptr;
 		Thread::ID loader_id = 0;
 		Semaphore *semaphore = nullptr;
 		String local_path;
@@ -136,26 +145,40 @@ private:
 		String type_hint;
 		float progress = 0.0;
 		ThreadLoadStatus status = THREAD_LOAD_IN_PROGRESS;
+		ThreadLoadStage stage = THREAD_LOAD_STAGE_DONE;
 		ResourceFormatLoader::CacheMode cache_mode = ResourceFormatLoader::CACHE_MODE_REUSE;
 		Error error = OK;
 		RES resource;
 		bool xl_remapped = false;
 		bool use_sub_threads = false;
-		bool start_next = true;
 		int requests = 0;
 		int poll_requests = 0;
 		Set<String> sub_tasks;
+		// A task holds a request on each of its dependencies until it is erased,
+		// so they stay cached for as long as it may need them.
+		LocalVector<ThreadLoadTask *> dependencies;
+		LocalVector<ThreadLoadTask *> dependents;
+		uint32_t pending_dependencies = 0;
+		List<ThreadLoadTask *>::Element *queue_element = nullptr;
 	};
 
-	static void _thread_load_function(void *p_userdata);
+	static void _thread_load_worker(void *p_userdata);
+	static void _run_load_task(ThreadLoadTask &p_load_task);
+	static void _scan_dependencies(ThreadLoadTask &p_load_task);
+	static ThreadLoadTask *_create_load_task(const String &p_local_path, const String &p_type_hint, bool p_use_sub_threads, ResourceFormatLoader::CacheMode p_cache_mode);
+	static void _queue_load_task(ThreadLoadTask *p_load_task, bool p_front = false);
+	static void _release_load_task(ThreadLoadTask *p_load_task);
+	static void _erase_load_task(ThreadLoadTask *p_load_task);
+	static bool _load_task_depends_on(ThreadLoadTask *p_load_task, ThreadLoadTask *p_dependency);
 	static Mutex *thread_load_mutex;
 	static HashMap<String, ThreadLoadTask> thread_load_tasks;
+	static List<ThreadLoadTask *> thread_load_queue;
+	static LocalVector<Thread *> thread_load_workers;
 	static Semaphore *thread_load_semaphore;
-	static int thread_waiting_count;
-	static int thread_loading_count;
-	static int thread_suspended_count;
+	static bool thread_load_exit;
 	static int thread_load_max;
 
+	static void _dependency_add_progress(const String &p_path, Set<String> &r_visited, float &r_progress);
 	static float _dependency_get_progress(const String &p_path);
 
 public:
@@ -48,10 +48,17 @@
 
 #include "bvh_tree.h"
 
+#include "core/templates/task_scheduler.h"
+
 #define BVHTREE_CLASS BVH_Tree<T, 2, MAX_ITEMS, USE_PAIRS, Bounds, Point>
 
 template <class T, bool USE_PAIRS = false, int MAX_ITEMS = 32, class Bounds = AABB, class Point = Vector3>
 class BVH_Manager {
+	enum {
+		// below this many changed items, pairing is checked on the calling thread only
+		PARALLEL_PAIRING_MIN_ITEMS = 64,
+	};
+
 public:
 	// note we are using uint32_t instead of BVHHandle, losing type safety, but this
 	// is for compatibility with octree
@@ -394,8 +401,46 @@ private:
 			return;
 		}
 
-		Bounds bb;
+		// find all the existing paired aabbs that are no longer
+		// paired, and send callbacks
+		for (unsigned int n = 0; n < changed_items.size(); n++) {
+			const BVHHandle &h = changed_items[n];
+
+			// use the expanded aabb for pairing
+			BVHABB_CLASS abb;
+			abb.from(tree._pairs[h.id()].expanded_aabb);
+
+			_find_leavers(h, abb, p_full_check);
+		}
+
+		// The tree is only read while culling, so many moved items are culled in parallel.
+		// Pairing callbacks are always sent from the calling thread, in changed item order.
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		if (changed_items.size() >= PARALLEL_PAIRING_MIN_ITEMS && scheduler) {
+			if (changed_item_hits.size() < changed_items.size()) {
+				changed_item_hits.resize(changed_items.size());
+			}
+			scheduler->parallel_for(changed_items.size(), this, &BVH_Manager::_cull_changed_item, changed_item_hits.ptr());
 
+			for (unsigned int n = 0; n < changed_items.size(); n++) {
+				_collide_hits(changed_items[n], changed_item_hits[n]);
+			}
+		} else {
+			for (unsigned int n = 0; n < changed_items.size(); n++) {
+				const BVHHandle &h = changed_items[n];
+				_cull_enterers(h, tree._cull_hits);
+				_collide_hits(h, tree._cull_hits);
+			}
+		}
+		_reset();
+	}
+
+	void _cull_changed_item(uint32_t p_index, LocalVector<uint32_t, uint32_t, true> *p_hits) {
+		_cull_enterers(changed_items[p_index], p_hits[p_index]);
+	}
+
+	// cull the tree with the expanded aabb of a changed item
+	void _cull_enterers(BVHHandle p_handle, LocalVector<uint32_t, uint32_t, true> &r_hits) {
 		typename BVHTREE_CLASS::CullParams params;
 
 		params.result_count_overall = 0;
@@ -404,55 +449,43 @@ private:
 		params.subindex_array = nullptr;
 		params.mask = 0xFFFFFFFF;
 		params.pairable_type = 0;
+		params.hits = &r_hits;
 
-		for (unsigned int n = 0; n < changed_items.size(); n++) {
-			const BVHHandle &h = changed_items[n];
+		// set up the test from this item.
+		// this includes whether to test the non pairable tree,
+		// and the item mask.
+		tree.item_fill_cullparams(p_handle, params);
 
-			// use the expanded aabb for pairing
-			const Bounds &expanded_aabb = tree._pairs[h.id()].expanded_aabb;
-			BVHABB_CLASS abb;
-			abb.from(expanded_aabb);
-
-			// find all the existing paired aabbs that are no longer
-			// paired, and send callbacks
-			_find_leavers(h, abb, p_full_check);
+		params.abb.from(tree._pairs[p_handle.id()].expanded_aabb);
 
-			uint32_t changed_item_ref_id = h.id();
-
-			// set up the test from this item.
-			// this includes whether to test the non pairable tree,
-			// and the item mask.
-			tree.item_fill_cullparams(h, params);
-
-			params.abb = abb;
+		tree.cull_aabb(params, false);
+	}
 
-			params.result_count_overall = 0; // might not be needed
-			tree.cull_aabb(params, false);
+	void _collide_hits(BVHHandle p_handle, const LocalVector<uint32_t, uint32_t, true> &p_hits) {
+		uint32_t changed_item_ref_id = p_handle.id();
 
-			for (unsigned int i = 0; i < tree._cull_hits.size(); i++) {
-				uint32_t ref_id = tree._cull_hits[i];
+		for (unsigned int i = 0; i < p_hits.size(); i++) {
+			uint32_t ref_id = p_hits[i];
 
-				// don't collide against ourself
-				if (ref_id == changed_item_ref_id) {
-					continue;
-				}
+			// don't collide against ourself
+			if (ref_id == changed_item_ref_id) {
+				continue;
+			}
 
 #ifdef BVH_CHECKS
-				// if neither are pairable, they should ignore each other
-				// THIS SHOULD NEVER HAPPEN .. now we only test the pairable tree
-				// if the changed item is not pairable
-				CRASH_COND(params.test_pairable_only && !tree._extra[ref_id].pairable);
+			// if neither are pairable, they should ignore each other
+			// THIS SHOULD NEVER HAPPEN .. now we only test the pairable tree
+			// if the changed item is not pairable
+			CRASH_COND(!tree._extra[changed_item_ref_id].pairable && !tree._extra[ref_id].pairable);
 #endif
 
-				// checkmasks is already done in the cull routine.
-				BVHHandle h_collidee;
-				h_collidee.set_id(ref_id);
+			// checkmasks is already done in the cull routine.
+			BVHHandle h_collidee;
+			h_collidee.set_id(ref_id);
 
-				// find NEW enterers, and send callbacks for them only
-				_collide(h, h_collidee);
-			}
+			// find NEW enterers, and send callbacks for them only
+			_collide(p_handle, h_collidee);
 		}
-		_reset();
 	}
 
 public:
@@ -678,6 +711,9 @@ private:
 	// for collision pairing,
 	// maintain a list of all items moved etc on each frame / tick
 	LocalVector<BVHHandle, uint32_t, true> changed_items;
+
+	// hits of each changed item when they are culled in parallel
+	LocalVector<LocalVector<uint32_t, uint32_t, true>> changed_item_hits;
 	uint32_t _tick;
 
 public:
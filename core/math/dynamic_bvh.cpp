@@ -386,6 +386,42 @@ bool DynamicBVH::update(const ID &p_id, const AABB &p_box) {
 	return true;
 }
 
+void DynamicBVH::refit(const ID *p_ids, const AABB *p_boxes, uint32_t p_count) {
+	// Reinsert the leaves that moved away first, so the refit below works on a consistent tree.
+	for (uint32_t i = 0; i < p_count; i++) {
+		ERR_CONTINUE(!p_ids[i].is_valid());
+		Volume volume;
+		volume.min = p_boxes[i].position;
+		volume.max = p_boxes[i].position + p_boxes[i].size;
+		if (!p_ids[i].node->volume.intersects(volume)) {
+			update(p_ids[i], p_boxes[i]);
+		}
+	}
+
+	for (uint32_t i = 0; i < p_count; i++) {
+		if (!p_ids[i].is_valid()) {
+			continue;
+		}
+		Node *leaf = p_ids[i].node;
+		Volume volume;
+		volume.min = p_boxes[i].position;
+		volume.max = p_boxes[i].position + p_boxes[i].size;
+		if (!leaf->volume.is_not_equal_to(volume)) {
+			continue;
+		}
+
+		leaf->volume = volume;
+		// Stop once a volume comes out unchanged, the ones above it still bound it.
+		for (Node *node = leaf->parent; node; node = node->parent) {
+			const Volume previous = node->volume;
+			node->volume = node->childs[0]->volume.merge(node->childs[1]->volume);
+			if (!previous.is_not_equal_to(node->volume)) {
+				break;
+			}
+		}
+	}
+}
+
 void DynamicBVH::remove(const ID &p_id) {
 	ERR_FAIL_COND(!p_id.is_valid());
 	Node *leaf = p_id.node;
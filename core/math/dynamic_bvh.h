@@ -293,6 +293,10 @@ public:
 	void optimize_incremental(int passes);
 	ID insert(const AABB &p_box, void *p_userdata);
 	bool update(const ID &p_id, const AABB &p_box);
+	// Moves many leaves at once. Leaves that still overlap their previous box keep their place and only the
+	// volumes above them are refit, the rest are reinserted like update() does. Call optimize_incremental() to
+	// recover tree quality over time.
+	void refit(const ID *p_ids, const AABB *p_boxes, uint32_t p_count);
 	void remove(const ID &p_id);
 	void get_elements(List<ID> *r_elements);
 
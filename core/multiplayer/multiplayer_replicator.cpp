@@ -38,6 +38,269 @@
 	if (packet_cache.size() < m_amount) \
 		packet_cache.resize(m_amount);
 
+// Bit-level packing for delta sync packets. Values are written LSB first.
+class DeltaBitWriter {
+	uint64_t scratch = 0;
+	int scratch_bits = 0;
+
+public:
+	LocalVector<uint8_t> bytes;
+
+	void write(uint64_t p_value, int p_bits) {
+		if (p_bits > 32) {
+			write(p_value & 0xFFFFFFFF, 32);
+			write(p_value >> 32, p_bits - 32);
+			return;
+		}
+		scratch |= (p_value & ((uint64_t(1) << p_bits) - 1)) << scratch_bits;
+		scratch_bits += p_bits;
+		while (scratch_bits >= 8) {
+			bytes.push_back(scratch & 0xFF);
+			scratch >>= 8;
+			scratch_bits -= 8;
+		}
+	}
+
+	void write_varint(uint64_t p_value) {
+		do {
+			uint64_t group = p_value & 0x7F;
+			p_value >>= 7;
+			write(group | (p_value ? 0x80 : 0), 8);
+		} while (p_value);
+	}
+
+	void write_signed(int64_t p_value) {
+		write_varint((uint64_t(p_value) << 1) ^ uint64_t(p_value >> 63));
+	}
+
+	void flush() {
+		if (scratch_bits) {
+			bytes.push_back(scratch & 0xFF);
+			scratch = 0;
+			scratch_bits = 0;
+		}
+	}
+};
+
+class DeltaBitReader {
+	const uint8_t *data = nullptr;
+	uint64_t size_bits = 0;
+	uint64_t pos = 0;
+
+public:
+	bool overflow = false;
+
+	uint64_t read(int p_bits) {
+		if (p_bits > 32) {
+			uint64_t low = read(32);
+			return low | (read(p_bits - 32) << 32);
+		}
+		if (pos + p_bits > size_bits) {
+			overflow = true;
+			return 0;
+		}
+		uint64_t value = 0;
+		for (int done = 0; done < p_bits;) {
+			int bit = pos & 7;
+			int take = MIN(8 - bit, p_bits - done);
+			value |= uint64_t((data[pos >> 3] >> bit) & ((1 << take) - 1)) << done;
+			done += take;
+			pos += take;
+		}
+		return value;
+	}
+
+	uint64_t read_varint() {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			uint64_t group = read(8);
+			value |= (group & 0x7F) << shift;
+			if (!(group & 0x80) || overflow) {
+				return value;
+			}
+		}
+		overflow = true;
+		return value;
+	}
+
+	int64_t read_signed() {
+		uint64_t value = read_varint();
+		return int64_t(value >> 1) ^ -int64_t(value & 1);
+	}
+
+	DeltaBitReader(const uint8_t *p_data, int p_size) {
+		data = p_data;
+		size_bits = uint64_t(p_size) << 3;
+	}
+};
+
+enum DeltaValueTag {
+	DELTA_VALUE_VARIANT,
+	DELTA_VALUE_BOOL,
+	DELTA_VALUE_INT,
+	DELTA_VALUE_FLOAT32,
+	DELTA_VALUE_FLOAT64,
+	DELTA_VALUE_QUANTIZED_FLOAT,
+	DELTA_VALUE_QUANTIZED_VECTOR2,
+	DELTA_VALUE_QUANTIZED_VECTOR3,
+	DELTA_VALUE_TAG_BITS = 3,
+};
+
+static _FORCE_INLINE_ int64_t _delta_quantize(real_t p_value, real_t p_step) {
+	return int64_t(Math::round(p_value / p_step));
+}
+
+static bool _delta_changed(const Variant &p_a, const Variant &p_b, real_t p_step) {
+	if (p_step > 0 && p_a.get_type() == p_b.get_type()) {
+		// Only differences that survive quantization are worth sending.
+		switch (p_a.get_type()) {
+			case Variant::FLOAT:
+				return _delta_quantize(p_a, p_step) != _delta_quantize(p_b, p_step);
+			case Variant::VECTOR2: {
+				Vector2 a = p_a;
+				Vector2 b = p_b;
+				return _delta_quantize(a.x, p_step) != _delta_quantize(b.x, p_step) || _delta_quantize(a.y, p_step) != _delta_quantize(b.y, p_step);
+			}
+			case Variant::VECTOR3: {
+				Vector3 a = p_a;
+				Vector3 b = p_b;
+				return _delta_quantize(a.x, p_step) != _delta_quantize(b.x, p_step) || _delta_quantize(a.y, p_step) != _delta_quantize(b.y, p_step) || _delta_quantize(a.z, p_step) != _delta_quantize(b.z, p_step);
+			}
+			default:
+				break;
+		}
+	}
+	return p_a != p_b;
+}
+
+static _FORCE_INLINE_ bool _delta_sequence_newer(uint16_t p_a, uint16_t p_b) {
+	return int16_t(p_a - p_b) > 0;
+}
+
+static Error _delta_write_value(MultiplayerAPI *p_multiplayer, DeltaBitWriter &r_writer, const Variant &p_value, real_t p_step) {
+	switch (p_value.get_type()) {
+		case Variant::BOOL: {
+			r_writer.write(DELTA_VALUE_BOOL, DELTA_VALUE_TAG_BITS);
+			r_writer.write(p_value.operator bool() ? 1 : 0, 1);
+			return OK;
+		}
+		case Variant::INT: {
+			r_writer.write(DELTA_VALUE_INT, DELTA_VALUE_TAG_BITS);
+			r_writer.write_signed(p_value.operator int64_t());
+			return OK;
+		}
+		case Variant::FLOAT: {
+			double value = p_value;
+			if (p_step > 0) {
+				r_writer.write(DELTA_VALUE_QUANTIZED_FLOAT, DELTA_VALUE_TAG_BITS);
+				r_writer.write_signed(_delta_quantize(value, p_step));
+			} else if (double(float(value)) == value) {
+				float single = value;
+				uint32_t bits;
+				memcpy(&bits, &single, sizeof(bits));
+				r_writer.write(DELTA_VALUE_FLOAT32, DELTA_VALUE_TAG_BITS);
+				r_writer.write(bits, 32);
+			} else {
+				uint64_t bits;
+				memcpy(&bits, &value, sizeof(bits));
+				r_writer.write(DELTA_VALUE_FLOAT64, DELTA_VALUE_TAG_BITS);
+				r_writer.write(bits, 64);
+			}
+			return OK;
+		}
+		case Variant::VECTOR2: {
+			if (p_step > 0) {
+				Vector2 value = p_value;
+				r_writer.write(DELTA_VALUE_QUANTIZED_VECTOR2, DELTA_VALUE_TAG_BITS);
+				r_writer.write_signed(_delta_quantize(value.x, p_step));
+				r_writer.write_signed(_delta_quantize(value.y, p_step));
+				return OK;
+			}
+		} break;
+		case Variant::VECTOR3: {
+			if (p_step > 0) {
+				Vector3 value = p_value;
+				r_writer.write(DELTA_VALUE_QUANTIZED_VECTOR3, DELTA_VALUE_TAG_BITS);
+				r_writer.write_signed(_delta_quantize(value.x, p_step));
+				r_writer.write_signed(_delta_quantize(value.y, p_step));
+				r_writer.write_signed(_delta_quantize(value.z, p_step));
+				return OK;
+			}
+		} break;
+		default:
+			break;
+	}
+
+	int len = 0;
+	Error err = p_multiplayer->encode_and_compress_variant(p_value, nullptr, len);
+	ERR_FAIL_COND_V(err != OK, err);
+	LocalVector<uint8_t> encoded;
+	encoded.resize(len);
+	p_multiplayer->encode_and_compress_variant(p_value, encoded.ptr(), len);
+	r_writer.write(DELTA_VALUE_VARIANT, DELTA_VALUE_TAG_BITS);
+	r_writer.write_varint(len);
+	for (int i = 0; i < len; i++) {
+		r_writer.write(encoded[i], 8);
+	}
+	return OK;
+}
+
+static Error _delta_read_value(MultiplayerAPI *p_multiplayer, DeltaBitReader &r_reader, Variant &r_value, real_t p_step) {
+	switch (r_reader.read(DELTA_VALUE_TAG_BITS)) {
+		case DELTA_VALUE_BOOL: {
+			r_value = r_reader.read(1) != 0;
+		} break;
+		case DELTA_VALUE_INT: {
+			r_value = r_reader.read_signed();
+		} break;
+		case DELTA_VALUE_FLOAT32: {
+			uint32_t bits = r_reader.read(32);
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			r_value = value;
+		} break;
+		case DELTA_VALUE_FLOAT64: {
+			uint64_t bits = r_reader.read(64);
+			double value;
+			memcpy(&value, &bits, sizeof(value));
+			r_value = value;
+		} break;
+		case DELTA_VALUE_QUANTIZED_FLOAT: {
+			ERR_FAIL_COND_V_MSG(p_step <= 0, ERR_INVALID_DATA, "Received a quantized value for a property without quantization.");
+			r_value = r_reader.read_signed() * p_step;
+		} break;
+		case DELTA_VALUE_QUANTIZED_VECTOR2: {
+			ERR_FAIL_COND_V_MSG(p_step <= 0, ERR_INVALID_DATA, "Received a quantized value for a property without quantization.");
+			Vector2 value;
+			value.x = r_reader.read_signed() * p_step;
+			value.y = r_reader.read_signed() * p_step;
+			r_value = value;
+		} break;
+		case DELTA_VALUE_QUANTIZED_VECTOR3: {
+			ERR_FAIL_COND_V_MSG(p_step <= 0, ERR_INVALID_DATA, "Received a quantized value for a property without quantization.");
+			Vector3 value;
+			value.x = r_reader.read_signed() * p_step;
+			value.y = r_reader.read_signed() * p_step;
+			value.z = r_reader.read_signed() * p_step;
+			r_value = value;
+		} break;
+		default: {
+			uint64_t len = r_reader.read_varint();
+			ERR_FAIL_COND_V(r_reader.overflow || len > (1 << 24), ERR_INVALID_DATA);
+			LocalVector<uint8_t> encoded;
+			encoded.resize(len);
+			for (uint64_t i = 0; i < len; i++) {
+				encoded[i] = r_reader.read(8);
+			}
+			ERR_FAIL_COND_V(r_reader.overflow, ERR_INVALID_DATA);
+			Error err = p_multiplayer->decode_and_decompress_variant(r_value, encoded.ptr(), len, nullptr);
+			ERR_FAIL_COND_V(err != OK, err);
+		} break;
+	}
+	ERR_FAIL_COND_V(r_reader.overflow, ERR_INVALID_DATA);
+	return OK;
+}
+
 Error MultiplayerReplicator::_sync_all_default(const ResourceUID::ID &p_scene_id, int p_peer) {
 	ERR_FAIL_COND_V(!replications.has(p_scene_id), ERR_INVALID_PARAMETER);
 	SceneConfig &cfg = replications[p_scene_id];
@@ -172,6 +435,355 @@ void MultiplayerReplicator::_process_default_sync(const ResourceUID::ID &p_id, c
 	}
 }
 
+Error MultiplayerReplicator::_sync_all_delta(const ResourceUID::ID &p_scene_id, int p_peer) {
+	ERR_FAIL_COND_V(!replications.has(p_scene_id), ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V_MSG(!multiplayer->is_server(), ERR_UNAVAILABLE, "Delta sync is only sent by the server");
+	const SceneConfig &cfg = replications[p_scene_id];
+
+	// Read the state once, it's diffed separately for each peer. Freed objects keep their index.
+	LocalVector<ObjectID> ids;
+	LocalVector<Vector<Variant>> values;
+	for (const ObjectID &obj_id : tracked_objects[p_scene_id]) {
+		Object *obj = ObjectDB::get_instance(obj_id);
+		Vector<Variant> state;
+		if (obj) {
+			for (const StringName &prop : cfg.sync_properties) {
+				bool valid = false;
+				state.push_back(obj->get(prop, &valid));
+				if (!valid) {
+					ERR_PRINT(vformat("Property '%s' not found.", prop));
+					state.clear();
+					break;
+				}
+			}
+		}
+		ids.push_back(state.is_empty() ? ObjectID() : obj_id);
+		values.push_back(state);
+	}
+
+	if (p_peer > 0) {
+		return _send_delta(p_scene_id, cfg, p_peer, ids, values);
+	}
+	// Zero sends to every peer, a negative ID to every peer but that one.
+	for (const int &peer_id : multiplayer->get_connected_peers()) {
+		if (peer_id == -p_peer) {
+			continue;
+		}
+		Error err = _send_delta(p_scene_id, cfg, peer_id, ids, values);
+		ERR_CONTINUE(err != OK);
+	}
+	return OK;
+}
+
+Error MultiplayerReplicator::_send_delta(const ResourceUID::ID &p_scene_id, const SceneConfig &p_cfg, int p_peer, const LocalVector<ObjectID> &p_ids, const LocalVector<Vector<Variant>> &p_values) {
+	DeltaSendState &state = delta_send_states[p_scene_id][p_peer];
+	const int prop_count = p_cfg.sync_properties.size();
+
+	const DeltaSnapshot *baseline = nullptr;
+	if (state.acked >= 0) {
+		for (const DeltaSnapshot &snapshot : state.history) {
+			if (snapshot.sequence == state.acked) {
+				baseline = &snapshot;
+				break;
+			}
+		}
+	}
+
+	// The new snapshot is the baseline with what is sent on top, the client builds the same one.
+	DeltaSnapshot snapshot;
+	snapshot.sequence = state.next_sequence;
+	if (baseline) {
+		snapshot.objects = baseline->objects;
+	}
+
+	// Tracked count, then for each object that changed: a continuation bit, the gap from the
+	// previous index, a bit mask of the changed properties and their values.
+	DeltaBitWriter writer;
+	writer.write_varint(p_ids.size());
+	uint32_t next_index = 0;
+	bool changed = false;
+	for (uint32_t i = 0; i < p_ids.size(); i++) {
+		if (p_ids[i].is_null()) {
+			continue;
+		}
+		const Vector<Variant> &values = p_values[i];
+
+		if (p_cfg.sync_relevancy.is_valid()) {
+			Variant args[2] = { p_peer, ObjectDB::get_instance(p_ids[i]) };
+			const Variant *argp[2] = { &args[0], &args[1] };
+			Callable::CallError ce;
+			Variant ret;
+			p_cfg.sync_relevancy.call(argp, 2, ret, ce);
+			ERR_FAIL_COND_V_MSG(ce.error != Callable::CallError::CALL_OK, FAILED, "Custom relevancy function failed");
+			if (!ret.operator bool()) {
+				continue;
+			}
+		}
+
+		const Vector<Variant> *old = baseline ? baseline->objects.getptr(p_ids[i]) : nullptr;
+		uint64_t mask = 0;
+		for (int j = 0; j < prop_count; j++) {
+			if (!old || _delta_changed((*old)[j], values[j], p_cfg.sync_quantization[j])) {
+				mask |= uint64_t(1) << j;
+			}
+		}
+		if (!mask) {
+			continue;
+		}
+
+		writer.write(1, 1);
+		writer.write_varint(i - next_index);
+		writer.write(mask, prop_count);
+		next_index = i + 1;
+		for (int j = 0; j < prop_count; j++) {
+			if (mask & (uint64_t(1) << j)) {
+				Error err = _delta_write_value(multiplayer, writer, values[j], p_cfg.sync_quantization[j]);
+				ERR_FAIL_COND_V(err != OK, err);
+			}
+		}
+
+		Vector<Variant> &stored = snapshot.objects[p_ids[i]];
+		if (old) {
+			for (int j = 0; j < prop_count; j++) {
+				if (mask & (uint64_t(1) << j)) {
+					stored.write[j] = values[j];
+				}
+			}
+		} else {
+			stored = values;
+		}
+		changed = true;
+	}
+	writer.write(0, 1);
+	writer.flush();
+
+	// Nothing new for this peer since its baseline.
+	if (baseline && !changed) {
+		return OK;
+	}
+
+	state.next_sequence++;
+	state.history.push_back(snapshot);
+	if (state.history.size() > DELTA_HISTORY_SIZE) {
+		if (state.history.front()->get().sequence == state.acked) {
+			// Too many updates without an ack, start over from a full state.
+			state.acked = -1;
+		}
+		state.history.pop_front();
+	}
+
+	MAKE_ROOM(SYNC_CMD_OFFSET + 4 + int(writer.bytes.size()));
+	uint8_t *ptr = packet_cache.ptrw();
+	ptr[0] = MultiplayerAPI::NETWORK_COMMAND_SYNC | DELTA_FLAG | (baseline ? DELTA_BASELINE_FLAG : 0);
+	int ofs = 1;
+	ofs += encode_uint64(p_scene_id, &ptr[ofs]);
+	ofs += encode_uint16(snapshot.sequence, &ptr[ofs]);
+	ofs += encode_uint16(baseline ? baseline->sequence : 0, &ptr[ofs]);
+	memcpy(&ptr[ofs], writer.bytes.ptr(), writer.bytes.size());
+	ofs += writer.bytes.size();
+
+	Ref<MultiplayerPeer> peer = multiplayer->get_multiplayer_peer();
+	peer->set_target_peer(p_peer);
+	peer->set_transfer_channel(0);
+	peer->set_transfer_mode(Multiplayer::TRANSFER_MODE_UNRELIABLE);
+	return peer->put_packet(ptr, ofs);
+}
+
+void MultiplayerReplicator::_process_delta_sync(const ResourceUID::ID &p_id, const uint8_t *p_packet, int p_packet_len) {
+	ERR_FAIL_COND_MSG(p_packet_len < SYNC_CMD_OFFSET + 4, "Invalid delta sync packet received");
+	const SceneConfig &cfg = replications[p_id];
+	const int prop_count = cfg.sync_properties.size();
+
+	int ofs = SYNC_CMD_OFFSET;
+	uint16_t sequence = decode_uint16(&p_packet[ofs]);
+	uint16_t baseline_sequence = decode_uint16(&p_packet[ofs + 2]);
+	ofs += 4;
+
+	DeltaReceiveState &state = delta_receive_states[p_id];
+	// Skip old updates.
+	if (state.applied >= 0 && !_delta_sequence_newer(sequence, state.applied)) {
+		return;
+	}
+
+	const DeltaSnapshot *baseline = nullptr;
+	if (p_packet[0] & DELTA_BASELINE_FLAG) {
+		for (const DeltaSnapshot &snapshot : state.history) {
+			if (snapshot.sequence == baseline_sequence) {
+				baseline = &snapshot;
+				break;
+			}
+		}
+		if (!baseline) {
+			// Lost when the tracked objects changed, ask for a full state.
+			_send_delta_ack(p_id, -1);
+			return;
+		}
+	}
+
+	LocalVector<ObjectID> ids;
+	if (tracked_objects.has(p_id)) {
+		for (const ObjectID &obj_id : tracked_objects[p_id]) {
+			ids.push_back(obj_id);
+		}
+	}
+	LocalVector<StringName> props;
+	for (const StringName &prop : cfg.sync_properties) {
+		props.push_back(prop);
+	}
+
+	DeltaBitReader reader(&p_packet[ofs], p_packet_len - ofs);
+	// The tracked objects differ until pending spawns and despawns arrive.
+	if (reader.read_varint() != ids.size() || reader.overflow) {
+		return;
+	}
+
+	// Decode everything first, so a bad packet changes nothing.
+	struct ObjectUpdate {
+		uint32_t index = 0;
+		uint64_t mask = 0;
+	};
+	LocalVector<ObjectUpdate> updates;
+	LocalVector<Variant> values;
+	uint32_t next_index = 0;
+	while (reader.read(1)) {
+		ObjectUpdate update;
+		uint64_t gap = reader.read_varint();
+		ERR_FAIL_COND_MSG(reader.overflow || gap >= ids.size() - next_index, "Invalid delta sync packet received");
+		update.index = next_index + gap;
+		update.mask = reader.read(prop_count);
+		ERR_FAIL_COND_MSG(reader.overflow, "Invalid delta sync packet received");
+		const Vector<Variant> *old = baseline ? baseline->objects.getptr(ids[update.index]) : nullptr;
+		ERR_FAIL_COND_MSG(!old && update.mask != (uint64_t(-1) >> (64 - prop_count)), "Invalid delta sync packet received, new objects must send every property");
+		for (int j = 0; j < prop_count; j++) {
+			if (update.mask & (uint64_t(1) << j)) {
+				Variant value;
+				Error err = _delta_read_value(multiplayer, reader, value, cfg.sync_quantization[j]);
+				ERR_FAIL_COND_MSG(err != OK, "Invalid delta sync packet received");
+				values.push_back(value);
+			}
+		}
+		updates.push_back(update);
+		next_index = update.index + 1;
+	}
+	ERR_FAIL_COND_MSG(reader.overflow, "Invalid delta sync packet received");
+
+	DeltaSnapshot snapshot;
+	snapshot.sequence = sequence;
+	if (baseline) {
+		snapshot.objects = baseline->objects;
+	}
+	uint32_t value_index = 0;
+	for (uint32_t i = 0; i < updates.size(); i++) {
+		const ObjectUpdate &update = updates[i];
+		const ObjectID &obj_id = ids[update.index];
+		Object *obj = ObjectDB::get_instance(obj_id);
+		Vector<Variant> &stored = snapshot.objects[obj_id];
+		stored.resize(prop_count);
+		for (int j = 0; j < prop_count; j++) {
+			if (update.mask & (uint64_t(1) << j)) {
+				const Variant &value = values[value_index++];
+				stored.write[j] = value;
+				if (obj) {
+					obj->set(props[j], value);
+				}
+			}
+		}
+	}
+
+	// The server never goes back to a baseline older than the one it used.
+	if (baseline) {
+		while (state.history.front()->get().sequence != baseline_sequence) {
+			state.history.pop_front();
+		}
+	} else {
+		state.history.clear();
+	}
+	state.history.push_back(snapshot);
+	if (state.history.size() > DELTA_HISTORY_SIZE) {
+		state.history.pop_front();
+	}
+	state.applied = sequence;
+
+	_send_delta_ack(p_id, sequence);
+}
+
+Error MultiplayerReplicator::_send_delta_ack(const ResourceUID::ID &p_scene_id, int p_sequence) {
+	// Without a sequence, the ack asks the server to start over from a full state.
+	MAKE_ROOM(SYNC_CMD_OFFSET + 2);
+	uint8_t *ptr = packet_cache.ptrw();
+	ptr[0] = MultiplayerAPI::NETWORK_COMMAND_SYNC | DELTA_FLAG | DELTA_ACK_FLAG | (p_sequence >= 0 ? DELTA_BASELINE_FLAG : 0);
+	encode_uint64(p_scene_id, &ptr[1]);
+	encode_uint16(p_sequence >= 0 ? p_sequence : 0, &ptr[SYNC_CMD_OFFSET]);
+
+	Ref<MultiplayerPeer> peer = multiplayer->get_multiplayer_peer();
+	peer->set_target_peer(MultiplayerPeer::TARGET_PEER_SERVER);
+	peer->set_transfer_channel(0);
+	peer->set_transfer_mode(Multiplayer::TRANSFER_MODE_UNRELIABLE);
+	return peer->put_packet(ptr, SYNC_CMD_OFFSET + 2);
+}
+
+void MultiplayerReplicator::_process_delta_ack(int p_from, const ResourceUID::ID &p_id, const uint8_t *p_packet, int p_packet_len) {
+	ERR_FAIL_COND_MSG(p_packet_len < SYNC_CMD_OFFSET + 2, "Invalid delta ack packet received");
+	ERR_FAIL_COND_MSG(!multiplayer->is_server(), "Delta acks are only processed by the server");
+	if (!delta_send_states.has(p_id) || !delta_send_states[p_id].has(p_from)) {
+		return;
+	}
+	DeltaSendState &state = delta_send_states[p_id][p_from];
+
+	if (!(p_packet[0] & DELTA_BASELINE_FLAG)) {
+		// Already sending full states otherwise.
+		if (state.acked >= 0) {
+			state.acked = -1;
+			state.history.clear();
+		}
+		return;
+	}
+
+	uint16_t sequence = decode_uint16(&p_packet[SYNC_CMD_OFFSET]);
+	if (state.acked >= 0 && !_delta_sequence_newer(sequence, state.acked)) {
+		return;
+	}
+	bool found = false;
+	for (const DeltaSnapshot &snapshot : state.history) {
+		if (snapshot.sequence == sequence) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		return;
+	}
+	// Older snapshots won't be used as baselines anymore.
+	while (state.history.front()->get().sequence != sequence) {
+		state.history.pop_front();
+	}
+	state.acked = sequence;
+}
+
+void MultiplayerReplicator::_reset_delta(const ResourceUID::ID &p_scene_id) {
+	// Objects are sent by index, so snapshots are only valid for the tracked list they were made with.
+	// Sequences carry on, clients would drop a restarted sequence as old.
+	if (delta_send_states.has(p_scene_id)) {
+		HashMap<int, DeltaSendState> &states = delta_send_states[p_scene_id];
+		const int *k = nullptr;
+		while ((k = states.next(k))) {
+			states[*k].acked = -1;
+			states[*k].history.clear();
+		}
+	}
+	delta_receive_states.erase(p_scene_id);
+}
+
+void MultiplayerReplicator::peer_removed(int p_peer) {
+	const ResourceUID::ID *k = nullptr;
+	while ((k = delta_send_states.next(k))) {
+		delta_send_states[*k].erase(p_peer);
+	}
+	if (p_peer == MultiplayerPeer::TARGET_PEER_SERVER) {
+		delta_receive_states.clear();
+	}
+}
+
 Error MultiplayerReplicator::_send_default_spawn_despawn(int p_peer_id, const ResourceUID::ID &p_scene_id, Object *p_obj, const NodePath &p_path, bool p_spawn) {
 	ERR_FAIL_COND_V(p_spawn && !p_obj, ERR_INVALID_PARAMETER);
 	ERR_FAIL_COND_V(!replications.has(p_scene_id), ERR_INVALID_PARAMETER);
@@ -340,6 +952,15 @@ void MultiplayerReplicator::process_sync(int p_from, const uint8_t *p_packet, in
 	ResourceUID::ID id = decode_uint64(&p_packet[1]);
 	ERR_FAIL_COND_MSG(!replications.has(id), "Invalid spawn ID received " + itos(id));
 	const SceneConfig &cfg = replications[id];
+	if (cfg.sync_delta && (p_packet[0] & DELTA_FLAG)) {
+		if (p_packet[0] & DELTA_ACK_FLAG) {
+			_process_delta_ack(p_from, id, p_packet, p_packet_len);
+		} else {
+			ERR_FAIL_COND_MSG(p_from != 1, "Delta sync only allows syncing from server to client");
+			_process_delta_sync(id, p_packet, p_packet_len);
+		}
+		return;
+	}
 	if (cfg.on_sync_receive.is_valid()) {
 		Array objs;
 		if (tracked_objects.has(id)) {
@@ -490,6 +1111,28 @@ Error MultiplayerReplicator::sync_config(const ResourceUID::ID &p_id, uint64_t p
 	return OK;
 }
 
+Error MultiplayerReplicator::sync_delta_config(const ResourceUID::ID &p_id, uint64_t p_interval, const TypedArray<StringName> &p_props, const PackedFloat32Array &p_quantization, const Callable &p_relevancy) {
+	ERR_FAIL_COND_V(!ResourceUID::get_singleton()->has_id(p_id), ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(!replications.has(p_id), ERR_UNCONFIGURED);
+	ERR_FAIL_COND_V_MSG(p_props.is_empty() || p_props.size() > DELTA_MAX_PROPERTIES, ERR_INVALID_PARAMETER, vformat("Delta sync needs between 1 and %d properties.", DELTA_MAX_PROPERTIES));
+	ERR_FAIL_COND_V_MSG(!p_quantization.is_empty() && p_quantization.size() != p_props.size(), ERR_INVALID_PARAMETER, "Quantization must be empty or have one step per property");
+	SceneConfig &cfg = replications[p_id];
+	ERR_FAIL_COND_V(cfg.mode == REPLICATION_MODE_NONE, ERR_UNCONFIGURED);
+	cfg.sync_properties.clear();
+	cfg.sync_quantization.resize(p_props.size());
+	for (int i = 0; i < p_props.size(); i++) {
+		cfg.sync_properties.push_back(p_props[i]);
+		cfg.sync_quantization.write[i] = p_quantization.is_empty() ? 0 : MAX(p_quantization[i], 0);
+	}
+	cfg.on_sync_send = Callable();
+	cfg.on_sync_receive = Callable();
+	cfg.sync_relevancy = p_relevancy;
+	cfg.sync_delta = true;
+	cfg.sync_interval = p_interval * 1000;
+	_reset_delta(p_id);
+	return OK;
+}
+
 Error MultiplayerReplicator::_send_spawn_despawn(int p_peer_id, const ResourceUID::ID &p_scene_id, const Variant &p_data, bool p_spawn) {
 	int data_size = 0;
 	int is_raw = false;
@@ -666,7 +1309,7 @@ void MultiplayerReplicator::poll() {
 		if (!E.value.sync_interval) {
 			continue;
 		}
-		if (E.value.mode == REPLICATION_MODE_SERVER && !multiplayer->is_server()) {
+		if ((E.value.mode == REPLICATION_MODE_SERVER || E.value.sync_delta) && !multiplayer->is_server()) {
 			continue;
 		}
 		uint64_t time = OS::get_singleton()->get_ticks_usec();
@@ -695,6 +1338,7 @@ void MultiplayerReplicator::_track(const ResourceUID::ID &p_scene_id, Object *p_
 		tracked_objects[p_scene_id] = List<ObjectID>();
 	}
 	tracked_objects[p_scene_id].push_back(p_obj->get_instance_id());
+	_reset_delta(p_scene_id);
 }
 
 void MultiplayerReplicator::untrack(const ResourceUID::ID &p_scene_id, Object *p_obj) {
@@ -710,6 +1354,7 @@ void MultiplayerReplicator::_untrack(const ResourceUID::ID &p_scene_id, Object *
 	if (tracked_objects.has(p_scene_id)) {
 		tracked_objects[p_scene_id].erase(p_obj->get_instance_id());
 	}
+	_reset_delta(p_scene_id);
 }
 
 Error MultiplayerReplicator::sync_all(const ResourceUID::ID &p_scene_id, int p_peer) {
@@ -734,6 +1379,8 @@ Error MultiplayerReplicator::sync_all(const ResourceUID::ID &p_scene_id, int p_p
 		cfg.on_sync_send.call((const Variant **)argp, 3, ret, ce);
 		ERR_FAIL_COND_V_MSG(ce.error != Callable::CallError::CALL_OK, FAILED, "Custom sync function failed");
 		return OK;
+	} else if (cfg.sync_delta) {
+		return _sync_all_delta(p_scene_id, p_peer);
 	} else if (cfg.sync_properties.size()) {
 		return _sync_all_default(p_scene_id, p_peer);
 	}
@@ -762,11 +1409,14 @@ Error MultiplayerReplicator::send_sync(int p_peer_id, const ResourceUID::ID &p_s
 void MultiplayerReplicator::clear() {
 	tracked_objects.clear();
 	replicated_nodes.clear();
+	delta_send_states.clear();
+	delta_receive_states.clear();
 }
 
 void MultiplayerReplicator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("spawn_config", "scene_id", "spawn_mode", "properties", "custom_send", "custom_receive"), &MultiplayerReplicator::spawn_config, DEFVAL(TypedArray<StringName>()), DEFVAL(Callable()), DEFVAL(Callable()));
 	ClassDB::bind_method(D_METHOD("sync_config", "scene_id", "interval", "properties", "custom_send", "custom_receive"), &MultiplayerReplicator::sync_config, DEFVAL(TypedArray<StringName>()), DEFVAL(Callable()), DEFVAL(Callable()));
+	ClassDB::bind_method(D_METHOD("sync_delta_config", "scene_id", "interval", "properties", "quantization", "relevancy"), &MultiplayerReplicator::sync_delta_config, DEFVAL(PackedFloat32Array()), DEFVAL(Callable()));
 	ClassDB::bind_method(D_METHOD("despawn", "scene_id", "object", "peer_id"), &MultiplayerReplicator::despawn, DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("spawn", "scene_id", "object", "peer_id"), &MultiplayerReplicator::spawn, DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("send_despawn", "peer_id", "scene_id", "data", "path"), &MultiplayerReplicator::send_despawn, DEFVAL(Variant()), DEFVAL(NodePath()));
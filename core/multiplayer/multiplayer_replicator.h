@@ -35,6 +35,7 @@
 
 #include "core/io/resource_uid.h"
 #include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "core/variant/typed_array.h"
 
 class MultiplayerReplicator : public Object {
@@ -63,6 +64,9 @@ public:
 		Callable on_spawn_despawn_receive;
 		Callable on_sync_send;
 		Callable on_sync_receive;
+		bool sync_delta = false;
+		Vector<real_t> sync_quantization; // One step per sync property, zero sends the value losslessly.
+		Callable sync_relevancy;
 	};
 
 protected:
@@ -75,6 +79,31 @@ private:
 
 	enum {
 		BYTE_OR_ZERO_FLAG = 1 << BYTE_OR_ZERO_SHIFT,
+		DELTA_FLAG = 1 << MultiplayerAPI::CMD_FLAG_1_SHIFT,
+		DELTA_BASELINE_FLAG = 1 << MultiplayerAPI::CMD_FLAG_2_SHIFT,
+		DELTA_ACK_FLAG = 1 << MultiplayerAPI::CMD_FLAG_3_SHIFT,
+	};
+
+	enum {
+		DELTA_HISTORY_SIZE = 32,
+		DELTA_MAX_PROPERTIES = 64,
+	};
+
+	// Sync property values of the objects a peer has been sent, as of one sequence number.
+	struct DeltaSnapshot {
+		uint16_t sequence = 0;
+		HashMap<ObjectID, Vector<Variant>> objects;
+	};
+
+	struct DeltaSendState {
+		uint16_t next_sequence = 0;
+		int acked = -1; // Baseline the peer has confirmed, -1 until the first ack.
+		List<DeltaSnapshot> history;
+	};
+
+	struct DeltaReceiveState {
+		int applied = -1;
+		List<DeltaSnapshot> history;
 	};
 
 	MultiplayerAPI *multiplayer = nullptr;
@@ -82,6 +111,8 @@ private:
 	Map<ResourceUID::ID, SceneConfig> replications;
 	Map<ObjectID, ResourceUID::ID> replicated_nodes;
 	HashMap<ResourceUID::ID, List<ObjectID>> tracked_objects;
+	HashMap<ResourceUID::ID, HashMap<int, DeltaSendState>> delta_send_states;
+	HashMap<ResourceUID::ID, DeltaReceiveState> delta_receive_states;
 
 	// Encoding
 	Error _get_state(const List<StringName> &p_properties, const Object *p_obj, List<Variant> &r_variant);
@@ -100,6 +131,14 @@ private:
 	void _track(const ResourceUID::ID &p_scene_id, Object *p_object);
 	void _untrack(const ResourceUID::ID &p_scene_id, Object *p_object);
 
+	// Delta sync
+	Error _sync_all_delta(const ResourceUID::ID &p_scene_id, int p_peer);
+	Error _send_delta(const ResourceUID::ID &p_scene_id, const SceneConfig &p_cfg, int p_peer, const LocalVector<ObjectID> &p_ids, const LocalVector<Vector<Variant>> &p_values);
+	void _process_delta_sync(const ResourceUID::ID &p_id, const uint8_t *p_packet, int p_packet_len);
+	Error _send_delta_ack(const ResourceUID::ID &p_scene_id, int p_sequence);
+	void _process_delta_ack(int p_from, const ResourceUID::ID &p_id, const uint8_t *p_packet, int p_packet_len);
+	void _reset_delta(const ResourceUID::ID &p_scene_id);
+
 public:
 	void clear();
 
@@ -116,6 +155,7 @@ public:
 
 	// Sync
 	Error sync_config(const ResourceUID::ID &p_id, uint64_t p_interval, const TypedArray<StringName> &p_props = TypedArray<StringName>(), const Callable &p_on_send = Callable(), const Callable &p_on_recv = Callable());
+	Error sync_delta_config(const ResourceUID::ID &p_id, uint64_t p_interval, const TypedArray<StringName> &p_props, const PackedFloat32Array &p_quantization = PackedFloat32Array(), const Callable &p_relevancy = Callable());
 	Error sync_all(const ResourceUID::ID &p_scene_id, int p_peer);
 	Error send_sync(int p_peer_id, const ResourceUID::ID &p_scene_id, PackedByteArray p_data, Multiplayer::TransferMode p_mode, int p_channel);
 	void track(const ResourceUID::ID &p_scene_id, Object *p_object);
@@ -126,6 +166,7 @@ public:
 	void process_spawn_despawn(int p_from, const uint8_t *p_packet, int p_packet_len, bool p_spawn);
 	void process_sync(int p_from, const uint8_t *p_packet, int p_packet_len);
 	void scene_enter_exit_notify(const String &p_scene, Node *p_node, bool p_enter);
+	void peer_removed(int p_peer);
 	void poll();
 
 	MultiplayerReplicator(MultiplayerAPI *p_multiplayer) {
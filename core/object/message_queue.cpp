@@ -35,11 +35,56 @@
 #include "core/object/script_language.h"
 
 MessageQueue *MessageQueue::singleton = nullptr;
+thread_local MessageQueue::ThreadBufferRef MessageQueue::thread_buffer;
+SafeNumeric<uint32_t> MessageQueue::generation;
+
+MessageQueue::ThreadBufferRef::~ThreadBufferRef() {
+	// The thread is gone, flush() frees its buffer once drained.
+	if (buffer && singleton && generation == MessageQueue::generation.get()) {
+		buffer->orphaned.set();
+	}
+}
 
 MessageQueue *MessageQueue::get_singleton() {
 	return singleton;
 }
 
+MessageQueue::ThreadBuffer *MessageQueue::_get_thread_buffer() {
+	if (likely(thread_buffer.buffer && thread_buffer.generation == generation.get())) {
+		return thread_buffer.buffer;
+	}
+
+	ThreadBuffer *buffer = memnew(ThreadBuffer);
+	buffers_mutex.lock();
+	thread_buffers.push_back(buffer);
+	buffers_mutex.unlock();
+
+	thread_buffer.buffer = buffer;
+	thread_buffer.generation = generation.get();
+	return buffer;
+}
+
+uint8_t *MessageQueue::_reserve(Storage &p_storage, uint32_t p_room) {
+	uint32_t needed = p_storage.end + p_room;
+	if (unlikely(needed > p_storage.size)) {
+		uint32_t new_size = MAX(p_storage.size ? p_storage.size * 2 : uint32_t(THREAD_QUEUE_SIZE_KB * 1024), needed);
+		if (needed > buffer_size) {
+			// Keep going rather than dropping the message, but make it visible.
+			overflow_count.increment();
+			WARN_PRINT_ONCE("Message queue exceeded its size limit and had to grow. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
+		} else {
+			new_size = MIN(new_size, buffer_size);
+		}
+		// Messages only hold Callables and Variants, which can be relocated.
+		p_storage.data = (uint8_t *)memrealloc(p_storage.data, new_size);
+		p_storage.size = new_size;
+	}
+
+	uint8_t *ptr = &p_storage.data[p_storage.end];
+	p_storage.end = needed;
+	return ptr;
+}
+
 Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
 	return push_callable(Callable(p_id, p_method), p_args, p_argcount, p_show_error);
 }
@@ -60,56 +105,38 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 }
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
-	_THREAD_SAFE_METHOD_
-
-	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
+	ThreadBuffer *buffer = _get_thread_buffer();
+	buffer->lock.lock();
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		String type;
-		if (ObjectDB::get_instance(p_id)) {
-			type = ObjectDB::get_instance(p_id)->get_class();
-		}
-		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
+	uint8_t *ptr = _reserve(buffer->write, sizeof(Message) + sizeof(Variant));
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(ptr, Message);
+	msg->sequence = sequence.postincrement();
 	msg->args = 1;
 	msg->callable = Callable(p_id, p_prop);
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
-
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
-	*v = p_value;
+	memnew_placement(ptr + sizeof(Message), Variant(p_value));
 
+	buffer->lock.unlock();
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
-	uint8_t room_needed = sizeof(Message);
+	ThreadBuffer *buffer = _get_thread_buffer();
+	buffer->lock.lock();
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
-
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(_reserve(buffer->write, sizeof(Message)), Message);
 
+	msg->sequence = sequence.postincrement();
 	msg->type = TYPE_NOTIFICATION;
 	msg->callable = Callable(p_id, CoreStringNames::get_singleton()->notification); //name is meaningless but callable needs it
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
-
+	buffer->lock.unlock();
 	return OK;
 }
 
@@ -126,17 +153,13 @@ Error MessageQueue::push_set(Object *p_object, const StringName &p_prop, const V
 }
 
 Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_args, int p_argcount, bool p_show_error) {
-	_THREAD_SAFE_METHOD_
-
-	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+	ThreadBuffer *buffer = _get_thread_buffer();
+	buffer->lock.lock();
 
-	if ((buffer_end + room_needed) >= buffer_size) {
-		print_line("Failed method: " + p_callable);
-		statistics();
-		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-	}
+	uint8_t *ptr = _reserve(buffer->write, sizeof(Message) + sizeof(Variant) * p_argcount);
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(ptr, Message);
+	msg->sequence = sequence.postincrement();
 	msg->args = p_argcount;
 	msg->callable = p_callable;
 	msg->type = TYPE_CALL;
@@ -144,14 +167,12 @@ Error MessageQueue::push_callable(const Callable &p_callable, const Variant **p_
 		msg->type |= FLAG_SHOW_ERROR;
 	}
 
-	buffer_end += sizeof(Message);
-
+	Variant *args = (Variant *)(msg + 1);
 	for (int i = 0; i < p_argcount; i++) {
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
-		*v = *p_args[i];
+		memnew_placement(&args[i], Variant(*p_args[i]));
 	}
 
+	buffer->lock.unlock();
 	return OK;
 }
 
@@ -175,56 +196,69 @@ void MessageQueue::statistics() {
 	Map<int, int> notify_count;
 	Map<Callable, int> call_count;
 	int null_count = 0;
+	uint32_t total_bytes = 0;
 
-	uint32_t read_pos = 0;
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
+	MutexLock lock(buffers_mutex);
+	for (uint32_t i = 0; i < thread_buffers.size(); i++) {
+		ThreadBuffer *buffer = thread_buffers[i];
+		buffer->lock.lock();
+		const Storage &storage = buffer->write;
+		total_bytes += storage.end;
 
-		Object *target = message->callable.get_object();
+		uint32_t read_pos = 0;
+		while (read_pos < storage.end) {
+			Message *message = (Message *)&storage.data[read_pos];
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					if (!call_count.has(message->callable)) {
-						call_count[message->callable] = 0;
-					}
+			Object *target = message->callable.get_object();
 
-					call_count[message->callable]++;
+			if (target != nullptr) {
+				switch (message->type & FLAG_MASK) {
+					case TYPE_CALL: {
+						if (!call_count.has(message->callable)) {
+							call_count[message->callable] = 0;
+						}
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					if (!notify_count.has(message->notification)) {
-						notify_count[message->notification] = 0;
-					}
+						call_count[message->callable]++;
 
-					notify_count[message->notification]++;
+					} break;
+					case TYPE_NOTIFICATION: {
+						if (!notify_count.has(message->notification)) {
+							notify_count[message->notification] = 0;
+						}
 
-				} break;
-				case TYPE_SET: {
-					StringName t = message->callable.get_method();
-					if (!set_count.has(t)) {
-						set_count[t] = 0;
-					}
+						notify_count[message->notification]++;
 
-					set_count[t]++;
+					} break;
+					case TYPE_SET: {
+						StringName t = message->callable.get_method();
+						if (!set_count.has(t)) {
+							set_count[t] = 0;
+						}
 
-				} break;
-			}
+						set_count[t]++;
 
-		} else {
-			//object was deleted
-			print_line("Object was deleted while awaiting a callback");
+					} break;
+				}
 
-			null_count++;
-		}
+			} else {
+				//object was deleted
+				print_line("Object was deleted while awaiting a callback");
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
+				null_count++;
+			}
+
+			read_pos += sizeof(Message);
+			if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+				read_pos += sizeof(Variant) * message->args;
+			}
 		}
+		buffer->lock.unlock();
 	}
 
-	print_line("TOTAL BYTES: " + itos(buffer_end));
+	print_line("TOTAL BYTES: " + itos(total_bytes));
+	print_line("MAX BYTES: " + itos(buffer_max_used));
+	print_line("THREAD BUFFERS: " + itos(thread_buffers.size()));
+	print_line("OVERFLOWS: " + itos(overflow_count.get()));
 	print_line("NULL count: " + itos(null_count));
 
 	for (const KeyValue<StringName, int> &E : set_count) {
@@ -244,6 +278,10 @@ int MessageQueue::get_max_buffer_usage() const {
 	return buffer_max_used;
 }
 
+uint32_t MessageQueue::get_overflow_count() const {
+	return overflow_count.get();
+}
+
 void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error) {
 	const Variant **argptrs = nullptr;
 	if (p_argcount) {
@@ -261,78 +299,158 @@ void MessageQueue::_call_function(const Callable &p_callable, const Variant *p_a
 	}
 }
 
-void MessageQueue::flush() {
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
+uint32_t MessageQueue::_get_message_size(const Message *p_message) {
+	if ((p_message->type & FLAG_MASK) == TYPE_NOTIFICATION) {
+		return sizeof(Message);
 	}
+	return sizeof(Message) + sizeof(Variant) * p_message->args;
+}
 
-	uint32_t read_pos = 0;
+void MessageQueue::_flush_message(Message *p_message) {
+	Object *target = p_message->callable.get_object();
 
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
+	if (target != nullptr) {
+		switch (p_message->type & FLAG_MASK) {
+			case TYPE_CALL: {
+				Variant *args = (Variant *)(p_message + 1);
 
-	if (flushing) {
-		_THREAD_SAFE_UNLOCK_
-		ERR_FAIL_COND(flushing); //already flushing, you did something odd
-	}
-	flushing = true;
+				// messages don't expect a return value
 
-	while (read_pos < buffer_end) {
-		//lock on each iteration, so a call can re-add itself to the message queue
+				_call_function(p_message->callable, args, p_message->args, p_message->type & FLAG_SHOW_ERROR);
 
-		Message *message = (Message *)&buffer[read_pos];
+			} break;
+			case TYPE_NOTIFICATION: {
+				// messages don't expect a return value
+				target->notification(p_message->notification);
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			advance += sizeof(Variant) * message->args;
-		}
-
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+			} break;
+			case TYPE_SET: {
+				Variant *arg = (Variant *)(p_message + 1);
+				// messages don't expect a return value
+				target->set(p_message->callable.get_method(), *arg);
 
-		_THREAD_SAFE_UNLOCK_
+			} break;
+		}
+	}
 
-		Object *target = message->callable.get_object();
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
 
-		if (target != nullptr) {
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
-					Variant *args = (Variant *)(message + 1);
+	p_message->~Message();
+}
 
-					// messages don't expect a return value
+void MessageQueue::_free_storage(Storage &p_storage) {
+	uint32_t read_pos = 0;
 
-					_call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
+	while (read_pos < p_storage.end) {
+		Message *message = (Message *)&p_storage.data[read_pos];
+		Variant *args = (Variant *)(message + 1);
+		int argc = message->args;
+		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+			for (int i = 0; i < argc; i++) {
+				args[i].~Variant();
+			}
+		}
+		message->~Message();
 
-				} break;
-				case TYPE_NOTIFICATION: {
-					// messages don't expect a return value
-					target->notification(message->notification);
+		read_pos += sizeof(Message);
+		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+			read_pos += sizeof(Variant) * argc;
+		}
+	}
 
-				} break;
-				case TYPE_SET: {
-					Variant *arg = (Variant *)(message + 1);
-					// messages don't expect a return value
-					target->set(message->callable.get_method(), *arg);
+	if (p_storage.data) {
+		memfree(p_storage.data);
+	}
+	p_storage = Storage();
+}
 
-				} break;
+void MessageQueue::flush() {
+	buffers_mutex.lock();
+	if (flushing) {
+		buffers_mutex.unlock();
+		ERR_FAIL_COND(flushing); //already flushing, you did something odd
+	}
+	flushing = true;
+	buffers_mutex.unlock();
+
+	// Messages pushed while flushing land in the swapped in buffers and are picked up by the next pass.
+	while (true) {
+		buffers_mutex.lock();
+		for (uint32_t i = 1; i < thread_buffers.size(); i++) {
+			ThreadBuffer *buffer = thread_buffers[i];
+			if (buffer->orphaned.is_set() && buffer->write.end == 0) {
+				_free_storage(buffer->write);
+				_free_storage(buffer->spare);
+				memdelete(buffer);
+				thread_buffers.remove_at(i);
+				i--;
 			}
 		}
+		flush_buffers = thread_buffers;
+		buffers_mutex.unlock();
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
+		// Swap every buffer while holding all of their locks, so a message caused by one that is left for the next
+		// pass can't be taken in this one. Pushers only ever hold their own lock, so this can't deadlock.
+		for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+			flush_buffers[i]->lock.lock();
+		}
+		uint32_t pending = 0;
+		for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+			ThreadBuffer *buffer = flush_buffers[i];
+			if (buffer->write.end != 0) {
+				SWAP(buffer->write, buffer->spare);
+				pending += buffer->spare.end;
 			}
 		}
+		for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+			flush_buffers[i]->lock.unlock();
+		}
 
-		message->~Message();
+		if (pending == 0) {
+			break;
+		}
+		if (pending > buffer_max_used) {
+			buffer_max_used = pending;
+		}
 
-		_THREAD_SAFE_LOCK_
+		// Each buffer is already in sequence order, merge them so messages run in global push order.
+		flush_positions.resize(flush_buffers.size());
+		for (uint32_t i = 0; i < flush_positions.size(); i++) {
+			flush_positions[i] = 0;
+		}
+		while (true) {
+			Message *next = nullptr;
+			uint32_t next_buffer = 0;
+			for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+				const Storage &storage = flush_buffers[i]->spare;
+				if (flush_positions[i] < storage.end) {
+					Message *message = (Message *)&storage.data[flush_positions[i]];
+					if (next == nullptr || message->sequence < next->sequence) {
+						next = message;
+						next_buffer = i;
+					}
+				}
+			}
+			if (next == nullptr) {
+				break;
+			}
+			flush_positions[next_buffer] += _get_message_size(next);
+			_flush_message(next);
+		}
+
+		for (uint32_t i = 0; i < flush_buffers.size(); i++) {
+			flush_buffers[i]->spare.end = 0;
+		}
 	}
 
-	buffer_end = 0; // reset buffer
+	buffers_mutex.lock();
 	flushing = false;
-	_THREAD_SAFE_UNLOCK_
+	buffers_mutex.unlock();
 }
 
 bool MessageQueue::is_flushing() const {
@@ -342,33 +460,27 @@ bool MessageQueue::is_flushing() const {
 MessageQueue::MessageQueue() {
 	ERR_FAIL_COND_MSG(singleton != nullptr, "A MessageQueue singleton already exists.");
 	singleton = this;
+	generation.increment();
 
 	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "1024,4096,1,or_greater"));
 	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+
+	// The main thread does most of the pushing, give it the full size up front.
+	ThreadBuffer *main_buffer = _get_thread_buffer();
+	main_buffer->write.data = (uint8_t *)memalloc(buffer_size);
+	main_buffer->write.size = buffer_size;
+	main_buffer->spare.data = (uint8_t *)memalloc(buffer_size);
+	main_buffer->spare.size = buffer_size;
 }
 
 MessageQueue::~MessageQueue() {
-	uint32_t read_pos = 0;
-
-	while (read_pos < buffer_end) {
-		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++) {
-				args[i].~Variant();
-			}
-		}
-		message->~Message();
-
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			read_pos += sizeof(Variant) * message->args;
-		}
+	for (uint32_t i = 0; i < thread_buffers.size(); i++) {
+		_free_storage(thread_buffers[i]->write);
+		_free_storage(thread_buffers[i]->spare);
+		memdelete(thread_buffers[i]);
 	}
+	thread_buffers.clear();
 
 	singleton = nullptr;
-	memdelete_arr(buffer);
 }
@@ -32,13 +32,15 @@
 #define MESSAGE_QUEUE_H
 
 #include "core/object/class_db.h"
-#include "core/os/thread_safe.h"
+#include "core/os/mutex.h"
+#include "core/os/spin_lock.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
 
 class MessageQueue {
-	_THREAD_SAFE_CLASS_
-
 	enum {
-		DEFAULT_QUEUE_SIZE_KB = 4096
+		DEFAULT_QUEUE_SIZE_KB = 4096,
+		THREAD_QUEUE_SIZE_KB = 64
 	};
 
 	enum {
@@ -52,6 +54,7 @@ class MessageQueue {
 
 	struct Message {
 		Callable callable;
+		uint64_t sequence; // Global push order, flush() merges the thread buffers by it.
 		int16_t type;
 		union {
 			int16_t notification;
@@ -59,11 +62,44 @@ class MessageQueue {
 		};
 	};
 
-	uint8_t *buffer;
-	uint32_t buffer_end = 0;
+	struct Storage {
+		uint8_t *data = nullptr;
+		uint32_t end = 0;
+		uint32_t size = 0;
+	};
+
+	// Each thread appends to its own buffer, the lock is only contended while flush() swaps it out.
+	struct ThreadBuffer {
+		SpinLock lock;
+		Storage write;
+		Storage spare; // Only touched by flush().
+		SafeFlag orphaned;
+	};
+
+	struct ThreadBufferRef {
+		ThreadBuffer *buffer = nullptr;
+		uint32_t generation = 0;
+		~ThreadBufferRef();
+	};
+
+	static thread_local ThreadBufferRef thread_buffer;
+	static SafeNumeric<uint32_t> generation;
+
+	LocalVector<ThreadBuffer *> thread_buffers;
+	LocalVector<ThreadBuffer *> flush_buffers;
+	LocalVector<uint32_t> flush_positions;
+	Mutex buffers_mutex;
+	SafeNumeric<uint64_t> sequence;
+
 	uint32_t buffer_max_used = 0;
 	uint32_t buffer_size;
+	SafeNumeric<uint32_t> overflow_count;
 
+	ThreadBuffer *_get_thread_buffer();
+	uint8_t *_reserve(Storage &p_storage, uint32_t p_room);
+	static uint32_t _get_message_size(const Message *p_message);
+	void _flush_message(Message *p_message);
+	static void _free_storage(Storage &p_storage);
 	void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
 
 	static MessageQueue *singleton;
@@ -90,6 +126,7 @@ public:
 	bool is_flushing() const;
 
 	int get_max_buffer_usage() const;
+	uint32_t get_overflow_count() const;
 
 	MessageQueue();
 	~MessageQueue();
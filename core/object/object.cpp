@@ -38,21 +38,10 @@
 #include "core/os/os.h"
 #include "core/string/print_string.h"
 #include "core/string/translation.h"
+#include "core/variant/variant_internal.h"
 
 #ifdef DEBUG_ENABLED
 
-struct _ObjectDebugLock {
-	Object *obj;
-
-	_ObjectDebugLock(Object *p_obj) {
-		obj = p_obj;
-		obj->_lock_index.ref();
-	}
-	~_ObjectDebugLock() {
-		obj->_lock_index.unref();
-	}
-};
-
 #define OBJ_DEBUG_LOCK _ObjectDebugLock _debug_lock(this);
 
 #else
@@ -1005,11 +994,6 @@ bool Object::_has_user_signal(const StringName &p_name) const {
 	return signal_map[p_name].user.name.length() > 0;
 }
 
-struct _ObjectSignalDisconnectData {
-	StringName signal;
-	Callable callable;
-};
-
 Variant Object::_emit_signal(const Variant **p_args, int p_argcount, Callable::CallError &r_error) {
 	r_error.error = Callable::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS;
 
@@ -1053,94 +1037,125 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 		return ERR_UNAVAILABLE;
 	}
 
-	List<_ObjectSignalDisconnectData> disconnect_data;
+	OBJ_DEBUG_LOCK
 
-	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
-	//this happens automatically and will not change the performance of calling.
-	//awesome, isn't it?
-	VMap<Callable, SignalData::Slot> slot_map = s->slot_map;
+	// Slots connected from here on are not called by this emission, and slots disconnected
+	// are skipped. Removal is deferred until no emission is iterating the slots anymore.
+	SignalEmission emission;
+	emission.data = s;
+	emission.prev = _signal_emissions;
+	_signal_emissions = &emission;
+	s->emitting++;
 
-	int ssize = slot_map.size();
+	const uint32_t slot_count = s->slots.size();
 
-	OBJ_DEBUG_LOCK
-
-	Vector<const Variant *> bind_mem;
+	const Variant **bind_args = nullptr;
+	if (s->max_binds) {
+		bind_args = (const Variant **)alloca(sizeof(Variant *) * (p_argcount + s->max_binds));
+		for (int j = 0; j < p_argcount; j++) {
+			bind_args[j] = p_args[j];
+		}
+	}
+	const void **ptr_args = p_argcount ? (const void **)alloca(sizeof(void *) * p_argcount) : nullptr;
 
 	Error err = OK;
 
-	for (int i = 0; i < ssize; i++) {
-		const Connection &c = slot_map.getv(i).conn;
+	for (uint32_t i = 0; i < slot_count; i++) {
+		// Don't keep references into the slots across calls, connecting may reallocate them.
+		const SignalData::Slot &slot = emission.data->slots[i];
+		if (slot.removed) {
+			continue;
+		}
 
-		Object *target = c.callable.get_object();
+		Object *target = slot.conn.callable.get_object();
 		if (!target) {
 			// Target might have been deleted during signal callback, this is expected and OK.
 			continue;
 		}
 
+		const Callable callable = slot.conn.callable;
+		const uint32_t flags = slot.conn.flags;
+		MethodBind *method = slot.method;
+
 		const Variant **args = p_args;
 		int argc = p_argcount;
 
-		if (c.binds.size()) {
+		if (slot.conn.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
-
-			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
-			}
-			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+			const Variant *binds = slot.conn.binds.ptr();
+			for (int j = 0; j < slot.conn.binds.size(); j++) {
+				bind_args[p_argcount + j] = &binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_args;
+			argc = p_argcount + slot.conn.binds.size();
 		}
 
-		if (c.flags & CONNECT_DEFERRED) {
-			MessageQueue::get_singleton()->push_callable(c.callable, args, argc, true);
+		if (flags & CONNECT_DEFERRED) {
+			MessageQueue::get_singleton()->push_callable(callable, args, argc, true);
 		} else {
-			Callable::CallError ce;
-			_emitting = true;
-			Variant ret;
-			c.callable.call(args, argc, ret, ce);
-			_emitting = false;
+			bool ptrcall = method && !target->get_script_instance() && method->get_argument_count() == argc;
+			for (int j = 0; ptrcall && j < argc; j++) {
+				Variant::Type type = method->get_argument_type(j);
+				if (type == Variant::NIL) {
+					ptr_args[j] = args[j]; // Variant argument.
+				} else if (args[j]->get_type() != type || type == Variant::OBJECT) {
+					// Object arguments need their class validated, leave those to the regular call.
+					ptrcall = false;
+				} else {
+					ptr_args[j] = VariantInternal::get_opaque_pointer(args[j]);
+				}
+			}
+
+			if (ptrcall) {
+				method->ptrcall(target, ptr_args, nullptr);
+			} else {
+				Callable::CallError ce;
+				Variant ret;
+				callable.call(args, argc, ret, ce);
 
-			if (ce.error != Callable::CallError::CALL_OK) {
+				if (ce.error != Callable::CallError::CALL_OK && !emission.freed) {
 #ifdef DEBUG_ENABLED
-				if (c.flags & CONNECT_PERSIST && Engine::get_singleton()->is_editor_hint() && (script.is_null() || !Ref<Script>(script)->is_tool())) {
-					continue;
-				}
+					if (flags & CONNECT_PERSIST && Engine::get_singleton()->is_editor_hint() && (script.is_null() || !Ref<Script>(script)->is_tool())) {
+						continue;
+					}
 #endif
-				if (ce.error == Callable::CallError::CALL_ERROR_INVALID_METHOD && !ClassDB::class_exists(target->get_class_name())) {
-					//most likely object is not initialized yet, do not throw error.
-				} else {
-					ERR_PRINT("Error calling from signal '" + String(p_name) + "' to callable: " + Variant::get_callable_error_text(c.callable, args, argc, ce) + ".");
-					err = ERR_METHOD_NOT_FOUND;
+					Object *current_target = callable.get_object();
+					if (ce.error == Callable::CallError::CALL_ERROR_INVALID_METHOD && current_target && !ClassDB::class_exists(current_target->get_class_name())) {
+						//most likely object is not initialized yet, do not throw error.
+					} else {
+						ERR_PRINT("Error calling from signal '" + String(p_name) + "' to callable: " + Variant::get_callable_error_text(callable, args, argc, ce) + ".");
+						err = ERR_METHOD_NOT_FOUND;
+					}
 				}
 			}
 		}
 
-		bool disconnect = c.flags & CONNECT_ONESHOT;
+		bool disconnect = flags & CONNECT_ONESHOT;
 #ifdef TOOLS_ENABLED
-		if (disconnect && (c.flags & CONNECT_PERSIST) && Engine::get_singleton()->is_editor_hint()) {
+		if (disconnect && (flags & CONNECT_PERSIST) && Engine::get_singleton()->is_editor_hint()) {
 			//this signal was connected from the editor, and is being edited. just don't disconnect for now
 			disconnect = false;
 		}
 #endif
-		if (disconnect) {
-			_ObjectSignalDisconnectData dd;
-			dd.signal = p_name;
-			dd.callable = c.callable;
-			disconnect_data.push_back(dd);
+		if (disconnect && !emission.freed && !emission.data->slots[i].removed) {
+			_disconnect(p_name, callable);
 		}
 	}
 
-	while (!disconnect_data.is_empty()) {
-		const _ObjectSignalDisconnectData &dd = disconnect_data.front()->get();
-
-		_disconnect(dd.signal, dd.callable);
-		disconnect_data.pop_front();
+	SignalData *data = emission.data;
+	data->emitting--;
+	if (emission.freed) {
+		// This object was freed by one of the callbacks, the slots were handed over to the emission.
+		if (!data->emitting) {
+			memdelete(data);
+		}
+		return err;
 	}
 
+	_signal_emissions = emission.prev;
+	_remove_disconnected_slots(p_name, data);
+
 	return err;
 }
 
@@ -1266,8 +1281,10 @@ void Object::get_all_signal_connections(List<Connection> *p_connections) const {
 	while ((S = signal_map.next(S))) {
 		const SignalData *s = &signal_map[*S];
 
-		for (int i = 0; i < s->slot_map.size(); i++) {
-			p_connections->push_back(s->slot_map.getv(i).conn);
+		for (uint32_t i = 0; i < s->slots.size(); i++) {
+			if (!s->slots[i].removed) {
+				p_connections->push_back(s->slots[i].conn);
+			}
 		}
 	}
 }
@@ -1278,8 +1295,10 @@ void Object::get_signal_connection_list(const StringName &p_signal, List<Connect
 		return; //nothing
 	}
 
-	for (int i = 0; i < s->slot_map.size(); i++) {
-		p_connections->push_back(s->slot_map.getv(i).conn);
+	for (uint32_t i = 0; i < s->slots.size(); i++) {
+		if (!s->slots[i].removed) {
+			p_connections->push_back(s->slots[i].conn);
+		}
 	}
 }
 
@@ -1290,8 +1309,8 @@ int Object::get_persistent_signal_connection_count() const {
 	while ((S = signal_map.next(S))) {
 		const SignalData *s = &signal_map[*S];
 
-		for (int i = 0; i < s->slot_map.size(); i++) {
-			if (s->slot_map.getv(i).conn.flags & CONNECT_PERSIST) {
+		for (uint32_t i = 0; i < s->slots.size(); i++) {
+			if (!s->slots[i].removed && (s->slots[i].conn.flags & CONNECT_PERSIST)) {
 				count += 1;
 			}
 		}
@@ -1339,9 +1358,10 @@ Error Object::connect(const StringName &p_signal, const Callable &p_callable, co
 	Callable target = p_callable;
 
 	//compare with the base callable, so binds can be ignored
-	if (s->slot_map.has(*target.get_base_comparator())) {
+	int slot_idx = s->slot_index.find(*target.get_base_comparator());
+	if (slot_idx != -1) {
 		if (p_flags & CONNECT_REFERENCE_COUNTED) {
-			s->slot_map[*target.get_base_comparator()].reference_count++;
+			s->slots[s->slot_index.getv(slot_idx)].reference_count++;
 			return OK;
 		} else {
 			ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Signal '" + p_signal + "' is already connected to given callable '" + p_callable + "' in that object.");
@@ -1361,8 +1381,17 @@ Error Object::connect(const StringName &p_signal, const Callable &p_callable, co
 		slot.reference_count = 1;
 	}
 
+	if (!p_callable.is_custom() && p_binds.is_empty()) {
+		MethodBind *method = ClassDB::get_method(target_object->get_class_name(), p_callable.get_method());
+		if (method && !method->is_vararg() && !method->has_return()) {
+			slot.method = method;
+		}
+	}
+
 	//use callable version as key, so binds can be ignored
-	s->slot_map[*target.get_base_comparator()] = slot;
+	s->slot_index[*target.get_base_comparator()] = s->slots.size();
+	s->slots.push_back(slot);
+	s->max_binds = MAX(s->max_binds, (uint32_t)p_binds.size());
 
 	return OK;
 }
@@ -1385,9 +1414,7 @@ bool Object::is_connected(const StringName &p_signal, const Callable &p_callable
 
 	Callable target = p_callable;
 
-	return s->slot_map.has(*target.get_base_comparator());
-	//const Map<Signal::Target,Signal::Slot>::Element *E = s->slot_map.find(target);
-	//return (E!=nullptr );
+	return s->slot_index.has(*target.get_base_comparator());
 }
 
 void Object::disconnect(const StringName &p_signal, const Callable &p_callable) {
@@ -1408,9 +1435,10 @@ void Object::_disconnect(const StringName &p_signal, const Callable &p_callable,
 	}
 	ERR_FAIL_COND_MSG(!s, vformat("Disconnecting nonexistent signal '%s' in %s.", p_signal, to_string()));
 
-	ERR_FAIL_COND_MSG(!s->slot_map.has(*p_callable.get_base_comparator()), "Disconnecting nonexistent signal '" + p_signal + "', callable: " + p_callable + ".");
+	int slot_idx = s->slot_index.find(*p_callable.get_base_comparator());
+	ERR_FAIL_COND_MSG(slot_idx == -1, "Disconnecting nonexistent signal '" + p_signal + "', callable: " + p_callable + ".");
 
-	SignalData::Slot *slot = &s->slot_map[*p_callable.get_base_comparator()];
+	SignalData::Slot *slot = &s->slots[s->slot_index.getv(slot_idx)];
 
 	if (!p_force) {
 		slot->reference_count--; // by default is zero, if it was not referenced it will go below it
@@ -1420,9 +1448,36 @@ void Object::_disconnect(const StringName &p_signal, const Callable &p_callable,
 	}
 
 	target_object->connections.erase(slot->cE);
-	s->slot_map.erase(*p_callable.get_base_comparator());
+	slot->cE = nullptr;
+	slot->removed = true;
+	s->removed_slots++;
+	s->slot_index.erase(*p_callable.get_base_comparator());
+
+	_remove_disconnected_slots(p_signal, s);
+}
+
+void Object::_remove_disconnected_slots(const StringName &p_signal, SignalData *p_data) {
+	if (p_data->emitting || !p_data->removed_slots) {
+		return;
+	}
+
+	uint32_t count = 0;
+	p_data->max_binds = 0;
+	for (uint32_t i = 0; i < p_data->slots.size(); i++) {
+		if (p_data->slots[i].removed) {
+			continue;
+		}
+		if (count != i) {
+			p_data->slots[count] = p_data->slots[i];
+			p_data->slot_index[*p_data->slots[count].conn.callable.get_base_comparator()] = count;
+		}
+		p_data->max_binds = MAX(p_data->max_binds, (uint32_t)p_data->slots[count].conn.binds.size());
+		count++;
+	}
+	p_data->slots.resize(count);
+	p_data->removed_slots = 0;
 
-	if (s->slot_map.is_empty() && ClassDB::has_signal(get_class_name(), p_signal)) {
+	if (p_data->slots.is_empty() && ClassDB::has_signal(get_class_name(), p_signal)) {
 		//not user signal, delete
 		signal_map.erase(p_signal);
 	}
@@ -1865,20 +1920,35 @@ Object::~Object() {
 
 	const StringName *S = nullptr;
 
-	if (_emitting) {
+	if (_signal_emissions) {
 		//@todo this may need to actually reach the debugger prioritarily somehow because it may crash before
 		ERR_PRINT("Object " + to_string() + " was freed or unreferenced while a signal is being emitted from it. Try connecting to the signal using 'CONNECT_DEFERRED' flag, or use queue_free() to free the object (if this object is a Node) to avoid this error and potential crashes.");
 	}
 
+	// Emissions still in progress keep iterating over their own copy of the slots.
+	for (SignalEmission *E = _signal_emissions; E; E = E->prev) {
+		if (E->freed) {
+			continue;
+		}
+		SignalData *original = E->data;
+		SignalData *copy = memnew(SignalData(*original));
+		for (SignalEmission *F = E; F; F = F->prev) {
+			if (F->data == original) {
+				F->data = copy;
+				F->freed = true;
+			}
+		}
+	}
+	_signal_emissions = nullptr;
+
 	while ((S = signal_map.next(nullptr))) {
 		SignalData *s = &signal_map[*S];
 
 		//brute force disconnect for performance
-		int slot_count = s->slot_map.size();
-		const VMap<Callable, SignalData::Slot>::Pair *slot_list = s->slot_map.get_array();
-
-		for (int i = 0; i < slot_count; i++) {
-			slot_list[i].value.conn.callable.get_object()->connections.erase(slot_list[i].value.cE);
+		for (uint32_t i = 0; i < s->slots.size(); i++) {
+			if (!s->slots[i].removed) {
+				s->slots[i].conn.callable.get_object()->connections.erase(s->slots[i].cE);
+			}
 		}
 
 		signal_map.erase(*S);
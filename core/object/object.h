@@ -37,6 +37,7 @@
 #include "core/os/spin_lock.h"
 #include "core/templates/hash_map.h"
 #include "core/templates/list.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/map.h"
 #include "core/templates/safe_refcount.h"
 #include "core/templates/set.h"
@@ -514,13 +515,31 @@ private:
 			int reference_count = 0;
 			Connection conn;
 			List<Connection>::Element *cE = nullptr;
+			// Native method target without binds, called through ptrcall when the arguments match exactly.
+			MethodBind *method = nullptr;
+			bool removed = false;
 		};
 
 		MethodInfo user;
-		VMap<Callable, Slot> slot_map;
+		// Slots in connection order. Slots disconnected while the signal is being emitted
+		// are only flagged, and removed once the outermost emission returns.
+		LocalVector<Slot> slots;
+		VMap<Callable, uint32_t> slot_index;
+		uint32_t removed_slots = 0;
+		uint32_t max_binds = 0;
+		uint32_t emitting = 0;
+	};
+
+	// One per emit_signal() in progress on this object, so that freeing the object
+	// from a callback can hand the slots being iterated over to the emission.
+	struct SignalEmission {
+		SignalData *data = nullptr;
+		SignalEmission *prev = nullptr;
+		bool freed = false;
 	};
 
 	HashMap<StringName, SignalData> signal_map;
+	SignalEmission *_signal_emissions = nullptr;
 	List<Connection> connections;
 #ifdef DEBUG_ENABLED
 	SafeRefCount _lock_index;
@@ -531,7 +550,6 @@ private:
 	bool _predelete();
 	void _postinitialize();
 	bool _can_translate = true;
-	bool _emitting = false;
 #ifdef TOOLS_ENABLED
 	bool _edited = false;
 	uint32_t _edited_version = 0;
@@ -644,6 +662,7 @@ protected:
 	virtual void _validate_property(PropertyInfo &property) const;
 
 	void _disconnect(const StringName &p_signal, const Callable &p_callable, bool p_force = false);
+	void _remove_disconnected_slots(const StringName &p_signal, SignalData *p_data);
 
 public: //should be protected, but bug in clang++
 	static void initialize_class();
@@ -840,6 +859,21 @@ public:
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
+#ifdef DEBUG_ENABLED
+// Keeps an object from being freed while one of its methods runs.
+struct _ObjectDebugLock {
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+#endif
+
 class ObjectDB {
 //this needs to add up to 63, 1 bit is for reference
 #define OBJECTDB_VALIDATOR_BITS 39
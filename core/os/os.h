@@ -143,6 +143,9 @@ public:
 	virtual Error close_dynamic_library(void *p_library_handle) { return ERR_UNAVAILABLE; }
 	virtual Error get_dynamic_library_symbol_handle(void *p_library_handle, const String p_name, void *&p_symbol_handle, bool p_optional = false) { return ERR_UNAVAILABLE; }
 
+	virtual Error map_file(const String &p_path, const uint8_t *&r_data, uint64_t &r_size) { return ERR_UNAVAILABLE; } ///< map a whole file read-only in memory
+	virtual Error unmap_file(const uint8_t *p_data, uint64_t p_size) { return ERR_UNAVAILABLE; }
+
 	virtual void set_low_processor_usage_mode(bool p_enabled);
 	virtual bool is_in_low_processor_usage_mode() const;
 	virtual void set_low_processor_usage_mode_sleep_usec(int p_usec);
@@ -76,6 +76,7 @@
 #include "core/os/time.h"
 #include "core/string/optimized_translation.h"
 #include "core/string/translation.h"
+#include "core/templates/task_scheduler.h"
 
 static Ref<ResourceFormatSaverBinary> resource_saver_binary;
 static Ref<ResourceFormatLoaderBinary> resource_loader_binary;
@@ -108,12 +109,17 @@ extern void unregister_global_constants();
 
 static ResourceUID *resource_uid = nullptr;
 
+static TaskScheduler *task_scheduler = nullptr;
+
 void register_core_types() {
 	//consistency check
 	static_assert(sizeof(Callable) <= 16);
 
 	ObjectDB::setup();
 
+	task_scheduler = memnew(TaskScheduler);
+	task_scheduler->init();
+
 	StringName::setup();
 	ResourceLoader::initialize();
 
@@ -372,4 +378,6 @@ void unregister_core_types() {
 	ResourceCache::clear();
 	CoreStringNames::free();
 	StringName::cleanup();
+
+	memdelete(task_scheduler);
 }
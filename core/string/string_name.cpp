@@ -32,6 +32,7 @@
 
 #include "core/os/os.h"
 #include "core/string/print_string.h"
+#include "core/templates/local_vector.h"
 
 StaticCString StaticCString::create(const char *p_ptr) {
 	StaticCString scs;
@@ -39,14 +40,115 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+struct StringName::_Shard {
+	struct Buckets {
+		uint32_t mask = 0;
+		std::atomic<_Data *> *heads = nullptr;
+	};
+
+	Mutex mutex;
+	std::atomic<Buckets *> buckets = { nullptr };
+	uint32_t count = 0;
+	// Threads inside a lock-free lookup. Unlinked nodes and replaced bucket arrays are kept until it reaches zero.
+	std::atomic<uint32_t> readers = { 0 };
+	LocalVector<_Data *> retired_data;
+	LocalVector<Buckets *> retired_buckets;
+
+	static Buckets *create_buckets(uint32_t p_bits) {
+		Buckets *b = memnew(Buckets);
+		b->mask = (1 << p_bits) - 1;
+		b->heads = memnew_arr(std::atomic<_Data *>, b->mask + 1);
+		for (uint32_t i = 0; i <= b->mask; i++) {
+			b->heads[i].store(nullptr, std::memory_order_relaxed);
+		}
+		return b;
+	}
+
+	static void free_buckets(Buckets *p_buckets) {
+		memdelete_arr(p_buckets->heads);
+		memdelete(p_buckets);
+	}
+
+	// Must be called with the mutex held, after the retired pointers were unlinked.
+	void reclaim() {
+		if (readers.load() != 0) {
+			return;
+		}
+		for (uint32_t i = 0; i < retired_data.size(); i++) {
+			memdelete(retired_data[i]);
+		}
+		retired_data.clear();
+		for (uint32_t i = 0; i < retired_buckets.size(); i++) {
+			free_buckets(retired_buckets[i]);
+		}
+		retired_buckets.clear();
+	}
+
+	void link(_Data *p_data) {
+		Buckets *b = buckets.load(std::memory_order_relaxed);
+		std::atomic<_Data *> &head = b->heads[(p_data->hash >> SHARD_BITS) & b->mask];
+		_Data *first = head.load(std::memory_order_relaxed);
+		p_data->prev = nullptr;
+		p_data->next.store(first, std::memory_order_relaxed);
+		if (first) {
+			first->prev = p_data;
+		}
+		// Publish only once the node is fully built.
+		head.store(p_data, std::memory_order_release);
+	}
+
+	void unlink(_Data *p_data) {
+		Buckets *b = buckets.load(std::memory_order_relaxed);
+		_Data *next = p_data->next.load(std::memory_order_relaxed);
+		if (p_data->prev) {
+			p_data->prev->next.store(next);
+		} else {
+			std::atomic<_Data *> &head = b->heads[(p_data->hash >> SHARD_BITS) & b->mask];
+			if (head.load(std::memory_order_relaxed) != p_data) {
+				ERR_PRINT("BUG!");
+			}
+			head.store(next);
+		}
+		if (next) {
+			next->prev = p_data->prev;
+		}
+	}
+
+	void grow() {
+		Buckets *old_buckets = buckets.load(std::memory_order_relaxed);
+		Buckets *new_buckets = create_buckets(get_shift_from_power_of_2(old_buckets->mask + 1) + 1);
+
+		// Nodes are moved in place. A concurrent lock-free lookup may wander off its chain,
+		// but only through live nodes, and a miss is always retried under the lock.
+		for (uint32_t i = 0; i <= old_buckets->mask; i++) {
+			_Data *d = old_buckets->heads[i].load(std::memory_order_relaxed);
+			while (d) {
+				_Data *next = d->next.load(std::memory_order_relaxed);
+				std::atomic<_Data *> &head = new_buckets->heads[(d->hash >> SHARD_BITS) & new_buckets->mask];
+				_Data *first = head.load(std::memory_order_relaxed);
+				d->prev = nullptr;
+				d->next.store(first, std::memory_order_release);
+				if (first) {
+					first->prev = d;
+				}
+				head.store(d, std::memory_order_relaxed);
+				d = next;
+			}
+		}
+
+		buckets.store(new_buckets);
+		retired_buckets.push_back(old_buckets);
+		reclaim();
+	}
+};
+
+StringName::_Shard *StringName::_shards = nullptr;
 
 StringName _scs_create(const char *p_chr, bool p_static) {
 	return (p_chr[0] ? StringName(StaticCString::create(p_chr), p_static) : StringName());
 }
 
 bool StringName::configured = false;
-Mutex StringName::mutex;
 
 #ifdef DEBUG_ENABLED
 bool StringName::debug_stringname = false;
@@ -54,23 +156,29 @@ bool StringName::debug_stringname = false;
 
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		_table[i] = nullptr;
+	_shards = memnew_arr(_Shard, SHARD_COUNT);
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		_shards[i].buckets.store(_Shard::create_buckets(SHARD_INITIAL_BUCKET_BITS));
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
-	MutexLock lock(mutex);
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		_shards[i].mutex.lock();
+	}
 
 #ifdef DEBUG_ENABLED
 	if (unlikely(debug_stringname)) {
 		Vector<_Data *> data;
-		for (int i = 0; i < STRING_TABLE_LEN; i++) {
-			_Data *d = _table[i];
-			while (d) {
-				data.push_back(d);
-				d = d->next;
+		for (int i = 0; i < SHARD_COUNT; i++) {
+			_Shard::Buckets *b = _shards[i].buckets.load();
+			for (uint32_t j = 0; j <= b->mask; j++) {
+				_Data *d = b->heads[j].load();
+				while (d) {
+					data.push_back(d);
+					d = d->next.load();
+				}
 			}
 		}
 		print_line("\nStringName Reference Ranking:\n");
@@ -81,25 +189,36 @@ void StringName::cleanup() {
 	}
 #endif
 	int lost_strings = 0;
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
-		while (_table[i]) {
-			_Data *d = _table[i];
-			lost_strings++;
-			if (d->static_count.get() != d->refcount.get() && OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
+	for (int i = 0; i < SHARD_COUNT; i++) {
+		_Shard &shard = _shards[i];
+		_Shard::Buckets *b = shard.buckets.load();
+		for (uint32_t j = 0; j <= b->mask; j++) {
+			_Data *d = b->heads[j].load();
+			while (d) {
+				lost_strings++;
+				if (d->static_count.get() != d->refcount.get() && OS::get_singleton()->is_stdout_verbose()) {
+					if (d->cname) {
+						print_line("Orphan StringName: " + String(d->cname));
+					} else {
+						print_line("Orphan StringName: " + String(d->name));
+					}
 				}
-			}
 
-			_table[i] = _table[i]->next;
-			memdelete(d);
+				_Data *next = d->next.load();
+				memdelete(d);
+				d = next;
+			}
 		}
+		shard.retired_buckets.push_back(b);
+		shard.buckets.store(nullptr);
+		shard.reclaim();
+		shard.mutex.unlock();
 	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
+	memdelete_arr(_shards);
+	_shards = nullptr;
 	configured = false;
 }
 
@@ -107,7 +226,8 @@ void StringName::unref() {
 	ERR_FAIL_COND(!configured);
 
 	if (_data && _data->refcount.unref()) {
-		MutexLock lock(mutex);
+		_Shard &shard = _shards[_data->hash & SHARD_MASK];
+		MutexLock lock(shard.mutex);
 
 		if (_data->static_count.get() > 0) {
 			if (_data->cname) {
@@ -116,22 +236,117 @@ void StringName::unref() {
 				ERR_PRINT("BUG: Unreferenced static string to 0: " + String(_data->name));
 			}
 		}
-		if (_data->prev) {
-			_data->prev->next = _data->next;
-		} else {
-			if (_table[_data->idx] != _data) {
-				ERR_PRINT("BUG!");
-			}
-			_table[_data->idx] = _data->next;
+		shard.unlink(_data);
+		shard.count--;
+		shard.retired_data.push_back(_data);
+		shard.reclaim();
+	}
+
+	_data = nullptr;
+}
+
+template <class T>
+StringName::_Data *StringName::_find(uint32_t p_hash, const T &p_name) {
+	_Shard &shard = _shards[p_hash & SHARD_MASK];
+	shard.readers.fetch_add(1);
+
+	_Data *found = nullptr;
+	_Shard::Buckets *b = shard.buckets.load();
+	_Data *d = b->heads[(p_hash >> SHARD_BITS) & b->mask].load();
+	for (int steps = 0; d && steps < LOCK_FREE_MAX_STEPS; steps++) {
+		// compare hash first
+		// A node whose count already dropped to zero is on its way out, skip it.
+		if (d->hash == p_hash && d->get_name() == p_name && d->refcount.ref()) {
+			found = d;
+			break;
 		}
+		d = d->next.load(std::memory_order_acquire);
+	}
 
-		if (_data->next) {
-			_data->next->prev = _data->prev;
+	shard.readers.fetch_sub(1);
+	return found;
+}
+
+template <class T>
+StringName::_Data *StringName::_find_locked(uint32_t p_hash, const T &p_name) {
+	_Shard::Buckets *b = _shards[p_hash & SHARD_MASK].buckets.load(std::memory_order_relaxed);
+	_Data *d = b->heads[(p_hash >> SHARD_BITS) & b->mask].load(std::memory_order_relaxed);
+	while (d) {
+		if (d->hash == p_hash && d->get_name() == p_name && d->refcount.ref()) {
+			return d;
 		}
-		memdelete(_data);
+		d = d->next.load(std::memory_order_relaxed);
 	}
+	return nullptr;
+}
 
-	_data = nullptr;
+template <class T>
+StringName StringName::_search(uint32_t p_hash, const T &p_name) {
+	_Data *d = _find(p_hash, p_name);
+	if (!d) {
+		MutexLock lock(_shards[p_hash & SHARD_MASK].mutex);
+		d = _find_locked(p_hash, p_name);
+	}
+
+	if (d) {
+#ifdef DEBUG_ENABLED
+		if (unlikely(debug_stringname)) {
+			d->debug_references++;
+		}
+#endif
+		return StringName(d);
+	}
+
+	return StringName(); //does not exist
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(uint32_t p_hash, const T &p_name, const char *p_cname, bool p_static) {
+	_Data *d = _find(p_hash, p_name);
+
+	if (!d) {
+		_Shard &shard = _shards[p_hash & SHARD_MASK];
+		MutexLock lock(shard.mutex);
+
+		// Someone else may have added it since the lock-free attempt.
+		d = _find_locked(p_hash, p_name);
+
+		if (!d) {
+			d = memnew(_Data);
+			if (p_cname) {
+				d->cname = p_cname;
+			} else {
+				d->name = p_name;
+			}
+			d->refcount.init();
+			d->static_count.set(p_static ? 1 : 0);
+			d->hash = p_hash;
+#ifdef DEBUG_ENABLED
+			if (unlikely(debug_stringname)) {
+				// Keep in memory, force static.
+				d->refcount.ref();
+				d->static_count.increment();
+			}
+#endif
+			shard.link(d);
+			shard.count++;
+			if (shard.count > (shard.buckets.load(std::memory_order_relaxed)->mask + 1) * 2) {
+				shard.grow();
+			}
+			return d;
+		}
+	}
+
+	// exists
+	if (p_static) {
+		d->static_count.increment();
+	}
+#ifdef DEBUG_ENABLED
+	if (unlikely(debug_stringname)) {
+		d->debug_references++;
+	}
+#endif
+	return d;
 }
 
 bool StringName::operator==(const String &p_name) const {
@@ -139,7 +354,11 @@ bool StringName::operator==(const String &p_name) const {
 		return (p_name.length() == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	// Compared in place, without building a String from a C string name.
+	if (_data->cname) {
+		return p_name == _data->cname;
+	}
+	return (_data->name == p_name);
 }
 
 bool StringName::operator==(const char *p_name) const {
@@ -147,7 +366,10 @@ bool StringName::operator==(const char *p_name) const {
 		return (p_name[0] == 0);
 	}
 
-	return (_data->get_name() == p_name);
+	if (_data->cname) {
+		return strcmp(_data->cname, p_name) == 0;
+	}
+	return (_data->name == p_name);
 }
 
 bool StringName::operator!=(const String &p_name) const {
@@ -191,58 +413,7 @@ StringName::StringName(const char *p_name, bool p_static) {
 		return; //empty, ignore
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-		}
-
-		return;
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _intern(String::hash(p_name), p_name, nullptr, p_static);
 }
 
 StringName::StringName(const StaticCString &p_static_string, bool p_static) {
@@ -252,57 +423,7 @@ StringName::StringName(const StaticCString &p_static_string, bool p_static) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _intern(String::hash(p_static_string.ptr), p_static_string.ptr, p_static_string.ptr, p_static);
 }
 
 StringName::StringName(const String &p_name, bool p_static) {
@@ -314,56 +435,7 @@ StringName::StringName(const String &p_name, bool p_static) {
 		return;
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = p_name.hash();
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			if (p_static) {
-				_data->static_count.increment();
-			}
-#ifdef DEBUG_ENABLED
-			if (unlikely(debug_stringname)) {
-				_data->debug_references++;
-			}
-#endif
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->static_count.set(p_static ? 1 : 0);
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-#ifdef DEBUG_ENABLED
-	if (unlikely(debug_stringname)) {
-		// Keep in memory, force static.
-		_data->refcount.ref();
-		_data->static_count.increment();
-	}
-#endif
-
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
+	_data = _intern(p_name.hash(), p_name, nullptr, p_static);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -374,32 +446,7 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
-
-		return StringName(_data);
-	}
-
-	return StringName(); //does not exist
+	return _search(String::hash(p_name), p_name);
 }
 
 StringName StringName::search(const char32_t *p_name) {
@@ -410,65 +457,20 @@ StringName StringName::search(const char32_t *p_name) {
 		return StringName();
 	}
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		return StringName(_data);
-	}
-
-	return StringName(); //does not exist
+	return _search(String::hash(p_name), p_name);
 }
 
 StringName StringName::search(const String &p_name) {
 	ERR_FAIL_COND_V(p_name.is_empty(), StringName());
 
-	MutexLock lock(mutex);
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name()) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-#ifdef DEBUG_ENABLED
-		if (unlikely(debug_stringname)) {
-			_data->debug_references++;
-		}
-#endif
-		return StringName(_data);
-	}
-
-	return StringName(); //does not exist
+	return _search(p_name.hash(), p_name);
 }
 
 bool operator==(const String &p_name, const StringName &p_string_name) {
-	return p_name == p_string_name.operator String();
+	return p_string_name == p_name;
 }
 bool operator!=(const String &p_name, const StringName &p_string_name) {
-	return p_name != p_string_name.operator String();
+	return !(p_string_name == p_name);
 }
 
 bool operator==(const char *p_name, const StringName &p_string_name) {
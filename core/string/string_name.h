@@ -44,9 +44,13 @@ struct StaticCString {
 
 class StringName {
 	enum {
-		STRING_TABLE_BITS = 16,
-		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		// Strings are spread over shards by hash, each shard has its own lock and growable bucket array.
+		SHARD_BITS = 6,
+		SHARD_COUNT = 1 << SHARD_BITS,
+		SHARD_MASK = SHARD_COUNT - 1,
+		SHARD_INITIAL_BUCKET_BITS = 8,
+		// Lock-free lookups give up after this many nodes and retry under the shard lock.
+		LOCK_FREE_MAX_STEPS = 64
 	};
 
 	struct _Data {
@@ -58,14 +62,24 @@ class StringName {
 		uint32_t debug_references = 0;
 #endif
 		String get_name() const { return cname ? String(cname) : name; }
-		int idx = 0;
 		uint32_t hash = 0;
 		_Data *prev = nullptr;
-		_Data *next = nullptr;
+		std::atomic<_Data *> next = { nullptr };
 		_Data() {}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	struct _Shard;
+
+	static _Shard *_shards;
+
+	template <class T>
+	static _Data *_find(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_find_locked(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static StringName _search(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_intern(uint32_t p_hash, const T &p_name, const char *p_cname, bool p_static);
 
 	_Data *_data = nullptr;
 
@@ -78,7 +92,6 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 	friend class Main;
-	static Mutex mutex;
 	static void setup();
 	static void cleanup();
 	static bool configured;
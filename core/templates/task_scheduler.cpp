@@ -0,0 +1,392 @@
+/*************************************************************************/
+/*  task_scheduler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "task_scheduler.h"
+
+#include "core/os/os.h"
+
+TaskScheduler *TaskScheduler::singleton = nullptr;
+thread_local TaskScheduler::ThreadData *TaskScheduler::current_thread = nullptr;
+
+void TaskScheduler::TaskDeque::push(Task *p_task) {
+	lock.lock();
+	if (bottom - top == capacity) {
+		uint32_t new_capacity = capacity ? capacity << 1 : 64;
+		Task **new_buffer = (Task **)memalloc(sizeof(Task *) * new_capacity);
+		for (uint32_t i = top; i != bottom; i++) {
+			new_buffer[i & (new_capacity - 1)] = buffer[i & (capacity - 1)];
+		}
+		if (buffer) {
+			memfree(buffer);
+		}
+		buffer = new_buffer;
+		capacity = new_capacity;
+	}
+	buffer[bottom & (capacity - 1)] = p_task;
+	bottom++;
+	size.store(bottom - top, std::memory_order_release);
+	lock.unlock();
+}
+
+TaskScheduler::Task *TaskScheduler::TaskDeque::pop() {
+	if (size.load(std::memory_order_acquire) == 0) {
+		return nullptr;
+	}
+	Task *task = nullptr;
+	lock.lock();
+	if (bottom != top) {
+		bottom--;
+		task = buffer[bottom & (capacity - 1)];
+		size.store(bottom - top, std::memory_order_release);
+	}
+	lock.unlock();
+	return task;
+}
+
+TaskScheduler::Task *TaskScheduler::TaskDeque::steal() {
+	if (size.load(std::memory_order_acquire) == 0) {
+		return nullptr;
+	}
+	Task *task = nullptr;
+	lock.lock();
+	if (bottom != top) {
+		task = buffer[top & (capacity - 1)];
+		top++;
+		size.store(bottom - top, std::memory_order_release);
+	}
+	lock.unlock();
+	return task;
+}
+
+TaskScheduler::TaskDeque::~TaskDeque() {
+	if (buffer) {
+		memfree(buffer);
+	}
+}
+
+void TaskScheduler::_thread_function(void *p_user) {
+	ThreadData *thread = static_cast<ThreadData *>(p_user);
+	TaskScheduler *scheduler = thread->scheduler;
+	current_thread = thread;
+
+	while (true) {
+		Task *task = scheduler->_next_task(thread);
+		if (task) {
+			scheduler->_execute_task(task);
+			continue;
+		}
+#if !defined(NO_THREADS)
+		std::unique_lock<std::mutex> lock(scheduler->sleep_mutex);
+		if (scheduler->exit_threads.load() && scheduler->queued_tasks.load() == 0) {
+			break;
+		}
+		scheduler->sleeping_workers.fetch_add(1);
+		// Checked again after registering as sleeper, so a concurrent push can't be missed.
+		if (scheduler->queued_tasks.load() == 0 && !scheduler->exit_threads.load()) {
+			scheduler->work_condition.wait(lock);
+		}
+		scheduler->sleeping_workers.fetch_sub(1);
+#else
+		break;
+#endif
+	}
+
+	current_thread = nullptr;
+}
+
+TaskScheduler::Task *TaskScheduler::_alloc_task(Group *p_group) {
+	Task *task = task_allocator.alloc();
+	task->group = p_group;
+	for (Group *group = p_group; group; group = group->parent) {
+		group->pending.fetch_add(1, std::memory_order_acq_rel);
+	}
+	return task;
+}
+
+void TaskScheduler::_submit_task(Task *p_task, const TaskID *p_dependencies, uint32_t p_dependency_count) {
+	for (uint32_t i = 0; i < p_dependency_count; i++) {
+		Task *dependency = p_dependencies[i];
+		ERR_CONTINUE(dependency == nullptr);
+		dependency->successor_lock.lock();
+		if (!dependency->completed.load(std::memory_order_acquire)) {
+			p_task->pending_dependencies.fetch_add(1, std::memory_order_acq_rel);
+			dependency->successors.push_back(p_task);
+		}
+		dependency->successor_lock.unlock();
+	}
+
+	// Drop the setup count, the task is ready if no dependency is left.
+	if (p_task->pending_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		_schedule_task(p_task);
+	}
+}
+
+void TaskScheduler::_schedule_task(Task *p_task) {
+	if (thread_count == 0) {
+		// No workers (or threads disabled), just run it right here.
+		_execute_task(p_task);
+		return;
+	}
+
+	ThreadData *thread = current_thread;
+	if (thread && thread->scheduler == this) {
+		thread->deque.push(p_task);
+	} else {
+		injection_queue.push(p_task);
+	}
+	queued_tasks.fetch_add(1);
+	_notify_work();
+}
+
+TaskScheduler::Task *TaskScheduler::_next_task(ThreadData *p_thread) {
+	if (queued_tasks.load(std::memory_order_acquire) == 0) {
+		return nullptr;
+	}
+
+	Task *task = nullptr;
+	if (p_thread) {
+		task = p_thread->deque.pop();
+	}
+	if (!task) {
+		task = injection_queue.steal();
+	}
+	if (!task && thread_count > 0) {
+		uint32_t start = p_thread ? p_thread->index + 1 : 0;
+		for (uint32_t i = 0; i < thread_count; i++) {
+			ThreadData *victim = &threads[(start + i) % thread_count];
+			if (victim == p_thread) {
+				continue;
+			}
+			task = victim->deque.steal();
+			if (task) {
+				break;
+			}
+		}
+	}
+
+	if (task) {
+		queued_tasks.fetch_sub(1);
+	}
+	return task;
+}
+
+void TaskScheduler::_execute_task(Task *p_task) {
+	BaseClosure *closure = reinterpret_cast<BaseClosure *>(p_task->closure);
+	closure->call();
+	closure->~BaseClosure();
+
+	// Nobody can link new successors once completed is set, so the list can be walked unlocked.
+	p_task->successor_lock.lock();
+	p_task->completed.store(true, std::memory_order_release);
+	p_task->successor_lock.unlock();
+
+	for (uint32_t i = 0; i < p_task->successors.size(); i++) {
+		Task *successor = p_task->successors[i];
+		if (successor->pending_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			_schedule_task(successor);
+		}
+	}
+
+	// Children first: a parent can't be waited out (and destroyed) before its children are done.
+	Group *group = p_task->group;
+	while (group) {
+		Group *parent = group->parent;
+		group->pending.fetch_sub(1, std::memory_order_acq_rel);
+		group = parent;
+	}
+
+	_notify_progress();
+	_unref_task(p_task);
+}
+
+void TaskScheduler::_unref_task(Task *p_task) {
+	if (p_task->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		task_allocator.free(p_task);
+	}
+}
+
+void TaskScheduler::_notify_work() {
+#if !defined(NO_THREADS)
+	if (sleeping_workers.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		work_condition.notify_one();
+	}
+	// Blocked waiters can help with the new task too.
+	_notify_progress();
+#endif
+}
+
+void TaskScheduler::_notify_progress() {
+#if !defined(NO_THREADS)
+	// Pairs with the fence in _help_until(): either the waiter sees the progress made
+	// before this call, or this sees the waiter and wakes it up.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (blocked_waiters.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		progress_condition.notify_all();
+	}
+#endif
+}
+
+template <class P>
+void TaskScheduler::_help_until(const P &p_done) {
+	ThreadData *thread = (current_thread && current_thread->scheduler == this) ? current_thread : nullptr;
+
+	while (!p_done()) {
+		Task *task = _next_task(thread);
+		if (task) {
+			_execute_task(task);
+			continue;
+		}
+#if !defined(NO_THREADS)
+		// Nothing to help with, the remaining work is running on other threads.
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		blocked_waiters.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!p_done() && queued_tasks.load() == 0) {
+			progress_condition.wait(lock);
+		}
+		blocked_waiters.fetch_sub(1);
+#endif
+	}
+}
+
+void TaskScheduler::_add_range(BaseRange *p_range, Group *p_group, uint32_t p_max_tasks) {
+	for (uint32_t i = 0; i < p_max_tasks; i++) {
+		Task *task = _alloc_task(p_group);
+		RangeClosure *closure = memnew_placement(task->closure, RangeClosure);
+		closure->range = p_range;
+		// Nobody keeps a handle to range tasks.
+		task->refcount.store(1, std::memory_order_relaxed);
+		_submit_task(task, nullptr, 0);
+	}
+}
+
+int TaskScheduler::get_current_thread_index() const {
+	if (current_thread && current_thread->scheduler == this) {
+		return current_thread->index;
+	}
+	return -1;
+}
+
+bool TaskScheduler::is_task_completed(TaskID p_task) const {
+	ERR_FAIL_COND_V(p_task == nullptr, true);
+	return p_task->completed.load(std::memory_order_acquire);
+}
+
+void TaskScheduler::wait_for_task(TaskID p_task) {
+	ERR_FAIL_COND(p_task == nullptr);
+	_help_until([p_task]() { return p_task->completed.load(std::memory_order_acquire); });
+	_unref_task(p_task);
+}
+
+void TaskScheduler::release_task(TaskID p_task) {
+	ERR_FAIL_COND(p_task == nullptr);
+	_unref_task(p_task);
+}
+
+void TaskScheduler::wait_for_group(Group *p_group) {
+	ERR_FAIL_COND(p_group == nullptr);
+	_help_until([p_group]() { return p_group->is_done(); });
+}
+
+void TaskScheduler::add_range(BaseRange *p_range, Group *p_group, int p_max_threads) {
+	ERR_FAIL_COND(p_range == nullptr);
+	uint32_t max_tasks = p_max_threads < 0 ? thread_count : MIN(thread_count, (uint32_t)p_max_threads);
+	max_tasks = MIN(max_tasks, p_range->elements);
+	if (max_tasks == 0) {
+		p_range->run();
+		return;
+	}
+	_add_range(p_range, p_group, max_tasks);
+}
+
+void TaskScheduler::init(int p_thread_count) {
+	ERR_FAIL_COND(threads != nullptr);
+#if !defined(NO_THREADS)
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_default_thread_pool_size();
+	}
+#else
+	p_thread_count = 0;
+#endif
+	if (p_thread_count == 0) {
+		return;
+	}
+
+	exit_threads.store(false);
+	thread_count = p_thread_count;
+	threads = memnew_arr(ThreadData, thread_count);
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].scheduler = this;
+		threads[i].index = i;
+	}
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].thread.start(&TaskScheduler::_thread_function, &threads[i]);
+	}
+}
+
+void TaskScheduler::finish() {
+	if (threads == nullptr) {
+		return;
+	}
+
+	exit_threads.store(true);
+#if !defined(NO_THREADS)
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		work_condition.notify_all();
+	}
+#endif
+	for (uint32_t i = 0; i < thread_count; i++) {
+		threads[i].thread.wait_to_finish();
+	}
+
+	// Anything still queued (tasks nobody waited for) runs here.
+	while (Task *task = _next_task(nullptr)) {
+		_execute_task(task);
+	}
+
+	memdelete_arr(threads);
+	threads = nullptr;
+	thread_count = 0;
+}
+
+TaskScheduler::TaskScheduler() {
+	singleton = this;
+}
+
+TaskScheduler::~TaskScheduler() {
+	finish();
+	if (singleton == this) {
+		singleton = nullptr;
+	}
+}
@@ -0,0 +1,281 @@
+/*************************************************************************/
+/*  task_scheduler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include "core/os/memory.h"
+#include "core/os/spin_lock.h"
+#include "core/os/thread.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/paged_allocator.h"
+
+#include <atomic>
+
+#if !defined(NO_THREADS)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+// Engine-wide work-stealing task scheduler.
+//
+// Every worker thread owns a deque of ready tasks. Tasks pushed from a worker go to
+// the bottom of its own deque and are popped LIFO (good locality for fork/join),
+// idle workers steal FIFO from the top of other deques. Tasks pushed from threads
+// outside the pool go to a shared injection queue.
+//
+// Tasks may belong to a Group (groups nest through their parent) and may depend on
+// other tasks. Waiting for a group or a task never blocks a core while there is work
+// left: the waiting thread keeps executing ready tasks until the condition is met.
+
+class TaskScheduler {
+public:
+	struct Group {
+		std::atomic<uint32_t> pending = { 0 };
+		Group *parent = nullptr;
+
+		_FORCE_INLINE_ bool is_done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+		Group(Group *p_parent = nullptr) :
+				parent(p_parent) {}
+	};
+
+private:
+	struct BaseClosure {
+		virtual void call() = 0;
+		virtual ~BaseClosure() {}
+	};
+
+	template <class C, class M, class U>
+	struct MethodClosure : public BaseClosure {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void call() override {
+			(instance->*method)(userdata);
+		}
+	};
+
+public:
+	struct BaseRange {
+		std::atomic<uint32_t> index = { 0 };
+		uint32_t elements = 0;
+		virtual void process(uint32_t p_index) = 0;
+		virtual ~BaseRange() {}
+
+		void run() {
+			while (true) {
+				uint32_t work_index = index.fetch_add(1, std::memory_order_relaxed);
+				if (work_index >= elements) {
+					break;
+				}
+				process(work_index);
+			}
+		}
+	};
+
+	template <class C, class M, class U>
+	struct Range : public BaseRange {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void process(uint32_t p_index) override {
+			(instance->*method)(p_index, userdata);
+		}
+	};
+
+	struct Task {
+		enum {
+			CLOSURE_SIZE = 64
+		};
+
+		alignas(16) uint8_t closure[CLOSURE_SIZE];
+		Group *group = nullptr;
+		// One extra count is held while the task is being set up, so it can't be scheduled
+		// before all its dependencies are linked.
+		std::atomic<uint32_t> pending_dependencies = { 1 };
+		// One reference for the scheduler, one for the TaskID handed to the user.
+		std::atomic<uint32_t> refcount = { 2 };
+		std::atomic<bool> completed = { false };
+		SpinLock successor_lock;
+		LocalVector<Task *> successors;
+	};
+
+	typedef Task *TaskID;
+
+private:
+	struct RangeClosure : public BaseClosure {
+		BaseRange *range = nullptr;
+		virtual void call() override {
+			range->run();
+		}
+	};
+
+	struct TaskDeque {
+		SpinLock lock;
+		Task **buffer = nullptr;
+		uint32_t capacity = 0; // Always a power of 2.
+		uint32_t top = 0; // Steal end.
+		uint32_t bottom = 0; // Owner end.
+		std::atomic<uint32_t> size = { 0 }; // Lets thieves skip empty deques without locking.
+
+		void push(Task *p_task);
+		Task *pop();
+		Task *steal();
+
+		~TaskDeque();
+	};
+
+	struct ThreadData {
+		TaskScheduler *scheduler = nullptr;
+		uint32_t index = 0;
+		Thread thread;
+		TaskDeque deque;
+	};
+
+	static TaskScheduler *singleton;
+	static thread_local ThreadData *current_thread;
+
+	ThreadData *threads = nullptr;
+	uint32_t thread_count = 0;
+	TaskDeque injection_queue;
+
+	PagedAllocator<Task, true> task_allocator;
+
+	std::atomic<uint32_t> queued_tasks = { 0 };
+	std::atomic<bool> exit_threads = { false };
+
+#if !defined(NO_THREADS)
+	std::mutex sleep_mutex;
+	std::condition_variable work_condition; // Idle workers wait here for new tasks.
+	std::condition_variable progress_condition; // Blocked waiters wait here for completions.
+	std::atomic<uint32_t> sleeping_workers = { 0 };
+	std::atomic<uint32_t> blocked_waiters = { 0 };
+#endif
+
+	static void _thread_function(void *p_user);
+
+	Task *_alloc_task(Group *p_group);
+	void _submit_task(Task *p_task, const TaskID *p_dependencies, uint32_t p_dependency_count);
+	void _schedule_task(Task *p_task);
+	Task *_next_task(ThreadData *p_thread);
+	void _execute_task(Task *p_task);
+	void _unref_task(Task *p_task);
+	void _notify_work();
+	void _notify_progress();
+
+	template <class P>
+	void _help_until(const P &p_done);
+
+	void _add_range(BaseRange *p_range, Group *p_group, uint32_t p_max_tasks);
+
+public:
+	_FORCE_INLINE_ static TaskScheduler *get_singleton() { return singleton; }
+
+	// Number of worker threads (the calling thread also helps when it waits).
+	_FORCE_INLINE_ uint32_t get_thread_count() const { return thread_count; }
+	// Index of the calling worker in [0, get_thread_count()), or -1 if it is not a worker of this scheduler.
+	int get_current_thread_index() const;
+
+	// Adds `(p_instance->*p_method)(p_userdata)` as a task. It will run once all the tasks in
+	// `p_dependencies` have completed. The returned ID must be passed to either wait_for_task()
+	// or release_task(), and stays valid until then.
+	template <class C, class M, class U>
+	TaskID add_task(C *p_instance, M p_method, U p_userdata, Group *p_group = nullptr, const TaskID *p_dependencies = nullptr, uint32_t p_dependency_count = 0) {
+		static_assert(sizeof(MethodClosure<C, M, U>) <= Task::CLOSURE_SIZE && alignof(MethodClosure<C, M, U>) <= 16, "Task userdata is too large, pass a pointer instead.");
+		Task *task = _alloc_task(p_group);
+		MethodClosure<C, M, U> *closure = memnew_placement(task->closure, (MethodClosure<C, M, U>));
+		closure->instance = p_instance;
+		closure->method = p_method;
+		closure->userdata = p_userdata;
+		_submit_task(task, p_dependencies, p_dependency_count);
+		return task;
+	}
+
+	bool is_task_completed(TaskID p_task) const;
+	// Helps running tasks until `p_task` is completed, then releases it.
+	void wait_for_task(TaskID p_task);
+	// Gives up the handle without waiting. The task still runs.
+	void release_task(TaskID p_task);
+
+	// Helps running tasks until every task in the group (and its nested groups) has completed.
+	void wait_for_group(Group *p_group);
+
+	// Calls `(p_instance->*p_method)(i, p_userdata)` for every i in [0, p_elements), using at most
+	// `p_max_threads` threads (including the calling one, -1 means all). Blocks until done, and can
+	// be called from inside tasks.
+	template <class C, class M, class U>
+	void parallel_for(uint32_t p_elements, C *p_instance, M p_method, U p_userdata, int p_max_threads = -1) {
+		if (p_elements == 0) {
+			return;
+		}
+		Range<C, M, U> range;
+		range.instance = p_instance;
+		range.method = p_method;
+		range.userdata = p_userdata;
+		range.elements = p_elements;
+
+		Group group;
+		uint32_t max_tasks = p_max_threads < 0 ? thread_count : MIN(thread_count, (uint32_t)MAX(p_max_threads - 1, 0));
+		_add_range(&range, &group, MIN(p_elements - 1, max_tasks));
+		range.run();
+		wait_for_group(&group);
+	}
+
+	// Non-blocking version of parallel_for(). `p_range` must stay alive until `p_group` is waited for.
+	void add_range(BaseRange *p_range, Group *p_group, int p_max_threads = -1);
+
+	template <class C, class M, class U>
+	static Range<C, M, U> *create_range(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		Range<C, M, U> *range = memnew((Range<C, M, U>));
+		range->instance = p_instance;
+		range->method = p_method;
+		range->userdata = p_userdata;
+		range->elements = p_elements;
+		return range;
+	}
+
+	static uint32_t get_range_index(const BaseRange *p_range) {
+		uint32_t idx = p_range->index.load(std::memory_order_acquire);
+		return MIN(idx, p_range->elements);
+	}
+
+	static void free_range(BaseRange *p_range) {
+		memdelete(p_range);
+	}
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	TaskScheduler();
+	~TaskScheduler();
+};
+
+#endif // TASK_SCHEDULER_H
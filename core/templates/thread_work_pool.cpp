@@ -32,48 +32,30 @@
 
 #include "core/os/os.h"
 
-void ThreadWorkPool::_thread_function(void *p_user) {
-	ThreadData *thread = static_cast<ThreadData *>(p_user);
-	while (true) {
-		thread->start.wait();
-		if (thread->exit.load()) {
-			break;
-		}
-		thread->work->work();
-		thread->completed.post();
-	}
-}
-
 void ThreadWorkPool::init(int p_thread_count) {
-	ERR_FAIL_COND(threads != nullptr);
+	ERR_FAIL_COND(thread_count != 0);
 	if (p_thread_count < 0) {
-		p_thread_count = OS::get_singleton()->get_default_thread_pool_size();
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		if (scheduler && scheduler->get_thread_count() > 0) {
+			p_thread_count = scheduler->get_thread_count();
+		} else {
+			p_thread_count = OS::get_singleton()->get_default_thread_pool_size();
+		}
 	}
 
-	thread_count = p_thread_count;
-	threads = memnew_arr(ThreadData, thread_count);
-
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(false);
-		threads[i].thread.start(&ThreadWorkPool::_thread_function, &threads[i]);
-	}
+	// Callers split their work by this number, so it must never be zero.
+	thread_count = MAX(p_thread_count, 1);
 }
 
 void ThreadWorkPool::finish() {
-	if (threads == nullptr) {
+	if (thread_count == 0) {
 		return;
 	}
 
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(true);
-		threads[i].start.post();
+	if (current_work != nullptr) {
+		end_work();
 	}
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].thread.wait_to_finish();
-	}
-
-	memdelete_arr(threads);
-	threads = nullptr;
+	thread_count = 0;
 }
 
 ThreadWorkPool::~ThreadWorkPool() {
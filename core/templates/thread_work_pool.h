@@ -32,74 +32,30 @@
 #define THREAD_WORK_POOL_H
 
 #include "core/os/memory.h"
-#include "core/os/semaphore.h"
-#include "core/os/thread.h"
+#include "core/templates/task_scheduler.h"
 
-#include <atomic>
+// Thin front-end over the engine-wide TaskScheduler. It owns no threads, so pools
+// created by different subsystems share the same cores instead of oversubscribing them.
+// get_thread_count() is only a concurrency cap (and a hint for splitting work).
 
 class ThreadWorkPool {
-	std::atomic<uint32_t> index;
-
-	struct BaseWork {
-		std::atomic<uint32_t> *index = nullptr;
-		uint32_t max_elements = 0;
-		virtual void work() = 0;
-		virtual ~BaseWork() = default;
-	};
-
-	template <class C, class M, class U>
-	struct Work : public BaseWork {
-		C *instance;
-		M method;
-		U userdata;
-		virtual void work() {
-			while (true) {
-				uint32_t work_index = index->fetch_add(1, std::memory_order_relaxed);
-				if (work_index >= max_elements) {
-					break;
-				}
-				(instance->*method)(work_index, userdata);
-			}
-		}
-	};
-
-	struct ThreadData {
-		Thread thread;
-		Semaphore start;
-		Semaphore completed;
-		std::atomic<bool> exit;
-		BaseWork *work;
-	};
-
-	ThreadData *threads = nullptr;
 	uint32_t thread_count = 0;
-	uint32_t threads_working = 0;
-	BaseWork *current_work = nullptr;
-
-	static void _thread_function(void *p_user);
+	TaskScheduler::BaseRange *current_work = nullptr;
+	TaskScheduler::Group work_group;
 
 public:
 	template <class C, class M, class U>
 	void begin_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-		ERR_FAIL_COND(!threads); //never initialized
+		ERR_FAIL_COND(thread_count == 0); //never initialized
 		ERR_FAIL_COND(current_work != nullptr);
 
-		index.store(0, std::memory_order_release);
-
-		Work<C, M, U> *w = memnew((Work<C, M, U>));
-		w->instance = p_instance;
-		w->userdata = p_userdata;
-		w->method = p_method;
-		w->index = &index;
-		w->max_elements = p_elements;
+		current_work = TaskScheduler::create_range(p_elements, p_instance, p_method, p_userdata);
 
-		current_work = w;
-
-		threads_working = MIN(p_elements, thread_count);
-
-		for (uint32_t i = 0; i < threads_working; i++) {
-			threads[i].work = w;
-			threads[i].start.post();
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		if (scheduler) {
+			scheduler->add_range(current_work, &work_group, thread_count);
+		} else {
+			current_work->run();
 		}
 	}
 
@@ -109,27 +65,26 @@ public:
 
 	bool is_done_dispatching() const {
 		ERR_FAIL_COND_V(current_work == nullptr, true);
-		return index.load(std::memory_order_acquire) >= current_work->max_elements;
+		return current_work->index.load(std::memory_order_acquire) >= current_work->elements;
 	}
 
 	uint32_t get_work_index() const {
 		ERR_FAIL_COND_V(current_work == nullptr, 0);
-		uint32_t idx = index.load(std::memory_order_acquire);
-		return MIN(idx, current_work->max_elements);
+		return TaskScheduler::get_range_index(current_work);
 	}
 
 	void end_work() {
 		ERR_FAIL_COND(current_work == nullptr);
-		for (uint32_t i = 0; i < threads_working; i++) {
-			threads[i].completed.wait();
-			threads[i].work = nullptr;
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		if (scheduler) {
+			scheduler->wait_for_group(&work_group);
 		}
 
-		threads_working = 0;
-		memdelete(current_work);
+		TaskScheduler::free_range(current_work);
 		current_work = nullptr;
 	}
 
+	// Unlike begin_work()/end_work(), this can be called concurrently and from inside other work.
 	template <class C, class M, class U>
 	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
 		switch (p_elements) {
@@ -141,10 +96,17 @@ public:
 				// and we're going to wait for it to finish. Just run it right here.
 				(p_instance->*p_method)(0, p_userdata);
 				break;
-			default:
+			default: {
 				// Multiple jobs to do; commence threaded business.
-				begin_work(p_elements, p_instance, p_method, p_userdata);
-				end_work();
+				TaskScheduler *scheduler = TaskScheduler::get_singleton();
+				if (scheduler) {
+					scheduler->parallel_for(p_elements, p_instance, p_method, p_userdata, thread_count + 1); // The calling thread helps too.
+				} else {
+					for (uint32_t i = 0; i < p_elements; i++) {
+						(p_instance->*p_method)(i, p_userdata);
+					}
+				}
+			} break;
 		}
 	}
 
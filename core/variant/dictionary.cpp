@@ -30,7 +30,6 @@
 
 #include "dictionary.h"
 
-#include "core/templates/ordered_hash_map.h"
 #include "core/templates/safe_refcount.h"
 #include "core/variant/variant.h"
 // required in this order by VariantInternal, do not remove this comment.
@@ -39,108 +38,502 @@
 #include "core/variant/type_info.h"
 #include "core/variant/variant_internal.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DICTIONARY_SSE2
+#endif
+
+// Entries are allocated from pages that double in size, so they never move while their key is
+// in the dictionary and pointers from getptr() stay valid until that key is erased. Erased entries
+// are reused by later insertions. The insertion order is kept in a dense array of entry pointers,
+// which is compacted once more than half of it are holes left by erased keys. Once there are more
+// than SMALL_SIZE entries, an open addressed index of entry pointers is built next to it. Each index
+// slot has one control byte (empty, deleted or 7 bits of the hash), and a probe compares a whole
+// group of control bytes at once.
 struct DictionaryPrivate {
+	enum {
+		SMALL_SIZE = 8,
+		FIRST_PAGE_SHIFT = 3,
+		FIRST_PAGE_SIZE = 1 << FIRST_PAGE_SHIFT,
+#ifdef DICTIONARY_SSE2
+		GROUP_WIDTH = 16,
+#else
+		GROUP_WIDTH = 8,
+#endif
+		CTRL_EMPTY = 0x80,
+		CTRL_DELETED = 0xFE,
+		NO_ENTRY = 0xFFFFFFFF,
+	};
+
+	struct Entry {
+		Variant key;
+		Variant value;
+		uint32_t hash = 0;
+		uint32_t index = 0; // Position in the order array, or the next free entry once erased.
+		uint32_t storage = 0; // Position in the pages.
+	};
+
 	SafeRefCount refcount;
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> variant_map;
+
+	Entry **pages = nullptr;
+	uint32_t page_count = 0;
+	uint32_t storage_count = 0; // Entries taken from the pages, including free ones.
+	uint32_t free_entry = NO_ENTRY;
+
+	Entry **order = nullptr;
+	uint32_t order_capacity = 0;
+	uint32_t entry_count = 0; // Including the holes of erased entries.
+	uint32_t erased_count = 0;
+
+	uint8_t *ctrl = nullptr;
+	Entry **slots = nullptr;
+	uint32_t capacity = 0;
+	uint32_t index_used = 0; // Full and deleted slots.
+
+	static _FORCE_INLINE_ uint32_t page_start(uint32_t p_page) {
+		return p_page ? FIRST_PAGE_SIZE << (p_page - 1) : 0;
+	}
+
+	static _FORCE_INLINE_ uint32_t page_size(uint32_t p_page) {
+		return p_page ? FIRST_PAGE_SIZE << (p_page - 1) : FIRST_PAGE_SIZE;
+	}
+
+	static _FORCE_INLINE_ uint32_t page_of(uint32_t p_index) {
+		if (p_index < FIRST_PAGE_SIZE) {
+			return 0;
+		}
+#if defined(__GNUC__)
+		return 32 - __builtin_clz(p_index >> FIRST_PAGE_SHIFT);
+#else
+		return nearest_shift(p_index >> FIRST_PAGE_SHIFT);
+#endif
+	}
+
+	_FORCE_INLINE_ Entry *storage_at(uint32_t p_storage) const {
+		uint32_t page = page_of(p_storage);
+		return &pages[page][p_storage - page_start(page)];
+	}
+
+	static _FORCE_INLINE_ uint8_t hash_tag(uint32_t p_hash) {
+		return p_hash >> 25;
+	}
+
+	static _FORCE_INLINE_ uint32_t lowest_bit(uint64_t p_mask) {
+#if defined(__GNUC__)
+		return __builtin_ctzll(p_mask);
+#else
+		uint32_t bit = 0;
+		while (!(p_mask & 1)) {
+			p_mask >>= 1;
+			bit++;
+		}
+		return bit;
+#endif
+	}
+
+	// Group matching, the returned masks have one bit per slot at (slot << GROUP_SHIFT).
+#ifdef DICTIONARY_SSE2
+	enum {
+		GROUP_SHIFT = 0
+	};
+
+	static _FORCE_INLINE_ uint64_t group_match(const uint8_t *p_group, uint8_t p_tag) {
+		__m128i group = _mm_loadu_si128((const __m128i *)p_group);
+		return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)p_tag)));
+	}
+
+	static _FORCE_INLINE_ uint64_t group_match_empty(const uint8_t *p_group) {
+		return group_match(p_group, CTRL_EMPTY);
+	}
+
+	static _FORCE_INLINE_ uint64_t group_match_free(const uint8_t *p_group) {
+		// Empty and deleted are the only control bytes with the high bit set.
+		return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)p_group));
+	}
+#else
+	enum {
+		GROUP_SHIFT = 3
+	};
+
+	static _FORCE_INLINE_ uint64_t group_load(const uint8_t *p_group) {
+		uint64_t group;
+		memcpy(&group, p_group, sizeof(group));
+#ifdef BIG_ENDIAN_ENABLED
+		group = BSWAP64(group);
+#endif
+		return group;
+	}
+
+	// May report false positives, which the hash and key comparison rejects.
+	static _FORCE_INLINE_ uint64_t group_match(const uint8_t *p_group, uint8_t p_tag) {
+		const uint64_t lsbs = 0x0101010101010101ULL;
+		uint64_t x = group_load(p_group) ^ (lsbs * p_tag);
+		return (x - lsbs) & ~x & (lsbs << 7);
+	}
+
+	static _FORCE_INLINE_ uint64_t group_match_empty(const uint8_t *p_group) {
+		uint64_t group = group_load(p_group);
+		return group & ~(group << 6) & 0x8080808080808080ULL;
+	}
+
+	static _FORCE_INLINE_ uint64_t group_match_free(const uint8_t *p_group) {
+		return group_load(p_group) & 0x8080808080808080ULL;
+	}
+#endif
+
+	template <class Match>
+	Entry *find(uint32_t p_hash, const Match &p_match) const {
+		if (!capacity) {
+			for (uint32_t i = 0; i < entry_count; i++) {
+				Entry *e = order[i];
+				if (e && e->hash == p_hash && p_match(e->key)) {
+					return e;
+				}
+			}
+			return nullptr;
+		}
+
+		const uint32_t group_mask = capacity / GROUP_WIDTH - 1;
+		const uint8_t tag = hash_tag(p_hash);
+		uint32_t group = p_hash & group_mask;
+		for (uint32_t step = 1;; step++) {
+			const uint32_t base = group * GROUP_WIDTH;
+			for (uint64_t m = group_match(&ctrl[base], tag); m; m &= m - 1) {
+				Entry *e = slots[base + (lowest_bit(m) >> GROUP_SHIFT)];
+				if (e->hash == p_hash && p_match(e->key)) {
+					return e;
+				}
+			}
+			if (group_match_empty(&ctrl[base]) || step > group_mask) {
+				return nullptr;
+			}
+			group = (group + step) & group_mask;
+		}
+	}
+
+	void index_insert(Entry *p_entry) {
+		const uint32_t group_mask = capacity / GROUP_WIDTH - 1;
+		uint32_t group = p_entry->hash & group_mask;
+		for (uint32_t step = 1;; step++) {
+			const uint32_t base = group * GROUP_WIDTH;
+			uint64_t m = group_match_free(&ctrl[base]);
+			if (m) {
+				uint32_t slot = base + (lowest_bit(m) >> GROUP_SHIFT);
+				if (ctrl[slot] == CTRL_EMPTY) {
+					index_used++;
+				}
+				ctrl[slot] = hash_tag(p_entry->hash);
+				slots[slot] = p_entry;
+				return;
+			}
+			group = (group + step) & group_mask;
+		}
+	}
+
+	void index_erase(Entry *p_entry) {
+		const uint32_t group_mask = capacity / GROUP_WIDTH - 1;
+		uint32_t group = p_entry->hash & group_mask;
+		for (uint32_t step = 1; step <= group_mask + 1; step++) {
+			const uint32_t base = group * GROUP_WIDTH;
+			for (uint64_t m = group_match(&ctrl[base], hash_tag(p_entry->hash)); m; m &= m - 1) {
+				uint32_t slot = base + (lowest_bit(m) >> GROUP_SHIFT);
+				if (slots[slot] == p_entry) {
+					ctrl[slot] = CTRL_DELETED;
+					slots[slot] = nullptr;
+					return;
+				}
+			}
+			group = (group + step) & group_mask;
+		}
+		ERR_FAIL_MSG("Dictionary entry missing from its index.");
+	}
+
+	void free_index() {
+		if (ctrl) {
+			memfree(ctrl);
+			memfree(slots);
+		}
+		ctrl = nullptr;
+		slots = nullptr;
+		capacity = 0;
+		index_used = 0;
+	}
+
+	void rebuild_index() {
+		free_index();
+		const uint32_t live = entry_count - erased_count;
+		if (live <= SMALL_SIZE) {
+			return;
+		}
+
+		uint32_t new_capacity = GROUP_WIDTH;
+		while (new_capacity * 7 / 16 < live + 1) {
+			new_capacity <<= 1;
+		}
+		capacity = new_capacity;
+		ctrl = (uint8_t *)memalloc(capacity);
+		memset(ctrl, CTRL_EMPTY, capacity);
+		slots = (Entry **)memalloc(sizeof(Entry *) * capacity);
+
+		for (uint32_t i = 0; i < entry_count; i++) {
+			if (order[i]) {
+				index_insert(order[i]);
+			}
+		}
+	}
+
+	Entry *allocate_entry() {
+		if (free_entry != NO_ENTRY) {
+			Entry *e = storage_at(free_entry);
+			free_entry = e->index;
+			return e;
+		}
+
+		uint32_t page = page_of(storage_count);
+		if (page == page_count) {
+			pages = (Entry **)memrealloc(pages, sizeof(Entry *) * (page_count + 1));
+			pages[page] = (Entry *)memalloc(sizeof(Entry) * page_size(page));
+			page_count++;
+		}
+		Entry *e = memnew_placement(&pages[page][storage_count - page_start(page)], Entry);
+		e->storage = storage_count;
+		storage_count++;
+		return e;
+	}
+
+	Entry *insert(uint32_t p_hash, const Variant &p_key) {
+		if (entry_count == order_capacity) {
+			order_capacity = order_capacity ? order_capacity * 2 : FIRST_PAGE_SIZE;
+			order = (Entry **)memrealloc(order, sizeof(Entry *) * order_capacity);
+		}
+
+		Entry *e = allocate_entry();
+		e->key = p_key;
+		e->hash = p_hash;
+		e->index = entry_count;
+		order[entry_count] = e;
+		entry_count++;
+
+		if (capacity) {
+			if ((index_used + 1) * 8 > capacity * 7) {
+				rebuild_index();
+			} else {
+				index_insert(e);
+			}
+		} else if (entry_count - erased_count > SMALL_SIZE) {
+			rebuild_index();
+		}
+		return e;
+	}
+
+	void compact_order() {
+		uint32_t live = 0;
+		for (uint32_t i = 0; i < entry_count; i++) {
+			if (order[i]) {
+				order[i]->index = live;
+				order[live++] = order[i];
+			}
+		}
+		entry_count = live;
+		erased_count = 0;
+	}
+
+	void erase(Entry *p_entry) {
+		if (capacity) {
+			index_erase(p_entry);
+		}
+		order[p_entry->index] = nullptr;
+		erased_count++;
+
+		p_entry->key = Variant();
+		p_entry->value = Variant();
+		p_entry->index = free_entry;
+		free_entry = p_entry->storage;
+
+		if (erased_count == entry_count) {
+			clear();
+			return;
+		}
+
+		while (!order[entry_count - 1]) {
+			entry_count--;
+			erased_count--;
+		}
+		// Only the order array is compacted, the entries themselves don't move.
+		if (erased_count > entry_count / 2) {
+			compact_order();
+		}
+	}
+
+	Entry *next_entry(uint32_t p_index) const {
+		for (uint32_t i = p_index; i < entry_count; i++) {
+			if (order[i]) {
+				return order[i];
+			}
+		}
+		return nullptr;
+	}
+
+	Entry *entry_at_live_index(uint32_t p_index) const {
+		if (!erased_count) {
+			return p_index < entry_count ? order[p_index] : nullptr;
+		}
+		uint32_t live = 0;
+		for (Entry *e = next_entry(0); e; e = next_entry(e->index + 1)) {
+			if (live == p_index) {
+				return e;
+			}
+			live++;
+		}
+		return nullptr;
+	}
+
+	void clear() {
+		for (uint32_t i = 0; i < storage_count; i++) {
+			storage_at(i)->~Entry();
+		}
+		for (uint32_t i = 0; i < page_count; i++) {
+			memfree(pages[i]);
+		}
+		if (pages) {
+			memfree(pages);
+		}
+		if (order) {
+			memfree(order);
+		}
+		pages = nullptr;
+		page_count = 0;
+		storage_count = 0;
+		free_entry = NO_ENTRY;
+		order = nullptr;
+		order_capacity = 0;
+		entry_count = 0;
+		erased_count = 0;
+		free_index();
+	}
+
+	~DictionaryPrivate() {
+		clear();
+	}
 };
 
-void Dictionary::get_key_list(List<Variant> *p_keys) const {
-	if (_p->variant_map.is_empty()) {
-		return;
+struct DictionaryVariantMatch {
+	const Variant &key;
+	_FORCE_INLINE_ bool operator()(const Variant &p_other) const { return p_other.hash_compare(key); }
+};
+
+// String keys, and StringName keys which are stored as String, skip the Variant hash and compare dispatch.
+struct DictionaryStringMatch {
+	const String &key;
+	_FORCE_INLINE_ bool operator()(const Variant &p_other) const {
+		return p_other.get_type() == Variant::STRING && *VariantInternal::get_string(&p_other) == key;
 	}
+};
 
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		p_keys->push_back(E.key());
+struct DictionaryStringNameMatch {
+	const StringName &key;
+	_FORCE_INLINE_ bool operator()(const Variant &p_other) const {
+		return p_other.get_type() == Variant::STRING && key == *VariantInternal::get_string(&p_other);
 	}
+};
+
+// Interned names cache String::hash() of their characters, only the empty name has nowhere to keep it.
+static _FORCE_INLINE_ uint32_t _string_name_key_hash(const StringName &p_name) {
+	return p_name ? p_name.hash() : String::hash("");
 }
 
-Variant Dictionary::get_key_at_index(int p_index) const {
-	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		if (index == p_index) {
-			return E.key();
+static _FORCE_INLINE_ DictionaryPrivate::Entry *_find_entry(const DictionaryPrivate *p_dict, const Variant &p_key, uint32_t &r_hash) {
+	switch (p_key.get_type()) {
+		case Variant::STRING_NAME: {
+			const StringName *name = VariantInternal::get_string_name(&p_key);
+			r_hash = _string_name_key_hash(*name);
+			return p_dict->find(r_hash, DictionaryStringNameMatch{ *name });
+		}
+		case Variant::STRING: {
+			const String *str = VariantInternal::get_string(&p_key);
+			r_hash = str->hash();
+			return p_dict->find(r_hash, DictionaryStringMatch{ *str });
+		}
+		default: {
+			r_hash = p_key.hash();
+			return p_dict->find(r_hash, DictionaryVariantMatch{ p_key });
+		}
+	}
+}
+
+static _FORCE_INLINE_ DictionaryPrivate::Entry *_find_entry(const DictionaryPrivate *p_dict, const Variant &p_key) {
+	uint32_t hash;
+	return _find_entry(p_dict, p_key, hash);
+}
+
+static DictionaryPrivate::Entry *_find_or_insert_entry(DictionaryPrivate *p_dict, const Variant &p_key) {
+	uint32_t hash;
+	DictionaryPrivate::Entry *e = _find_entry(p_dict, p_key, hash);
+	if (!e) {
+		if (p_key.get_type() == Variant::STRING_NAME) {
+			// Stored as String, so both forms of a key are the same key.
+			e = p_dict->insert(hash, String(*VariantInternal::get_string_name(&p_key)));
+		} else {
+			e = p_dict->insert(hash, p_key);
 		}
-		index++;
+	}
+	return e;
+}
+
+void Dictionary::get_key_list(List<Variant> *p_keys) const {
+	for (DictionaryPrivate::Entry *E = _p->next_entry(0); E; E = _p->next_entry(E->index + 1)) {
+		p_keys->push_back(E->key);
+	}
+}
+
+Variant Dictionary::get_key_at_index(int p_index) const {
+	DictionaryPrivate::Entry *E = p_index >= 0 ? _p->entry_at_live_index(p_index) : nullptr;
+	if (E) {
+		return E->key;
 	}
 
 	return Variant();
 }
 
 Variant Dictionary::get_value_at_index(int p_index) const {
-	int index = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		if (index == p_index) {
-			return E.value();
-		}
-		index++;
+	DictionaryPrivate::Entry *E = p_index >= 0 ? _p->entry_at_live_index(p_index) : nullptr;
+	if (E) {
+		return E->value;
 	}
 
 	return Variant();
 }
 
 Variant &Dictionary::operator[](const Variant &p_key) {
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		return _p->variant_map[sn->operator String()];
-	} else {
-		return _p->variant_map[p_key];
-	}
+	return _find_or_insert_entry(_p, p_key)->value;
 }
 
 const Variant &Dictionary::operator[](const Variant &p_key) const {
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		return _p->variant_map[sn->operator String()];
-	} else {
-		return _p->variant_map[p_key];
-	}
+	return _find_or_insert_entry(_p, p_key)->value;
 }
 
 const Variant *Dictionary::getptr(const Variant &p_key) const {
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E;
-
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(sn->operator String());
-	} else {
-		E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
-	}
-
+	DictionaryPrivate::Entry *E = _find_entry(_p, p_key);
 	if (!E) {
 		return nullptr;
 	}
-	return &E.get();
+	return &E->value;
 }
 
 Variant *Dictionary::getptr(const Variant &p_key) {
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E;
-
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		E = ((OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(sn->operator String());
-	} else {
-		E = ((OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
-	}
+	DictionaryPrivate::Entry *E = _find_entry(_p, p_key);
 	if (!E) {
 		return nullptr;
 	}
-	return &E.get();
+	return &E->value;
 }
 
 Variant Dictionary::get_valid(const Variant &p_key) const {
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement E;
-
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(sn->operator String());
-	} else {
-		E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->find(p_key);
-	}
-
+	DictionaryPrivate::Entry *E = _find_entry(_p, p_key);
 	if (!E) {
 		return Variant();
 	}
-	return E.get();
+	return E->value;
 }
 
 Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
@@ -153,20 +546,15 @@ Variant Dictionary::get(const Variant &p_key, const Variant &p_default) const {
 }
 
 int Dictionary::size() const {
-	return _p->variant_map.size();
+	return _p->entry_count - _p->erased_count;
 }
 
 bool Dictionary::is_empty() const {
-	return !_p->variant_map.size();
+	return _p->entry_count == _p->erased_count;
 }
 
 bool Dictionary::has(const Variant &p_key) const {
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		return _p->variant_map.has(sn->operator String());
-	} else {
-		return _p->variant_map.has(p_key);
-	}
+	return _find_entry(_p, p_key) != nullptr;
 }
 
 bool Dictionary::has_all(const Array &p_keys) const {
@@ -179,12 +567,12 @@ bool Dictionary::has_all(const Array &p_keys) const {
 }
 
 bool Dictionary::erase(const Variant &p_key) {
-	if (p_key.get_type() == Variant::STRING_NAME) {
-		const StringName *sn = VariantInternal::get_string_name(&p_key);
-		return _p->variant_map.erase(sn->operator String());
-	} else {
-		return _p->variant_map.erase(p_key);
+	DictionaryPrivate::Entry *E = _find_entry(_p, p_key);
+	if (!E) {
+		return false;
 	}
+	_p->erase(E);
+	return true;
 }
 
 bool Dictionary::operator==(const Dictionary &p_dictionary) const {
@@ -200,7 +588,7 @@ bool Dictionary::recursive_equal(const Dictionary &p_dictionary, int recursion_c
 	if (_p == p_dictionary._p) {
 		return true;
 	}
-	if (_p->variant_map.size() != p_dictionary._p->variant_map.size()) {
+	if (size() != p_dictionary.size()) {
 		return false;
 	}
 
@@ -210,9 +598,10 @@ bool Dictionary::recursive_equal(const Dictionary &p_dictionary, int recursion_c
 		return true;
 	}
 	recursion_count++;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement this_E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&_p->variant_map)->front(); this_E; this_E = this_E.next()) {
-		OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::ConstElement other_E = ((const OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator> *)&p_dictionary._p->variant_map)->find(this_E.key());
-		if (!other_E || !this_E.value().hash_compare(other_E.value(), recursion_count)) {
+	for (DictionaryPrivate::Entry *this_E = _p->next_entry(0); this_E; this_E = _p->next_entry(this_E->index + 1)) {
+		// Stored keys are never StringNames, the cached hash can be reused.
+		DictionaryPrivate::Entry *other_E = p_dictionary._p->find(this_E->hash, DictionaryVariantMatch{ this_E->key });
+		if (!other_E || !this_E->value.hash_compare(other_E->value, recursion_count)) {
 			return false;
 		}
 	}
@@ -237,7 +626,7 @@ void Dictionary::_ref(const Dictionary &p_from) const {
 }
 
 void Dictionary::clear() {
-	_p->variant_map.clear();
+	_p->clear();
 }
 
 void Dictionary::_unref() const {
@@ -261,9 +650,9 @@ uint32_t Dictionary::recursive_hash(int recursion_count) const {
 	uint32_t h = hash_djb2_one_32(Variant::DICTIONARY);
 
 	recursion_count++;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		h = hash_djb2_one_32(E.key().recursive_hash(recursion_count), h);
-		h = hash_djb2_one_32(E.value().recursive_hash(recursion_count), h);
+	for (DictionaryPrivate::Entry *E = _p->next_entry(0); E; E = _p->next_entry(E->index + 1)) {
+		h = hash_djb2_one_32(E->key.recursive_hash(recursion_count), h);
+		h = hash_djb2_one_32(E->value.recursive_hash(recursion_count), h);
 	}
 
 	return h;
@@ -271,15 +660,15 @@ uint32_t Dictionary::recursive_hash(int recursion_count) const {
 
 Array Dictionary::keys() const {
 	Array varr;
-	if (_p->variant_map.is_empty()) {
+	if (is_empty()) {
 		return varr;
 	}
 
 	varr.resize(size());
 
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		varr[i] = E.key();
+	for (DictionaryPrivate::Entry *E = _p->next_entry(0); E; E = _p->next_entry(E->index + 1)) {
+		varr[i] = E->key;
 		i++;
 	}
 
@@ -288,15 +677,15 @@ Array Dictionary::keys() const {
 
 Array Dictionary::values() const {
 	Array varr;
-	if (_p->variant_map.is_empty()) {
+	if (is_empty()) {
 		return varr;
 	}
 
 	varr.resize(size());
 
 	int i = 0;
-	for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-		varr[i] = E.get();
+	for (DictionaryPrivate::Entry *E = _p->next_entry(0); E; E = _p->next_entry(E->index + 1)) {
+		varr[i] = E->value;
 		i++;
 	}
 
@@ -304,17 +693,19 @@ Array Dictionary::values() const {
 }
 
 const Variant *Dictionary::next(const Variant *p_key) const {
+	DictionaryPrivate::Entry *E;
 	if (p_key == nullptr) {
 		// caller wants to get the first element
-		if (_p->variant_map.front()) {
-			return &_p->variant_map.front().key();
+		E = _p->next_entry(0);
+	} else {
+		E = _find_entry(_p, *p_key);
+		if (E) {
+			E = _p->next_entry(E->index + 1);
 		}
-		return nullptr;
 	}
-	OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.find(*p_key);
 
-	if (E && E.next()) {
-		return &E.next().key();
+	if (E) {
+		return &E->key;
 	}
 	return nullptr;
 }
@@ -333,12 +724,12 @@ Dictionary Dictionary::recursive_duplicate(bool p_deep, int recursion_count) con
 
 	if (p_deep) {
 		recursion_count++;
-		for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-			n[E.key().recursive_duplicate(true, recursion_count)] = E.value().recursive_duplicate(true, recursion_count);
+		for (DictionaryPrivate::Entry *E = _p->next_entry(0); E; E = _p->next_entry(E->index + 1)) {
+			n[E->key.recursive_duplicate(true, recursion_count)] = E->value.recursive_duplicate(true, recursion_count);
 		}
 	} else {
-		for (OrderedHashMap<Variant, Variant, VariantHasher, VariantComparator>::Element E = _p->variant_map.front(); E; E = E.next()) {
-			n[E.key()] = E.value();
+		for (DictionaryPrivate::Entry *E = _p->next_entry(0); E; E = _p->next_entry(E->index + 1)) {
+			n._p->insert(E->hash, E->key)->value = E->value;
 		}
 	}
 
@@ -350,7 +741,7 @@ void Dictionary::operator=(const Dictionary &p_dictionary) {
 }
 
 const void *Dictionary::id() const {
-	return _p->variant_map.id();
+	return _p;
 }
 
 Dictionary::Dictionary(const Dictionary &p_from) {
@@ -53,6 +53,7 @@ public:
 	Variant &operator[](const Variant &p_key);
 	const Variant &operator[](const Variant &p_key) const;
 
+	// The pointer stays valid until its key is erased or the dictionary is cleared.
 	const Variant *getptr(const Variant &p_key) const;
 	Variant *getptr(const Variant &p_key);
 
@@ -54,12 +54,15 @@
 #include <assert.h>
 #include <dlfcn.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/wait.h>
 #include <time.h>
@@ -435,6 +438,37 @@ Error OS_Unix::get_dynamic_library_symbol_handle(void *p_library_handle, const S
 	return OK;
 }
 
+Error OS_Unix::map_file(const String &p_path, const uint8_t *&r_data, uint64_t &r_size) {
+	int fd = ::open(p_path.utf8().get_data(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return ERR_FILE_CANT_OPEN;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return ERR_FILE_CANT_READ;
+	}
+
+	// The mapping keeps its own reference to the file.
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		return ERR_FILE_CANT_READ;
+	}
+
+	r_data = (const uint8_t *)data;
+	r_size = st.st_size;
+	return OK;
+}
+
+Error OS_Unix::unmap_file(const uint8_t *p_data, uint64_t p_size) {
+	if (munmap((void *)p_data, p_size)) {
+		return FAILED;
+	}
+	return OK;
+}
+
 Error OS_Unix::set_cwd(const String &p_cwd) {
 	if (chdir(p_cwd.utf8().get_data()) != 0) {
 		return ERR_CANT_OPEN;
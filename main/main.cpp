@@ -408,6 +408,7 @@ Error Main::test_setup() {
 	GLOBAL_DEF("debug/settings/crash_handler/message",
 			String("Please include this when reporting the bug on https://github.com/meshengine/mesh/issues"));
 	GLOBAL_DEF_RST("rendering/occlusion_culling/bvh_build_quality", 2);
+	GLOBAL_DEF_RST("rendering/occlusion_culling/backend", 0);
 
 	translation_server = memnew(TranslationServer);
 	tsman = memnew(TextServerManager);
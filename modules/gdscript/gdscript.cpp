@@ -1226,6 +1226,7 @@ GDScript::~GDScript() {
 	for (const KeyValue<StringName, GDScriptFunction *> &E : member_functions) {
 		memdelete(E.value);
 	}
+	GDScriptFunction::invalidate_inline_caches();
 
 	if (GDScriptCache::singleton) { // Cache may have been already destroyed at engine shutdown.
 		GDScriptCache::remove_script(get_path());
@@ -393,6 +393,15 @@ GDScriptFunction *GDScriptByteCodeGenerator::write_end() {
 		function->_lambdas_count = 0;
 	}
 
+	if (inline_cache_count) {
+		function->inline_caches.resize(inline_cache_count);
+		function->_inline_caches_ptr = function->inline_caches.ptr();
+		function->_inline_caches_count = inline_cache_count;
+	} else {
+		function->_inline_caches_ptr = nullptr;
+		function->_inline_caches_count = 0;
+	}
+
 	if (debug_stack) {
 		function->stack_debug = stack_debug;
 	}
@@ -536,6 +545,9 @@ void GDScriptByteCodeGenerator::write_unary_operator(const Address &p_target, Va
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, Variant::NIL);
 
+		fuse_last_load(p_left_operand, p_left_operand);
+		last_operator_pos = opcodes.size();
+		last_operator_target = p_target;
 		append(GDScriptFunction::OPCODE_OPERATOR_VALIDATED, 3);
 		append(p_left_operand);
 		append(Address());
@@ -565,6 +577,9 @@ void GDScriptByteCodeGenerator::write_binary_operator(const Address &p_target, V
 		// Gather specific operator.
 		Variant::ValidatedOperatorEvaluator op_func = Variant::get_validated_operator_evaluator(p_operator, p_left_operand.type.builtin_type, p_right_operand.type.builtin_type);
 
+		fuse_last_load(p_left_operand, p_right_operand);
+		last_operator_pos = opcodes.size();
+		last_operator_target = p_target;
 		append(GDScriptFunction::OPCODE_OPERATOR_VALIDATED, 3);
 		append(p_left_operand);
 		append(p_right_operand);
@@ -596,6 +611,7 @@ void GDScriptByteCodeGenerator::write_type_test_builtin(const Address &p_target,
 }
 
 void GDScriptByteCodeGenerator::write_and_left_operand(const Address &p_left_operand) {
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT, p_left_operand);
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
 	append(p_left_operand);
 	logic_op_jump_pos1.push_back(opcodes.size());
@@ -603,6 +619,7 @@ void GDScriptByteCodeGenerator::write_and_left_operand(const Address &p_left_ope
 }
 
 void GDScriptByteCodeGenerator::write_and_right_operand(const Address &p_right_operand) {
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT, p_right_operand);
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
 	append(p_right_operand);
 	logic_op_jump_pos2.push_back(opcodes.size());
@@ -626,6 +643,7 @@ void GDScriptByteCodeGenerator::write_end_and(const Address &p_target) {
 }
 
 void GDScriptByteCodeGenerator::write_or_left_operand(const Address &p_left_operand) {
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF, p_left_operand);
 	append(GDScriptFunction::OPCODE_JUMP_IF, 1);
 	append(p_left_operand);
 	logic_op_jump_pos1.push_back(opcodes.size());
@@ -633,6 +651,7 @@ void GDScriptByteCodeGenerator::write_or_left_operand(const Address &p_left_oper
 }
 
 void GDScriptByteCodeGenerator::write_or_right_operand(const Address &p_right_operand) {
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF, p_right_operand);
 	append(GDScriptFunction::OPCODE_JUMP_IF, 1);
 	append(p_right_operand);
 	logic_op_jump_pos2.push_back(opcodes.size());
@@ -660,6 +679,7 @@ void GDScriptByteCodeGenerator::write_start_ternary(const Address &p_target) {
 }
 
 void GDScriptByteCodeGenerator::write_ternary_condition(const Address &p_condition) {
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT, p_condition);
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
 	append(p_condition);
 	ternary_jump_fail_pos.push_back(opcodes.size());
@@ -724,6 +744,9 @@ void GDScriptByteCodeGenerator::write_get(const Address &p_target, const Address
 		if (IS_BUILTIN_TYPE(p_index, Variant::INT) && Variant::get_member_validated_indexed_getter(p_source.type.builtin_type)) {
 			// Use indexed getter instead.
 			Variant::ValidatedIndexedGetter getter = Variant::get_member_validated_indexed_getter(p_source.type.builtin_type);
+			last_load_pos = opcodes.size();
+			last_load_size = 5;
+			last_load_target = p_target;
 			append(GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED, 3);
 			append(p_source);
 			append(p_index);
@@ -760,11 +783,15 @@ void GDScriptByteCodeGenerator::write_set_named(const Address &p_target, const S
 	append(p_target);
 	append(p_source);
 	append(p_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const StringName &p_name, const Address &p_source) {
 	if (HAS_BUILTIN_TYPE(p_source) && Variant::get_member_validated_getter(p_source.type.builtin_type, p_name)) {
 		Variant::ValidatedGetter getter = Variant::get_member_validated_getter(p_source.type.builtin_type, p_name);
+		last_load_pos = opcodes.size();
+		last_load_size = 4;
+		last_load_target = p_target;
 		append(GDScriptFunction::OPCODE_GET_NAMED_VALIDATED, 2);
 		append(p_source);
 		append(p_target);
@@ -775,6 +802,7 @@ void GDScriptByteCodeGenerator::write_get_named(const Address &p_target, const S
 	append(p_source);
 	append(p_target);
 	append(p_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_set_member(const Address &p_value, const StringName &p_name) {
@@ -845,6 +873,7 @@ void GDScriptByteCodeGenerator::write_assign(const Address &p_target, const Addr
 		append(p_source);
 		append(p_target.type.builtin_type);
 	} else {
+		fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_ASSIGN, p_source);
 		append(GDScriptFunction::OPCODE_ASSIGN, 2);
 		append(p_target);
 		append(p_source);
@@ -918,6 +947,7 @@ void GDScriptByteCodeGenerator::write_call(const Address &p_target, const Addres
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_super_call(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -939,6 +969,7 @@ void GDScriptByteCodeGenerator::write_call_async(const Address &p_target, const
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_call_gdscript_utility(const Address &p_target, GDScriptUtilityFunctions::FunctionPtr p_function, const Vector<Address> &p_arguments) {
@@ -1168,6 +1199,7 @@ void GDScriptByteCodeGenerator::write_call_self(const Address &p_target, const S
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1179,6 +1211,7 @@ void GDScriptByteCodeGenerator::write_call_self_async(const Address &p_target, c
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_target, const Address &p_base, const StringName &p_function_name, const Vector<Address> &p_arguments) {
@@ -1190,6 +1223,7 @@ void GDScriptByteCodeGenerator::write_call_script_function(const Address &p_targ
 	append(p_target);
 	append(p_arguments.size());
 	append(p_function_name);
+	append(inline_cache_count++);
 }
 
 void GDScriptByteCodeGenerator::write_lambda(const Address &p_target, GDScriptFunction *p_function, const Vector<Address> &p_captures) {
@@ -1298,6 +1332,7 @@ void GDScriptByteCodeGenerator::write_await(const Address &p_target, const Addre
 }
 
 void GDScriptByteCodeGenerator::write_if(const Address &p_condition) {
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT, p_condition);
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
 	append(p_condition);
 	if_jmp_addrs.push_back(opcodes.size());
@@ -1485,6 +1520,7 @@ void GDScriptByteCodeGenerator::start_while_condition() {
 
 void GDScriptByteCodeGenerator::write_while(const Address &p_condition) {
 	// Condition check.
+	fuse_last_operator(GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT, p_condition);
 	append(GDScriptFunction::OPCODE_JUMP_IF_NOT, 1);
 	append(p_condition);
 	while_jmp_addrs.push_back(opcodes.size());
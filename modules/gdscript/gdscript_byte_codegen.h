@@ -71,6 +71,7 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	int current_line = 0;
 	int instr_args_max = 0;
 	int ptrcall_max = 0;
+	int inline_cache_count = 0;
 
 #ifdef DEBUG_ENABLED
 	List<int> temp_stack;
@@ -115,6 +116,15 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 	List<List<int>> current_breaks_to_patch;
 	List<List<int>> match_continues_to_patch;
 
+	// Last validated operator, so it can be fused with the instruction that consumes its result.
+	int last_operator_pos = -1;
+	Address last_operator_target;
+
+	// Last validated load, so it can be fused with the operator that consumes its result.
+	int last_load_pos = -1;
+	int last_load_size = 0;
+	Address last_load_target;
+
 	void add_stack_identifier(const StringName &p_id, int p_stackpos) {
 		if (locals.size() > max_locals) {
 			max_locals = locals.size();
@@ -331,6 +341,35 @@ class GDScriptByteCodeGenerator : public GDScriptCodeGenerator {
 		return -1; // Unreachable.
 	}
 
+	void fuse_last_operator(GDScriptFunction::Opcode p_fused_code, const Address &p_operand) {
+		// Only fuse when the consumer directly follows the operator and reads its result.
+		// The operator's opcode word is the only thing rewritten, so jump targets remain valid.
+		if (last_operator_pos < 0 || opcodes.size() != last_operator_pos + 5) {
+			return;
+		}
+		if (last_operator_target.mode != p_operand.mode || last_operator_target.address != p_operand.address) {
+			return;
+		}
+		opcodes.write[last_operator_pos] = (p_fused_code & GDScriptFunction::INSTR_MASK) | (3 << GDScriptFunction::INSTR_BITS);
+		last_operator_pos = -1;
+	}
+
+	void fuse_last_load(const Address &p_left_operand, const Address &p_right_operand) {
+		// Same rules as above, the operator is kept as is and still runs on its own if jumped to.
+		if (last_load_pos < 0 || opcodes.size() != last_load_pos + last_load_size) {
+			return;
+		}
+		bool left = last_load_target.mode == p_left_operand.mode && last_load_target.address == p_left_operand.address;
+		bool right = last_load_target.mode == p_right_operand.mode && last_load_target.address == p_right_operand.address;
+		if (!left && !right) {
+			return;
+		}
+		int load_code = opcodes[last_load_pos] & GDScriptFunction::INSTR_MASK;
+		GDScriptFunction::Opcode fused_code = load_code == GDScriptFunction::OPCODE_GET_NAMED_VALIDATED ? GDScriptFunction::OPCODE_GET_NAMED_VALIDATED_OPERATOR : GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED_OPERATOR;
+		opcodes.write[last_load_pos] = (fused_code & GDScriptFunction::INSTR_MASK) | (opcodes[last_load_pos] & GDScriptFunction::INSTR_ARGS_MASK);
+		last_load_pos = -1;
+	}
+
 	void append(GDScriptFunction::Opcode p_code, int p_argument_count) {
 		opcodes.push_back((p_code & GDScriptFunction::INSTR_MASK) | (p_argument_count << GDScriptFunction::INSTR_BITS));
 		instr_args_max = MAX(instr_args_max, p_argument_count);
@@ -206,7 +206,8 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr += 5;
 			} break;
-			case OPCODE_GET_INDEXED_VALIDATED: {
+			case OPCODE_GET_INDEXED_VALIDATED:
+			case OPCODE_GET_INDEXED_VALIDATED_OPERATOR: {
 				text += "get indexed validated ";
 				text += DADDR(3);
 				text += " = ";
@@ -225,7 +226,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				text += "\"] = ";
 				text += DADDR(2);
 
-				incr += 4;
+				incr += 5;
 			} break;
 			case OPCODE_SET_NAMED_VALIDATED: {
 				text += "set_named validated ";
@@ -246,9 +247,10 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				text += _global_names_ptr[_code_ptr[ip + 3]];
 				text += "\"]";
 
-				incr += 4;
+				incr += 5;
 			} break;
-			case OPCODE_GET_NAMED_VALIDATED: {
+			case OPCODE_GET_NAMED_VALIDATED:
+			case OPCODE_GET_NAMED_VALIDATED_OPERATOR: {
 				text += "get_named validated ";
 				text += DADDR(2);
 				text += " = ";
@@ -509,7 +511,7 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 				}
 				text += ")";
 
-				incr = 5 + argc;
+				incr = 6 + argc;
 			} break;
 			case OPCODE_CALL_METHOD_BIND:
 			case OPCODE_CALL_METHOD_BIND_RET: {
@@ -792,6 +794,20 @@ void GDScriptFunction::disassemble(const Vector<String> &p_code_lines) const {
 
 				incr = 3;
 			} break;
+			case OPCODE_OPERATOR_VALIDATED_JUMP_IF:
+			case OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT:
+			case OPCODE_OPERATOR_VALIDATED_ASSIGN: {
+				// Fused with the next instruction, which is disassembled on its own.
+				text += "fused validated operator ";
+
+				text += DADDR(3);
+				text += " = ";
+				text += DADDR(1);
+				text += " <operator function> ";
+				text += DADDR(2);
+
+				incr += 5;
+			} break;
 			case OPCODE_JUMP_TO_DEF_ARGUMENT: {
 				text += "jump-to-default-argument ";
 
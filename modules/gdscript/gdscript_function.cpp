@@ -30,6 +30,7 @@
 
 #include "gdscript_function.h"
 
+#include "core/core_string_names.h"
 #include "gdscript.h"
 
 const int *GDScriptFunction::get_code() const {
@@ -138,6 +139,178 @@ void GDScriptFunction::debug_get_stack_member_state(int p_line, List<Pair<String
 	}
 }
 
+SafeNumeric<uint32_t> GDScriptFunction::inline_cache_epoch(1);
+
+bool GDScriptFunction::_inline_cache_lookup(int p_cache, Object *p_object, const StringName &p_name, InlineCacheAccess p_access, InlineCacheEntry &r_entry) {
+	if (unlikely(p_cache < 0 || p_cache >= _inline_caches_count)) {
+		return false;
+	}
+
+	const GDScript *script = nullptr;
+	ScriptInstance *script_instance = p_object->get_script_instance();
+	if (script_instance) {
+		if (script_instance->is_placeholder() || script_instance->get_language() != GDScriptLanguage::get_singleton()) {
+			return false;
+		}
+		script = static_cast<GDScriptInstance *>(script_instance)->script.ptr();
+	}
+	const void *class_id = p_object->get_class_name().data_unique_pointer();
+
+	uint32_t epoch = inline_cache_epoch.get();
+	InlineCache &cache = _inline_caches_ptr[p_cache];
+
+	uint32_t version = cache.version.get();
+	if (!(version & 1) && cache.epoch == epoch) {
+		const InlineCacheEntry *hit = nullptr;
+		for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+			const InlineCacheEntry &entry = cache.entries[i];
+			if (entry.kind != InlineCacheEntry::EMPTY && entry.class_id == class_id && entry.script == script) {
+				r_entry = entry;
+				hit = &entry;
+				break;
+			}
+		}
+		bool megamorphic = cache.fills >= INLINE_CACHE_MAX_FILLS;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (cache.version.get() == version) {
+			if (hit) {
+				return r_entry.kind != InlineCacheEntry::UNCACHEABLE;
+			}
+			if (megamorphic) {
+				return false;
+			}
+		}
+	}
+
+	inline_cache_lock.lock();
+	if (cache.epoch != epoch) {
+		cache.version.increment();
+		std::atomic_thread_fence(std::memory_order_release);
+		for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+			cache.entries[i].kind = InlineCacheEntry::EMPTY;
+		}
+		cache.next = 0;
+		cache.fills = 0;
+		cache.epoch = epoch;
+		cache.version.increment();
+	}
+	for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+		const InlineCacheEntry &entry = cache.entries[i];
+		if (entry.kind != InlineCacheEntry::EMPTY && entry.class_id == class_id && entry.script == script) {
+			r_entry = entry;
+			inline_cache_lock.unlock();
+			return r_entry.kind != InlineCacheEntry::UNCACHEABLE;
+		}
+	}
+	bool megamorphic = cache.fills >= INLINE_CACHE_MAX_FILLS;
+	inline_cache_lock.unlock();
+
+	if (megamorphic) {
+		return false;
+	}
+
+	// Resolve outside of the lock, this goes through the same maps as the generic path.
+	r_entry = InlineCacheEntry();
+	r_entry.script = script;
+	r_entry.class_id = class_id;
+	_inline_cache_resolve(p_object, script, p_name, p_access, r_entry);
+
+	inline_cache_lock.lock();
+	if (cache.epoch == epoch) {
+		cache.version.increment();
+		std::atomic_thread_fence(std::memory_order_release);
+		cache.entries[cache.next] = r_entry;
+		cache.next = (cache.next + 1) % INLINE_CACHE_SIZE;
+		cache.fills++;
+		cache.version.increment();
+	}
+	inline_cache_lock.unlock();
+
+	return r_entry.kind != InlineCacheEntry::UNCACHEABLE;
+}
+
+void GDScriptFunction::_inline_cache_resolve(Object *p_object, const GDScript *p_script, const StringName &p_name, InlineCacheAccess p_access, InlineCacheEntry &r_entry) {
+	// Mirrors the lookup order of Object::call(), Object::get() and Object::set(). Anything
+	// that could not be proven to resolve the same way every time is left to the generic path.
+	r_entry.kind = InlineCacheEntry::UNCACHEABLE;
+	const StringName &class_name = p_object->get_class_name();
+
+	if (p_access == INLINE_CACHE_CALL) {
+		if (p_name == CoreStringNames::get_singleton()->_free) {
+			return;
+		}
+		for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			const Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_name);
+			if (E) {
+				r_entry.kind = InlineCacheEntry::SCRIPT_FUNCTION;
+				r_entry.function = E->get();
+				return;
+			}
+		}
+		MethodBind *method = ClassDB::get_method(class_name, p_name);
+		if (method) {
+			r_entry.kind = InlineCacheEntry::METHOD_BIND;
+			r_entry.method = method;
+		}
+		return;
+	}
+
+	bool is_set = p_access == INLINE_CACHE_SET;
+
+	if (p_script) {
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			const GDScript::MemberInfo &member = E->get();
+			bool has_accessor = is_set ? member.setter != StringName() : member.getter != StringName();
+			bool typed_array = member.data_type.has_type && member.data_type.builtin_type == Variant::ARRAY && member.data_type.has_container_element_type();
+			if (!has_accessor && !(is_set && typed_array)) {
+				r_entry.kind = InlineCacheEntry::SCRIPT_MEMBER;
+				r_entry.index = member.index;
+				r_entry.member_type = &member.data_type;
+			}
+			return;
+		}
+
+		// Anything else the script answers to by name shadows native properties.
+		const StringName &fallback = is_set ? GDScriptLanguage::get_singleton()->strings._set : GDScriptLanguage::get_singleton()->strings._get;
+		for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (sptr->member_functions.has(fallback)) {
+				return;
+			}
+			if (!is_set && (sptr->constants.has(p_name) || sptr->_signals.has(p_name) || sptr->member_functions.has(p_name))) {
+				return;
+			}
+		}
+	}
+
+	ClassDB::APIType api = ClassDB::get_api_type(class_name);
+	if (api == ClassDB::API_EXTENSION || api == ClassDB::API_EDITOR_EXTENSION) {
+		return; // Extensions get their own property hooks first.
+	}
+
+	bool valid = false;
+	int index = ClassDB::get_property_index(class_name, p_name, &valid);
+	if (!valid) {
+		return;
+	}
+	StringName accessor = is_set ? ClassDB::get_property_setter(class_name, p_name) : ClassDB::get_property_getter(class_name, p_name);
+	if (accessor == StringName()) {
+		return;
+	}
+	for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+		if (sptr->member_functions.has(accessor)) {
+			return; // ClassDB may dispatch the accessor through Object::call(), which the script overrides.
+		}
+	}
+	MethodBind *method = ClassDB::get_method(class_name, accessor);
+	if (!method) {
+		return;
+	}
+	r_entry.kind = InlineCacheEntry::NATIVE_PROPERTY;
+	r_entry.method = method;
+	r_entry.index = index;
+}
+
 GDScriptFunction::GDScriptFunction() {
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
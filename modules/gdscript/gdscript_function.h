@@ -33,9 +33,12 @@
 
 #include "core/object/ref_counted.h"
 #include "core/object/script_language.h"
+#include "core/os/spin_lock.h"
 #include "core/os/thread.h"
 #include "core/string/string_name.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/pair.h"
+#include "core/templates/safe_refcount.h"
 #include "core/templates/self_list.h"
 #include "core/variant/variant.h"
 #include "gdscript_utility_functions.h"
@@ -301,6 +304,11 @@ public:
 		OPCODE_JUMP,
 		OPCODE_JUMP_IF,
 		OPCODE_JUMP_IF_NOT,
+		OPCODE_OPERATOR_VALIDATED_JUMP_IF,
+		OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT,
+		OPCODE_OPERATOR_VALIDATED_ASSIGN,
+		OPCODE_GET_NAMED_VALIDATED_OPERATOR,
+		OPCODE_GET_INDEXED_VALIDATED_OPERATOR,
 		OPCODE_JUMP_TO_DEF_ARGUMENT,
 		OPCODE_RETURN,
 		OPCODE_RETURN_TYPED_BUILTIN,
@@ -502,6 +510,64 @@ private:
 
 	List<StackDebug> stack_debug;
 
+	enum {
+		INLINE_CACHE_SIZE = 4, // Receivers remembered per site.
+		INLINE_CACHE_MAX_FILLS = 16, // Sites refilled more often are megamorphic and stop caching.
+	};
+
+	enum InlineCacheAccess {
+		INLINE_CACHE_CALL,
+		INLINE_CACHE_GET,
+		INLINE_CACHE_SET,
+	};
+
+	// Resolution of an untyped call or named access for one receiver, keyed on its
+	// native class and GDScript. Entries are dropped whenever a script is recompiled or freed.
+	struct InlineCacheEntry {
+		enum Kind {
+			EMPTY,
+			UNCACHEABLE,
+			SCRIPT_FUNCTION,
+			SCRIPT_MEMBER,
+			METHOD_BIND,
+			NATIVE_PROPERTY,
+		};
+
+		Kind kind = EMPTY;
+		const GDScript *script = nullptr;
+		const void *class_id = nullptr;
+		GDScriptFunction *function = nullptr;
+		MethodBind *method = nullptr;
+		const GDScriptDataType *member_type = nullptr;
+		int index = -1; // Member index, or index argument of a native property.
+	};
+
+	// Hits are read without the lock. Writers hold it and keep the version odd while they
+	// write, so a read that saw the same even version before and after is consistent.
+	struct InlineCache {
+		InlineCacheEntry entries[INLINE_CACHE_SIZE];
+		uint32_t next = 0;
+		uint32_t fills = 0;
+		uint32_t epoch = 0;
+		SafeNumeric<uint32_t> version;
+	};
+
+	LocalVector<InlineCache> inline_caches;
+	InlineCache *_inline_caches_ptr = nullptr;
+	int _inline_caches_count = 0;
+	SpinLock inline_cache_lock;
+
+	static SafeNumeric<uint32_t> inline_cache_epoch;
+
+	bool _inline_cache_lookup(int p_cache, Object *p_object, const StringName &p_name, InlineCacheAccess p_access, InlineCacheEntry &r_entry);
+
+	// Handler address for each code word, built on the first call when the VM uses computed goto.
+	Vector<const void *> threaded_code;
+	SafeFlag threaded_code_ready;
+
+	const void *const *_get_threaded_code(const void *const *p_handlers);
+	static void _inline_cache_resolve(Object *p_object, const GDScript *p_script, const StringName &p_name, InlineCacheAccess p_access, InlineCacheEntry &r_entry);
+
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Callable::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
@@ -589,6 +655,10 @@ public:
 #endif
 
 	_FORCE_INLINE_ Multiplayer::RPCConfig get_rpc_config() const { return rpc_config; }
+
+	// Must be called whenever script functions or members may have been freed or moved.
+	static void invalidate_inline_caches() { inline_cache_epoch.increment(); }
+
 	GDScriptFunction();
 	~GDScriptFunction();
 };
@@ -276,6 +276,11 @@ void (*type_init_function_table[])(Variant *) = {
 		&&OPCODE_JUMP,                               \
 		&&OPCODE_JUMP_IF,                            \
 		&&OPCODE_JUMP_IF_NOT,                        \
+		&&OPCODE_OPERATOR_VALIDATED_JUMP_IF,         \
+		&&OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT,     \
+		&&OPCODE_OPERATOR_VALIDATED_ASSIGN,          \
+		&&OPCODE_GET_NAMED_VALIDATED_OPERATOR,       \
+		&&OPCODE_GET_INDEXED_VALIDATED_OPERATOR,     \
 		&&OPCODE_JUMP_TO_DEF_ARGUMENT,               \
 		&&OPCODE_RETURN,                             \
 		&&OPCODE_RETURN_TYPED_BUILTIN,               \
@@ -363,7 +368,8 @@ void (*type_init_function_table[])(Variant *) = {
 		&&OPCODE_LINE,                               \
 		&&OPCODE_END                                 \
 	};                                               \
-	static_assert((sizeof(switch_table_ops) / sizeof(switch_table_ops[0]) == (OPCODE_END + 1)), "Opcodes in jump table aren't the same as opcodes in enum.");
+	static_assert((sizeof(switch_table_ops) / sizeof(switch_table_ops[0]) == (OPCODE_END + 1)), "Opcodes in jump table aren't the same as opcodes in enum."); \
+	const void *const *threaded_code_ptr = _get_threaded_code(switch_table_ops);
 
 #define OPCODE(m_op) \
 	m_op:
@@ -374,7 +380,8 @@ void (*type_init_function_table[])(Variant *) = {
 #define OPCODES_OUT \
 	OPSOUT:
 #define DISPATCH_OPCODE goto OPSWHILE
-#define OPCODE_SWITCH(m_test) goto *switch_table_ops[m_test];
+// Handlers are resolved ahead of time, so dispatch doesn't decode the opcode word.
+#define OPCODE_SWITCH(m_test) goto *threaded_code_ptr[ip];
 #define OPCODE_BREAK goto OPSEXIT
 #define OPCODE_OUT goto OPSOUT
 #else
@@ -424,6 +431,25 @@ void (*type_init_function_table[])(Variant *) = {
 #define OP_GET_BASIS get_basis
 #define OP_GET_RID get_rid
 
+const void *const *GDScriptFunction::_get_threaded_code(const void *const *p_handlers) {
+	if (likely(threaded_code_ready.is_set())) {
+		return threaded_code.ptr();
+	}
+
+	MutexLock lock(GDScriptLanguage::singleton->lock);
+	if (!threaded_code_ready.is_set()) {
+		threaded_code.resize(_code_size);
+		const void **threaded = threaded_code.ptrw();
+		for (int i = 0; i < _code_size; i++) {
+			// Operand words get an entry too, but they are never dispatched.
+			int opcode = _code_ptr[i] & INSTR_MASK;
+			threaded[i] = opcode <= OPCODE_END ? p_handlers[opcode] : nullptr;
+		}
+		threaded_code_ready.set();
+	}
+	return threaded_code.ptr();
+}
+
 Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_args, int p_argcount, Callable::CallError &r_err, CallState *p_state) {
 	OPCODES_TABLE;
 
@@ -931,7 +957,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_SET_NAMED) {
-				CHECK_SPACE(3);
+				CHECK_SPACE(5);
 
 				GET_INSTRUCTION_ARG(dst, 0);
 				GET_INSTRUCTION_ARG(value, 1);
@@ -941,6 +967,48 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				Object *dst_obj = dst->get_type() == Variant::OBJECT ? dst->get_validated_object() : nullptr;
+				InlineCacheEntry cached;
+				if (dst_obj && _inline_cache_lookup(_code_ptr[ip + 4], dst_obj, *index, INLINE_CACHE_SET, cached)) {
+					bool handled = false;
+					if (cached.kind == InlineCacheEntry::SCRIPT_MEMBER) {
+						GDScriptInstance *dst_instance = static_cast<GDScriptInstance *>(dst_obj->get_script_instance());
+						// Values that need a conversion go through GDScriptInstance::set().
+						if (cached.index < dst_instance->members.size() && (!cached.member_type->has_type || cached.member_type->is_type(*value))) {
+							dst_instance->members.write[cached.index] = *value;
+							handled = true;
+						}
+					} else {
+						Callable::CallError ce;
+#ifdef DEBUG_ENABLED
+						// Native calls lock the object like Object::call() does, so it can't be freed during them.
+						_ObjectDebugLock debug_lock(dst_obj);
+#endif
+						if (cached.index >= 0) {
+							Variant property_index = cached.index;
+							const Variant *args[2] = { &property_index, value };
+							cached.method->call(dst_obj, args, 2, ce);
+						} else {
+							const Variant *args[1] = { value };
+							cached.method->call(dst_obj, args, 1, ce);
+						}
+#ifdef DEBUG_ENABLED
+						if (ce.error != Callable::CallError::CALL_OK) {
+							err_text = "Invalid set index '" + String(*index) + "' (on base: '" + _get_var_type(dst) + "') with value of type '" + _get_var_type(value) + "'.";
+							OPCODE_BREAK;
+						}
+#endif
+						handled = true;
+					}
+					if (handled) {
+#ifdef TOOLS_ENABLED
+						dst_obj->set_edited(true);
+#endif
+						ip += 5;
+						DISPATCH_OPCODE;
+					}
+				}
+
 				bool valid;
 				dst->set_named(*index, *value, valid);
 
@@ -951,7 +1019,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 					OPCODE_BREAK;
 				}
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -971,7 +1039,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			DISPATCH_OPCODE;
 
 			OPCODE(OPCODE_GET_NAMED) {
-				CHECK_SPACE(4);
+				CHECK_SPACE(5);
 
 				GET_INSTRUCTION_ARG(src, 0);
 				GET_INSTRUCTION_ARG(dst, 1);
@@ -981,6 +1049,43 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
+				Object *src_obj = src->get_type() == Variant::OBJECT ? src->get_validated_object() : nullptr;
+				InlineCacheEntry cached;
+				if (src_obj && _inline_cache_lookup(_code_ptr[ip + 4], src_obj, *index, INLINE_CACHE_GET, cached)) {
+					bool handled = false;
+					if (cached.kind == InlineCacheEntry::SCRIPT_MEMBER) {
+						const GDScriptInstance *src_instance = static_cast<GDScriptInstance *>(src_obj->get_script_instance());
+						if (cached.index < src_instance->members.size()) {
+							// Copy first, dst may hold the last reference to the source.
+							Variant ret = src_instance->members[cached.index];
+							*dst = ret;
+							handled = true;
+						}
+					} else {
+						Callable::CallError ce;
+						Variant ret;
+						{
+#ifdef DEBUG_ENABLED
+							_ObjectDebugLock debug_lock(src_obj);
+#endif
+							if (cached.index >= 0) {
+								Variant property_index = cached.index;
+								const Variant *args[1] = { &property_index };
+								ret = cached.method->call(src_obj, args, 1, ce);
+							} else {
+								ret = cached.method->call(src_obj, nullptr, 0, ce);
+							}
+						}
+						// Assigned once unlocked, dst may hold the last reference to the source.
+						*dst = ret;
+						handled = true;
+					}
+					if (handled) {
+						ip += 5;
+						DISPATCH_OPCODE;
+					}
+				}
+
 				bool valid;
 #ifdef DEBUG_ENABLED
 				//allow better error message in cases where src and dst are the same stack position
@@ -1000,7 +1105,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 				*dst = ret;
 #endif
-				ip += 4;
+				ip += 5;
 			}
 			DISPATCH_OPCODE;
 
@@ -1455,7 +1560,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			OPCODE(OPCODE_CALL_ASYNC)
 			OPCODE(OPCODE_CALL_RETURN)
 			OPCODE(OPCODE_CALL) {
-				CHECK_SPACE(3 + instr_arg_count);
+				CHECK_SPACE(4 + instr_arg_count);
 				bool call_ret = (_code_ptr[ip] & INSTR_MASK) != OPCODE_CALL;
 #ifdef DEBUG_ENABLED
 				bool call_async = (_code_ptr[ip] & INSTR_MASK) == OPCODE_CALL_ASYNC;
@@ -1482,30 +1587,45 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 #endif
 				Callable::CallError err;
-				if (call_ret) {
-					GET_INSTRUCTION_ARG(ret, argc + 1);
-					base->call(*methodname, (const Variant **)argptrs, argc, *ret, err);
-#ifdef DEBUG_ENABLED
-					if (!call_async && ret->get_type() == Variant::OBJECT) {
-						// Check if getting a function state without await.
-						bool was_freed = false;
-						Object *obj = ret->get_validated_object_with_check(was_freed);
+				Variant discarded_ret;
+				Variant *ret = call_ret ? instruction_args[argc + 1] : &discarded_ret;
 
-						if (was_freed) {
-							err_text = "Got a freed object as a result of the call.";
-							OPCODE_BREAK;
-						}
-						if (obj && obj->is_class_ptr(GDScriptFunctionState::get_class_ptr_static())) {
-							err_text = R"(Trying to call an async function without "await".)";
-							OPCODE_BREAK;
+				Object *base_obj = base->get_type() == Variant::OBJECT ? base->get_validated_object() : nullptr;
+				InlineCacheEntry cached;
+				if (base_obj && _inline_cache_lookup(_code_ptr[ip + 3], base_obj, *methodname, INLINE_CACHE_CALL, cached)) {
+					Variant cached_ret;
+					{
+#ifdef DEBUG_ENABLED
+						_ObjectDebugLock debug_lock(base_obj);
+#endif
+						if (cached.kind == InlineCacheEntry::SCRIPT_FUNCTION) {
+							cached_ret = cached.function->call(static_cast<GDScriptInstance *>(base_obj->get_script_instance()), (const Variant **)argptrs, argc, err);
+						} else {
+							cached_ret = cached.method->call(base_obj, (const Variant **)argptrs, argc, err);
 						}
 					}
-#endif
+					// Assigned once unlocked, ret may hold the last reference to the base.
+					*ret = cached_ret;
 				} else {
-					Variant ret;
-					base->call(*methodname, (const Variant **)argptrs, argc, ret, err);
+					base->call(*methodname, (const Variant **)argptrs, argc, *ret, err);
 				}
+
 #ifdef DEBUG_ENABLED
+				if (call_ret && !call_async && ret->get_type() == Variant::OBJECT) {
+					// Check if getting a function state without await.
+					bool was_freed = false;
+					Object *obj = ret->get_validated_object_with_check(was_freed);
+
+					if (was_freed) {
+						err_text = "Got a freed object as a result of the call.";
+						OPCODE_BREAK;
+					}
+					if (obj && obj->is_class_ptr(GDScriptFunctionState::get_class_ptr_static())) {
+						err_text = R"(Trying to call an async function without "await".)";
+						OPCODE_BREAK;
+					}
+				}
+
 				if (GDScriptLanguage::get_singleton()->profiling) {
 					function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
 				}
@@ -1548,7 +1668,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 				}
 #endif
 
-				ip += 3;
+				ip += 4;
 			}
 			DISPATCH_OPCODE;
 
@@ -2241,6 +2361,159 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			// Superinstructions, fused by the code generator. Only the opcode word of the operator
+			// is rewritten, the following instruction is kept intact so it stays a valid jump target.
+			OPCODE(OPCODE_OPERATOR_VALIDATED_JUMP_IF) {
+				CHECK_SPACE(8);
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_INSTRUCTION_ARG(a, 0);
+				GET_INSTRUCTION_ARG(b, 1);
+				GET_INSTRUCTION_ARG(dst, 2);
+
+				operator_func(a, b, dst);
+
+				if (dst->booleanize()) {
+					int to = _code_ptr[ip + 7];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 8;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT) {
+				CHECK_SPACE(8);
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_INSTRUCTION_ARG(a, 0);
+				GET_INSTRUCTION_ARG(b, 1);
+				GET_INSTRUCTION_ARG(dst, 2);
+
+				operator_func(a, b, dst);
+
+				if (!dst->booleanize()) {
+					int to = _code_ptr[ip + 7];
+					GD_ERR_BREAK(to < 0 || to > _code_size);
+					ip = to;
+				} else {
+					ip += 8;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_VALIDATED_ASSIGN) {
+				CHECK_SPACE(8);
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_INSTRUCTION_ARG(a, 0);
+				GET_INSTRUCTION_ARG(b, 1);
+				GET_INSTRUCTION_ARG(dst, 2);
+
+				operator_func(a, b, dst);
+
+				GET_VARIANT_PTR(assign_dst, 6);
+				*assign_dst = *dst;
+
+				ip += 8;
+			}
+			DISPATCH_OPCODE;
+
+			// Typed loads fused with the validated operator that reads their result. The operator
+			// runs here too, including the jump or assign fused into it, without another dispatch.
+			OPCODE(OPCODE_GET_NAMED_VALIDATED_OPERATOR) {
+				CHECK_SPACE(9);
+
+				GET_INSTRUCTION_ARG(src, 0);
+				GET_INSTRUCTION_ARG(dst, 1);
+
+				int index_getter = _code_ptr[ip + 3];
+				GD_ERR_BREAK(index_getter < 0 || index_getter >= _getters_count);
+				const Variant::ValidatedGetter getter = _getters_ptr[index_getter];
+
+				getter(src, dst);
+				ip += 4;
+			}
+			goto fused_operator;
+
+			OPCODE(OPCODE_GET_INDEXED_VALIDATED_OPERATOR) {
+				CHECK_SPACE(10);
+
+				GET_INSTRUCTION_ARG(src, 0);
+				GET_INSTRUCTION_ARG(index, 1);
+				GET_INSTRUCTION_ARG(dst, 2);
+
+				int index_getter = _code_ptr[ip + 4];
+				GD_ERR_BREAK(index_getter < 0 || index_getter >= _indexed_getters_count);
+				const Variant::ValidatedIndexedGetter getter = _indexed_getters_ptr[index_getter];
+
+				int64_t int_index = *VariantInternal::get_int(index);
+
+				bool oob;
+				getter(src, int_index, dst, &oob);
+
+#ifdef DEBUG_ENABLED
+				if (oob) {
+					String v = index->operator String();
+					if (!v.is_empty()) {
+						v = "'" + v + "'";
+					} else {
+						v = "of type '" + _get_var_type(index) + "'";
+					}
+					err_text = "Out of bounds get index " + v + " (on base: '" + _get_var_type(src) + "')";
+					OPCODE_BREAK;
+				}
+#endif
+				ip += 5;
+			}
+			goto fused_operator;
+
+			fused_operator: {
+				// The operator instruction is left intact by the fusion, its opcode word says what follows it.
+				CHECK_SPACE(5);
+				int operator_code = _code_ptr[ip] & INSTR_MASK;
+
+				int operator_idx = _code_ptr[ip + 4];
+				GD_ERR_BREAK(operator_idx < 0 || operator_idx >= _operator_funcs_count);
+				Variant::ValidatedOperatorEvaluator operator_func = _operator_funcs_ptr[operator_idx];
+
+				GET_VARIANT_PTR(a, 1);
+				GET_VARIANT_PTR(b, 2);
+				GET_VARIANT_PTR(dst, 3);
+
+				operator_func(a, b, dst);
+
+				if (operator_code == OPCODE_OPERATOR_VALIDATED) {
+					ip += 5;
+				} else if (operator_code == OPCODE_OPERATOR_VALIDATED_ASSIGN) {
+					CHECK_SPACE(8);
+					GET_VARIANT_PTR(assign_dst, 6);
+					*assign_dst = *dst;
+					ip += 8;
+				} else {
+					CHECK_SPACE(8);
+					bool jump = dst->booleanize() == (operator_code == OPCODE_OPERATOR_VALIDATED_JUMP_IF);
+					if (jump) {
+						int to = _code_ptr[ip + 7];
+						GD_ERR_BREAK(to < 0 || to > _code_size);
+						ip = to;
+					} else {
+						ip += 8;
+					}
+				}
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT) {
 				CHECK_SPACE(2);
 				ip = _default_arg_ptr[defarg];
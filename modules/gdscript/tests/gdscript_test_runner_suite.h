@@ -69,6 +69,69 @@ func _init():
 	CHECK_MESSAGE(int(ref_counted->get_meta("result")) == 42, "The script should assign object metadata successfully.");
 }
 
+// Operands are addresses, indices and jump targets, which stay below `1 << INSTR_BITS` in a small script
+// or carry address type bits above the argument count, so only opcode words can match exactly.
+static bool function_has_instruction(const GDScriptFunction *p_function, GDScriptFunction::Opcode p_opcode, int p_argument_count) {
+	const int word = (p_opcode & GDScriptFunction::INSTR_MASK) | (p_argument_count << GDScriptFunction::INSTR_BITS);
+	const int *code = p_function->get_code();
+	for (int i = 0; i < p_function->get_code_size(); i++) {
+		if (code[i] == word) {
+			return true;
+		}
+	}
+	return false;
+}
+
+TEST_CASE("[Modules][GDScript] Fused instructions are emitted and run") {
+	Ref<GDScript> gdscript = memnew(GDScript);
+	gdscript->set_source_code(R"(
+extends RefCounted
+
+func first_above(values: PackedInt32Array, limit: int) -> int:
+	var i: int = 0
+	while i < values.size():
+		if values[i] > limit:
+			return i
+		i += 1
+	return -1
+
+func length_squared(v: Vector2) -> float:
+	var result: float = v.x * v.x + v.y * v.y
+	return result
+)");
+	ERR_PRINT_OFF;
+	const Error error = gdscript->reload();
+	ERR_PRINT_ON;
+	REQUIRE_MESSAGE(error == OK, "The script should parse successfully.");
+
+	const Map<StringName, GDScriptFunction *> &functions = gdscript->get_member_functions();
+	const GDScriptFunction *first_above = functions["first_above"];
+	const GDScriptFunction *length_squared = functions["length_squared"];
+
+	CHECK_MESSAGE(function_has_instruction(first_above, GDScriptFunction::OPCODE_OPERATOR_VALIDATED_JUMP_IF_NOT, 3),
+			"The loop condition should be fused with its jump.");
+	CHECK_MESSAGE(function_has_instruction(first_above, GDScriptFunction::OPCODE_GET_INDEXED_VALIDATED_OPERATOR, 3),
+			"The typed indexed load should be fused with the comparison that consumes it.");
+	CHECK_MESSAGE(function_has_instruction(length_squared, GDScriptFunction::OPCODE_GET_NAMED_VALIDATED_OPERATOR, 2),
+			"The typed member load should be fused with the operator that consumes it.");
+	CHECK_MESSAGE(function_has_instruction(length_squared, GDScriptFunction::OPCODE_OPERATOR_VALIDATED_ASSIGN, 3),
+			"The last operator should be fused with the assignment to the typed local.");
+
+	Ref<RefCounted> ref_counted = memnew(RefCounted);
+	ref_counted->set_script(gdscript);
+
+	PackedInt32Array values;
+	values.push_back(4);
+	values.push_back(8);
+	values.push_back(15);
+	values.push_back(16);
+	CHECK(int(ref_counted->call("first_above", values, 10)) == 2);
+	CHECK(int(ref_counted->call("first_above", values, 8)) == 2);
+	CHECK(int(ref_counted->call("first_above", values, 3)) == 0);
+	CHECK(int(ref_counted->call("first_above", values, 100)) == -1);
+	CHECK(double(ref_counted->call("length_squared", Vector2(3, 4))) == doctest::Approx(25.0));
+}
+
 } // namespace GDScriptTests
 
 #endif // GDSCRIPT_TEST_RUNNER_SUITE_H
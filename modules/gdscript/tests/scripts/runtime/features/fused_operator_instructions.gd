@@ -0,0 +1,23 @@
+func test():
+	var i: int = 0
+	var total: int = 0
+	while i < 10:
+		if i % 2 == 0:
+			total += i
+		i += 1
+	print(total)
+
+	var a: int = 3
+	var b: int = 5
+	var c: int = a * b
+	print(c)
+	print(a < b and b < c)
+	print(a > b or c > b)
+	print(a > b or b > c)
+	print("less" if a < b else "greater")
+
+	var count: int = 0
+	for j in 20:
+		if not (j < 15):
+			count += 1
+	print(count)
@@ -0,0 +1,39 @@
+func first_above(values: PackedInt32Array, limit: int) -> int:
+	var i: int = 0
+	while i < values.size():
+		if values[i] > limit:
+			return i
+		i += 1
+	return -1
+
+func scaled_sum(points: PackedVector2Array) -> float:
+	var total: float = 0.0
+	for i in points.size():
+		var p: Vector2 = points[i]
+		total = total + p.x * 2.0
+	return total
+
+func test():
+	var values := PackedInt32Array([4, 8, 15, 16, 23, 42])
+	print(first_above(values, 10))
+	print(first_above(values, 100))
+
+	var points := PackedVector2Array([Vector2(1, 5), Vector2(2.5, 6), Vector2(-0.5, 7)])
+	print(scaled_sum(points))
+
+	var v := Vector2(3, 4)
+	var d: float = v.x * v.x + v.y * v.y
+	print(d)
+
+	var even: int = 0
+	var index: int = 0
+	while index < values.size():
+		if values[index] % 2 == 0:
+			even += 1
+		index += 1
+	print(even)
+
+	var e := Vector3(1, 2, 3)
+	print(-e.y)
+	if e.z > e.x:
+		print("ordered")
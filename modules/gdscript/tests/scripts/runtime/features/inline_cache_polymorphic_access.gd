@@ -0,0 +1,46 @@
+class A:
+	var value = 1
+	func get_value():
+		return value
+
+class B:
+	var value = 2
+	func get_value():
+		return value * 10
+
+class C extends A:
+	func get_value():
+		return value + 100
+
+class D:
+	var value: float = 0.0
+
+func read(obj):
+	return obj.get_value()
+
+func read_property(obj):
+	return obj.value
+
+func write_property(obj, v):
+	obj.value = v
+
+func test():
+	var objects = [A.new(), B.new(), C.new()]
+	for i in 2:
+		for obj in objects:
+			print(read(obj))
+
+	for obj in objects:
+		write_property(obj, read_property(obj) + 5)
+		print(read_property(obj))
+
+	var d = D.new()
+	write_property(d, 3)
+	print(read_property(d))
+
+	var node = Node.new()
+	for i in 2:
+		node.name = "Node%d" % i
+		print(node.name)
+		print(node.get_child_count())
+	node.free()
@@ -30,7 +30,9 @@
 
 #include "mesh_navigation_server.h"
 
+#include "core/config/project_settings.h"
 #include "core/os/mutex.h"
+#include "core/os/os.h"
 
 #ifndef _3D_DISABLED
 #include "navigation_mesh_generator.h"
@@ -40,6 +42,9 @@
 	@author AndreaCatania
 */
 
+/// Path queries solved per pool thread between two budget checks.
+#define PATH_QUERIES_PER_THREAD 4
+
 /// Creates a struct for each function and a function that once called creates
 /// an instance of that struct with the submitted parameters.
 /// Then, that struct is stored in an array; the `sync` function consume that array.
@@ -115,10 +120,17 @@
 
 MeshNavigationServer::MeshNavigationServer() :
 		NavigationServer3D() {
+	path_query_budget_usec = GLOBAL_DEF("navigation/path_queries/frame_budget_usec", 2000);
+	ProjectSettings::get_singleton()->set_custom_property_info("navigation/path_queries/frame_budget_usec", PropertyInfo(Variant::INT, "navigation/path_queries/frame_budget_usec", PROPERTY_HINT_RANGE, "0,100000,1,or_greater"));
+	path_cache_size = GLOBAL_DEF("navigation/path_queries/cache_size", 1024);
+	ProjectSettings::get_singleton()->set_custom_property_info("navigation/path_queries/cache_size", PropertyInfo(Variant::INT, "navigation/path_queries/cache_size", PROPERTY_HINT_RANGE, "0,65536,1,or_greater"));
+
+	path_query_pool.init();
 }
 
 MeshNavigationServer::~MeshNavigationServer() {
 	flush_queries();
+	path_query_pool.finish();
 }
 
 void MeshNavigationServer::add_command(SetCommand *command) const {
@@ -135,6 +147,7 @@ RID MeshNavigationServer::map_create() const {
 	RID rid = map_owner.make_rid();
 	NavMap *space = map_owner.get_or_null(rid);
 	space->set_self(rid);
+	space->set_path_cache_size(path_cache_size);
 	return rid;
 }
 
@@ -239,6 +252,43 @@ RID MeshNavigationServer::map_get_closest_point_owner(RID p_map, const Vector3 &
 	return map->get_closest_point_owner(p_point);
 }
 
+RID MeshNavigationServer::map_query_path(RID p_map, Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers) const {
+	const NavMap *map = map_owner.get_or_null(p_map);
+	ERR_FAIL_COND_V(map == nullptr, RID());
+
+	RID rid = path_query_owner.make_rid();
+	NavPathQuery *query = path_query_owner.get_or_null(rid);
+	query->set_self(rid);
+	query->map = p_map;
+	query->origin = p_origin;
+	query->destination = p_destination;
+	query->optimize = p_optimize;
+	query->layers = p_layers;
+
+	MeshNavigationServer *mut_this = const_cast<MeshNavigationServer *>(this);
+	MutexLock lock(mut_this->path_queries_mutex);
+	mut_this->pending_path_queries.push_back(rid);
+	return rid;
+}
+
+bool MeshNavigationServer::path_query_is_done(RID p_query) const {
+	MeshNavigationServer *mut_this = const_cast<MeshNavigationServer *>(this);
+	MutexLock lock(mut_this->path_queries_mutex);
+	const NavPathQuery *query = path_query_owner.get_or_null(p_query);
+	ERR_FAIL_COND_V(query == nullptr, false);
+
+	return query->done;
+}
+
+Vector<Vector3> MeshNavigationServer::path_query_get_path(RID p_query) const {
+	MeshNavigationServer *mut_this = const_cast<MeshNavigationServer *>(this);
+	MutexLock lock(mut_this->path_queries_mutex);
+	const NavPathQuery *query = path_query_owner.get_or_null(p_query);
+	ERR_FAIL_COND_V(query == nullptr, Vector<Vector3>());
+
+	return query->path;
+}
+
 RID MeshNavigationServer::region_create() const {
 	MeshNavigationServer *mut_this = const_cast<MeshNavigationServer *>(this);
 	MutexLock lock(mut_this->operations_mutex);
@@ -495,6 +545,12 @@ COMMAND_1(free, RID, p_object) {
 
 		agent_owner.free(p_object);
 
+	} else if (path_query_owner.owns(p_object)) {
+		// Drop the query if it's still waiting to be solved.
+		MutexLock lock(path_queries_mutex);
+		pending_path_queries.erase(p_object);
+		path_query_owner.free(p_object);
+
 	} else {
 		ERR_FAIL_COND("Invalid ID.");
 	}
@@ -531,6 +587,10 @@ void MeshNavigationServer::process(real_t p_delta_time) {
 	for (uint32_t i(0); i < active_maps.size(); i++) {
 		active_maps[i]->sync();
 		active_maps[i]->step(p_delta_time);
+	}
+
+	// All the avoidance callbacks of the frame are dispatched together, once every map is stepped.
+	for (uint32_t i(0); i < active_maps.size(); i++) {
 		active_maps[i]->dispatch_callbacks();
 
 		// Emit a signal if a map changed.
@@ -540,6 +600,51 @@ void MeshNavigationServer::process(real_t p_delta_time) {
 			active_maps_update_id[i] = new_map_update_id;
 		}
 	}
+
+	_process_path_queries();
+}
+
+void MeshNavigationServer::_solve_path_query(uint32_t p_index, NavPathQuery **p_queries) {
+	NavPathQuery *query = p_queries[p_index];
+
+	Vector<Vector3> path;
+	if (query->map_ptr) {
+		path = query->map_ptr->get_path(query->origin, query->destination, query->optimize, query->layers);
+	}
+
+	MutexLock lock(path_queries_mutex);
+	query->path = path;
+	query->done = true;
+	query->map_ptr = nullptr;
+}
+
+void MeshNavigationServer::_process_path_queries() {
+	const uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+	const uint32_t batch_size = MAX(path_query_pool.get_thread_count(), 1) * PATH_QUERIES_PER_THREAD;
+
+	// Solve the oldest queries in parallel batches until the frame budget is spent.
+	// At least one batch is solved each frame, so queries always make progress.
+	do {
+		path_query_batch.clear();
+		{
+			MutexLock lock(path_queries_mutex);
+			while (path_query_batch.size() < batch_size && !pending_path_queries.is_empty()) {
+				NavPathQuery *query = path_query_owner.get_or_null(pending_path_queries.front()->get());
+				pending_path_queries.pop_front();
+				if (query) {
+					// A freed map leaves the query done with an empty path.
+					query->map_ptr = map_owner.get_or_null(query->map);
+					path_query_batch.push_back(query);
+				}
+			}
+		}
+
+		if (path_query_batch.is_empty()) {
+			break;
+		}
+
+		path_query_pool.do_work(path_query_batch.size(), this, &MeshNavigationServer::_solve_path_query, path_query_batch.ptr());
+	} while (OS::get_singleton()->get_ticks_usec() - begin_usec < path_query_budget_usec);
 }
 
 #undef COMMAND_1
@@ -31,12 +31,15 @@
 #ifndef MESH_NAVIGATION_SERVER_H
 #define MESH_NAVIGATION_SERVER_H
 
+#include "core/templates/list.h"
 #include "core/templates/local_vector.h"
 #include "core/templates/rid.h"
 #include "core/templates/rid_owner.h"
+#include "core/templates/thread_work_pool.h"
 #include "servers/navigation_server_3d.h"
 
 #include "nav_map.h"
+#include "nav_path_query.h"
 #include "nav_region.h"
 #include "rvo_agent.h"
 
@@ -78,11 +81,25 @@ class MeshNavigationServer : public NavigationServer3D {
 	mutable RID_Owner<NavMap> map_owner;
 	mutable RID_Owner<NavRegion> region_owner;
 	mutable RID_Owner<RvoAgent> agent_owner;
+	mutable RID_Owner<NavPathQuery, true> path_query_owner;
 
 	bool active = true;
 	LocalVector<NavMap *> active_maps;
 	LocalVector<uint32_t> active_maps_update_id;
 
+	/// Guards the pending path queries and the query results.
+	Mutex path_queries_mutex;
+	List<RID> pending_path_queries;
+	LocalVector<NavPathQuery *> path_query_batch;
+	ThreadWorkPool path_query_pool;
+
+	/// Time spent solving path queries each `process`, in microseconds.
+	uint64_t path_query_budget_usec = 0;
+	int path_cache_size = 0;
+
+	void _solve_path_query(uint32_t p_index, NavPathQuery **p_queries);
+	void _process_path_queries();
+
 public:
 	MeshNavigationServer();
 	virtual ~MeshNavigationServer();
@@ -109,6 +126,10 @@ public:
 	virtual Vector3 map_get_closest_point_normal(RID p_map, const Vector3 &p_point) const;
 	virtual RID map_get_closest_point_owner(RID p_map, const Vector3 &p_point) const;
 
+	virtual RID map_query_path(RID p_map, Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_layers = 1) const;
+	virtual bool path_query_is_done(RID p_query) const;
+	virtual Vector<Vector3> path_query_get_path(RID p_query) const;
+
 	virtual RID region_create() const;
 	COMMAND_2(region_set_map, RID, p_region, RID, p_map);
 	COMMAND_2(region_set_layers, RID, p_region, uint32_t, p_layers);
@@ -30,7 +30,7 @@
 
 #include "nav_map.h"
 
-#include "core/os/threaded_array_processor.h"
+#include "core/templates/hash_map.h"
 #include "nav_region.h"
 #include "rvo_agent.h"
 
@@ -42,6 +42,36 @@
 
 #define THREE_POINTS_CROSS_PRODUCT(m_a, m_b, m_c) (((m_c) - (m_a)).cross((m_b) - (m_a)))
 
+// Controlled agents solved by one task of the avoidance step.
+#define AGENTS_PER_CHUNK 64
+
+// Refitting keeps the split planes of the last build, which get worse as the
+// agents move, so the tree is rebuilt from time to time even if nobody joins or leaves.
+#define AGENT_TREE_MAX_REFITS 30
+
+NavMap::NavMap() {
+	step_work_pool.init();
+}
+
+static _FORCE_INLINE_ uint32_t get_polygon_cluster(const gd::Polygon *p_poly) {
+	return p_poly->owner->get_cluster_offset() + p_poly->cluster;
+}
+
+static Vector3 get_polygon_closest_point(const gd::Polygon *p_poly, const Vector3 &p_point) {
+	Vector3 closest_point;
+	float closest_point_d = 1e20;
+	for (size_t point_id = 2; point_id < p_poly->points.size(); point_id++) {
+		Face3 f(p_poly->points[point_id - 2].pos, p_poly->points[point_id - 1].pos, p_poly->points[point_id].pos);
+		Vector3 spoint = f.get_closest_point_to(p_point);
+		float dpoint = spoint.distance_to(p_point);
+		if (dpoint < closest_point_d) {
+			closest_point = spoint;
+			closest_point_d = dpoint;
+		}
+	}
+	return closest_point;
+}
+
 void NavMap::set_up(Vector3 p_up) {
 	up = p_up;
 	regenerate_polygons = true;
@@ -80,7 +110,7 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 	float end_d = 1e20;
 	// Find the initial poly and the end poly on this map.
 	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+		const gd::Polygon &p = *polygons[i];
 
 		// Only consider the polygon if it in a region with compatible layers.
 		if ((p_layers & p.owner->get_layers()) == 0) {
@@ -126,15 +156,227 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 
 	// List of all reachable navigation polys.
 	std::vector<gd::NavigationPoly> navigation_polys;
-	navigation_polys.reserve(polygons.size() * 0.75);
+	int least_cost_id = -1;
+
+	const uint64_t corridor_key = (uint64_t(begin_poly->id) << 32) | end_poly->id;
+	if (get_cached_corridor(corridor_key, p_layers, begin_point, navigation_polys)) {
+		least_cost_id = navigation_polys.size() - 1;
+	} else {
+		bool found_route = false;
+
+		// Across clusters, only search the polygons of the clusters along the coarse path.
+		const uint32_t begin_cluster = get_polygon_cluster(begin_poly);
+		const uint32_t end_cluster = get_polygon_cluster(end_poly);
+		if (begin_cluster != end_cluster) {
+			LocalVector<uint8_t> allowed_clusters;
+			if (find_cluster_corridor(begin_cluster, end_cluster, p_layers, allowed_clusters)) {
+				found_route = find_polygon_corridor(begin_poly, begin_point, end_poly, end_point, p_destination, p_layers, allowed_clusters.ptr(), navigation_polys, least_cost_id);
+			}
+		}
+
+		if (!found_route) {
+			found_route = find_polygon_corridor(begin_poly, begin_point, end_poly, end_point, p_destination, p_layers, nullptr, navigation_polys, least_cost_id);
+		}
+
+		// If we did not find a route, return an empty path.
+		if (!found_route) {
+			return Vector<Vector3>();
+		}
+
+		cache_corridor(corridor_key, p_layers, navigation_polys, least_cost_id);
+	}
+
+	// When the end polygon is not reachable, the path ends on the closest reachable polygon.
+	if (navigation_polys[least_cost_id].poly != end_poly) {
+		end_point = get_polygon_closest_point(navigation_polys[least_cost_id].poly, p_destination);
+	}
+
+	Vector<Vector3> path;
+	// Optimize the path.
+	if (p_optimize) {
+		// Set the apex poly/point to the end point
+		gd::NavigationPoly *apex_poly = &navigation_polys[least_cost_id];
+		Vector3 apex_point = end_point;
+
+		gd::NavigationPoly *left_poly = apex_poly;
+		Vector3 left_portal = apex_point;
+		gd::NavigationPoly *right_poly = apex_poly;
+		Vector3 right_portal = apex_point;
+
+		gd::NavigationPoly *p = apex_poly;
+
+		path.push_back(end_point);
+
+		while (p) {
+			// Set left and right points of the pathway between polygons.
+			Vector3 left = p->back_navigation_edge_pathway_start;
+			Vector3 right = p->back_navigation_edge_pathway_end;
+			if (THREE_POINTS_CROSS_PRODUCT(apex_point, left, right).dot(up) < 0) {
+				SWAP(left, right);
+			}
+
+			bool skip = false;
+			if (THREE_POINTS_CROSS_PRODUCT(apex_point, left_portal, left).dot(up) >= 0) {
+				//process
+				if (left_portal == apex_point || THREE_POINTS_CROSS_PRODUCT(apex_point, left, right_portal).dot(up) > 0) {
+					left_poly = p;
+					left_portal = left;
+				} else {
+					clip_path(navigation_polys, path, apex_poly, right_portal, right_poly);
+
+					apex_point = right_portal;
+					p = right_poly;
+					left_poly = p;
+					apex_poly = p;
+					left_portal = apex_point;
+					right_portal = apex_point;
+					path.push_back(apex_point);
+					skip = true;
+				}
+			}
+
+			if (!skip && THREE_POINTS_CROSS_PRODUCT(apex_point, right_portal, right).dot(up) <= 0) {
+				//process
+				if (right_portal == apex_point || THREE_POINTS_CROSS_PRODUCT(apex_point, right, left_portal).dot(up) < 0) {
+					right_poly = p;
+					right_portal = right;
+				} else {
+					clip_path(navigation_polys, path, apex_poly, left_portal, left_poly);
+
+					apex_point = left_portal;
+					p = left_poly;
+					right_poly = p;
+					apex_poly = p;
+					right_portal = apex_point;
+					left_portal = apex_point;
+					path.push_back(apex_point);
+				}
+			}
+
+			// Go to the previous polygon.
+			if (p->back_navigation_poly_id != -1) {
+				p = &navigation_polys[p->back_navigation_poly_id];
+			} else {
+				// The end
+				p = nullptr;
+			}
+		}
+
+		// If the last point is not the begin point, add it to the list.
+		if (path[path.size() - 1] != begin_point) {
+			path.push_back(begin_point);
+		}
+
+		path.reverse();
+
+	} else {
+		path.push_back(end_point);
+
+		// Add mid points
+		int np_id = least_cost_id;
+		while (np_id != -1) {
+			path.push_back(navigation_polys[np_id].entry);
+			np_id = navigation_polys[np_id].back_navigation_poly_id;
+		}
+
+		path.reverse();
+	}
+
+	return path;
+}
+
+bool NavMap::find_cluster_corridor(uint32_t p_begin_cluster, uint32_t p_end_cluster, uint32_t p_layers, LocalVector<uint8_t> &r_allowed_clusters) const {
+	// A* over the cluster graph, using the cluster centers as positions.
+	LocalVector<float> traveled_distance;
+	LocalVector<uint32_t> back_cluster;
+	LocalVector<uint8_t> closed;
+	traveled_distance.resize(clusters.size());
+	back_cluster.resize(clusters.size());
+	closed.resize(clusters.size());
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		traveled_distance[i] = 1e30;
+		back_cluster[i] = UINT32_MAX;
+		closed[i] = 0;
+	}
+
+	const Vector3 &end_center = clusters[p_end_cluster].center;
+
+	// Min-heap of (estimated cost, cluster), through std::greater.
+	std::vector<std::pair<float, uint32_t>> to_visit;
+	traveled_distance[p_begin_cluster] = 0.0;
+	to_visit.push_back(std::make_pair(clusters[p_begin_cluster].center.distance_to(end_center), p_begin_cluster));
+
+	bool found_route = false;
+	while (!to_visit.empty()) {
+		std::pop_heap(to_visit.begin(), to_visit.end(), std::greater<std::pair<float, uint32_t>>());
+		const uint32_t cluster_id = to_visit.back().second;
+		to_visit.pop_back();
+
+		if (closed[cluster_id]) {
+			continue;
+		}
+		if (cluster_id == p_end_cluster) {
+			found_route = true;
+			break;
+		}
+		closed[cluster_id] = 1;
+
+		const gd::Cluster &cluster = clusters[cluster_id];
+		for (uint32_t i = 0; i < cluster.links.size(); i++) {
+			const uint32_t link_id = cluster.links[i];
+			const gd::Cluster &link = clusters[link_id];
+			if (closed[link_id] || (p_layers & link.owner->get_layers()) == 0) {
+				continue;
+			}
+
+			const float new_distance = traveled_distance[cluster_id] + cluster.center.distance_to(link.center);
+			if (new_distance < traveled_distance[link_id]) {
+				traveled_distance[link_id] = new_distance;
+				back_cluster[link_id] = cluster_id;
+				to_visit.push_back(std::make_pair(new_distance + link.center.distance_to(end_center), link_id));
+				std::push_heap(to_visit.begin(), to_visit.end(), std::greater<std::pair<float, uint32_t>>());
+			}
+		}
+	}
+
+	if (!found_route) {
+		return false;
+	}
+
+	// Allow the clusters of the coarse path and their neighbours, so the polygon path can cut corners.
+	r_allowed_clusters.resize(clusters.size());
+	memset(r_allowed_clusters.ptr(), 0, clusters.size());
+	for (uint32_t cluster_id = p_end_cluster; cluster_id != UINT32_MAX; cluster_id = back_cluster[cluster_id]) {
+		r_allowed_clusters[cluster_id] = 1;
+		const gd::Cluster &cluster = clusters[cluster_id];
+		for (uint32_t i = 0; i < cluster.links.size(); i++) {
+			r_allowed_clusters[cluster.links[i]] = 1;
+		}
+	}
+
+	return true;
+}
+
+bool NavMap::find_polygon_corridor(const gd::Polygon *p_begin_poly, const Vector3 &p_begin_point, const gd::Polygon *p_end_poly, const Vector3 &p_end_point, const Vector3 &p_destination, uint32_t p_layers, const uint8_t *p_allowed_clusters, std::vector<gd::NavigationPoly> &r_navigation_polys, int &r_least_cost_id) const {
+	const gd::Polygon *end_poly = p_end_poly;
+	Vector3 end_point = p_end_point;
+
+	// List of all reachable navigation polys.
+	std::vector<gd::NavigationPoly> &navigation_polys = r_navigation_polys;
+	navigation_polys.clear();
+	navigation_polys.reserve(p_allowed_clusters ? 64 : polygons.size() * 0.75);
+
+	// Index of each reached polygon in navigation_polys.
+	HashMap<uint32_t, uint32_t> navigation_poly_ids;
 
 	// Add the start polygon to the reachable navigation polygons.
-	gd::NavigationPoly begin_navigation_poly = gd::NavigationPoly(begin_poly);
+	gd::NavigationPoly begin_navigation_poly = gd::NavigationPoly(p_begin_poly);
 	begin_navigation_poly.self_id = 0;
-	begin_navigation_poly.entry = begin_point;
-	begin_navigation_poly.back_navigation_edge_pathway_start = begin_point;
-	begin_navigation_poly.back_navigation_edge_pathway_end = begin_point;
+	begin_navigation_poly.entry = p_begin_point;
+	begin_navigation_poly.back_navigation_edge_pathway_start = p_begin_point;
+	begin_navigation_poly.back_navigation_edge_pathway_end = p_begin_point;
 	navigation_polys.push_back(begin_navigation_poly);
+	navigation_poly_ids.set(p_begin_poly->id, 0);
 
 	// List of polygon IDs to visit.
 	List<uint32_t> to_visit;
@@ -164,17 +406,20 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 					continue;
 				}
 
+				// Stay in the clusters of the coarse path, if any.
+				if (p_allowed_clusters && !p_allowed_clusters[get_polygon_cluster(connection.polygon)]) {
+					continue;
+				}
+
 				Vector3 pathway[2] = { connection.pathway_start, connection.pathway_end };
 				const Vector3 new_entry = Geometry3D::get_closest_point_to_segment(least_cost_poly->entry, pathway);
 				const float new_distance = least_cost_poly->entry.distance_to(new_entry) + least_cost_poly->traveled_distance;
 
-				const std::vector<gd::NavigationPoly>::iterator it = std::find(
-						navigation_polys.begin(),
-						navigation_polys.end(),
-						gd::NavigationPoly(connection.polygon));
+				const uint32_t *navigation_poly_id = navigation_poly_ids.getptr(connection.polygon->id);
 
-				if (it != navigation_polys.end()) {
+				if (navigation_poly_id) {
 					// Polygon already visited, check if we can reduce the travel cost.
+					gd::NavigationPoly *it = &navigation_polys[*navigation_poly_id];
 					if (new_distance < it->traveled_distance) {
 						it->back_navigation_poly_id = least_cost_id;
 						it->back_navigation_edge = connection.edge;
@@ -194,6 +439,7 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 					new_navigation_poly.traveled_distance = new_distance;
 					new_navigation_poly.entry = new_entry;
 					navigation_polys.push_back(new_navigation_poly);
+					navigation_poly_ids.set(connection.polygon->id, new_navigation_poly.self_id);
 
 					// Add the neighbour polygon to the polygons to visit.
 					to_visit.push_back(navigation_polys.size() - 1);
@@ -206,6 +452,11 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 
 		// When the list of polygons to visit is empty at this point it means the End Polygon is not reachable
 		if (to_visit.size() == 0) {
+			// A search restricted to some clusters is retried on the whole map instead.
+			if (p_allowed_clusters) {
+				break;
+			}
+
 			// Thus use the further reachable polygon
 			ERR_BREAK_MSG(is_reachable == false, "It's not expect to not find the most reachable polygons");
 			is_reachable = false;
@@ -216,21 +467,14 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 
 			// Set as end point the furthest reachable point.
 			end_poly = reachable_end;
-			end_d = 1e20;
-			for (size_t point_id = 2; point_id < end_poly->points.size(); point_id++) {
-				Face3 f(end_poly->points[point_id - 2].pos, end_poly->points[point_id - 1].pos, end_poly->points[point_id].pos);
-				Vector3 spoint = f.get_closest_point_to(p_destination);
-				float dpoint = spoint.distance_to(p_destination);
-				if (dpoint < end_d) {
-					end_point = spoint;
-					end_d = dpoint;
-				}
-			}
+			end_point = get_polygon_closest_point(end_poly, p_destination);
 
 			// Reset open and navigation_polys
 			gd::NavigationPoly np = navigation_polys[0];
 			navigation_polys.clear();
 			navigation_polys.push_back(np);
+			navigation_poly_ids.clear();
+			navigation_poly_ids.set(np.poly->id, 0);
 			to_visit.clear();
 			to_visit.push_back(0);
 
@@ -270,103 +514,73 @@ Vector<Vector3> NavMap::get_path(Vector3 p_origin, Vector3 p_destination, bool p
 		}
 	}
 
-	// If we did not find a route, return an empty path.
-	if (!found_route) {
-		return Vector<Vector3>();
-	}
-
-	Vector<Vector3> path;
-	// Optimize the path.
-	if (p_optimize) {
-		// Set the apex poly/point to the end point
-		gd::NavigationPoly *apex_poly = &navigation_polys[least_cost_id];
-		Vector3 apex_point = end_point;
-
-		gd::NavigationPoly *left_poly = apex_poly;
-		Vector3 left_portal = apex_point;
-		gd::NavigationPoly *right_poly = apex_poly;
-		Vector3 right_portal = apex_point;
-
-		gd::NavigationPoly *p = apex_poly;
-
-		path.push_back(end_point);
-
-		while (p) {
-			// Set left and right points of the pathway between polygons.
-			Vector3 left = p->back_navigation_edge_pathway_start;
-			Vector3 right = p->back_navigation_edge_pathway_end;
-			if (THREE_POINTS_CROSS_PRODUCT(apex_point, left, right).dot(up) < 0) {
-				SWAP(left, right);
-			}
-
-			bool skip = false;
-			if (THREE_POINTS_CROSS_PRODUCT(apex_point, left_portal, left).dot(up) >= 0) {
-				//process
-				if (left_portal == apex_point || THREE_POINTS_CROSS_PRODUCT(apex_point, left, right_portal).dot(up) > 0) {
-					left_poly = p;
-					left_portal = left;
-				} else {
-					clip_path(navigation_polys, path, apex_poly, right_portal, right_poly);
-
-					apex_point = right_portal;
-					p = right_poly;
-					left_poly = p;
-					apex_poly = p;
-					left_portal = apex_point;
-					right_portal = apex_point;
-					path.push_back(apex_point);
-					skip = true;
-				}
-			}
-
-			if (!skip && THREE_POINTS_CROSS_PRODUCT(apex_point, right_portal, right).dot(up) <= 0) {
-				//process
-				if (right_portal == apex_point || THREE_POINTS_CROSS_PRODUCT(apex_point, right, left_portal).dot(up) < 0) {
-					right_poly = p;
-					right_portal = right;
-				} else {
-					clip_path(navigation_polys, path, apex_poly, left_portal, left_poly);
+	r_least_cost_id = least_cost_id;
+	return found_route;
+}
 
-					apex_point = left_portal;
-					p = left_poly;
-					right_poly = p;
-					apex_poly = p;
-					right_portal = apex_point;
-					left_portal = apex_point;
-					path.push_back(apex_point);
-				}
-			}
+bool NavMap::get_cached_corridor(uint64_t p_key, uint32_t p_layers, const Vector3 &p_begin_point, std::vector<gd::NavigationPoly> &r_navigation_polys) const {
+	MutexLock lock(path_cache_mutex);
 
-			// Go to the previous polygon.
-			if (p->back_navigation_poly_id != -1) {
-				p = &navigation_polys[p->back_navigation_poly_id];
-			} else {
-				// The end
-				p = nullptr;
-			}
-		}
+	const gd::PathCorridor *corridor = path_cache.getptr(p_key);
+	if (!corridor || corridor->layers != p_layers) {
+		return false;
+	}
 
-		// If the last point is not the begin point, add it to the list.
-		if (path[path.size() - 1] != begin_point) {
-			path.push_back(begin_point);
+	// Rebuild the navigation polys chain, with the entries seen from the new begin point.
+	r_navigation_polys.clear();
+	r_navigation_polys.reserve(corridor->polys.size());
+	for (uint32_t i = 0; i < corridor->polys.size(); i++) {
+		const gd::CorridorPoly &corridor_poly = corridor->polys[i];
+
+		gd::NavigationPoly navigation_poly = gd::NavigationPoly(polygons[corridor_poly.polygon]);
+		navigation_poly.self_id = i;
+		navigation_poly.back_navigation_edge = corridor_poly.back_navigation_edge;
+		navigation_poly.back_navigation_edge_pathway_start = corridor_poly.back_navigation_edge_pathway_start;
+		navigation_poly.back_navigation_edge_pathway_end = corridor_poly.back_navigation_edge_pathway_end;
+		if (i == 0) {
+			navigation_poly.entry = p_begin_point;
+			navigation_poly.back_navigation_edge_pathway_start = p_begin_point;
+			navigation_poly.back_navigation_edge_pathway_end = p_begin_point;
+		} else {
+			const gd::NavigationPoly &back_navigation_poly = r_navigation_polys[i - 1];
+			Vector3 pathway[2] = { navigation_poly.back_navigation_edge_pathway_start, navigation_poly.back_navigation_edge_pathway_end };
+			navigation_poly.back_navigation_poly_id = i - 1;
+			navigation_poly.entry = Geometry3D::get_closest_point_to_segment(back_navigation_poly.entry, pathway);
+			navigation_poly.traveled_distance = back_navigation_poly.traveled_distance + back_navigation_poly.entry.distance_to(navigation_poly.entry);
 		}
+		r_navigation_polys.push_back(navigation_poly);
+	}
 
-		path.reverse();
+	return true;
+}
 
-	} else {
-		path.push_back(end_point);
+void NavMap::cache_corridor(uint64_t p_key, uint32_t p_layers, const std::vector<gd::NavigationPoly> &p_navigation_polys, int p_end_id) const {
+	gd::PathCorridor corridor;
+	corridor.layers = p_layers;
+	for (int np_id = p_end_id; np_id != -1; np_id = p_navigation_polys[np_id].back_navigation_poly_id) {
+		const gd::NavigationPoly &navigation_poly = p_navigation_polys[np_id];
+
+		gd::CorridorPoly corridor_poly;
+		corridor_poly.polygon = navigation_poly.poly->id;
+		corridor_poly.back_navigation_edge = navigation_poly.back_navigation_edge;
+		corridor_poly.back_navigation_edge_pathway_start = navigation_poly.back_navigation_edge_pathway_start;
+		corridor_poly.back_navigation_edge_pathway_end = navigation_poly.back_navigation_edge_pathway_end;
+		corridor.polys.push_back(corridor_poly);
+	}
+	corridor.polys.invert();
 
-		// Add mid points
-		int np_id = least_cost_id;
-		while (np_id != -1) {
-			path.push_back(navigation_polys[np_id].entry);
-			np_id = navigation_polys[np_id].back_navigation_poly_id;
-		}
+	MutexLock lock(path_cache_mutex);
+	path_cache.insert(p_key, corridor);
+}
 
-		path.reverse();
-	}
+void NavMap::set_path_cache_size(int p_size) {
+	MutexLock lock(path_cache_mutex);
+	path_cache.set_capacity(p_size);
+}
 
-	return path;
+void NavMap::clear_path_cache() {
+	MutexLock lock(path_cache_mutex);
+	path_cache.clear();
 }
 
 Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector3 &p_to, const bool p_use_collision) const {
@@ -376,7 +590,7 @@ Vector3 NavMap::get_closest_point_to_segment(const Vector3 &p_from, const Vector
 
 	// Find the initial poly and the end poly on this map.
 	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+		const gd::Polygon &p = *polygons[i];
 
 		// For each point cast a face and check the distance to the segment
 		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
@@ -427,7 +641,7 @@ Vector3 NavMap::get_closest_point(const Vector3 &p_point) const {
 
 	// Find the initial poly and the end poly on this map.
 	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+		const gd::Polygon &p = *polygons[i];
 
 		// For each point cast a face and check the distance to the point
 		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
@@ -453,7 +667,7 @@ Vector3 NavMap::get_closest_point_normal(const Vector3 &p_point) const {
 
 	// Find the initial poly and the end poly on this map.
 	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+		const gd::Polygon &p = *polygons[i];
 
 		// For each point cast a face and check the distance to the point
 		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
@@ -480,7 +694,7 @@ RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
 
 	// Find the initial poly and the end poly on this map.
 	for (size_t i(0); i < polygons.size(); i++) {
-		const gd::Polygon &p = polygons[i];
+		const gd::Polygon &p = *polygons[i];
 
 		// For each point cast a face and check the distance to the point
 		for (size_t point_id = 2; point_id < p.points.size(); point_id += 1) {
@@ -500,14 +714,24 @@ RID NavMap::get_closest_point_owner(const Vector3 &p_point) const {
 
 void NavMap::add_region(NavRegion *p_region) {
 	regions.push_back(p_region);
-	regenerate_links = true;
+	p_region->set_linked(false);
+	polygons_changed = true;
 }
 
 void NavMap::remove_region(NavRegion *p_region) {
 	const std::vector<NavRegion *>::iterator it = std::find(regions.begin(), regions.end(), p_region);
 	if (it != regions.end()) {
+		// The region polygons may be freed after this, so drop the connections to them now.
+		if (p_region->is_linked()) {
+			unlink_region(p_region);
+		}
 		regions.erase(it);
-		regenerate_links = true;
+
+		// Nothing is published until the next sync, the map polygons may point to the removed ones.
+		polygons.clear();
+		clusters.clear();
+		clear_path_cache();
+		polygons_changed = true;
 	}
 }
 
@@ -536,6 +760,7 @@ void NavMap::set_agent_as_controlled(RvoAgent *agent) {
 	if (!exist) {
 		ERR_FAIL_COND(!has_agent(agent));
 		controlled_agents.push_back(agent);
+		controlled_agents_dirty = true;
 	}
 }
 
@@ -543,7 +768,16 @@ void NavMap::remove_agent_as_controlled(RvoAgent *agent) {
 	const std::vector<RvoAgent *>::iterator it = std::find(controlled_agents.begin(), controlled_agents.end(), agent);
 	if (it != controlled_agents.end()) {
 		controlled_agents.erase(it);
+		controlled_agents_dirty = true;
+	}
+}
+
+const RVO::Agent *NavMap::get_rvo_agent(const RvoAgent *p_agent) const {
+	const uint32_t index = p_agent->get_map_agent_index();
+	if (index >= rvo_agent_owners.size() || rvo_agent_owners[index] != p_agent) {
+		return nullptr;
 	}
+	return &rvo_agents[index];
 }
 
 void NavMap::sync() {
@@ -555,173 +789,427 @@ void NavMap::sync() {
 		regenerate_links = true;
 	}
 
+	if (regenerate_links) {
+		// Remove all the connections, every region is linked again below.
+		for (size_t r(0); r < regions.size(); r++) {
+			NavRegion *region = regions[r];
+			std::vector<gd::Polygon> &region_polygons = region->get_polygons();
+			for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+				for (size_t e(0); e < region_polygons[poly_id].edges.size(); e++) {
+					region_polygons[poly_id].edges[e].connections.clear();
+				}
+			}
+			region->get_connections().clear();
+			region->get_free_edges().clear();
+			region->set_linked(false);
+		}
+		linked_edge_connection_margin = edge_connection_margin;
+		polygons_changed = true;
+	}
+
+	// Unlink the regions that are about to rebuild their polygons, while the old polygons still exist.
+	for (size_t r(0); r < regions.size(); r++) {
+		if (regions[r]->is_dirty() && regions[r]->is_linked()) {
+			unlink_region(regions[r]);
+		}
+	}
+
 	for (size_t r(0); r < regions.size(); r++) {
 		if (regions[r]->sync()) {
-			regenerate_links = true;
+			polygons_changed = true;
 		}
 	}
 
-	if (regenerate_links) {
-		// Remove regions connections.
-		for (size_t r(0); r < regions.size(); r++) {
-			regions[r]->get_connections().clear();
+	// Only the new and rebuilt regions need to be linked.
+	for (size_t r(0); r < regions.size(); r++) {
+		if (!regions[r]->is_linked()) {
+			link_region(regions[r]);
 		}
+	}
 
-		// Resize the polygon count.
-		int count = 0;
-		for (size_t r(0); r < regions.size(); r++) {
-			count += regions[r]->get_polygons().size();
+	if (polygons_changed) {
+		publish_polygons();
+	}
+
+	update_agent_tree();
+
+	regenerate_polygons = false;
+	regenerate_links = false;
+	polygons_changed = false;
+	agents_dirty = false;
+	controlled_agents_dirty = false;
+}
+
+void NavMap::pack_rvo_agents() {
+	for (size_t i(0); i < agents.size(); i++) {
+		agents[i]->set_map_agent_index(UINT32_MAX);
+	}
+
+	// Controlled agents first, so the avoidance step solves the start of the array.
+	rvo_agent_owners.clear();
+	for (size_t i(0); i < controlled_agents.size(); i++) {
+		controlled_agents[i]->set_map_agent_index(rvo_agent_owners.size());
+		rvo_agent_owners.push_back(controlled_agents[i]);
+	}
+	controlled_rvo_agent_count = rvo_agent_owners.size();
+	for (size_t i(0); i < agents.size(); i++) {
+		if (agents[i]->get_map_agent_index() == UINT32_MAX) {
+			agents[i]->set_map_agent_index(rvo_agent_owners.size());
+			rvo_agent_owners.push_back(agents[i]);
 		}
-		polygons.resize(count);
+	}
 
-		// Copy all region polygons in the map.
-		count = 0;
-		for (size_t r(0); r < regions.size(); r++) {
-			std::copy(
-					regions[r]->get_polygons().data(),
-					regions[r]->get_polygons().data() + regions[r]->get_polygons().size(),
-					polygons.begin() + count);
-			count += regions[r]->get_polygons().size();
+	// The agent tree still points into the old array, it is rebuilt right after.
+	rvo_agents.resize(rvo_agent_owners.size());
+}
+
+void NavMap::update_agent_tree() {
+	// Repacking moves the agents, so the tree is rebuilt with it.
+	const bool repacked = agents_dirty || controlled_agents_dirty;
+	if (repacked) {
+		pack_rvo_agents();
+	}
+
+	// Only the settings are copied, the neighbours and planes of the last step keep their memory.
+	for (size_t i(0); i < rvo_agents.size(); i++) {
+		const RVO::Agent *source = rvo_agent_owners[i]->get_agent();
+		RVO::Agent &agent = rvo_agents[i];
+		agent.position_ = source->position_;
+		agent.velocity_ = source->velocity_;
+		agent.prefVelocity_ = source->prefVelocity_;
+		agent.id_ = source->id_;
+		agent.maxNeighbors_ = source->maxNeighbors_;
+		agent.maxSpeed_ = source->maxSpeed_;
+		agent.neighborDist_ = source->neighborDist_;
+		agent.radius_ = source->radius_;
+		agent.timeHorizon_ = source->timeHorizon_;
+		agent.ignore_y_ = source->ignore_y_;
+	}
+
+	// The agents moved since the last step, so the tree is updated even if nobody joined or left.
+	if (repacked || agent_tree_refits >= AGENT_TREE_MAX_REFITS) {
+		std::vector<RVO::Agent *> raw_agents;
+		raw_agents.reserve(rvo_agents.size());
+		for (size_t i(0); i < rvo_agents.size(); i++) {
+			raw_agents.push_back(&rvo_agents[i]);
+		}
+		rvo.buildAgentTree(raw_agents);
+		agent_tree_refits = 0;
+	} else {
+		rvo.refitAgentTree();
+		agent_tree_refits++;
+	}
+}
+
+void NavMap::publish_polygons() {
+	// Publish the region polygons and clusters in the map.
+	int count = 0;
+	for (size_t r(0); r < regions.size(); r++) {
+		count += regions[r]->get_polygons().size();
+	}
+	polygons.resize(count);
+
+	count = 0;
+	uint32_t cluster_count = 0;
+	for (size_t r(0); r < regions.size(); r++) {
+		std::vector<gd::Polygon> &region_polygons = regions[r]->get_polygons();
+		for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+			region_polygons[poly_id].id = count;
+			polygons[count] = &region_polygons[poly_id];
+			count++;
 		}
 
-		// Group all edges per key.
-		Map<gd::EdgeKey, Vector<gd::Edge::Connection>> connections;
-		for (size_t poly_id(0); poly_id < polygons.size(); poly_id++) {
-			gd::Polygon &poly(polygons[poly_id]);
+		regions[r]->set_cluster_offset(cluster_count);
+		cluster_count += regions[r]->get_cluster_count();
+	}
+	clusters.resize(cluster_count);
 
-			for (size_t p(0); p < poly.points.size(); p++) {
-				int next_point = (p + 1) % poly.points.size();
-				gd::EdgeKey ek(poly.points[p].key, poly.points[next_point].key);
+	link_clusters();
 
-				Map<gd::EdgeKey, Vector<gd::Edge::Connection>>::Element *connection = connections.find(ek);
-				if (!connection) {
-					connections[ek] = Vector<gd::Edge::Connection>();
-				}
-				if (connections[ek].size() <= 1) {
-					// Add the polygon/edge tuple to this key.
-					gd::Edge::Connection new_connection;
-					new_connection.polygon = &poly;
-					new_connection.edge = p;
-					new_connection.pathway_start = poly.points[p].pos;
-					new_connection.pathway_end = poly.points[next_point].pos;
-					connections[ek].push_back(new_connection);
-				} else {
-					// The edge is already connected with another edge, skip.
-					ERR_PRINT("Attempted to merge a navigation mesh triangle edge with another already-merged edge. This happens when the current `cell_size` is different from the one used to generate the navigation mesh. This will cause navigation problem.");
-				}
-			}
+	// The polygons changed, so the cached corridors are invalid.
+	clear_path_cache();
+
+	// Update the update ID.
+	map_update_id = (map_update_id + 1) % 9999999;
+}
+
+bool NavMap::is_edge_shared(const gd::Edge::Connection &p_edge) const {
+	// A free edge is shared when a polygon of another region has the exact same edge.
+	const gd::Polygon *poly = p_edge.polygon;
+	const gd::EdgeKey ek(poly->points[p_edge.edge].key, poly->points[(p_edge.edge + 1) % poly->points.size()].key);
+
+	const gd::Edge &edge = poly->edges[p_edge.edge];
+	for (int i = 0; i < edge.connections.size(); i++) {
+		const gd::Edge::Connection &connection = edge.connections[i];
+		const gd::Polygon *other_poly = connection.polygon;
+		const gd::EdgeKey other_ek(other_poly->points[connection.edge].key, other_poly->points[(connection.edge + 1) % other_poly->points.size()].key);
+		if (ek.a.key == other_ek.a.key && ek.b.key == other_ek.b.key) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void NavMap::connect_free_edges(const gd::Edge::Connection &p_free_edge, const gd::Edge::Connection &p_other_edge) const {
+	Vector3 edge_p1 = p_free_edge.polygon->points[p_free_edge.edge].pos;
+	Vector3 edge_p2 = p_free_edge.polygon->points[(p_free_edge.edge + 1) % p_free_edge.polygon->points.size()].pos;
+
+	Vector3 other_edge_p1 = p_other_edge.polygon->points[p_other_edge.edge].pos;
+	Vector3 other_edge_p2 = p_other_edge.polygon->points[(p_other_edge.edge + 1) % p_other_edge.polygon->points.size()].pos;
+
+	// Compute the projection of the opposite edge on the current one
+	Vector3 edge_vector = edge_p2 - edge_p1;
+	float projected_p1_ratio = edge_vector.dot(other_edge_p1 - edge_p1) / (edge_vector.length_squared());
+	float projected_p2_ratio = edge_vector.dot(other_edge_p2 - edge_p1) / (edge_vector.length_squared());
+	if ((projected_p1_ratio < 0.0 && projected_p2_ratio < 0.0) || (projected_p1_ratio > 1.0 && projected_p2_ratio > 1.0)) {
+		return;
+	}
+
+	// Check if the two edges are close to each other enough and compute a pathway between the two regions.
+	Vector3 self1 = edge_vector * CLAMP(projected_p1_ratio, 0.0, 1.0) + edge_p1;
+	Vector3 other1;
+	if (projected_p1_ratio >= 0.0 && projected_p1_ratio <= 1.0) {
+		other1 = other_edge_p1;
+	} else {
+		other1 = other_edge_p1.lerp(other_edge_p2, (1.0 - projected_p1_ratio) / (projected_p2_ratio - projected_p1_ratio));
+	}
+	if (other1.distance_to(self1) > edge_connection_margin) {
+		return;
+	}
+
+	Vector3 self2 = edge_vector * CLAMP(projected_p2_ratio, 0.0, 1.0) + edge_p1;
+	Vector3 other2;
+	if (projected_p2_ratio >= 0.0 && projected_p2_ratio <= 1.0) {
+		other2 = other_edge_p2;
+	} else {
+		other2 = other_edge_p1.lerp(other_edge_p2, (0.0 - projected_p1_ratio) / (projected_p2_ratio - projected_p1_ratio));
+	}
+	if (other2.distance_to(self2) > edge_connection_margin) {
+		return;
+	}
+
+	// The edges can now be connected.
+	gd::Edge::Connection new_connection = p_other_edge;
+	new_connection.pathway_start = (self1 + other1) / 2.0;
+	new_connection.pathway_end = (self2 + other2) / 2.0;
+	p_free_edge.polygon->edges[p_free_edge.edge].connections.push_back(new_connection);
+
+	// Add the connection to the region_connection map.
+	p_free_edge.polygon->owner->get_connections().push_back(new_connection);
+}
+
+void NavMap::get_linked_neighbours(const NavRegion *p_region, LocalVector<NavRegion *> &r_neighbours) const {
+	// Only the regions within the connection margin can share or weld edges.
+	const AABB region_aabb = p_region->get_aabb().grow(linked_edge_connection_margin);
+	for (size_t r(0); r < regions.size(); r++) {
+		NavRegion *other = regions[r];
+		if (other != p_region && other->is_linked() && region_aabb.intersects_inclusive(other->get_aabb())) {
+			r_neighbours.push_back(other);
 		}
+	}
+}
+
+void NavMap::link_region(NavRegion *p_region) {
+	std::vector<gd::Polygon> &region_polygons = p_region->get_polygons();
+	LocalVector<gd::Edge::Connection> &free_edges = p_region->get_free_edges();
+	free_edges.clear();
 
-		Vector<gd::Edge::Connection> free_edges;
-		for (KeyValue<gd::EdgeKey, Vector<gd::Edge::Connection>> &E : connections) {
-			if (E.value.size() == 2) {
-				// Connect edge that are shared in different polygons.
-				gd::Edge::Connection &c1 = E.value.write[0];
-				gd::Edge::Connection &c2 = E.value.write[1];
-				c1.polygon->edges[c1.edge].connections.push_back(c2);
-				c2.polygon->edges[c2.edge].connections.push_back(c1);
-				// Note: The pathway_start/end are full for those connection and do not need to be modified.
+	// Group all edges of the region per key.
+	Map<gd::EdgeKey, Vector<gd::Edge::Connection>> connections;
+	for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+		gd::Polygon &poly(region_polygons[poly_id]);
+
+		for (size_t p(0); p < poly.points.size(); p++) {
+			int next_point = (p + 1) % poly.points.size();
+			gd::EdgeKey ek(poly.points[p].key, poly.points[next_point].key);
+
+			Map<gd::EdgeKey, Vector<gd::Edge::Connection>>::Element *connection = connections.find(ek);
+			if (!connection) {
+				connection = connections.insert(ek, Vector<gd::Edge::Connection>());
+			}
+			if (connection->get().size() <= 1) {
+				// Add the polygon/edge tuple to this key.
+				gd::Edge::Connection new_connection;
+				new_connection.polygon = &poly;
+				new_connection.edge = p;
+				new_connection.pathway_start = poly.points[p].pos;
+				new_connection.pathway_end = poly.points[next_point].pos;
+				connection->get().push_back(new_connection);
 			} else {
-				CRASH_COND_MSG(E.value.size() != 1, vformat("Number of connection != 1. Found: %d", E.value.size()));
-				free_edges.push_back(E.value[0]);
+				// The edge is already connected with another edge, skip.
+				ERR_PRINT("Attempted to merge a navigation mesh triangle edge with another already-merged edge. This happens when the current `cell_size` is different from the one used to generate the navigation mesh. This will cause navigation problem.");
 			}
 		}
+	}
 
-		// Find the compatible near edges.
-		//
-		// Note:
-		// Considering that the edges must be compatible (for obvious reasons)
-		// to be connected, create new polygons to remove that small gap is
-		// not really useful and would result in wasteful computation during
-		// connection, integration and path finding.
-		for (int i = 0; i < free_edges.size(); i++) {
-			const gd::Edge::Connection &free_edge = free_edges[i];
-			Vector3 edge_p1 = free_edge.polygon->points[free_edge.edge].pos;
-			Vector3 edge_p2 = free_edge.polygon->points[(free_edge.edge + 1) % free_edge.polygon->points.size()].pos;
-
-			for (int j = 0; j < free_edges.size(); j++) {
-				const gd::Edge::Connection &other_edge = free_edges[j];
-				if (i == j || free_edge.polygon->owner == other_edge.polygon->owner) {
-					continue;
-				}
+	Map<gd::EdgeKey, uint32_t> free_edge_ids;
+	for (KeyValue<gd::EdgeKey, Vector<gd::Edge::Connection>> &E : connections) {
+		if (E.value.size() == 2) {
+			// Connect edge that are shared in different polygons.
+			gd::Edge::Connection &c1 = E.value.write[0];
+			gd::Edge::Connection &c2 = E.value.write[1];
+			c1.polygon->edges[c1.edge].connections.push_back(c2);
+			c2.polygon->edges[c2.edge].connections.push_back(c1);
+			// Note: The pathway_start/end are full for those connection and do not need to be modified.
+		} else {
+			CRASH_COND_MSG(E.value.size() != 1, vformat("Number of connection != 1. Found: %d", E.value.size()));
+			free_edge_ids.insert(E.key, free_edges.size());
+			free_edges.push_back(E.value[0]);
+		}
+	}
 
-				Vector3 other_edge_p1 = other_edge.polygon->points[other_edge.edge].pos;
-				Vector3 other_edge_p2 = other_edge.polygon->points[(other_edge.edge + 1) % other_edge.polygon->points.size()].pos;
+	LocalVector<NavRegion *> neighbours;
+	get_linked_neighbours(p_region, neighbours);
+
+	// Connect the edges shared with the polygons of the neighbour regions.
+	LocalVector<uint8_t> shared_edges;
+	shared_edges.resize(free_edges.size());
+	memset(shared_edges.ptr(), 0, free_edges.size());
+	for (uint32_t n = 0; n < neighbours.size(); n++) {
+		const LocalVector<gd::Edge::Connection> &other_free_edges = neighbours[n]->get_free_edges();
+		for (uint32_t i = 0; i < other_free_edges.size(); i++) {
+			const gd::Edge::Connection &other_edge = other_free_edges[i];
+			const gd::Polygon *other_poly = other_edge.polygon;
+			gd::EdgeKey ek(other_poly->points[other_edge.edge].key, other_poly->points[(other_edge.edge + 1) % other_poly->points.size()].key);
+
+			Map<gd::EdgeKey, uint32_t>::Element *E = free_edge_ids.find(ek);
+			if (!E || shared_edges[E->get()] || is_edge_shared(other_edge)) {
+				continue;
+			}
 
-				// Compute the projection of the opposite edge on the current one
-				Vector3 edge_vector = edge_p2 - edge_p1;
-				float projected_p1_ratio = edge_vector.dot(other_edge_p1 - edge_p1) / (edge_vector.length_squared());
-				float projected_p2_ratio = edge_vector.dot(other_edge_p2 - edge_p1) / (edge_vector.length_squared());
-				if ((projected_p1_ratio < 0.0 && projected_p2_ratio < 0.0) || (projected_p1_ratio > 1.0 && projected_p2_ratio > 1.0)) {
-					continue;
-				}
+			const gd::Edge::Connection &free_edge = free_edges[E->get()];
+			free_edge.polygon->edges[free_edge.edge].connections.push_back(other_edge);
+			other_edge.polygon->edges[other_edge.edge].connections.push_back(free_edge);
+			shared_edges[E->get()] = 1;
+		}
+	}
 
-				// Check if the two edges are close to each other enough and compute a pathway between the two regions.
-				Vector3 self1 = edge_vector * CLAMP(projected_p1_ratio, 0.0, 1.0) + edge_p1;
-				Vector3 other1;
-				if (projected_p1_ratio >= 0.0 && projected_p1_ratio <= 1.0) {
-					other1 = other_edge_p1;
-				} else {
-					other1 = other_edge_p1.lerp(other_edge_p2, (1.0 - projected_p1_ratio) / (projected_p2_ratio - projected_p1_ratio));
-				}
-				if (other1.distance_to(self1) > edge_connection_margin) {
-					continue;
-				}
+	// Find the compatible near edges.
+	//
+	// Note:
+	// Considering that the edges must be compatible (for obvious reasons)
+	// to be connected, create new polygons to remove that small gap is
+	// not really useful and would result in wasteful computation during
+	// connection, integration and path finding.
+	for (uint32_t i = 0; i < free_edges.size(); i++) {
+		if (shared_edges[i]) {
+			continue;
+		}
+		const gd::Edge::Connection &free_edge = free_edges[i];
 
-				Vector3 self2 = edge_vector * CLAMP(projected_p2_ratio, 0.0, 1.0) + edge_p1;
-				Vector3 other2;
-				if (projected_p2_ratio >= 0.0 && projected_p2_ratio <= 1.0) {
-					other2 = other_edge_p2;
-				} else {
-					other2 = other_edge_p1.lerp(other_edge_p2, (0.0 - projected_p1_ratio) / (projected_p2_ratio - projected_p1_ratio));
-				}
-				if (other2.distance_to(self2) > edge_connection_margin) {
+		for (uint32_t n = 0; n < neighbours.size(); n++) {
+			const LocalVector<gd::Edge::Connection> &other_free_edges = neighbours[n]->get_free_edges();
+			for (uint32_t j = 0; j < other_free_edges.size(); j++) {
+				const gd::Edge::Connection &other_edge = other_free_edges[j];
+				if (is_edge_shared(other_edge)) {
 					continue;
 				}
 
-				// The edges can now be connected.
-				gd::Edge::Connection new_connection = other_edge;
-				new_connection.pathway_start = (self1 + other1) / 2.0;
-				new_connection.pathway_end = (self2 + other2) / 2.0;
-				free_edge.polygon->edges[free_edge.edge].connections.push_back(new_connection);
+				connect_free_edges(free_edge, other_edge);
+				connect_free_edges(other_edge, free_edge);
+			}
+		}
+	}
+
+	p_region->set_linked(true);
+}
 
-				// Add the connection to the region_connection map.
-				free_edge.polygon->owner->get_connections().push_back(new_connection);
+void NavMap::unlink_region(NavRegion *p_region) {
+	LocalVector<NavRegion *> neighbours;
+	get_linked_neighbours(p_region, neighbours);
+
+	// Remove the connections the neighbours have to this region.
+	for (uint32_t n = 0; n < neighbours.size(); n++) {
+		std::vector<gd::Polygon> &other_polygons = neighbours[n]->get_polygons();
+		for (size_t poly_id(0); poly_id < other_polygons.size(); poly_id++) {
+			gd::Polygon &poly = other_polygons[poly_id];
+			for (size_t e(0); e < poly.edges.size(); e++) {
+				Vector<gd::Edge::Connection> &edge_connections = poly.edges[e].connections;
+				for (int i = edge_connections.size() - 1; i >= 0; i--) {
+					if (edge_connections[i].polygon->owner == p_region) {
+						edge_connections.remove_at(i);
+					}
+				}
 			}
 		}
 
-		// Update the update ID.
-		map_update_id = (map_update_id + 1) % 9999999;
+		Vector<gd::Edge::Connection> &region_connections = neighbours[n]->get_connections();
+		for (int i = region_connections.size() - 1; i >= 0; i--) {
+			if (region_connections[i].polygon->owner == p_region) {
+				region_connections.remove_at(i);
+			}
+		}
 	}
 
-	// Update agents tree.
-	if (agents_dirty) {
-		std::vector<RVO::Agent *> raw_agents;
-		raw_agents.reserve(agents.size());
-		for (size_t i(0); i < agents.size(); i++) {
-			raw_agents.push_back(agents[i]->get_agent());
+	// And the connections of this region.
+	std::vector<gd::Polygon> &region_polygons = p_region->get_polygons();
+	for (size_t poly_id(0); poly_id < region_polygons.size(); poly_id++) {
+		for (size_t e(0); e < region_polygons[poly_id].edges.size(); e++) {
+			region_polygons[poly_id].edges[e].connections.clear();
 		}
-		rvo.buildAgentTree(raw_agents);
 	}
+	p_region->get_connections().clear();
+	p_region->get_free_edges().clear();
+	p_region->set_linked(false);
+	polygons_changed = true;
+}
 
-	regenerate_polygons = false;
-	regenerate_links = false;
-	agents_dirty = false;
+void NavMap::link_clusters() {
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		clusters[i].center = Vector3();
+		clusters[i].links.clear();
+	}
+
+	LocalVector<uint32_t> cluster_sizes;
+	cluster_sizes.resize(clusters.size());
+	memset(cluster_sizes.ptr(), 0, clusters.size() * sizeof(uint32_t));
+
+	for (size_t poly_id(0); poly_id < polygons.size(); poly_id++) {
+		const gd::Polygon &poly = *polygons[poly_id];
+		const uint32_t cluster_id = get_polygon_cluster(&poly);
+		gd::Cluster &cluster = clusters[cluster_id];
+		cluster.owner = poly.owner;
+		cluster.center += poly.center;
+		cluster_sizes[cluster_id]++;
+
+		// Two clusters are linked when any of their polygons are connected.
+		for (size_t e(0); e < poly.edges.size(); e++) {
+			const gd::Edge &edge = poly.edges[e];
+			for (int c = 0; c < edge.connections.size(); c++) {
+				const uint32_t other_cluster = get_polygon_cluster(edge.connections[c].polygon);
+				if (other_cluster != cluster_id && cluster.links.find(other_cluster) == -1) {
+					cluster.links.push_back(other_cluster);
+				}
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < clusters.size(); i++) {
+		if (cluster_sizes[i] > 0) {
+			clusters[i].center /= cluster_sizes[i];
+		}
+	}
 }
 
-void NavMap::compute_single_step(uint32_t index, RvoAgent **agent) {
-	(*(agent + index))->get_agent()->computeNeighbors(&rvo);
-	(*(agent + index))->get_agent()->computeNewVelocity(deltatime);
+void NavMap::compute_agents_chunk(uint32_t p_chunk_index, void *p_userdata) {
+	const uint32_t from = p_chunk_index * AGENTS_PER_CHUNK;
+	const uint32_t to = MIN(from + AGENTS_PER_CHUNK, controlled_rvo_agent_count);
+
+	// Agents only write their own neighbours and new velocity, so chunks never conflict.
+	for (uint32_t i = from; i < to; i++) {
+		rvo_agents[i].computeNeighbors(&rvo);
+	}
+	for (uint32_t i = from; i < to; i++) {
+		rvo_agents[i].computeNewVelocity(deltatime);
+		rvo_agent_owners[i]->get_agent()->newVelocity_ = rvo_agents[i].newVelocity_;
+	}
 }
 
 void NavMap::step(real_t p_deltatime) {
 	deltatime = p_deltatime;
-	if (controlled_agents.size() > 0) {
-		thread_process_array(
-				controlled_agents.size(),
-				this,
-				&NavMap::compute_single_step,
-				controlled_agents.data());
+	if (controlled_rvo_agent_count > 0) {
+		const uint32_t chunk_count = (controlled_rvo_agent_count + AGENTS_PER_CHUNK - 1) / AGENTS_PER_CHUNK;
+		step_work_pool.do_work(chunk_count, this, &NavMap::compute_agents_chunk, nullptr);
 	}
 }
 
@@ -34,8 +34,13 @@
 #include "nav_rid.h"
 
 #include "core/math/math_defs.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/lru.h"
 #include "core/templates/map.h"
+#include "core/templates/thread_work_pool.h"
 #include "nav_utils.h"
+#include <Agent.h>
 #include <KdTree.h>
 
 /**
@@ -57,13 +62,26 @@ class NavMap : public NavRid {
 	/// This value is used to detect the near edges to connect.
 	real_t edge_connection_margin = 5.0;
 
+	/// The margin the current links were made with, until the next full relink.
+	real_t linked_edge_connection_margin = 5.0;
+
 	bool regenerate_polygons = true;
 	bool regenerate_links = true;
 
+	/// Are regions added, removed or relinked since the last sync?
+	bool polygons_changed = false;
+
 	std::vector<NavRegion *> regions;
 
-	/// Map polygons
-	std::vector<gd::Polygon> polygons;
+	/// Map polygons, owned by the regions.
+	std::vector<gd::Polygon *> polygons;
+
+	/// Clusters of neighbour polygons, searched before the polygons on long paths.
+	LocalVector<gd::Cluster> clusters;
+
+	/// Recently found corridors, keyed by begin and end polygon ids.
+	mutable Mutex path_cache_mutex;
+	mutable LRUCache<uint64_t, gd::PathCorridor> path_cache;
 
 	/// Rvo world
 	RVO::KdTree rvo;
@@ -71,12 +89,30 @@ class NavMap : public NavRid {
 	/// Is agent array modified?
 	bool agents_dirty = false;
 
+	/// Is controlled agent array modified?
+	bool controlled_agents_dirty = false;
+
+	/// Steps the agent tree was refitted instead of rebuilt.
+	uint32_t agent_tree_refits = 0;
+
 	/// All the Agents (even the controlled one)
 	std::vector<RvoAgent *> agents;
 
 	/// Controlled agents
 	std::vector<RvoAgent *> controlled_agents;
 
+	/// The RVO state of every agent, stored by value and copied from the agents on sync,
+	/// so the avoidance step walks a single array. The controlled agents come first.
+	std::vector<RVO::Agent> rvo_agents;
+
+	/// The agent each entry of `rvo_agents` is copied from.
+	LocalVector<RvoAgent *> rvo_agent_owners;
+
+	/// Controlled agents at the start of `rvo_agents`.
+	uint32_t controlled_rvo_agent_count = 0;
+
+	ThreadWorkPool step_work_pool;
+
 	/// Physics delta time
 	real_t deltatime = 0.0;
 
@@ -84,7 +120,7 @@ class NavMap : public NavRid {
 	uint32_t map_update_id = 0;
 
 public:
-	NavMap() {}
+	NavMap();
 
 	void set_up(Vector3 p_up);
 	Vector3 get_up() const {
@@ -125,16 +161,36 @@ public:
 	void set_agent_as_controlled(RvoAgent *agent);
 	void remove_agent_as_controlled(RvoAgent *agent);
 
+	/// The state used by the avoidance step for this agent, or null before the agent is synced.
+	const RVO::Agent *get_rvo_agent(const RvoAgent *p_agent) const;
+
 	uint32_t get_map_update_id() const {
 		return map_update_id;
 	}
 
+	void set_path_cache_size(int p_size);
+	void clear_path_cache();
+
 	void sync();
 	void step(real_t p_deltatime);
 	void dispatch_callbacks();
 
 private:
-	void compute_single_step(uint32_t index, RvoAgent **agent);
+	bool find_cluster_corridor(uint32_t p_begin_cluster, uint32_t p_end_cluster, uint32_t p_layers, LocalVector<uint8_t> &r_allowed_clusters) const;
+	bool find_polygon_corridor(const gd::Polygon *p_begin_poly, const Vector3 &p_begin_point, const gd::Polygon *p_end_poly, const Vector3 &p_end_point, const Vector3 &p_destination, uint32_t p_layers, const uint8_t *p_allowed_clusters, std::vector<gd::NavigationPoly> &r_navigation_polys, int &r_least_cost_id) const;
+	bool get_cached_corridor(uint64_t p_key, uint32_t p_layers, const Vector3 &p_begin_point, std::vector<gd::NavigationPoly> &r_navigation_polys) const;
+	void cache_corridor(uint64_t p_key, uint32_t p_layers, const std::vector<gd::NavigationPoly> &p_navigation_polys, int p_end_id) const;
+	bool is_edge_shared(const gd::Edge::Connection &p_edge) const;
+	void connect_free_edges(const gd::Edge::Connection &p_free_edge, const gd::Edge::Connection &p_other_edge) const;
+	void get_linked_neighbours(const NavRegion *p_region, LocalVector<NavRegion *> &r_neighbours) const;
+	void link_region(NavRegion *p_region);
+	void unlink_region(NavRegion *p_region);
+	void publish_polygons();
+	void link_clusters();
+
+	void pack_rvo_agents();
+	void update_agent_tree();
+	void compute_agents_chunk(uint32_t p_chunk_index, void *p_userdata);
 	void clip_path(const std::vector<gd::NavigationPoly> &p_navigation_polys, Vector<Vector3> &path, const gd::NavigationPoly *from_poly, const Vector3 &p_to_point, const gd::NavigationPoly *p_to_poly) const;
 };
 
@@ -0,0 +1,58 @@
+/*************************************************************************/
+/*  nav_path_query.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef NAV_PATH_QUERY_H
+#define NAV_PATH_QUERY_H
+
+#include "nav_rid.h"
+
+#include "core/math/vector3.h"
+#include "core/templates/vector.h"
+
+class NavMap;
+
+/// A path request solved asynchronously by the navigation server.
+class NavPathQuery : public NavRid {
+public:
+	RID map;
+	Vector3 origin;
+	Vector3 destination;
+	bool optimize = true;
+	uint32_t layers = 1;
+
+	/// Set when the query is taken from the pending list, for the duration of the solve.
+	const NavMap *map_ptr = nullptr;
+
+	/// The results, written by the server once the query is solved.
+	bool done = false;
+	Vector<Vector3> path;
+};
+
+#endif // NAV_PATH_QUERY_H
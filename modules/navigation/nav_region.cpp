@@ -32,10 +32,14 @@
 
 #include "nav_map.h"
 
+#include "core/templates/map.h"
+
 /**
 	@author AndreaCatania
 */
 
+#define CLUSTER_MAX_POLYGONS 32
+
 void NavRegion::set_map(NavMap *p_map) {
 	map = p_map;
 	polygons_dirty = true;
@@ -46,6 +50,10 @@ void NavRegion::set_map(NavMap *p_map) {
 
 void NavRegion::set_layers(uint32_t p_layers) {
 	layers = p_layers;
+	if (map) {
+		// Cached paths may cross this region with the old layers.
+		map->clear_path_cache();
+	}
 }
 
 uint32_t NavRegion::get_layers() const {
@@ -94,6 +102,9 @@ void NavRegion::update_polygons() {
 		return;
 	}
 	polygons.clear();
+	free_edges.clear();
+	cluster_count = 0;
+	aabb = AABB();
 	polygons_dirty = false;
 
 	if (map == nullptr) {
@@ -139,6 +150,12 @@ void NavRegion::update_polygons() {
 			p.points[j].pos = point_position;
 			p.points[j].key = map->get_point_key(point_position);
 
+			if (i == 0 && j == 0) {
+				aabb.position = point_position;
+			} else {
+				aabb.expand_to(point_position);
+			}
+
 			center += point_position; // Composing the center of the polygon
 
 			if (j >= 2) {
@@ -158,4 +175,54 @@ void NavRegion::update_polygons() {
 			p.center = center / float(mesh_poly.size());
 		}
 	}
+
+	update_clusters();
+}
+
+void NavRegion::update_clusters() {
+	// Polygons of this region sharing an edge are neighbours.
+	LocalVector<LocalVector<uint32_t>> neighbours;
+	neighbours.resize(polygons.size());
+	Map<gd::EdgeKey, uint32_t> edge_polygons;
+	for (uint32_t i = 0; i < polygons.size(); i++) {
+		const gd::Polygon &p = polygons[i];
+		for (size_t j = 0; j < p.points.size(); j++) {
+			gd::EdgeKey ek(p.points[j].key, p.points[(j + 1) % p.points.size()].key);
+			Map<gd::EdgeKey, uint32_t>::Element *E = edge_polygons.find(ek);
+			if (E) {
+				neighbours[i].push_back(E->get());
+				neighbours[E->get()].push_back(i);
+			} else {
+				edge_polygons.insert(ek, i);
+			}
+		}
+		polygons[i].cluster = UINT32_MAX;
+	}
+
+	// Grow each cluster breadth first, so it stays compact.
+	LocalVector<uint32_t> to_visit;
+	for (uint32_t seed = 0; seed < polygons.size(); seed++) {
+		if (polygons[seed].cluster != UINT32_MAX) {
+			continue;
+		}
+
+		uint32_t cluster_size = 1;
+		polygons[seed].cluster = cluster_count;
+		to_visit.clear();
+		to_visit.push_back(seed);
+
+		for (uint32_t i = 0; i < to_visit.size() && cluster_size < CLUSTER_MAX_POLYGONS; i++) {
+			const LocalVector<uint32_t> &poly_neighbours = neighbours[to_visit[i]];
+			for (uint32_t j = 0; j < poly_neighbours.size() && cluster_size < CLUSTER_MAX_POLYGONS; j++) {
+				gd::Polygon &neighbour = polygons[poly_neighbours[j]];
+				if (neighbour.cluster == UINT32_MAX) {
+					neighbour.cluster = cluster_count;
+					to_visit.push_back(poly_neighbours[j]);
+					cluster_size++;
+				}
+			}
+		}
+
+		cluster_count++;
+	}
 }
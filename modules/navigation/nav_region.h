@@ -56,6 +56,21 @@ class NavRegion : public NavRid {
 	/// Cache
 	std::vector<gd::Polygon> polygons;
 
+	/// Number of polygon clusters in this region, see `update_clusters`.
+	uint32_t cluster_count = 0;
+
+	/// Id of the first cluster of this region in the map.
+	uint32_t cluster_offset = 0;
+
+	/// Bounds of the polygons.
+	AABB aabb;
+
+	/// Is this region connected to the other regions of the map?
+	bool linked = false;
+
+	/// The edges not shared by two polygons of this region, set by the map when it links the region.
+	LocalVector<gd::Edge::Connection> free_edges;
+
 public:
 	NavRegion() {}
 
@@ -91,11 +106,45 @@ public:
 	std::vector<gd::Polygon> const &get_polygons() const {
 		return polygons;
 	}
+	std::vector<gd::Polygon> &get_polygons() {
+		return polygons;
+	}
+
+	bool is_dirty() const {
+		return polygons_dirty;
+	}
+
+	const AABB &get_aabb() const {
+		return aabb;
+	}
+
+	uint32_t get_cluster_count() const {
+		return cluster_count;
+	}
+
+	void set_cluster_offset(uint32_t p_cluster_offset) {
+		cluster_offset = p_cluster_offset;
+	}
+	uint32_t get_cluster_offset() const {
+		return cluster_offset;
+	}
+
+	void set_linked(bool p_linked) {
+		linked = p_linked;
+	}
+	bool is_linked() const {
+		return linked;
+	}
+
+	LocalVector<gd::Edge::Connection> &get_free_edges() {
+		return free_edges;
+	}
 
 	bool sync();
 
 private:
 	void update_polygons();
+	void update_clusters();
 };
 
 #endif // NAV_REGION_H
@@ -32,6 +32,7 @@
 #define NAV_UTILS_H
 
 #include "core/math/vector3.h"
+#include "core/templates/local_vector.h"
 
 #include <vector>
 
@@ -94,6 +95,12 @@ struct Edge {
 struct Polygon {
 	NavRegion *owner;
 
+	/// The index of this `Polygon` in the map.
+	uint32_t id = 0;
+
+	/// The cluster of this `Polygon` in its region.
+	uint32_t cluster = 0;
+
 	/// The points of this `Polygon`
 	std::vector<Point> points;
 
@@ -107,6 +114,31 @@ struct Polygon {
 	Vector3 center;
 };
 
+/// A group of neighbour polygons of the same region, used as a node of the coarse path search.
+struct Cluster {
+	NavRegion *owner = nullptr;
+
+	/// The average of the polygon centers.
+	Vector3 center;
+
+	/// The clusters this one has at least a polygon connection with.
+	LocalVector<uint32_t> links;
+};
+
+/// A polygon of a cached path, with the pathway used to enter it.
+struct CorridorPoly {
+	uint32_t polygon = 0;
+	uint32_t back_navigation_edge = UINT32_MAX;
+	Vector3 back_navigation_edge_pathway_start;
+	Vector3 back_navigation_edge_pathway_end;
+};
+
+/// The polygons crossed by a path, from the begin polygon to the end one.
+struct PathCorridor {
+	uint32_t layers = 0;
+	LocalVector<CorridorPoly> polys;
+};
+
 struct NavigationPoly {
 	uint32_t self_id = 0;
 	/// This poly.
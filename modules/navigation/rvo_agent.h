@@ -55,6 +55,9 @@ class RvoAgent : public NavRid {
 	AvoidanceComputedCallback callback;
 	uint32_t map_update_id = 0;
 
+	/// Index of this agent's state in the packed agents of its map.
+	uint32_t map_agent_index = UINT32_MAX;
+
 public:
 	RvoAgent();
 
@@ -69,6 +72,13 @@ public:
 
 	bool is_map_changed();
 
+	void set_map_agent_index(uint32_t p_index) {
+		map_agent_index = p_index;
+	}
+	uint32_t get_map_agent_index() const {
+		return map_agent_index;
+	}
+
 	void set_callback(ObjectID p_id, const StringName p_method, const Variant p_udata = Variant());
 	bool has_callback() const;
 
@@ -0,0 +1,437 @@
+/*************************************************************************/
+/*  test_navigation_server.h                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_NAVIGATION_SERVER_H
+#define TEST_NAVIGATION_SERVER_H
+
+#include "core/os/os.h"
+#include "modules/navigation/mesh_navigation_server.h"
+#include "modules/navigation/nav_map.h"
+#include "modules/navigation/rvo_agent.h"
+#include "scene/resources/navigation_mesh.h"
+
+#include "tests/test_macros.h"
+
+namespace TestNavigationServer {
+
+// A flat grid of 1x1 quads, from p_offset to p_offset + (p_size, 0, p_size).
+static Ref<NavigationMesh> create_grid_mesh(int p_size, const Vector3 &p_offset = Vector3()) {
+	Ref<NavigationMesh> mesh;
+	mesh.instantiate();
+
+	Vector<Vector3> vertices;
+	for (int z = 0; z <= p_size; z++) {
+		for (int x = 0; x <= p_size; x++) {
+			vertices.push_back(p_offset + Vector3(x, 0, z));
+		}
+	}
+	mesh->set_vertices(vertices);
+
+	for (int z = 0; z < p_size; z++) {
+		for (int x = 0; x < p_size; x++) {
+			Vector<int> polygon;
+			polygon.push_back(z * (p_size + 1) + x);
+			polygon.push_back(z * (p_size + 1) + x + 1);
+			polygon.push_back((z + 1) * (p_size + 1) + x + 1);
+			polygon.push_back((z + 1) * (p_size + 1) + x);
+			mesh->add_polygon(polygon);
+		}
+	}
+
+	return mesh;
+}
+
+static void check_path_ends(const Vector<Vector3> &p_path, const Vector3 &p_origin, const Vector3 &p_destination) {
+	REQUIRE(p_path.size() >= 2);
+	CHECK(p_path[0].is_equal_approx(p_origin));
+	CHECK(p_path[p_path.size() - 1].is_equal_approx(p_destination));
+}
+
+TEST_CASE("[NavigationServer] Path across many polygon clusters") {
+	MeshNavigationServer *server = memnew(MeshNavigationServer);
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	RID region = server->region_create();
+	server->region_set_map(region, map);
+	server->region_set_navmesh(region, create_grid_mesh(40));
+	server->process(0.0);
+
+	const Vector3 origin(0.5, 0, 0.5);
+	const Vector3 destination(39.5, 0, 20.5);
+
+	const Vector<Vector3> path = server->map_get_path(map, origin, destination, true);
+	check_path_ends(path, origin, destination);
+
+	SUBCASE("Cached paths match the searched ones") {
+		CHECK(server->map_get_path(map, origin, destination, true) == path);
+
+		const Vector<Vector3> raw_path = server->map_get_path(map, origin, destination, false);
+		check_path_ends(raw_path, origin, destination);
+		CHECK(server->map_get_path(map, origin, destination, false) == raw_path);
+	}
+
+	SUBCASE("Cached corridors adapt to new end points in the same polygons") {
+		const Vector3 other_origin(0.25, 0, 0.75);
+		const Vector3 other_destination(39.75, 0, 20.25);
+		check_path_ends(server->map_get_path(map, other_origin, other_destination, true), other_origin, other_destination);
+	}
+
+	server->free(region);
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+TEST_CASE("[NavigationServer] Paths only cross regions with compatible layers") {
+	MeshNavigationServer *server = memnew(MeshNavigationServer);
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	RID regions[3];
+	for (int i = 0; i < 3; i++) {
+		regions[i] = server->region_create();
+		server->region_set_map(regions[i], map);
+		server->region_set_navmesh(regions[i], create_grid_mesh(10, Vector3(i * 10, 0, 0)));
+	}
+	server->process(0.0);
+
+	const Vector3 origin(0.5, 0, 5.5);
+	const Vector3 destination(29.5, 0, 5.5);
+	check_path_ends(server->map_get_path(map, origin, destination, true), origin, destination);
+
+	// With the middle region on another layer, the path stops at the edge of the first region.
+	server->region_set_layers(regions[1], 2);
+	server->process(0.0);
+	const Vector<Vector3> path = server->map_get_path(map, origin, destination, true);
+	REQUIRE(path.size() >= 2);
+	CHECK(path[path.size() - 1].x <= 10.0 + CMP_EPSILON);
+
+	for (int i = 0; i < 3; i++) {
+		server->free(regions[i]);
+	}
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+TEST_CASE("[NavigationServer] Asynchronous path queries") {
+	MeshNavigationServer *server = memnew(MeshNavigationServer);
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	RID region = server->region_create();
+	server->region_set_map(region, map);
+	server->region_set_navmesh(region, create_grid_mesh(20));
+	server->process(0.0);
+
+	const int query_count = 200;
+	Vector<RID> queries;
+	for (int i = 0; i < query_count; i++) {
+		const Vector3 origin(0.5 + (i % 20), 0, 0.5);
+		const Vector3 destination(19.5 - (i % 20), 0, 19.5);
+		queries.push_back(server->map_query_path(map, origin, destination, true));
+	}
+	CHECK_FALSE(server->path_query_is_done(queries[0]));
+	CHECK(server->path_query_get_path(queries[0]).is_empty());
+
+	// Every frame solves at least one batch, whatever the budget.
+	for (int frame = 0; frame < query_count && !server->path_query_is_done(queries[query_count - 1]); frame++) {
+		server->process(0.0);
+	}
+
+	for (int i = 0; i < query_count; i++) {
+		REQUIRE(server->path_query_is_done(queries[i]));
+		const Vector3 origin(0.5 + (i % 20), 0, 0.5);
+		const Vector3 destination(19.5 - (i % 20), 0, 19.5);
+		CHECK(server->path_query_get_path(queries[i]) == server->map_get_path(map, origin, destination, true));
+		server->free(queries[i]);
+	}
+
+	// Queries on a freed map complete with an empty path.
+	RID query = server->map_query_path(map, Vector3(0.5, 0, 0.5), Vector3(19.5, 0, 19.5), true);
+	server->free(region);
+	server->free(map);
+	server->process(0.0);
+	CHECK(server->path_query_is_done(query));
+	CHECK(server->path_query_get_path(query).is_empty());
+	server->free(query);
+	server->process(0.0);
+
+	memdelete(server);
+}
+
+TEST_CASE("[NavigationServer] Regions are relinked when they change") {
+	MeshNavigationServer *server = memnew(MeshNavigationServer);
+
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+	server->map_set_edge_connection_margin(map, 1.0);
+
+	// Three regions in a row, with a gap of half a unit between the second and the third.
+	RID regions[3];
+	const Vector3 offsets[3] = { Vector3(0, 0, 0), Vector3(10, 0, 0), Vector3(20.5, 0, 0) };
+	for (int i = 0; i < 3; i++) {
+		regions[i] = server->region_create();
+		server->region_set_map(regions[i], map);
+		server->region_set_navmesh(regions[i], create_grid_mesh(10, offsets[i]));
+	}
+	server->process(0.0);
+
+	const Vector3 origin(0.5, 0, 5.5);
+	const Vector3 destination(29.5, 0, 5.5);
+	check_path_ends(server->map_get_path(map, origin, destination, true), origin, destination);
+
+	// Only the edges welded across the gap are region connections.
+	const int gap_connections = server->region_get_connections_count(regions[2]);
+	CHECK(server->region_get_connections_count(regions[0]) == 0);
+	CHECK(server->region_get_connections_count(regions[1]) == gap_connections);
+	CHECK(gap_connections >= 10);
+
+	SUBCASE("Removing a region disconnects its neighbours") {
+		server->region_set_map(regions[1], RID());
+		server->process(0.0);
+		CHECK(server->region_get_connections_count(regions[2]) == 0);
+		const Vector<Vector3> path = server->map_get_path(map, origin, destination, true);
+		REQUIRE(path.size() >= 2);
+		CHECK(path[path.size() - 1].x <= 10.0 + CMP_EPSILON);
+
+		server->region_set_map(regions[1], map);
+		server->process(0.0);
+		CHECK(server->region_get_connections_count(regions[2]) == gap_connections);
+		check_path_ends(server->map_get_path(map, origin, destination, true), origin, destination);
+	}
+
+	SUBCASE("Moving a region relinks it") {
+		// Out of the margin of the third region.
+		server->region_set_transform(regions[2], Transform3D(Basis(), Vector3(2, 0, 0)));
+		server->process(0.0);
+		CHECK(server->region_get_connections_count(regions[1]) == 0);
+		CHECK(server->region_get_connections_count(regions[2]) == 0);
+
+		server->region_set_transform(regions[2], Transform3D());
+		server->process(0.0);
+		CHECK(server->region_get_connections_count(regions[1]) == gap_connections);
+		check_path_ends(server->map_get_path(map, origin, destination, true), origin, destination);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		server->free(regions[i]);
+	}
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+static RvoAgent *create_agent(NavMap *p_map, const Vector3 &p_position) {
+	RvoAgent *agent = memnew(RvoAgent);
+	RVO::Agent *rvo_agent = agent->get_agent();
+	rvo_agent->position_ = RVO::Vector3(p_position.x, p_position.y, p_position.z);
+	rvo_agent->neighborDist_ = 2.0;
+	rvo_agent->maxNeighbors_ = 10;
+	rvo_agent->radius_ = 0.5;
+	rvo_agent->maxSpeed_ = 1.0;
+	rvo_agent->timeHorizon_ = 1.0;
+	agent->set_map(p_map);
+	p_map->add_agent(agent);
+	return agent;
+}
+
+TEST_CASE("[NavigationServer] Avoidance finds agents that moved since the agent tree was built") {
+	NavMap *map = memnew(NavMap);
+
+	// Far apart, so every agent starts without neighbours.
+	Vector<RvoAgent *> agents;
+	for (int i = 0; i < 40; i++) {
+		RvoAgent *agent = create_agent(map, Vector3(i * 10, 0, 0));
+		map->set_agent_as_controlled(agent);
+		agents.push_back(agent);
+	}
+	map->sync();
+	map->step(0.1);
+	REQUIRE(map->get_rvo_agent(agents[39]) != nullptr);
+	CHECK(map->get_rvo_agent(agents[39])->agentNeighbors_.size() == 0);
+
+	// Only positions change, so the tree is refitted instead of rebuilt.
+	agents[0]->get_agent()->position_ = RVO::Vector3(390.5, 0, 0);
+	map->sync();
+	map->step(0.1);
+	REQUIRE(map->get_rvo_agent(agents[39])->agentNeighbors_.size() == 1);
+	CHECK(map->get_rvo_agent(agents[39])->agentNeighbors_[0].second == map->get_rvo_agent(agents[0]));
+
+	for (int i = 0; i < agents.size(); i++) {
+		map->remove_agent(agents[i]);
+		memdelete(agents[i]);
+	}
+	memdelete(map);
+}
+
+TEST_CASE("[NavigationServer] Avoidance runs on the packed agents and writes the velocities back") {
+	NavMap *map = memnew(NavMap);
+
+	RvoAgent *controlled = create_agent(map, Vector3(0, 0, 0));
+	controlled->get_agent()->prefVelocity_ = RVO::Vector3(1, 0, 0);
+	RvoAgent *obstacle = create_agent(map, Vector3(-1.5, 0, 0));
+	map->set_agent_as_controlled(controlled);
+	map->sync();
+	map->step(0.1);
+
+	// The uncontrolled agent is packed after the controlled one and is still found as a neighbour.
+	const RVO::Agent *packed = map->get_rvo_agent(controlled);
+	REQUIRE(packed != nullptr);
+	REQUIRE(map->get_rvo_agent(obstacle) != nullptr);
+	CHECK(map->get_rvo_agent(obstacle) == packed + 1);
+	REQUIRE(packed->agentNeighbors_.size() == 1);
+	CHECK(packed->agentNeighbors_[0].second == map->get_rvo_agent(obstacle));
+
+	// Nothing is in the way, so the agent keeps its preferred velocity.
+	const RVO::Vector3 new_velocity = controlled->get_agent()->newVelocity_;
+	CHECK(new_velocity.x() == doctest::Approx(1.0));
+	CHECK(new_velocity.y() == doctest::Approx(0.0));
+	CHECK(new_velocity.z() == doctest::Approx(0.0));
+
+	// A removed agent has no packed state once the map is synced again.
+	map->remove_agent(obstacle);
+	map->sync();
+	CHECK(map->get_rvo_agent(obstacle) == nullptr);
+	CHECK(map->get_rvo_agent(controlled) != nullptr);
+
+	map->remove_agent(controlled);
+	memdelete(obstacle);
+	memdelete(controlled);
+	memdelete(map);
+}
+
+// Time spent by the avoidance step of a crowd of agents walking on a grid.
+static void benchmark_avoidance() {
+	const int count = 5000;
+	const int steps = 60;
+
+	NavMap *map = memnew(NavMap);
+	Vector<RvoAgent *> agents;
+	const int side = Math::sqrt((double)count);
+	for (int i = 0; i < count; i++) {
+		RvoAgent *agent = create_agent(map, Vector3((i % side) * 1.5, 0, (i / side) * 1.5));
+		agent->get_agent()->prefVelocity_ = RVO::Vector3(1, 0, (i % 2) ? 1 : -1);
+		map->set_agent_as_controlled(agent);
+		agents.push_back(agent);
+	}
+
+	uint64_t sync_usec = 0;
+	uint64_t step_usec = 0;
+	for (int s = 0; s < steps; s++) {
+		uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+		map->sync();
+		sync_usec += OS::get_singleton()->get_ticks_usec() - begin_usec;
+
+		begin_usec = OS::get_singleton()->get_ticks_usec();
+		map->step(1.0 / 60.0);
+		step_usec += OS::get_singleton()->get_ticks_usec() - begin_usec;
+
+		for (int i = 0; i < agents.size(); i++) {
+			RVO::Agent *agent = agents[i]->get_agent();
+			agent->velocity_ = agent->newVelocity_;
+			agent->position_ = agent->position_ + agent->velocity_ * (1.0 / 60.0);
+		}
+	}
+	print_line(vformat("Agent tree update of %d agents: %d usec", count, sync_usec / steps));
+	print_line(vformat("Avoidance step of %d agents: %d usec", count, step_usec / steps));
+
+	for (int i = 0; i < agents.size(); i++) {
+		map->remove_agent(agents[i]);
+		memdelete(agents[i]);
+	}
+	memdelete(map);
+}
+
+// Time spent syncing a map of p_width * p_depth tiles when adding or removing one tile,
+// compared to relinking the whole map.
+static void benchmark_region_sync() {
+	const int width = 50;
+	const int depth = 40;
+	const int tile_size = 4;
+
+	MeshNavigationServer *server = memnew(MeshNavigationServer);
+	RID map = server->map_create();
+	server->map_set_active(map, true);
+
+	Ref<NavigationMesh> tile = create_grid_mesh(tile_size);
+	Vector<RID> regions;
+	for (int z = 0; z < depth; z++) {
+		for (int x = 0; x < width; x++) {
+			RID region = server->region_create();
+			server->region_set_map(region, map);
+			server->region_set_transform(region, Transform3D(Basis(), Vector3(x * tile_size, 0, z * tile_size)));
+			server->region_set_navmesh(region, tile);
+			regions.push_back(region);
+		}
+	}
+
+	uint64_t begin_usec = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	print_line(vformat("Initial sync of %d regions: %d usec", regions.size(), OS::get_singleton()->get_ticks_usec() - begin_usec));
+
+	const int iterations = 20;
+	RID middle = regions[(depth / 2) * width + width / 2];
+	uint64_t remove_usec = 0;
+	uint64_t add_usec = 0;
+	for (int i = 0; i < iterations; i++) {
+		server->region_set_map(middle, RID());
+		begin_usec = OS::get_singleton()->get_ticks_usec();
+		server->process(0.0);
+		remove_usec += OS::get_singleton()->get_ticks_usec() - begin_usec;
+
+		server->region_set_map(middle, map);
+		begin_usec = OS::get_singleton()->get_ticks_usec();
+		server->process(0.0);
+		add_usec += OS::get_singleton()->get_ticks_usec() - begin_usec;
+	}
+	print_line(vformat("Remove one region: %d usec", remove_usec / iterations));
+	print_line(vformat("Add one region: %d usec", add_usec / iterations));
+
+	// Changing the margin relinks every region.
+	server->map_set_edge_connection_margin(map, 4.0);
+	begin_usec = OS::get_singleton()->get_ticks_usec();
+	server->process(0.0);
+	print_line(vformat("Relink all regions: %d usec", OS::get_singleton()->get_ticks_usec() - begin_usec));
+
+	for (int i = 0; i < regions.size(); i++) {
+		server->free(regions[i]);
+	}
+	server->free(map);
+	server->process(0.0);
+	memdelete(server);
+}
+
+REGISTER_TEST_COMMAND("navigation-region-sync-benchmark", &benchmark_region_sync);
+REGISTER_TEST_COMMAND("navigation-avoidance-benchmark", &benchmark_avoidance);
+} // namespace TestNavigationServer
+
+#endif // TEST_NAVIGATION_SERVER_H
@@ -286,6 +286,42 @@ Error OS_Windows::get_dynamic_library_symbol_handle(void *p_library_handle, cons
 	return OK;
 }
 
+Error OS_Windows::map_file(const String &p_path, const uint8_t *&r_data, uint64_t &r_size) {
+	HANDLE file = CreateFileW((LPCWSTR)(p_path.utf16().get_data()), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return ERR_FILE_CANT_OPEN;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+		CloseHandle(file);
+		return ERR_FILE_CANT_READ;
+	}
+
+	// The view keeps its own references to the file and the mapping.
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) {
+		return ERR_FILE_CANT_READ;
+	}
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data) {
+		return ERR_FILE_CANT_READ;
+	}
+
+	r_data = (const uint8_t *)data;
+	r_size = size.QuadPart;
+	return OK;
+}
+
+Error OS_Windows::unmap_file(const uint8_t *p_data, uint64_t p_size) {
+	if (!UnmapViewOfFile(p_data)) {
+		return FAILED;
+	}
+	return OK;
+}
+
 String OS_Windows::get_name() const {
 	return "Windows";
 }
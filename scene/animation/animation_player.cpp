@@ -406,6 +406,13 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, double
 	bool can_call = is_inside_tree() && !Engine::get_singleton()->is_editor_hint();
 	bool backward = signbit(p_delta);
 
+	// Compressed animations sample all their tracks in one pass, instead of one search per track.
+	if (a->is_compressed()) {
+		a->sample_compressed_tracks(p_time, compressed_samples);
+	} else {
+		compressed_samples.clear();
+	}
+
 	for (int i = 0; i < a->get_track_count(); i++) {
 		// If an animation changes this animation (or it animates itself)
 		// we need to recreate our animation cache
@@ -436,11 +443,15 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, double
 
 				Vector3 loc;
 
-				Error err = a->position_track_interpolate(i, p_time, &loc);
-				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+				if (_has_compressed_sample(i)) {
+					loc = compressed_samples[i].vector;
+				} else {
+					Error err = a->position_track_interpolate(i, p_time, &loc);
+					//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
-				if (err != OK) {
-					continue;
+					if (err != OK) {
+						continue;
+					}
 				}
 
 				if (nc->accum_pass != accum_pass) {
@@ -463,11 +474,15 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, double
 
 				Quaternion rot;
 
-				Error err = a->rotation_track_interpolate(i, p_time, &rot);
-				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+				if (_has_compressed_sample(i)) {
+					rot = compressed_samples[i].rotation;
+				} else {
+					Error err = a->rotation_track_interpolate(i, p_time, &rot);
+					//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
-				if (err != OK) {
-					continue;
+					if (err != OK) {
+						continue;
+					}
 				}
 
 				if (nc->accum_pass != accum_pass) {
@@ -490,11 +505,15 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, double
 
 				Vector3 scale;
 
-				Error err = a->scale_track_interpolate(i, p_time, &scale);
-				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+				if (_has_compressed_sample(i)) {
+					scale = compressed_samples[i].vector;
+				} else {
+					Error err = a->scale_track_interpolate(i, p_time, &scale);
+					//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
-				if (err != OK) {
-					continue;
+					if (err != OK) {
+						continue;
+					}
 				}
 
 				if (nc->accum_pass != accum_pass) {
@@ -517,11 +536,15 @@ void AnimationPlayer::_animation_process_animation(AnimationData *p_anim, double
 
 				float blend;
 
-				Error err = a->blend_shape_track_interpolate(i, p_time, &blend);
-				//ERR_CONTINUE(err!=OK); //used for testing, should be removed
+				if (_has_compressed_sample(i)) {
+					blend = compressed_samples[i].blend_shape;
+				} else {
+					Error err = a->blend_shape_track_interpolate(i, p_time, &blend);
+					//ERR_CONTINUE(err!=OK); //used for testing, should be removed
 
-				if (err != OK) {
-					continue;
+					if (err != OK) {
+						continue;
+					}
 				}
 
 				if (nc->accum_pass != accum_pass) {
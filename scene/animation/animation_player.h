@@ -180,6 +180,11 @@ private:
 	float speed_scale = 1.0;
 	float default_blend_time = 0.0;
 
+	LocalVector<Animation::TrackSample> compressed_samples;
+	_FORCE_INLINE_ bool _has_compressed_sample(int p_track) const {
+		return p_track < (int)compressed_samples.size() && compressed_samples[p_track].valid;
+	}
+
 	struct AnimationData {
 		String name;
 		StringName next;
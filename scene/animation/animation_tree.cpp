@@ -32,10 +32,16 @@
 
 #include "animation_blend_tree.h"
 #include "core/config/engine.h"
+#include "core/config/project_settings.h"
+#include "core/object/message_queue.h"
 #include "scene/resources/animation.h"
 #include "scene/scene_string_names.h"
 #include "servers/audio/audio_stream.h"
 
+LocalVector<AnimationTree *> AnimationTree::blend_queue;
+AnimationTree *AnimationTree::blend_queue_flusher = nullptr;
+ThreadWorkPool AnimationTree::blend_pool;
+
 void AnimationNode::get_parameter_list(List<PropertyInfo> *r_list) const {
 	Array parameters;
 
@@ -524,6 +530,8 @@ AnimationTree::AnimationProcessCallback AnimationTree::get_process_callback() co
 }
 
 void AnimationTree::_node_removed(Node *p_node) {
+	// The queued pose may target the removed node.
+	_cancel_blend();
 	cache_valid = false;
 }
 
@@ -770,22 +778,45 @@ bool AnimationTree::_update_caches(AnimationPlayer *player) {
 	}
 
 	state.track_map.clear();
+	pose_transforms.clear();
+	pose_blend_shapes.clear();
 
 	K = nullptr;
 	int idx = 0;
 	while ((K = track_cache.next(K))) {
 		state.track_map[*K] = idx;
 		idx++;
+
+		TrackCache *tc = track_cache[*K];
+		if (tc->type == Animation::TYPE_POSITION_3D) {
+			TrackCacheTransform *t = static_cast<TrackCacheTransform *>(tc);
+			t->pose_index = pose_transforms.size();
+			pose_transforms.push_back(t);
+		} else if (tc->type == Animation::TYPE_BLEND_SHAPE) {
+			TrackCacheBlendShape *t = static_cast<TrackCacheBlendShape *>(tc);
+			t->pose_index = pose_blend_shapes.size();
+			pose_blend_shapes.push_back(t);
+		}
 	}
 
 	state.track_count = idx;
 
+	pose_locs.resize(pose_transforms.size());
+	pose_rots.resize(pose_transforms.size());
+	pose_rot_blend_accums.resize(pose_transforms.size());
+	pose_scales.resize(pose_transforms.size());
+	pose_blend_shape_values.resize(pose_blend_shapes.size());
+
 	cache_valid = true;
 
 	return true;
 }
 
 void AnimationTree::_clear_caches() {
+	_cancel_blend();
+	pose_transforms.clear();
+	pose_blend_shapes.clear();
+
 	const NodePath *K = nullptr;
 	while ((K = track_cache.next(K))) {
 		memdelete(track_cache[*K]);
@@ -796,7 +827,14 @@ void AnimationTree::_clear_caches() {
 	cache_valid = false;
 }
 
-void AnimationTree::_process_graph(real_t p_delta) {
+void AnimationTree::_process_graph(real_t p_delta, bool p_defer_pose) {
+	if (blend_queued) {
+		// Processed twice before the queue was flushed, finish the previous pass first.
+		_cancel_blend();
+		_blend_pose();
+		_apply_pose();
+	}
+
 	_update_properties(); //if properties need updating, update them
 
 	//check all tracks, see if they need modification
@@ -865,6 +903,8 @@ void AnimationTree::_process_graph(real_t p_delta) {
 		state.last_pass = process_pass;
 		state.tree = this;
 
+		blend_program.clear();
+
 		// root source blends
 
 		root->blends.resize(state.track_count);
@@ -1014,14 +1054,7 @@ void AnimationTree::_process_graph(real_t p_delta) {
 							prev_time = !backward ? 0 : (double)a->get_length();
 
 						} else {
-							Vector3 loc;
-
-							Error err = a->position_track_interpolate(i, time, &loc);
-							if (err != OK) {
-								continue;
-							}
-
-							t->loc = t->loc.lerp(loc, blend);
+							blend_program.push_back({ a, time, blend, i, t->pose_index, ttype });
 						}
 #endif // _3D_DISABLED
 					} break;
@@ -1110,21 +1143,7 @@ void AnimationTree::_process_graph(real_t p_delta) {
 							prev_time = !backward ? 0 : (double)a->get_length();
 
 						} else {
-							Quaternion rot;
-
-							Error err = a->rotation_track_interpolate(i, time, &rot);
-							if (err != OK) {
-								continue;
-							}
-
-							if (t->rot_blend_accum == 0) {
-								t->rot = rot;
-								t->rot_blend_accum = blend;
-							} else {
-								real_t rot_total = t->rot_blend_accum + blend;
-								t->rot = rot.slerp(t->rot, t->rot_blend_accum / rot_total).normalized();
-								t->rot_blend_accum = rot_total;
-							}
+							blend_program.push_back({ a, time, blend, i, t->pose_index, ttype });
 						}
 #endif // _3D_DISABLED
 					} break;
@@ -1210,36 +1229,16 @@ void AnimationTree::_process_graph(real_t p_delta) {
 							prev_time = !backward ? 0 : (double)a->get_length();
 
 						} else {
-							Vector3 scale;
-
-							Error err = a->scale_track_interpolate(i, time, &scale);
-							if (err != OK) {
-								continue;
-							}
-
-							t->scale = t->scale.lerp(scale, blend);
+							blend_program.push_back({ a, time, blend, i, t->pose_index, ttype });
 						}
 #endif // _3D_DISABLED
 					} break;
 					case Animation::TYPE_BLEND_SHAPE: {
 #ifndef _3D_DISABLED
 						TrackCacheBlendShape *t = static_cast<TrackCacheBlendShape *>(track);
+						t->process_pass = process_pass;
 
-						if (t->process_pass != process_pass) {
-							t->process_pass = process_pass;
-							t->value = 0;
-						}
-
-						float value;
-
-						Error err = a->blend_shape_track_interpolate(i, time, &value);
-						//ERR_CONTINUE(err!=OK); //used for testing, should be removed
-
-						if (err != OK) {
-							continue;
-						}
-
-						t->value = Math::lerp(t->value, value, (float)blend);
+						blend_program.push_back({ a, time, blend, i, t->pose_index, ttype });
 #endif // _3D_DISABLED
 					} break;
 					case Animation::TYPE_VALUE: {
@@ -1522,43 +1521,13 @@ void AnimationTree::_process_graph(real_t p_delta) {
 #ifndef _3D_DISABLED
 					TrackCacheTransform *t = static_cast<TrackCacheTransform *>(track);
 
+					// The other transforms are set by _apply_pose().
 					if (t->root_motion) {
 						Transform3D xform;
 						xform.origin = t->loc;
 						xform.basis.set_quaternion_scale(t->rot, t->scale);
 
 						root_motion_transform = xform;
-
-					} else if (t->skeleton && t->bone_idx >= 0) {
-						if (t->loc_used) {
-							t->skeleton->set_bone_pose_position(t->bone_idx, t->loc);
-						}
-						if (t->rot_used) {
-							t->skeleton->set_bone_pose_rotation(t->bone_idx, t->rot);
-						}
-						if (t->scale_used) {
-							t->skeleton->set_bone_pose_scale(t->bone_idx, t->scale);
-						}
-
-					} else if (!t->skeleton) {
-						if (t->loc_used) {
-							t->node_3d->set_position(t->loc);
-						}
-						if (t->rot_used) {
-							t->node_3d->set_rotation(t->rot.get_euler());
-						}
-						if (t->scale_used) {
-							t->node_3d->set_scale(t->scale);
-						}
-					}
-#endif // _3D_DISABLED
-				} break;
-				case Animation::TYPE_BLEND_SHAPE: {
-#ifndef _3D_DISABLED
-					TrackCacheBlendShape *t = static_cast<TrackCacheBlendShape *>(track);
-
-					if (t->mesh_3d) {
-						t->mesh_3d->set_blend_shape_value(t->shape_index, t->value);
 					}
 #endif // _3D_DISABLED
 				} break;
@@ -1579,6 +1548,176 @@ void AnimationTree::_process_graph(real_t p_delta) {
 			}
 		}
 	}
+
+	if (p_defer_pose) {
+		_queue_blend();
+	} else {
+		_blend_pose();
+		_apply_pose();
+	}
+}
+
+void AnimationTree::_blend_pose() {
+	for (uint32_t i = 0; i < pose_locs.size(); i++) {
+		pose_locs[i] = Vector3();
+		pose_rots[i] = Quaternion();
+		pose_rot_blend_accums[i] = 0;
+		pose_scales[i] = Vector3(1, 1, 1);
+	}
+	for (uint32_t i = 0; i < pose_blend_shape_values.size(); i++) {
+		pose_blend_shape_values[i] = 0;
+	}
+
+	for (uint32_t i = 0; i < blend_program.size(); i++) {
+		const BlendOp &op = blend_program[i];
+
+		switch (op.type) {
+			case Animation::TYPE_POSITION_3D: {
+				Vector3 loc;
+				if (op.animation->position_track_interpolate(op.track, op.time, &loc) != OK) {
+					continue;
+				}
+				pose_locs[op.pose_index] = pose_locs[op.pose_index].lerp(loc, op.blend);
+			} break;
+			case Animation::TYPE_ROTATION_3D: {
+				Quaternion rot;
+				if (op.animation->rotation_track_interpolate(op.track, op.time, &rot) != OK) {
+					continue;
+				}
+				real_t &rot_blend_accum = pose_rot_blend_accums[op.pose_index];
+				if (rot_blend_accum == 0) {
+					pose_rots[op.pose_index] = rot;
+					rot_blend_accum = op.blend;
+				} else {
+					real_t rot_total = rot_blend_accum + op.blend;
+					pose_rots[op.pose_index] = rot.slerp(pose_rots[op.pose_index], rot_blend_accum / rot_total).normalized();
+					rot_blend_accum = rot_total;
+				}
+			} break;
+			case Animation::TYPE_SCALE_3D: {
+				Vector3 scale;
+				if (op.animation->scale_track_interpolate(op.track, op.time, &scale) != OK) {
+					continue;
+				}
+				pose_scales[op.pose_index] = pose_scales[op.pose_index].lerp(scale, op.blend);
+			} break;
+			case Animation::TYPE_BLEND_SHAPE: {
+				float value;
+				if (op.animation->blend_shape_track_interpolate(op.track, op.time, &value) != OK) {
+					continue;
+				}
+				pose_blend_shape_values[op.pose_index] = Math::lerp(pose_blend_shape_values[op.pose_index], value, (float)op.blend);
+			} break;
+			default: {
+			}
+		}
+	}
+}
+
+void AnimationTree::_apply_pose() {
+#ifndef _3D_DISABLED
+	for (uint32_t i = 0; i < pose_transforms.size(); i++) {
+		TrackCacheTransform *t = pose_transforms[i];
+		if (t->process_pass != process_pass || t->root_motion) {
+			continue;
+		}
+
+		if (t->skeleton && t->bone_idx >= 0) {
+			if (t->loc_used) {
+				t->skeleton->set_bone_pose_position(t->bone_idx, pose_locs[i]);
+			}
+			if (t->rot_used) {
+				t->skeleton->set_bone_pose_rotation(t->bone_idx, pose_rots[i]);
+			}
+			if (t->scale_used) {
+				t->skeleton->set_bone_pose_scale(t->bone_idx, pose_scales[i]);
+			}
+
+		} else if (!t->skeleton) {
+			if (t->loc_used) {
+				t->node_3d->set_position(pose_locs[i]);
+			}
+			if (t->rot_used) {
+				t->node_3d->set_rotation(pose_rots[i].get_euler());
+			}
+			if (t->scale_used) {
+				t->node_3d->set_scale(pose_scales[i]);
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < pose_blend_shapes.size(); i++) {
+		TrackCacheBlendShape *t = pose_blend_shapes[i];
+		if (t->process_pass != process_pass) {
+			continue;
+		}
+
+		if (t->mesh_3d) {
+			t->mesh_3d->set_blend_shape_value(t->shape_index, pose_blend_shape_values[i]);
+		}
+	}
+#endif // _3D_DISABLED
+}
+
+void AnimationTree::_queue_blend() {
+	if (blend_queued) {
+		return;
+	}
+
+	if (blend_queue.is_empty()) {
+		blend_queue_flusher = this;
+		MessageQueue::get_singleton()->push_callable(callable_mp(this, &AnimationTree::_flush_blend_queue));
+	}
+	blend_queue.push_back(this);
+	blend_queued = true;
+}
+
+void AnimationTree::_cancel_blend() {
+	if (!blend_queued) {
+		return;
+	}
+
+	blend_queue.erase(this);
+	blend_queued = false;
+
+	if (blend_queue_flusher == this) {
+		// The flush was pushed on this tree, which may be deleted before it runs.
+		blend_queue_flusher = nullptr;
+		if (!blend_queue.is_empty()) {
+			blend_queue_flusher = blend_queue[0];
+			MessageQueue::get_singleton()->push_callable(callable_mp(blend_queue_flusher, &AnimationTree::_flush_blend_queue));
+		}
+	}
+}
+
+void AnimationTree::_blend_queued_tree(uint32_t p_index, void *p_userdata) {
+	blend_queue[p_index]->_blend_pose();
+}
+
+void AnimationTree::_flush_blend_queue() {
+	if (blend_queue.is_empty()) {
+		return;
+	}
+
+	if (blend_pool.get_thread_count() == 0) {
+		blend_pool.init();
+	}
+	blend_pool.do_work(blend_queue.size(), this, &AnimationTree::_blend_queued_tree, nullptr);
+
+	// Scene nodes aren't thread safe, so the poses are written back here, all at once.
+	for (uint32_t i = 0; i < blend_queue.size(); i++) {
+		blend_queue[i]->blend_queued = false;
+		blend_queue[i]->_apply_pose();
+	}
+	blend_queue.clear();
+	blend_queue_flusher = nullptr;
+}
+
+void AnimationTree::finish_blend_pool() {
+	// Queued trees are gone by now, the flush they pushed was either run or dropped.
+	blend_queue.clear();
+	blend_queue_flusher = nullptr;
+	blend_pool.finish();
 }
 
 void AnimationTree::advance(real_t p_time) {
@@ -1587,11 +1726,11 @@ void AnimationTree::advance(real_t p_time) {
 
 void AnimationTree::_notification(int p_what) {
 	if (active && p_what == NOTIFICATION_INTERNAL_PHYSICS_PROCESS && process_callback == ANIMATION_PROCESS_PHYSICS) {
-		_process_graph(get_physics_process_delta_time());
+		_process_graph(get_physics_process_delta_time(), threaded_blending);
 	}
 
 	if (active && p_what == NOTIFICATION_INTERNAL_PROCESS && process_callback == ANIMATION_PROCESS_IDLE) {
-		_process_graph(get_process_delta_time());
+		_process_graph(get_process_delta_time(), threaded_blending);
 	}
 
 	if (p_what == NOTIFICATION_EXIT_TREE) {
@@ -1840,7 +1979,9 @@ void AnimationTree::_bind_methods() {
 }
 
 AnimationTree::AnimationTree() {
+	threaded_blending = GLOBAL_DEF("animation/animation_tree/threaded_blending", false);
 }
 
 AnimationTree::~AnimationTree() {
+	_cancel_blend();
 }
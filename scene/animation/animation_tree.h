@@ -32,6 +32,8 @@
 #define ANIMATION_GRAPH_PLAYER_H
 
 #include "animation_player.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/thread_work_pool.h"
 #include "scene/3d/node_3d.h"
 #include "scene/3d/skeleton_3d.h"
 #include "scene/resources/animation.h"
@@ -197,10 +199,12 @@ private:
 		bool loc_used = false;
 		bool rot_used = false;
 		bool scale_used = false;
+		// Only used by the root motion track, the others are blended into the pose arrays.
 		Vector3 loc;
 		Quaternion rot;
 		real_t rot_blend_accum = 0.0;
 		Vector3 scale;
+		int pose_index = -1;
 
 		TrackCacheTransform() {
 			type = Animation::TYPE_POSITION_3D;
@@ -209,8 +213,8 @@ private:
 
 	struct TrackCacheBlendShape : public TrackCache {
 		MeshInstance3D *mesh_3d = nullptr;
-		float value = 0;
 		int shape_index = -1;
+		int pose_index = -1;
 		TrackCacheBlendShape() { type = Animation::TYPE_BLEND_SHAPE; }
 	};
 
@@ -253,6 +257,42 @@ private:
 	HashMap<NodePath, TrackCache *> track_cache;
 	Set<TrackCache *> playing_caches;
 
+	// Transform and blend shape keys to blend this pass, flattened out of the node graph.
+	// Running it only reads the animations and writes the pose arrays, so it can be done
+	// on a worker thread, while everything touching the scene stays on the main thread.
+	struct BlendOp {
+		Ref<Animation> animation;
+		double time = 0.0;
+		real_t blend = 0.0;
+		int track = 0;
+		int pose_index = 0;
+		Animation::TrackType type = Animation::TYPE_POSITION_3D;
+	};
+
+	LocalVector<BlendOp> blend_program;
+	LocalVector<TrackCacheTransform *> pose_transforms;
+	LocalVector<TrackCacheBlendShape *> pose_blend_shapes;
+	LocalVector<Vector3> pose_locs;
+	LocalVector<Quaternion> pose_rots;
+	LocalVector<real_t> pose_rot_blend_accums;
+	LocalVector<Vector3> pose_scales;
+	LocalVector<float> pose_blend_shape_values;
+
+	// Trees processed in the same frame blend their poses in parallel, and write them
+	// back together when the message queue is flushed.
+	static LocalVector<AnimationTree *> blend_queue;
+	static AnimationTree *blend_queue_flusher;
+	static ThreadWorkPool blend_pool;
+	bool threaded_blending = false;
+	bool blend_queued = false;
+
+	void _blend_pose();
+	void _apply_pose();
+	void _queue_blend();
+	void _cancel_blend();
+	void _blend_queued_tree(uint32_t p_index, void *p_userdata);
+	void _flush_blend_queue();
+
 	Ref<AnimationNode> root;
 
 	AnimationProcessCallback process_callback = ANIMATION_PROCESS_IDLE;
@@ -265,7 +305,7 @@ private:
 
 	void _clear_caches();
 	bool _update_caches(AnimationPlayer *player);
-	void _process_graph(real_t p_delta);
+	void _process_graph(real_t p_delta, bool p_defer_pose = false);
 
 	uint64_t setup_pass = 1;
 	uint64_t process_pass = 1;
@@ -332,6 +372,9 @@ public:
 	void rename_parameter(const String &p_base, const String &p_new_base);
 
 	uint64_t get_last_process_pass() const;
+
+	static void finish_blend_pool();
+
 	AnimationTree();
 	~AnimationTree();
 };
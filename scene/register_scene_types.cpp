@@ -1110,5 +1110,6 @@ void unregister_scene_types() {
 	ParticlesMaterial::finish_shaders();
 	CanvasItemMaterial::finish_shaders();
 	ColorPicker::finish_shaders();
+	AnimationTree::finish_blend_pool();
 	SceneStringNames::free();
 }
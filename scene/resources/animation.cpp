@@ -4992,6 +4992,21 @@ bool Animation::_blend_shape_interpolate_compressed(uint32_t p_compressed_track,
 	return true;
 }
 
+int32_t Animation::_find_compressed_page(double p_time) const {
+	// Pages are sorted by time, find the last one starting before p_time.
+	uint32_t low = 0;
+	uint32_t high = compression.pages.size();
+	while (low < high) {
+		uint32_t middle = (low + high) / 2;
+		if (compression.pages[middle].time_offset > p_time) {
+			high = middle;
+		} else {
+			low = middle + 1;
+		}
+	}
+	return int32_t(low) - 1;
+}
+
 template <uint32_t COMPONENTS>
 bool Animation::_fetch_compressed(uint32_t p_compressed_track, double p_time, Vector3i &r_current_value, double &r_current_time, Vector3i &r_next_value, double &r_next_time, uint32_t *key_index) const {
 	ERR_FAIL_COND_V(!compression.enabled, false);
@@ -5001,20 +5016,20 @@ bool Animation::_fetch_compressed(uint32_t p_compressed_track, double p_time, Ve
 		*key_index = 0;
 	}
 
-	double frame_to_sec = 1.0 / double(compression.fps);
-
-	int32_t page_index = -1;
-	for (uint32_t i = 0; i < compression.pages.size(); i++) {
-		if (compression.pages[i].time_offset > p_time) {
-			break;
-		}
-		page_index = i;
-	}
+	int32_t page_index = _find_compressed_page(p_time);
 
 	ERR_FAIL_COND_V(page_index == -1, false); //should not happen
 
-	double page_base_time = compression.pages[page_index].time_offset;
-	const uint8_t *page_data = compression.pages[page_index].data.ptr();
+	_fetch_compressed_in_page<COMPONENTS>(p_compressed_track, page_index, p_time, r_current_value, r_current_time, r_next_value, r_next_time, key_index);
+	return true;
+}
+
+template <uint32_t COMPONENTS>
+void Animation::_fetch_compressed_in_page(uint32_t p_compressed_track, uint32_t p_page, double p_time, Vector3i &r_current_value, double &r_current_time, Vector3i &r_next_value, double &r_next_time, uint32_t *key_index) const {
+	double frame_to_sec = 1.0 / double(compression.fps);
+
+	double page_base_time = compression.pages[p_page].time_offset;
+	const uint8_t *page_data = compression.pages[p_page].data.ptr();
 #ifndef _MSC_VER
 #warning Little endian assumed. No major big endian hardware exists any longer, but in case it does it will need to be supported
 #endif
@@ -5026,21 +5041,37 @@ bool Animation::_fetch_compressed(uint32_t p_compressed_track, double p_time, Ve
 	double packet_time = double(time_keys[0]) * frame_to_sec + page_base_time;
 	uint32_t base_frame = time_keys[0];
 
-	for (uint32_t i = 1; i < time_key_count; i++) {
-		uint32_t f = time_keys[i * 2 + 0];
-		double frame_time = double(f) * frame_to_sec + page_base_time;
+	if (key_index) {
+		// The key index counts the data keys of every skipped time key, so walk them all.
+		for (uint32_t i = 1; i < time_key_count; i++) {
+			uint32_t f = time_keys[i * 2 + 0];
+			double frame_time = double(f) * frame_to_sec + page_base_time;
 
-		if (frame_time > p_time) {
-			break;
-		}
+			if (frame_time > p_time) {
+				break;
+			}
 
-		if (key_index) {
 			(*key_index) += (time_keys[(i - 1) * 2 + 1] >> 12) + 1;
-		}
 
-		packet_idx = i;
-		packet_time = frame_time;
-		base_frame = f;
+			packet_idx = i;
+			packet_time = frame_time;
+			base_frame = f;
+		}
+	} else {
+		// Time keys are sorted, find the last one before p_time.
+		uint32_t low = 1;
+		uint32_t high = time_key_count;
+		while (low < high) {
+			uint32_t middle = (low + high) / 2;
+			if (double(time_keys[middle * 2 + 0]) * frame_to_sec + page_base_time > p_time) {
+				high = middle;
+			} else {
+				low = middle + 1;
+			}
+		}
+		packet_idx = low - 1;
+		base_frame = time_keys[packet_idx * 2 + 0];
+		packet_time = double(base_frame) * frame_to_sec + page_base_time;
 	}
 
 	const uint8_t *data_keys_base = (const uint8_t *)&page_data[indices[p_compressed_track * 3 + 2]];
@@ -5136,8 +5167,99 @@ bool Animation::_fetch_compressed(uint32_t p_compressed_track, double p_time, Ve
 		r_current_value[i] = decode[i];
 		r_next_value[i] = decode_next[i];
 	}
+}
 
-	return true;
+void Animation::sample_compressed_tracks(double p_time, LocalVector<TrackSample> &r_samples) const {
+	r_samples.resize(tracks.size());
+	for (uint32_t i = 0; i < r_samples.size(); i++) {
+		r_samples[i].valid = false;
+	}
+
+	if (!compression.enabled) {
+		return;
+	}
+
+	p_time = CLAMP(p_time, 0, length);
+
+	// All the tracks share the page layout, so the page is only looked up once.
+	int32_t page_index = _find_compressed_page(p_time);
+	ERR_FAIL_COND(page_index == -1);
+
+	for (int i = 0; i < tracks.size(); i++) {
+		const Track *t = tracks[i];
+
+		int32_t compressed_track = -1;
+		switch (t->type) {
+			case TYPE_POSITION_3D: {
+				compressed_track = static_cast<const PositionTrack *>(t)->compressed_track;
+			} break;
+			case TYPE_ROTATION_3D: {
+				compressed_track = static_cast<const RotationTrack *>(t)->compressed_track;
+			} break;
+			case TYPE_SCALE_3D: {
+				compressed_track = static_cast<const ScaleTrack *>(t)->compressed_track;
+			} break;
+			case TYPE_BLEND_SHAPE: {
+				compressed_track = static_cast<const BlendShapeTrack *>(t)->compressed_track;
+			} break;
+			default: {
+			}
+		}
+
+		if (compressed_track < 0) {
+			continue;
+		}
+
+		Vector3i current;
+		Vector3i next;
+		double time_current;
+		double time_next;
+		if (t->type == TYPE_BLEND_SHAPE) {
+			_fetch_compressed_in_page<1>(compressed_track, page_index, p_time, current, time_current, next, time_next);
+		} else {
+			_fetch_compressed_in_page<3>(compressed_track, page_index, p_time, current, time_current, next, time_next);
+		}
+
+		// Same rules as the per track interpolation.
+		float c;
+		if (time_current >= p_time || time_current == time_next) {
+			c = 0.0;
+		} else if (p_time >= time_next) {
+			c = 1.0;
+		} else {
+			c = (p_time - time_current) / (time_next - time_current);
+		}
+
+		TrackSample &sample = r_samples[i];
+		switch (t->type) {
+			case TYPE_POSITION_3D:
+			case TYPE_SCALE_3D: {
+				// Decoding is affine, so the keys can be blended before it.
+				Vector3i key = c == 0.0 ? current : next;
+				if (c > 0.0 && c < 1.0) {
+					Vector3 unorm = Vector3(current.x, current.y, current.z).lerp(Vector3(next.x, next.y, next.z), c) / 65535.0;
+					sample.vector = compression.bounds[compressed_track].position + unorm * compression.bounds[compressed_track].size;
+				} else {
+					sample.vector = _uncompress_pos_scale(compressed_track, key);
+				}
+			} break;
+			case TYPE_ROTATION_3D: {
+				if (c == 0.0) {
+					sample.rotation = _uncompress_quaternion(current);
+				} else if (c == 1.0) {
+					sample.rotation = _uncompress_quaternion(next);
+				} else {
+					sample.rotation = _uncompress_quaternion(current).slerp(_uncompress_quaternion(next), c);
+				}
+			} break;
+			case TYPE_BLEND_SHAPE: {
+				sample.blend_shape = Math::lerp(_uncompress_blend_shape(current), _uncompress_blend_shape(next), c);
+			} break;
+			default: {
+			}
+		}
+		sample.valid = true;
+	}
 }
 
 template <uint32_t COMPONENTS>
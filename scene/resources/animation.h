@@ -317,9 +317,12 @@ private:
 	bool _rotation_interpolate_compressed(uint32_t p_compressed_track, double p_time, Quaternion &r_ret) const;
 	bool _pos_scale_interpolate_compressed(uint32_t p_compressed_track, double p_time, Vector3 &r_ret) const;
 	bool _blend_shape_interpolate_compressed(uint32_t p_compressed_track, double p_time, float &r_ret) const;
+	int32_t _find_compressed_page(double p_time) const;
 	template <uint32_t COMPONENTS>
 	bool _fetch_compressed(uint32_t p_compressed_track, double p_time, Vector3i &r_current_value, double &r_current_time, Vector3i &r_next_value, double &r_next_time, uint32_t *key_index = nullptr) const;
 	template <uint32_t COMPONENTS>
+	void _fetch_compressed_in_page(uint32_t p_compressed_track, uint32_t p_page, double p_time, Vector3i &r_current_value, double &r_current_time, Vector3i &r_next_value, double &r_next_time, uint32_t *key_index = nullptr) const;
+	template <uint32_t COMPONENTS>
 	bool _fetch_compressed_by_index(uint32_t p_compressed_track, int p_index, Vector3i &r_value, double &r_time) const;
 	int _get_compressed_key_count(uint32_t p_compressed_track) const;
 	template <uint32_t COMPONENTS>
@@ -405,6 +408,16 @@ public:
 	real_t track_get_key_transition(int p_track, int p_key_idx) const;
 	bool track_is_compressed(int p_track) const;
 
+	struct TrackSample {
+		Vector3 vector; // Position or scale.
+		Quaternion rotation;
+		float blend_shape = 0.0;
+		bool valid = false;
+	};
+
+	bool is_compressed() const { return compression.enabled; }
+	void sample_compressed_tracks(double p_time, LocalVector<TrackSample> &r_samples) const;
+
 	int position_track_insert_key(int p_track, double p_time, const Vector3 &p_position);
 	Error position_track_get_key(int p_track, int p_key, Vector3 *r_position) const;
 	Error position_track_interpolate(int p_track, double p_time, Vector3 *r_interpolation) const;
@@ -95,6 +95,15 @@ public:
 	virtual Vector3 map_get_closest_point_normal(RID p_map, const Vector3 &p_point) const = 0;
 	virtual RID map_get_closest_point_owner(RID p_map, const Vector3 &p_point) const = 0;
 
+	/// Queues a path request, solved during `process` within the per frame path query budget.
+	virtual RID map_query_path(RID p_map, Vector3 p_origin, Vector3 p_destination, bool p_optimize, uint32_t p_navigable_layers = 1) const = 0;
+
+	/// Returns true once the path query is solved.
+	virtual bool path_query_is_done(RID p_query) const = 0;
+
+	/// Returns the path found by the query, empty until the query is done.
+	virtual Vector<Vector3> path_query_get_path(RID p_query) const = 0;
+
 	/// Creates a new region.
 	virtual RID region_create() const = 0;
 
@@ -47,6 +47,7 @@ class MeshAreaPair3D : public MeshConstraint3D {
 
 public:
 	virtual bool setup(real_t p_step) override;
+	virtual bool is_pre_solve_thread_safe() const override { return false; }
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
@@ -68,6 +69,7 @@ class MeshArea2Pair3D : public MeshConstraint3D {
 
 public:
 	virtual bool setup(real_t p_step) override;
+	virtual bool is_pre_solve_thread_safe() const override { return false; }
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
@@ -86,6 +88,7 @@ class MeshAreaSoftBodyPair3D : public MeshConstraint3D {
 
 public:
 	virtual bool setup(real_t p_step) override;
+	virtual bool is_pre_solve_thread_safe() const override { return false; }
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
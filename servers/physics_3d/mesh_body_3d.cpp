@@ -472,6 +472,28 @@ bool MeshBody3D::is_axis_locked(PhysicsServer3D::BodyAxis p_axis) const {
 	return locked_axis & p_axis;
 }
 
+void MeshBody3D::_apply_damp_override() {
+	// Override linear damping with body's value.
+	switch (linear_damp_mode) {
+		case PhysicsServer3D::BODY_DAMP_MODE_COMBINE: {
+			total_linear_damp += linear_damp;
+		} break;
+		case PhysicsServer3D::BODY_DAMP_MODE_REPLACE: {
+			total_linear_damp = linear_damp;
+		} break;
+	}
+
+	// Override angular damping with body's value.
+	switch (angular_damp_mode) {
+		case PhysicsServer3D::BODY_DAMP_MODE_COMBINE: {
+			total_angular_damp += angular_damp;
+		} break;
+		case PhysicsServer3D::BODY_DAMP_MODE_REPLACE: {
+			total_angular_damp = angular_damp;
+		} break;
+	}
+}
+
 void MeshBody3D::integrate_forces(real_t p_step) {
 	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
 		return;
@@ -582,25 +604,7 @@ void MeshBody3D::integrate_forces(real_t p_step) {
 		}
 	}
 
-	// Override linear damping with body's value.
-	switch (linear_damp_mode) {
-		case PhysicsServer3D::BODY_DAMP_MODE_COMBINE: {
-			total_linear_damp += linear_damp;
-		} break;
-		case PhysicsServer3D::BODY_DAMP_MODE_REPLACE: {
-			total_linear_damp = linear_damp;
-		} break;
-	}
-
-	// Override angular damping with body's value.
-	switch (angular_damp_mode) {
-		case PhysicsServer3D::BODY_DAMP_MODE_COMBINE: {
-			total_angular_damp += angular_damp;
-		} break;
-		case PhysicsServer3D::BODY_DAMP_MODE_REPLACE: {
-			total_angular_damp = angular_damp;
-		} break;
-	}
+	_apply_damp_override();
 
 	gravity *= gravity_scale;
 
@@ -627,27 +631,7 @@ void MeshBody3D::integrate_forces(real_t p_step) {
 	} else {
 		if (!omit_force_integration) {
 			//overridden by direct state query
-
-			Vector3 force = gravity * mass + applied_force + constant_force;
-			Vector3 torque = applied_torque + constant_torque;
-
-			real_t damp = 1.0 - p_step * total_linear_damp;
-
-			if (damp < 0) { // reached zero in the given time
-				damp = 0;
-			}
-
-			real_t angular_damp = 1.0 - p_step * total_angular_damp;
-
-			if (angular_damp < 0) { // reached zero in the given time
-				angular_damp = 0;
-			}
-
-			linear_velocity *= damp;
-			angular_velocity *= angular_damp;
-
-			linear_velocity += _inv_mass * force * p_step;
-			angular_velocity += _inv_inertia_tensor.xform(torque) * p_step;
+			_integrate_forces_and_damp(p_step);
 		}
 
 		if (continuous_cd) {
@@ -669,6 +653,50 @@ void MeshBody3D::integrate_forces(real_t p_step) {
 	contact_count = 0;
 }
 
+void MeshBody3D::_integrate_forces_and_damp(real_t p_step) {
+	Vector3 force = gravity * mass + applied_force + constant_force;
+	Vector3 torque = applied_torque + constant_torque;
+
+	real_t damp = 1.0 - p_step * total_linear_damp;
+
+	if (damp < 0) { // reached zero in the given time
+		damp = 0;
+	}
+
+	real_t angular_damp = 1.0 - p_step * total_angular_damp;
+
+	if (angular_damp < 0) { // reached zero in the given time
+		angular_damp = 0;
+	}
+
+	linear_velocity *= damp;
+	angular_velocity *= angular_damp;
+
+	linear_velocity += _inv_mass * force * p_step;
+	angular_velocity += _inv_inertia_tensor.xform(torque) * p_step;
+}
+
+void MeshBody3D::integrate_default_area_forces(const DefaultAreaForces &p_forces, real_t p_step) {
+	// Same as integrate_forces() for a dynamic body without overlapping areas, custom integrator or CCD.
+	gravity = p_forces.gravity * gravity_scale;
+	total_linear_damp = p_forces.linear_damp;
+	total_angular_damp = p_forces.angular_damp;
+	_apply_damp_override();
+
+	prev_linear_velocity = linear_velocity;
+	prev_angular_velocity = angular_velocity;
+
+	_integrate_forces_and_damp(p_step);
+
+	applied_force = Vector3();
+	applied_torque = Vector3();
+
+	biased_angular_velocity = Vector3();
+	biased_linear_velocity = Vector3();
+
+	contact_count = 0;
+}
+
 void MeshBody3D::integrate_velocities(real_t p_step) {
 	if (mode == PhysicsServer3D::BODY_MODE_STATIC) {
 		return;
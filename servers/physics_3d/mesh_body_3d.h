@@ -146,6 +146,8 @@ class MeshBody3D : public MeshCollisionObject3D {
 	uint64_t island_step = 0;
 
 	void _update_transform_dependent();
+	void _apply_damp_override();
+	void _integrate_forces_and_damp(real_t p_step);
 
 	friend class MeshPhysicsDirectBodyState3D; // i give up, too many functions to expose
 
@@ -318,6 +320,19 @@ public:
 	void integrate_forces(real_t p_step);
 	void integrate_velocities(real_t p_step);
 
+	// Gravity and damping of the space's default area, resolved once per step for all the bodies that only feel it.
+	struct DefaultAreaForces {
+		Vector3 gravity;
+		real_t linear_damp = 0.0;
+		real_t angular_damp = 0.0;
+	};
+
+	// Such bodies only touch their own state when integrating forces, so they can be integrated in parallel.
+	_FORCE_INLINE_ bool can_integrate_default_area_forces() const {
+		return mode > PhysicsServer3D::BODY_MODE_KINEMATIC && areas.is_empty() && !omit_force_integration && !continuous_cd;
+	}
+	void integrate_default_area_forces(const DefaultAreaForces &p_forces, real_t p_step);
+
 	_FORCE_INLINE_ Vector3 get_velocity_in_local_point(const Vector3 &rel_pos) const {
 		return linear_velocity + angular_velocity.cross(rel_pos - center_of_mass);
 	}
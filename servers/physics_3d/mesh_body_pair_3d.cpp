@@ -77,47 +77,100 @@ void MeshBodyPair3D::contact_added_callback(const Vector3 &p_point_A, int p_inde
 
 	// Figure out if the contact amount must be reduced to fit the new contact.
 	if (new_index == MAX_CONTACTS) {
-		// Remove the contact with the minimum depth.
+		int replaced = _get_contact_to_replace(contact);
+		if (replaced > -1) {
+			contacts[replaced] = contact;
+		}
+
+		return;
+	}
+
+	contacts[new_index] = contact;
+	contact_count++;
+}
 
-		const Basis &basis_A = A->get_transform().basis;
-		const Basis &basis_B = B->get_transform().basis;
+static _FORCE_INLINE_ real_t _contact_area_squared(const Vector3 &p_a, const Vector3 &p_b, const Vector3 &p_c, const Vector3 &p_d) {
+	// The points aren't sorted, so take the largest of the three possible quads.
+	real_t area = (p_a - p_b).cross(p_c - p_d).length_squared();
+	area = MAX(area, (p_a - p_c).cross(p_b - p_d).length_squared());
+	return MAX(area, (p_a - p_d).cross(p_b - p_c).length_squared());
+}
 
-		int least_deep = -1;
-		real_t min_depth;
+int MeshBodyPair3D::_get_contact_to_replace(const Contact &p_contact) const {
+	// Keep the deepest contact, and the three others spanning the largest area,
+	// which makes the most stable manifold. Index MAX_CONTACTS is the new contact.
+	const Basis &basis_A = A->get_transform().basis;
+	const Basis &basis_B = B->get_transform().basis;
 
-		// Start with depth for new contact.
-		{
-			Vector3 global_A = basis_A.xform(contact.local_A);
-			Vector3 global_B = basis_B.xform(contact.local_B) + offset_B;
+	Vector3 points[MAX_CONTACTS + 1];
+	int deepest = -1;
+	real_t max_depth = 0.0;
 
-			Vector3 axis = global_A - global_B;
-			min_depth = axis.dot(contact.normal);
+	for (int i = 0; i <= MAX_CONTACTS; i++) {
+		const Contact &c = i < MAX_CONTACTS ? contacts[i] : p_contact;
+		Vector3 global_A = basis_A.xform(c.local_A);
+		Vector3 global_B = basis_B.xform(c.local_B) + offset_B;
+		real_t depth = (global_A - global_B).dot(c.normal);
+
+		points[i] = global_A;
+		if (deepest == -1 || depth > max_depth) {
+			max_depth = depth;
+			deepest = i;
 		}
+	}
 
-		for (int i = 0; i < contact_count; i++) {
-			const Contact &c = contacts[i];
-			Vector3 global_A = basis_A.xform(c.local_A);
-			Vector3 global_B = basis_B.xform(c.local_B) + offset_B;
+	// Dropping the new contact is an option too, unless it's the deepest.
+	int replaced = -1;
+	real_t max_area = deepest == MAX_CONTACTS ? -1.0 : _contact_area_squared(points[0], points[1], points[2], points[3]);
 
-			Vector3 axis = global_A - global_B;
-			real_t depth = axis.dot(c.normal);
+	for (int i = 0; i < MAX_CONTACTS; i++) {
+		if (i == deepest) {
+			continue;
+		}
 
-			if (depth < min_depth) {
-				min_depth = depth;
-				least_deep = i;
+		Vector3 kept[MAX_CONTACTS];
+		int kept_count = 0;
+		for (int j = 0; j <= MAX_CONTACTS; j++) {
+			if (j != i) {
+				kept[kept_count++] = points[j];
 			}
 		}
 
-		if (least_deep > -1) {
-			// Replace the least deep contact by the new one.
-			contacts[least_deep] = contact;
+		real_t area = _contact_area_squared(kept[0], kept[1], kept[2], kept[3]);
+		if (area > max_area) {
+			max_area = area;
+			replaced = i;
 		}
+	}
 
-		return;
+	return replaced;
+}
+
+bool MeshBodyPair3D::_can_reuse_manifold() const {
+	if (!manifold_cached || !collided || contact_count == 0) {
+		return false;
 	}
 
-	contacts[new_index] = contact;
-	contact_count++;
+	real_t linear_tolerance = space->get_contact_persistence_linear_tolerance();
+	if (offset_B.distance_squared_to(manifold_offset_B) > linear_tolerance * linear_tolerance) {
+		return false;
+	}
+
+	// The trace of the relative rotation is 1 + 2 cos(angle).
+	const real_t min_trace = 1.0 + 2.0 * Math::cos(space->get_contact_persistence_angular_tolerance());
+
+	const Basis &basis_A = A->get_transform().basis;
+	const Basis &basis_B = B->get_transform().basis;
+	for (int i = 0; i < 2; i++) {
+		const Basis &basis = i == 0 ? basis_A : basis_B;
+		const Basis &cached = i == 0 ? manifold_basis_A : manifold_basis_B;
+		real_t trace = basis.get_axis(0).dot(cached.get_axis(0)) + basis.get_axis(1).dot(cached.get_axis(1)) + basis.get_axis(2).dot(cached.get_axis(2));
+		if (trace < min_trace) {
+			return false;
+		}
+	}
+
+	return true;
 }
 
 void MeshBodyPair3D::validate_contacts() {
@@ -222,6 +275,7 @@ bool MeshBodyPair3D::setup(real_t p_step) {
 
 	if (!A->interacts_with(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self())) {
 		collided = false;
+		manifold_cached = false;
 		return false;
 	}
 
@@ -234,6 +288,7 @@ bool MeshBodyPair3D::setup(real_t p_step) {
 			report_contacts_only = true;
 		} else {
 			collided = false;
+			manifold_cached = false;
 			return false;
 		}
 	}
@@ -242,6 +297,14 @@ bool MeshBodyPair3D::setup(real_t p_step) {
 
 	validate_contacts();
 
+	if (space->is_contact_persistence_enabled() && _can_reuse_manifold()) {
+		// The bodies barely moved since the last narrowphase, keep its contacts and their impulses.
+		for (int i = 0; i < contact_count; i++) {
+			contacts[i].used = true;
+		}
+		return true;
+	}
+
 	const Vector3 &offset_A = A->get_transform().get_origin();
 	Transform3D xform_Au = Transform3D(A->get_transform().basis, Vector3());
 	Transform3D xform_A = xform_Au * A->get_shape_transform(shape_A);
@@ -255,6 +318,13 @@ bool MeshBodyPair3D::setup(real_t p_step) {
 
 	collided = MeshCollisionSolver3D::solve_static(shape_A_ptr, xform_A, shape_B_ptr, xform_B, _contact_added_callback, this, &sep_axis);
 
+	manifold_cached = collided;
+	if (collided) {
+		manifold_offset_B = offset_B;
+		manifold_basis_A = A->get_transform().basis;
+		manifold_basis_B = B->get_transform().basis;
+	}
+
 	if (!collided) {
 		if (A->is_continuous_collision_detection_enabled() && collide_A) {
 			check_ccd = true;
@@ -272,6 +342,17 @@ bool MeshBodyPair3D::setup(real_t p_step) {
 	return true;
 }
 
+bool MeshBodyPair3D::is_pre_solve_thread_safe() const {
+	// Dynamic bodies belong to a single island, others can be touched by several islands at once.
+	if (A->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC && A->can_report_contacts()) {
+		return false;
+	}
+	if (B->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC && B->can_report_contacts()) {
+		return false;
+	}
+	return true;
+}
+
 bool MeshBodyPair3D::pre_solve(real_t p_step) {
 	if (!collided) {
 		if (check_ccd) {
@@ -96,15 +96,24 @@ class MeshBodyPair3D : public MeshBodyContact3D {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count = 0;
 
+	// Placement of the bodies when the contacts were last generated by the narrowphase.
+	bool manifold_cached = false;
+	Vector3 manifold_offset_B;
+	Basis manifold_basis_A;
+	Basis manifold_basis_B;
+
 	static void _contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B, void *p_userdata);
 
 	void contact_added_callback(const Vector3 &p_point_A, int p_index_A, const Vector3 &p_point_B, int p_index_B);
 
 	void validate_contacts();
+	bool _can_reuse_manifold() const;
+	int _get_contact_to_replace(const Contact &p_contact) const;
 	bool _test_ccd(real_t p_step, MeshBody3D *p_A, int p_shape_A, const Transform3D &p_xform_A, MeshBody3D *p_B, int p_shape_B, const Transform3D &p_xform_B);
 
 public:
 	virtual bool setup(real_t p_step) override;
+	virtual bool is_pre_solve_thread_safe() const override;
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
@@ -133,6 +142,8 @@ class MeshBodySoftBodyPair3D : public MeshBodyContact3D {
 
 public:
 	virtual bool setup(real_t p_step) override;
+	// Wakes up the body, which changes the active list of the space.
+	virtual bool is_pre_solve_thread_safe() const override { return false; }
 	virtual bool pre_solve(real_t p_step) override;
 	virtual void solve(real_t p_step) override;
 
@@ -72,6 +72,9 @@ public:
 	_FORCE_INLINE_ bool is_disabled_collisions_between_bodies() const { return disabled_collisions_between_bodies; }
 
 	virtual bool setup(real_t p_step) = 0;
+	// Constraints are pre-solved in parallel per island, unless pre_solve() writes to objects
+	// that can be shared between islands, like areas or contacts reported by kinematic bodies.
+	virtual bool is_pre_solve_thread_safe() const { return true; }
 	virtual bool pre_solve(real_t p_step) = 0;
 	virtual void solve(real_t p_step) = 0;
 
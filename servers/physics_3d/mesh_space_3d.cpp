@@ -1246,6 +1246,13 @@ MeshSpace3D::MeshSpace3D() {
 	solver_iterations = GLOBAL_DEF("physics/3d/solver/solver_iterations", 16);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/solver_iterations", PropertyInfo(Variant::INT, "physics/3d/solver/solver_iterations", PROPERTY_HINT_RANGE, "1,32,1,or_greater"));
 
+	// Large islands get their constraints graph-colored and each color solved in parallel.
+	solver_parallel_island = GLOBAL_DEF("physics/3d/solver/parallel_island_solve", false);
+	solver_parallel_island_min_constraints = GLOBAL_DEF("physics/3d/solver/parallel_island_min_constraints", 512);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/parallel_island_min_constraints", PropertyInfo(Variant::INT, "physics/3d/solver/parallel_island_min_constraints", PROPERTY_HINT_RANGE, "16,8192,1,or_greater"));
+	// Bodies that only feel the default area get their forces integrated on the step's work pool.
+	parallel_force_integration = GLOBAL_DEF("physics/3d/solver/parallel_force_integration", false);
+
 	contact_recycle_radius = GLOBAL_DEF("physics/3d/solver/contact_recycle_radius", 0.01);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/contact_recycle_radius", PropertyInfo(Variant::FLOAT, "physics/3d/solver/contact_max_separation", PROPERTY_HINT_RANGE, "0,0.1,0.01,or_greater"));
 
@@ -1258,6 +1265,12 @@ MeshSpace3D::MeshSpace3D() {
 	contact_bias = GLOBAL_DEF("physics/3d/solver/default_contact_bias", 0.8);
 	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/default_contact_bias", PropertyInfo(Variant::FLOAT, "physics/3d/solver/default_contact_bias", PROPERTY_HINT_RANGE, "0,1,0.01"));
 
+	// Body pairs keep their contacts without running the narrowphase while their bodies stay within these tolerances.
+	contact_persistence = GLOBAL_DEF("physics/3d/solver/persistent_contacts", false);
+	contact_persistence_linear_tolerance = GLOBAL_DEF("physics/3d/solver/persistent_contacts_linear_tolerance", 0.005);
+	ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/solver/persistent_contacts_linear_tolerance", PropertyInfo(Variant::FLOAT, "physics/3d/solver/persistent_contacts_linear_tolerance", PROPERTY_HINT_RANGE, "0,0.1,0.001,or_greater"));
+	contact_persistence_angular_tolerance = GLOBAL_DEF("physics/3d/solver/persistent_contacts_angular_tolerance", Math::deg2rad(1.0));
+
 	broadphase = MeshBroadPhase3D::create_func();
 	broadphase->set_pair_callback(_broadphase_pair, this);
 	broadphase->set_unpair_callback(_broadphase_unpair, this);
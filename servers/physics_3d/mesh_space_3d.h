@@ -94,11 +94,17 @@ private:
 	MeshArea3D *area = nullptr;
 
 	int solver_iterations = 0;
+	bool solver_parallel_island = false;
+	int solver_parallel_island_min_constraints = 0;
+	bool parallel_force_integration = false;
 
 	real_t contact_recycle_radius = 0.0;
 	real_t contact_max_separation = 0.0;
 	real_t contact_max_allowed_penetration = 0.0;
 	real_t contact_bias = 0.0;
+	bool contact_persistence = false;
+	real_t contact_persistence_linear_tolerance = 0.0;
+	real_t contact_persistence_angular_tolerance = 0.0;
 
 	enum {
 		INTERSECTION_QUERY_MAX = 2048
@@ -161,10 +167,16 @@ public:
 	const Set<MeshCollisionObject3D *> &get_objects() const;
 
 	_FORCE_INLINE_ int get_solver_iterations() const { return solver_iterations; }
+	_FORCE_INLINE_ bool is_solver_parallel_island_enabled() const { return solver_parallel_island; }
+	_FORCE_INLINE_ int get_solver_parallel_island_min_constraints() const { return solver_parallel_island_min_constraints; }
+	_FORCE_INLINE_ bool is_parallel_force_integration_enabled() const { return parallel_force_integration; }
 	_FORCE_INLINE_ real_t get_contact_recycle_radius() const { return contact_recycle_radius; }
 	_FORCE_INLINE_ real_t get_contact_max_separation() const { return contact_max_separation; }
 	_FORCE_INLINE_ real_t get_contact_max_allowed_penetration() const { return contact_max_allowed_penetration; }
 	_FORCE_INLINE_ real_t get_contact_bias() const { return contact_bias; }
+	_FORCE_INLINE_ bool is_contact_persistence_enabled() const { return contact_persistence; }
+	_FORCE_INLINE_ real_t get_contact_persistence_linear_tolerance() const { return contact_persistence_linear_tolerance; }
+	_FORCE_INLINE_ real_t get_contact_persistence_angular_tolerance() const { return contact_persistence_angular_tolerance; }
 	_FORCE_INLINE_ real_t get_body_linear_velocity_sleep_threshold() const { return body_linear_velocity_sleep_threshold; }
 	_FORCE_INLINE_ real_t get_body_angular_velocity_sleep_threshold() const { return body_angular_velocity_sleep_threshold; }
 	_FORCE_INLINE_ real_t get_body_time_to_sleep() const { return body_time_to_sleep; }
@@ -39,6 +39,8 @@
 #define ISLAND_COUNT_RESERVE 128
 #define ISLAND_SIZE_RESERVE 512
 #define CONSTRAINT_COUNT_RESERVE 1024
+#define SOLVER_CHUNK_SIZE 32
+#define FORCE_INTEGRATION_CHUNK_SIZE 256
 
 void MeshStep3D::_populate_island(MeshBody3D *p_body, LocalVector<MeshBody3D *> &p_body_island, LocalVector<MeshConstraint3D *> &p_constraint_island) {
 	p_body->set_island_step(_step);
@@ -129,6 +131,41 @@ void MeshStep3D::_pre_solve_island(LocalVector<MeshConstraint3D *> &p_constraint
 	p_constraint_island.resize(valid_constraint_count);
 }
 
+void MeshStep3D::_pre_solve_island_thread_safe(uint32_t p_island_index, void *p_userdata) {
+	LocalVector<MeshConstraint3D *> &constraint_island = constraint_islands[p_island_index];
+
+	bool deferred = false;
+	uint32_t constraint_count = constraint_island.size();
+	uint32_t valid_constraint_count = 0;
+	for (uint32_t constraint_index = 0; constraint_index < constraint_count; ++constraint_index) {
+		MeshConstraint3D *constraint = constraint_island[constraint_index];
+		if (!constraint->is_pre_solve_thread_safe()) {
+			// Keep it in place, it's pre-solved after all islands.
+			constraint_island[valid_constraint_count++] = constraint;
+			deferred = true;
+		} else if (constraint->pre_solve(delta)) {
+			// Keep this constraint for solving.
+			constraint_island[valid_constraint_count++] = constraint;
+		}
+	}
+	constraint_island.resize(valid_constraint_count);
+
+	pre_solve_deferred[p_island_index] = deferred;
+}
+
+void MeshStep3D::_pre_solve_island_deferred(LocalVector<MeshConstraint3D *> &p_constraint_island) const {
+	uint32_t constraint_count = p_constraint_island.size();
+	uint32_t valid_constraint_count = 0;
+	for (uint32_t constraint_index = 0; constraint_index < constraint_count; ++constraint_index) {
+		MeshConstraint3D *constraint = p_constraint_island[constraint_index];
+		if (constraint->is_pre_solve_thread_safe() || constraint->pre_solve(delta)) {
+			// Keep this constraint for solving.
+			p_constraint_island[valid_constraint_count++] = constraint;
+		}
+	}
+	p_constraint_island.resize(valid_constraint_count);
+}
+
 void MeshStep3D::_solve_island(uint32_t p_island_index, void *p_userdata) {
 	LocalVector<MeshConstraint3D *> &constraint_island = constraint_islands[p_island_index];
 
@@ -157,6 +194,141 @@ void MeshStep3D::_solve_island(uint32_t p_island_index, void *p_userdata) {
 	}
 }
 
+void MeshStep3D::_solve_small_island(uint32_t p_index, void *p_userdata) {
+	_solve_island(small_islands[p_index]);
+}
+
+void MeshStep3D::_color_island(const LocalVector<MeshConstraint3D *> &p_constraint_island) {
+	uint32_t constraint_count = p_constraint_island.size();
+
+	body_color_masks.clear();
+	constraint_colors.resize(constraint_count);
+
+	uint32_t color_counts[MAX_SOLVER_COLORS + 1] = {};
+
+	// Greedy coloring, each constraint takes the first color none of its dynamic bodies uses yet.
+	for (uint32_t constraint_index = 0; constraint_index < constraint_count; ++constraint_index) {
+		MeshConstraint3D *constraint = p_constraint_island[constraint_index];
+		MeshBody3D **bodies = constraint->get_body_ptr();
+		int body_count = constraint->get_body_count();
+
+		uint32_t color = MAX_SOLVER_COLORS;
+
+		// Soft body constraints write to the soft body too, keep them in the serial batch.
+		if (constraint->get_soft_body_count() == 0) {
+			uint64_t used_colors = 0;
+			for (int i = 0; i < body_count; i++) {
+				if (bodies[i]->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC) {
+					continue; // Never written to by the solver.
+				}
+				uint64_t *mask = body_color_masks.lookup_ptr((uint64_t)bodies[i]);
+				if (mask) {
+					used_colors |= *mask;
+				}
+			}
+
+			color = 0;
+			while (color < MAX_SOLVER_COLORS && (used_colors & (uint64_t(1) << color))) {
+				++color;
+			}
+
+			if (color < MAX_SOLVER_COLORS) {
+				for (int i = 0; i < body_count; i++) {
+					if (bodies[i]->get_mode() <= PhysicsServer3D::BODY_MODE_KINEMATIC) {
+						continue;
+					}
+					uint64_t *mask = body_color_masks.lookup_ptr((uint64_t)bodies[i]);
+					if (mask) {
+						*mask |= uint64_t(1) << color;
+					} else {
+						body_color_masks.insert((uint64_t)bodies[i], uint64_t(1) << color);
+					}
+				}
+			}
+		}
+
+		constraint_colors[constraint_index] = color;
+		++color_counts[color];
+	}
+
+	// Sort constraints by color, keeping their original order within each color.
+	uint32_t offset = 0;
+	solver_color_count = 0;
+	for (uint32_t color = 0; color <= MAX_SOLVER_COLORS; ++color) {
+		solver_colors[color].start = offset;
+		solver_colors[color].count = 0;
+		offset += color_counts[color];
+		if (color < MAX_SOLVER_COLORS && color_counts[color] > 0) {
+			solver_color_count = color + 1;
+		}
+	}
+
+	colored_constraints.resize(constraint_count);
+	for (uint32_t constraint_index = 0; constraint_index < constraint_count; ++constraint_index) {
+		SolverColor &solver_color = solver_colors[constraint_colors[constraint_index]];
+		colored_constraints[solver_color.start + solver_color.count++] = p_constraint_island[constraint_index];
+	}
+}
+
+void MeshStep3D::_solve_color_chunk(uint32_t p_chunk_index, SolverColor *p_color) {
+	uint32_t from = p_color->start + p_chunk_index * SOLVER_CHUNK_SIZE;
+	uint32_t to = MIN(from + SOLVER_CHUNK_SIZE, p_color->start + p_color->count);
+	for (uint32_t constraint_index = from; constraint_index < to; ++constraint_index) {
+		colored_constraints[constraint_index]->solve(delta);
+	}
+}
+
+void MeshStep3D::_solve_island_colored(uint32_t p_island_index) {
+	const LocalVector<MeshConstraint3D *> &constraint_island = constraint_islands[p_island_index];
+
+	_color_island(constraint_island);
+
+	SolverColor &serial_color = solver_colors[MAX_SOLVER_COLORS];
+
+	int current_priority = 1;
+
+	uint32_t constraint_count = constraint_island.size();
+	while (constraint_count > 0) {
+		for (int i = 0; i < iterations; i++) {
+			// Constraints of a same color don't share any body, so each color can be solved in parallel.
+			for (uint32_t color_index = 0; color_index < solver_color_count; ++color_index) {
+				SolverColor &solver_color = solver_colors[color_index];
+				uint32_t chunk_count = (solver_color.count + SOLVER_CHUNK_SIZE - 1) / SOLVER_CHUNK_SIZE;
+				work_pool.do_work(chunk_count, this, &MeshStep3D::_solve_color_chunk, &solver_color);
+			}
+
+			for (uint32_t constraint_index = 0; constraint_index < serial_color.count; ++constraint_index) {
+				colored_constraints[serial_color.start + constraint_index]->solve(delta);
+			}
+		}
+
+		// Check priority to keep only higher priority constraints.
+		++current_priority;
+		constraint_count = 0;
+		for (uint32_t color_index = 0; color_index <= MAX_SOLVER_COLORS; ++color_index) {
+			SolverColor &solver_color = solver_colors[color_index];
+			uint32_t priority_constraint_count = 0;
+			for (uint32_t constraint_index = 0; constraint_index < solver_color.count; ++constraint_index) {
+				MeshConstraint3D *constraint = colored_constraints[solver_color.start + constraint_index];
+				if (constraint->get_priority() >= current_priority) {
+					// Keep this constraint for the next iteration.
+					colored_constraints[solver_color.start + priority_constraint_count++] = constraint;
+				}
+			}
+			solver_color.count = priority_constraint_count;
+			constraint_count += priority_constraint_count;
+		}
+	}
+}
+
+void MeshStep3D::_integrate_default_area_chunk(uint32_t p_chunk_index, void *p_userdata) {
+	uint32_t from = p_chunk_index * FORCE_INTEGRATION_CHUNK_SIZE;
+	uint32_t to = MIN(from + FORCE_INTEGRATION_CHUNK_SIZE, default_area_bodies.size());
+	for (uint32_t i = from; i < to; i++) {
+		default_area_bodies[i]->integrate_default_area_forces(default_area_forces, delta);
+	}
+}
+
 void MeshStep3D::_check_suspend(const LocalVector<MeshBody3D *> &p_body_island) const {
 	bool can_sleep = true;
 
@@ -191,6 +363,9 @@ void MeshStep3D::step(MeshSpace3D *p_space, real_t p_delta) {
 	iterations = p_space->get_solver_iterations();
 	delta = p_delta;
 
+	parallel_island_solve = p_space->is_solver_parallel_island_enabled();
+	parallel_island_min_constraints = MAX(p_space->get_solver_parallel_island_min_constraints(), 1);
+
 	const SelfList<MeshBody3D>::List *body_list = &p_space->get_active_body_list();
 
 	const SelfList<MeshSoftBody3D>::List *soft_body_list = &p_space->get_active_soft_body_list();
@@ -202,13 +377,34 @@ void MeshStep3D::step(MeshSpace3D *p_space, real_t p_delta) {
 
 	int active_count = 0;
 
+	// Point gravity depends on each body's position, so it can't be resolved once for all bodies.
+	MeshArea3D *default_area = p_space->get_default_area();
+	bool parallel_integration = p_space->is_parallel_force_integration_enabled() && default_area && !default_area->is_gravity_point();
+
+	default_area_bodies.clear();
+	if (parallel_integration) {
+		default_area->compute_gravity(Vector3(), default_area_forces.gravity);
+		default_area_forces.linear_damp = default_area->get_linear_damp();
+		default_area_forces.angular_damp = default_area->get_angular_damp();
+	}
+
 	const SelfList<MeshBody3D> *b = body_list->first();
 	while (b) {
-		b->self()->integrate_forces(p_delta);
+		MeshBody3D *body = b->self();
+		if (parallel_integration && body->can_integrate_default_area_forces()) {
+			default_area_bodies.push_back(body);
+		} else {
+			body->integrate_forces(p_delta);
+		}
 		b = b->next();
 		active_count++;
 	}
 
+	if (default_area_bodies.size()) {
+		uint32_t chunk_count = (default_area_bodies.size() + FORCE_INTEGRATION_CHUNK_SIZE - 1) / FORCE_INTEGRATION_CHUNK_SIZE;
+		work_pool.do_work(chunk_count, this, &MeshStep3D::_integrate_default_area_chunk, nullptr);
+	}
+
 	/* UPDATE SOFT BODY MOTION */
 
 	const SelfList<MeshSoftBody3D> *sb = soft_body_list->first();
@@ -353,16 +549,48 @@ void MeshStep3D::step(MeshSpace3D *p_space, real_t p_delta) {
 
 	/* PRE-SOLVE CONSTRAINT ISLANDS */
 
-	// Warning: This doesn't run on threads, because it involves thread-unsafe processing.
-	for (uint32_t island_index = 0; island_index < island_count; ++island_index) {
-		_pre_solve_island(constraint_islands[island_index]);
+	if (p_space->is_debugging_contacts()) {
+		// Debug contacts are added to the space from every island.
+		for (uint32_t island_index = 0; island_index < island_count; ++island_index) {
+			_pre_solve_island(constraint_islands[island_index]);
+		}
+	} else {
+		// Islands don't share dynamic bodies, so they're pre-solved in parallel. Constraints writing to
+		// shared objects are left in their island, and pre-solved on this thread afterwards.
+		pre_solve_deferred.resize(island_count);
+		work_pool.do_work(island_count, this, &MeshStep3D::_pre_solve_island_thread_safe, nullptr);
+
+		for (uint32_t island_index = 0; island_index < island_count; ++island_index) {
+			if (pre_solve_deferred[island_index]) {
+				_pre_solve_island_deferred(constraint_islands[island_index]);
+			}
+		}
 	}
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
 	// Warning: _solve_island modifies the constraint islands for optimization purpose,
 	// their content is not reliable after these calls and shouldn't be used anymore.
-	work_pool.do_work(island_count, this, &MeshStep3D::_solve_island, nullptr);
+	if (parallel_island_solve) {
+		// Small islands are solved in parallel with each other, large ones are split by graph coloring.
+		small_islands.clear();
+		large_islands.clear();
+		for (uint32_t island_index = 0; island_index < island_count; ++island_index) {
+			if (constraint_islands[island_index].size() >= parallel_island_min_constraints) {
+				large_islands.push_back(island_index);
+			} else {
+				small_islands.push_back(island_index);
+			}
+		}
+
+		work_pool.do_work(small_islands.size(), this, &MeshStep3D::_solve_small_island, nullptr);
+
+		for (uint32_t i = 0; i < large_islands.size(); ++i) {
+			_solve_island_colored(large_islands[i]);
+		}
+	} else {
+		work_pool.do_work(island_count, this, &MeshStep3D::_solve_island, nullptr);
+	}
 
 	{ //profile
 		profile_endtime = OS::get_singleton()->get_ticks_usec();
@@ -34,9 +34,20 @@
 #include "mesh_space_3d.h"
 
 #include "core/templates/local_vector.h"
+#include "core/templates/oa_hash_map.h"
 #include "core/templates/thread_work_pool.h"
 
 class MeshStep3D {
+	enum {
+		// One bit per color in the body masks, constraints that don't fit are solved serially.
+		MAX_SOLVER_COLORS = 64,
+	};
+
+	struct SolverColor {
+		uint32_t start = 0;
+		uint32_t count = 0;
+	};
+
 	uint64_t _step = 1;
 
 	int iterations = 0;
@@ -47,12 +58,39 @@ class MeshStep3D {
 	LocalVector<LocalVector<MeshBody3D *>> body_islands;
 	LocalVector<LocalVector<MeshConstraint3D *>> constraint_islands;
 	LocalVector<MeshConstraint3D *> all_constraints;
+	// Islands left with constraints that must be pre-solved on the physics thread.
+	LocalVector<uint8_t> pre_solve_deferred;
+
+	bool parallel_island_solve = false;
+	uint32_t parallel_island_min_constraints = 0;
+
+	LocalVector<uint32_t> small_islands;
+	LocalVector<uint32_t> large_islands;
+
+	// Active bodies that only feel the default area, integrated in parallel.
+	LocalVector<MeshBody3D *> default_area_bodies;
+	MeshBody3D::DefaultAreaForces default_area_forces;
+
+	// Graph coloring of the large island being solved. Constraints are sorted by color,
+	// and no two constraints of the same color touch the same dynamic body.
+	LocalVector<MeshConstraint3D *> colored_constraints;
+	LocalVector<uint8_t> constraint_colors;
+	OAHashMap<uint64_t, uint64_t> body_color_masks;
+	SolverColor solver_colors[MAX_SOLVER_COLORS + 1];
+	uint32_t solver_color_count = 0;
 
 	void _populate_island(MeshBody3D *p_body, LocalVector<MeshBody3D *> &p_body_island, LocalVector<MeshConstraint3D *> &p_constraint_island);
 	void _populate_island_soft_body(MeshSoftBody3D *p_soft_body, LocalVector<MeshBody3D *> &p_body_island, LocalVector<MeshConstraint3D *> &p_constraint_island);
 	void _setup_contraint(uint32_t p_constraint_index, void *p_userdata = nullptr);
 	void _pre_solve_island(LocalVector<MeshConstraint3D *> &p_constraint_island) const;
+	void _pre_solve_island_thread_safe(uint32_t p_island_index, void *p_userdata = nullptr);
+	void _pre_solve_island_deferred(LocalVector<MeshConstraint3D *> &p_constraint_island) const;
 	void _solve_island(uint32_t p_island_index, void *p_userdata = nullptr);
+	void _solve_small_island(uint32_t p_index, void *p_userdata = nullptr);
+	void _color_island(const LocalVector<MeshConstraint3D *> &p_constraint_island);
+	void _solve_color_chunk(uint32_t p_chunk_index, SolverColor *p_color);
+	void _solve_island_colored(uint32_t p_island_index);
+	void _integrate_default_area_chunk(uint32_t p_chunk_index, void *p_userdata = nullptr);
 	void _check_suspend(const LocalVector<MeshBody3D *> &p_body_island) const;
 
 public:
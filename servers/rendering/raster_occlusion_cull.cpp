@@ -0,0 +1,581 @@
+/*************************************************************************/
+/*  raster_occlusion_cull.cpp                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "raster_occlusion_cull.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define RASTER_OCCLUSION_SSE
+#endif
+
+RasterOcclusionCull *RasterOcclusionCull::raster_singleton = nullptr;
+
+void RasterOcclusionCull::RasterHZBuffer::clear() {
+	HZBuffer::clear();
+
+	tile_bins.clear();
+	tile_grid_size = Size2i();
+}
+
+void RasterOcclusionCull::RasterHZBuffer::resize(const Size2i &p_size) {
+	if (p_size == Size2i()) {
+		clear();
+		return;
+	}
+
+	if (!sizes.is_empty() && p_size == sizes[0]) {
+		return; // Size didn't change
+	}
+
+	HZBuffer::resize(p_size);
+
+	tile_grid_size = Size2i((p_size.x + TILE_SIZE - 1) / TILE_SIZE, (p_size.y + TILE_SIZE - 1) / TILE_SIZE);
+	tile_bins.resize(tile_grid_size.x * tile_grid_size.y);
+}
+
+void RasterOcclusionCull::RasterHZBuffer::rasterize(const LocalVector<LocalVector<ScreenTriangle>> &p_triangles, bool p_orthogonal, float p_z_far, ThreadWorkPool &p_thread_pool) {
+	ERR_FAIL_COND(is_empty());
+
+	orthogonal = p_orthogonal;
+	debug_tex_range = p_z_far;
+
+	for (uint32_t i = 0; i < tile_bins.size(); i++) {
+		tile_bins[i].clear();
+	}
+
+	// Bin every triangle into the tiles its bounds touch, so tiles can be rasterized independently.
+	for (uint32_t i = 0; i < p_triangles.size(); i++) {
+		const LocalVector<ScreenTriangle> &triangles = p_triangles[i];
+		for (uint32_t j = 0; j < triangles.size(); j++) {
+			const ScreenTriangle &triangle = triangles[j];
+			int tile_min_x = triangle.min_x / TILE_SIZE;
+			int tile_max_x = triangle.max_x / TILE_SIZE;
+			int tile_min_y = triangle.min_y / TILE_SIZE;
+			int tile_max_y = triangle.max_y / TILE_SIZE;
+
+			for (int y = tile_min_y; y <= tile_max_y; y++) {
+				for (int x = tile_min_x; x <= tile_max_x; x++) {
+					tile_bins[y * tile_grid_size.x + x].push_back(&triangle);
+				}
+			}
+		}
+	}
+
+	p_thread_pool.do_work(tile_bins.size(), this, &RasterHZBuffer::_rasterize_tile, nullptr);
+
+	update_mips();
+}
+
+void RasterOcclusionCull::RasterHZBuffer::_rasterize_tile(uint32_t p_tile, void *p_userdata) {
+	const Size2i &buffer_size = sizes[0];
+	int from_x = (p_tile % tile_grid_size.x) * TILE_SIZE;
+	int from_y = (p_tile / tile_grid_size.x) * TILE_SIZE;
+	int to_x = MIN(from_x + TILE_SIZE, buffer_size.x) - 1;
+	int to_y = MIN(from_y + TILE_SIZE, buffer_size.y) - 1;
+
+	for (int y = from_y; y <= to_y; y++) {
+		float *row = &mips[0][y * buffer_size.x];
+		for (int x = from_x; x <= to_x; x++) {
+			row[x] = FLT_MAX;
+		}
+	}
+
+	const LocalVector<const ScreenTriangle *> &bin = tile_bins[p_tile];
+	for (uint32_t i = 0; i < bin.size(); i++) {
+		const ScreenTriangle &triangle = *bin[i];
+		_rasterize_triangle(triangle, MAX(from_x, triangle.min_x), MAX(from_y, triangle.min_y), MIN(to_x, triangle.max_x), MIN(to_y, triangle.max_y));
+	}
+}
+
+void RasterOcclusionCull::RasterHZBuffer::_rasterize_triangle(const ScreenTriangle &p_triangle, int p_from_x, int p_from_y, int p_to_x, int p_to_y) {
+	const float *tx = p_triangle.x;
+	const float *ty = p_triangle.y;
+	const float *tz = p_triangle.z;
+
+	// Edge functions, positive inside the triangle. Edge `i` is opposite to vertex `i`,
+	// so dividing it by the area gives the barycentric weight of that vertex.
+	float edge_dx[3];
+	float edge_dy[3];
+	float edge_c[3];
+	for (int i = 0; i < 3; i++) {
+		int a = (i + 1) % 3;
+		int b = (i + 2) % 3;
+		edge_dx[i] = ty[a] - ty[b];
+		edge_dy[i] = tx[b] - tx[a];
+		edge_c[i] = tx[a] * ty[b] - tx[b] * ty[a];
+	}
+
+	float inv_area = 1.0f / (edge_c[0] + edge_c[1] + edge_c[2]);
+	float z_dx = (tz[0] * edge_dx[0] + tz[1] * edge_dx[1] + tz[2] * edge_dx[2]) * inv_area;
+	float z_dy = (tz[0] * edge_dy[0] + tz[1] * edge_dy[1] + tz[2] * edge_dy[2]) * inv_area;
+	float z_c = (tz[0] * edge_c[0] + tz[1] * edge_c[1] + tz[2] * edge_c[2]) * inv_area;
+
+	const int width = sizes[0].x;
+
+	for (int y = p_from_y; y <= p_to_y; y++) {
+		float *row = &mips[0][y * width];
+		float py = y + 0.5f;
+		int x = p_from_x;
+
+#ifdef RASTER_OCCLUSION_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+		for (; x + 3 <= p_to_x; x += 4) {
+			__m128 px = _mm_add_ps(_mm_set1_ps(float(x)), lane_offsets);
+
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (int i = 0; i < 3; i++) {
+				__m128 e = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(edge_dx[i])), _mm_set1_ps(edge_dy[i] * py + edge_c[i]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(e, zero));
+			}
+			if (_mm_movemask_ps(inside) == 0) {
+				continue;
+			}
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(z_dx)), _mm_set1_ps(z_dy * py + z_c));
+			if (!orthogonal) {
+				depth = _mm_div_ps(one, depth);
+			}
+
+			__m128 current = _mm_loadu_ps(&row[x]);
+			__m128 nearest = _mm_min_ps(current, depth);
+			_mm_storeu_ps(&row[x], _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+		}
+#endif
+
+		for (; x <= p_to_x; x++) {
+			float px = x + 0.5f;
+
+			if (edge_dx[0] * px + edge_dy[0] * py + edge_c[0] < 0.0f || edge_dx[1] * px + edge_dy[1] * py + edge_c[1] < 0.0f || edge_dx[2] * px + edge_dy[2] * py + edge_c[2] < 0.0f) {
+				continue;
+			}
+
+			float depth = z_dx * px + z_dy * py + z_c;
+			if (!orthogonal) {
+				depth = 1.0f / depth;
+			}
+			row[x] = MIN(row[x], depth);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////
+
+bool RasterOcclusionCull::is_occluder(RID p_rid) {
+	return occluder_owner.owns(p_rid);
+}
+
+RID RasterOcclusionCull::occluder_allocate() {
+	return occluder_owner.allocate_rid();
+}
+
+void RasterOcclusionCull::occluder_initialize(RID p_occluder) {
+	Occluder *occluder = memnew(Occluder);
+	occluder_owner.initialize_rid(p_occluder, occluder);
+}
+
+void RasterOcclusionCull::occluder_set_mesh(RID p_occluder, const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices) {
+	Occluder *occluder = occluder_owner.get_or_null(p_occluder);
+	ERR_FAIL_COND(!occluder);
+
+	occluder->vertices = p_vertices;
+	occluder->indices = p_indices;
+
+	for (Set<InstanceID>::Element *E = occluder->users.front(); E; E = E->next()) {
+		RID scenario_rid = E->get().scenario;
+		RID instance_rid = E->get().instance;
+		ERR_CONTINUE(!scenarios.has(scenario_rid));
+		Scenario &scenario = scenarios[scenario_rid];
+		ERR_CONTINUE(!scenario.instances.has(instance_rid));
+
+		if (!scenario.dirty_instances.has(instance_rid)) {
+			scenario.dirty_instances.insert(instance_rid);
+			scenario.dirty_instances_array.push_back(instance_rid);
+		}
+	}
+}
+
+void RasterOcclusionCull::free_occluder(RID p_occluder) {
+	Occluder *occluder = occluder_owner.get_or_null(p_occluder);
+	ERR_FAIL_COND(!occluder);
+	memdelete(occluder);
+	occluder_owner.free(p_occluder);
+}
+
+////////////////////////////////////////////////////////
+
+void RasterOcclusionCull::add_scenario(RID p_scenario) {
+	if (!scenarios.has(p_scenario)) {
+		scenarios[p_scenario] = Scenario();
+	}
+}
+
+void RasterOcclusionCull::remove_scenario(RID p_scenario) {
+	ERR_FAIL_COND(!scenarios.has(p_scenario));
+	Scenario &scenario = scenarios[p_scenario];
+
+	// Nothing is built asynchronously from the scenario, so it can go right away.
+	const RID *instance_rid = nullptr;
+	while ((instance_rid = scenario.instances.next(instance_rid))) {
+		Occluder *occluder = occluder_owner.get_or_null(scenario.instances[*instance_rid].occluder);
+		if (occluder) {
+			occluder->users.erase(InstanceID(p_scenario, *instance_rid));
+		}
+	}
+
+	scenarios.erase(p_scenario);
+}
+
+void RasterOcclusionCull::scenario_set_instance(RID p_scenario, RID p_instance, RID p_occluder, const Transform3D &p_xform, bool p_enabled) {
+	ERR_FAIL_COND(!scenarios.has(p_scenario));
+	Scenario &scenario = scenarios[p_scenario];
+
+	if (!scenario.instances.has(p_instance)) {
+		scenario.instances[p_instance] = OccluderInstance();
+	}
+
+	OccluderInstance &instance = scenario.instances[p_instance];
+
+	if (instance.removed) {
+		instance.removed = false;
+		scenario.removed_instances.erase(p_instance);
+	}
+
+	bool changed = false;
+
+	if (instance.occluder != p_occluder) {
+		Occluder *old_occluder = occluder_owner.get_or_null(instance.occluder);
+		if (old_occluder) {
+			old_occluder->users.erase(InstanceID(p_scenario, p_instance));
+		}
+
+		instance.occluder = p_occluder;
+
+		if (p_occluder.is_valid()) {
+			Occluder *occluder = occluder_owner.get_or_null(p_occluder);
+			ERR_FAIL_COND(!occluder);
+			occluder->users.insert(InstanceID(p_scenario, p_instance));
+		}
+		changed = true;
+	}
+
+	if (instance.xform != p_xform) {
+		instance.xform = p_xform;
+		changed = true;
+	}
+
+	instance.enabled = p_enabled;
+
+	if (changed && !scenario.dirty_instances.has(p_instance)) {
+		scenario.dirty_instances.insert(p_instance);
+		scenario.dirty_instances_array.push_back(p_instance);
+	}
+}
+
+void RasterOcclusionCull::scenario_remove_instance(RID p_scenario, RID p_instance) {
+	ERR_FAIL_COND(!scenarios.has(p_scenario));
+	Scenario &scenario = scenarios[p_scenario];
+
+	if (scenario.instances.has(p_instance)) {
+		OccluderInstance &instance = scenario.instances[p_instance];
+
+		if (!instance.removed) {
+			Occluder *occluder = occluder_owner.get_or_null(instance.occluder);
+			if (occluder) {
+				occluder->users.erase(InstanceID(p_scenario, p_instance));
+			}
+
+			scenario.removed_instances.push_back(p_instance);
+			instance.removed = true;
+		}
+	}
+}
+
+void RasterOcclusionCull::Scenario::_update_dirty_instance(uint32_t p_idx, RID *p_instances) {
+	OccluderInstance *occ_inst = instances.getptr(p_instances[p_idx]);
+
+	if (!occ_inst) {
+		return;
+	}
+
+	Occluder *occ = raster_singleton->occluder_owner.get_or_null(occ_inst->occluder);
+
+	if (!occ) {
+		occ_inst->xformed_vertices.clear();
+		occ_inst->indices.clear();
+		return;
+	}
+
+	int vertices_size = occ->vertices.size();
+	occ_inst->xformed_vertices.resize(vertices_size);
+
+	const Vector3 *read_ptr = occ->vertices.ptr();
+	Vector3 *write_ptr = occ_inst->xformed_vertices.ptr();
+	for (int i = 0; i < vertices_size; i++) {
+		write_ptr[i] = occ_inst->xform.xform(read_ptr[i]);
+		if (i == 0) {
+			occ_inst->aabb = AABB(write_ptr[i], Vector3());
+		} else {
+			occ_inst->aabb.expand_to(write_ptr[i]);
+		}
+	}
+
+	// Drop indices that point past the vertices once, instead of checking them every frame.
+	occ_inst->indices.clear();
+	const int32_t *indices = occ->indices.ptr();
+	for (int i = 0; i + 2 < occ->indices.size(); i += 3) {
+		if (indices[i] < 0 || indices[i] >= vertices_size || indices[i + 1] < 0 || indices[i + 1] >= vertices_size || indices[i + 2] < 0 || indices[i + 2] >= vertices_size) {
+			continue;
+		}
+		occ_inst->indices.push_back(indices[i]);
+		occ_inst->indices.push_back(indices[i + 1]);
+		occ_inst->indices.push_back(indices[i + 2]);
+	}
+}
+
+void RasterOcclusionCull::Scenario::update(ThreadWorkPool &p_thread_pool) {
+	for (unsigned int i = 0; i < removed_instances.size(); i++) {
+		instances.erase(removed_instances[i]);
+	}
+
+	p_thread_pool.do_work(dirty_instances_array.size(), this, &Scenario::_update_dirty_instance, dirty_instances_array.ptr());
+
+	dirty_instances.clear();
+	dirty_instances_array.clear();
+	removed_instances.clear();
+}
+
+////////////////////////////////////////////////////////
+
+void RasterOcclusionCull::_setup_triangles_threaded(uint32_t p_thread, SetupThreadData *p_data) {
+	uint32_t total_instances = p_data->scenario->visible_instances.size();
+	uint32_t from = p_thread * total_instances / p_data->thread_count;
+	uint32_t to = (p_thread + 1 == p_data->thread_count) ? total_instances : ((p_thread + 1) * total_instances / p_data->thread_count);
+
+	thread_triangles[p_thread].clear();
+
+	for (uint32_t i = from; i < to; i++) {
+		_setup_instance_triangles(p_data->scenario->visible_instances[i], p_data, p_thread);
+	}
+}
+
+void RasterOcclusionCull::_setup_instance_triangles(const OccluderInstance *p_instance, const SetupThreadData *p_data, uint32_t p_thread) {
+	LocalVector<ScreenTriangle> &triangles = thread_triangles[p_thread];
+	LocalVector<Vector3> &view_vertices = thread_view_vertices[p_thread];
+
+	const uint32_t vertex_count = p_instance->xformed_vertices.size();
+	view_vertices.resize(vertex_count);
+	for (uint32_t i = 0; i < vertex_count; i++) {
+		view_vertices[i] = p_data->cam_inv_transform.xform(p_instance->xformed_vertices[i]);
+	}
+
+	const float width = p_data->buffer_size.x;
+	const float height = p_data->buffer_size.y;
+	const float near_z = -p_data->z_near;
+
+	for (uint32_t i = 0; i < p_instance->indices.size(); i += 3) {
+		// Clip against the near plane, which leaves at most four vertices.
+		Vector3 polygon[4];
+		int polygon_size = 0;
+
+		for (int j = 0; j < 3; j++) {
+			const Vector3 &a = view_vertices[p_instance->indices[i + j]];
+			const Vector3 &b = view_vertices[p_instance->indices[i + (j + 1) % 3]];
+			bool a_inside = a.z <= near_z;
+			bool b_inside = b.z <= near_z;
+
+			if (a_inside) {
+				polygon[polygon_size++] = a;
+			}
+			if (a_inside != b_inside) {
+				real_t t = (near_z - a.z) / (b.z - a.z);
+				polygon[polygon_size++] = a.lerp(b, t);
+			}
+		}
+
+		if (polygon_size < 3) {
+			continue;
+		}
+
+		float sx[4];
+		float sy[4];
+		float sz[4];
+		for (int j = 0; j < polygon_size; j++) {
+			Plane projected = p_data->cam_projection.xform4(Plane(polygon[j], 1.0));
+			float w = projected.d;
+			sx[j] = (projected.normal.x / w * 0.5f + 0.5f) * width;
+			sy[j] = (projected.normal.y / w * 0.5f + 0.5f) * height;
+			float depth = -polygon[j].z;
+			sz[j] = p_data->orthogonal ? depth : 1.0f / depth;
+		}
+
+		for (int j = 1; j + 1 < polygon_size; j++) {
+			ScreenTriangle triangle;
+			const int order[3] = { 0, j, j + 1 };
+			for (int k = 0; k < 3; k++) {
+				triangle.x[k] = sx[order[k]];
+				triangle.y[k] = sy[order[k]];
+				triangle.z[k] = sz[order[k]];
+			}
+
+			float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+			if (Math::abs(area) < CMP_EPSILON) {
+				continue;
+			}
+			if (area < 0.0f) {
+				// Occluders are double sided, flip them to a single winding for the edge functions.
+				SWAP(triangle.x[1], triangle.x[2]);
+				SWAP(triangle.y[1], triangle.y[2]);
+				SWAP(triangle.z[1], triangle.z[2]);
+			}
+
+			// Pixels whose center is inside the bounds.
+			float min_x = MIN(triangle.x[0], MIN(triangle.x[1], triangle.x[2]));
+			float max_x = MAX(triangle.x[0], MAX(triangle.x[1], triangle.x[2]));
+			float min_y = MIN(triangle.y[0], MIN(triangle.y[1], triangle.y[2]));
+			float max_y = MAX(triangle.y[0], MAX(triangle.y[1], triangle.y[2]));
+
+			if (max_x < 0.0f || max_y < 0.0f || min_x > width || min_y > height) {
+				continue;
+			}
+
+			triangle.min_x = MAX(0, int(Math::ceil(min_x - 0.5f)));
+			triangle.min_y = MAX(0, int(Math::ceil(min_y - 0.5f)));
+			triangle.max_x = MIN(p_data->buffer_size.x - 1, int(Math::floor(max_x - 0.5f)));
+			triangle.max_y = MIN(p_data->buffer_size.y - 1, int(Math::floor(max_y - 0.5f)));
+
+			if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+				continue;
+			}
+
+			triangles.push_back(triangle);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////
+
+void RasterOcclusionCull::add_buffer(RID p_buffer) {
+	ERR_FAIL_COND(buffers.has(p_buffer));
+	buffers[p_buffer] = RasterHZBuffer();
+}
+
+void RasterOcclusionCull::remove_buffer(RID p_buffer) {
+	ERR_FAIL_COND(!buffers.has(p_buffer));
+	buffers.erase(p_buffer);
+}
+
+void RasterOcclusionCull::buffer_set_scenario(RID p_buffer, RID p_scenario) {
+	ERR_FAIL_COND(!buffers.has(p_buffer));
+	ERR_FAIL_COND(p_scenario.is_valid() && !scenarios.has(p_scenario));
+	buffers[p_buffer].scenario_rid = p_scenario;
+}
+
+void RasterOcclusionCull::buffer_set_size(RID p_buffer, const Vector2i &p_size) {
+	ERR_FAIL_COND(!buffers.has(p_buffer));
+	buffers[p_buffer].resize(p_size);
+}
+
+void RasterOcclusionCull::buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_pool) {
+	if (!buffers.has(p_buffer)) {
+		return;
+	}
+
+	RasterHZBuffer &buffer = buffers[p_buffer];
+
+	if (buffer.is_empty() || !scenarios.has(buffer.scenario_rid)) {
+		return;
+	}
+
+	Scenario &scenario = scenarios[buffer.scenario_rid];
+	scenario.update(p_thread_pool);
+
+	Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
+	Vector3 frustum_points[8];
+	p_cam_projection.get_endpoints(p_cam_transform, frustum_points);
+
+	scenario.visible_instances.clear();
+	const RID *instance_rid = nullptr;
+	while ((instance_rid = scenario.instances.next(instance_rid))) {
+		const OccluderInstance &instance = scenario.instances[*instance_rid];
+		if (!instance.enabled || instance.indices.is_empty()) {
+			continue;
+		}
+		if (!instance.aabb.intersects_convex_shape(planes.ptr(), planes.size(), frustum_points, 8)) {
+			continue;
+		}
+		scenario.visible_instances.push_back(&instance);
+	}
+
+	SetupThreadData td;
+	td.scenario = &scenario;
+	td.cam_inv_transform = p_cam_transform.affine_inverse();
+	td.cam_projection = p_cam_projection;
+	td.buffer_size = buffer.get_size();
+	td.z_near = p_cam_projection.get_z_near();
+	td.orthogonal = p_cam_orthogonal;
+	td.thread_count = MAX(1, MIN(p_thread_pool.get_thread_count(), (int)scenario.visible_instances.size()));
+
+	if (thread_triangles.size() < td.thread_count) {
+		thread_triangles.resize(td.thread_count);
+		thread_view_vertices.resize(td.thread_count);
+	}
+	for (uint32_t i = td.thread_count; i < thread_triangles.size(); i++) {
+		thread_triangles[i].clear();
+	}
+
+	p_thread_pool.do_work(td.thread_count, this, &RasterOcclusionCull::_setup_triangles_threaded, &td);
+
+	buffer.rasterize(thread_triangles, p_cam_orthogonal, p_cam_projection.get_z_far(), p_thread_pool);
+}
+
+RasterOcclusionCull::HZBuffer *RasterOcclusionCull::buffer_get_ptr(RID p_buffer) {
+	if (!buffers.has(p_buffer)) {
+		return nullptr;
+	}
+	return &buffers[p_buffer];
+}
+
+RID RasterOcclusionCull::buffer_get_debug_texture(RID p_buffer) {
+	ERR_FAIL_COND_V(!buffers.has(p_buffer), RID());
+	return buffers[p_buffer].get_debug_texture();
+}
+
+////////////////////////////////////////////////////////
+
+RasterOcclusionCull::RasterOcclusionCull() {
+	raster_singleton = this;
+}
+
+RasterOcclusionCull::~RasterOcclusionCull() {
+	raster_singleton = nullptr;
+}
@@ -0,0 +1,171 @@
+/*************************************************************************/
+/*  raster_occlusion_cull.h                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RASTER_OCCLUSION_CULL_H
+#define RASTER_OCCLUSION_CULL_H
+
+#include "core/math/camera_matrix.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/rid_owner.h"
+#include "core/templates/set.h"
+#include "servers/rendering/renderer_scene_occlusion_cull.h"
+
+// Occlusion culling backend that rasterizes occluder meshes on the CPU, for platforms
+// and projects where the Embree ray-caster in the raycast module is not available.
+class RasterOcclusionCull : public RendererSceneOcclusionCull {
+public:
+	enum {
+		TILE_SIZE = 16, // In depth buffer pixels, each tile is rasterized by a single thread.
+	};
+
+	// A triangle projected to depth buffer pixels, with counter-clockwise winding.
+	struct ScreenTriangle {
+		float x[3];
+		float y[3];
+		float z[3]; // 1 / depth for perspective cameras, depth for orthogonal ones.
+		int min_x;
+		int min_y;
+		int max_x;
+		int max_y;
+	};
+
+	class RasterHZBuffer : public HZBuffer {
+		Size2i tile_grid_size;
+		LocalVector<LocalVector<const ScreenTriangle *>> tile_bins;
+		bool orthogonal = false;
+
+		void _rasterize_tile(uint32_t p_tile, void *p_userdata);
+		void _rasterize_triangle(const ScreenTriangle &p_triangle, int p_from_x, int p_from_y, int p_to_x, int p_to_y);
+
+	public:
+		RID scenario_rid;
+
+		virtual void clear() override;
+		virtual void resize(const Size2i &p_size) override;
+		_FORCE_INLINE_ Size2i get_size() const { return sizes.is_empty() ? Size2i() : sizes[0]; }
+
+		void rasterize(const LocalVector<LocalVector<ScreenTriangle>> &p_triangles, bool p_orthogonal, float p_z_far, ThreadWorkPool &p_thread_pool);
+	};
+
+private:
+	struct InstanceID {
+		RID scenario;
+		RID instance;
+
+		bool operator<(const InstanceID &rhs) const {
+			if (instance == rhs.instance) {
+				return rhs.scenario < scenario;
+			}
+			return instance < rhs.instance;
+		}
+
+		InstanceID() {}
+		InstanceID(RID s, RID i) :
+				scenario(s), instance(i) {}
+	};
+
+	struct Occluder {
+		PackedVector3Array vertices;
+		PackedInt32Array indices;
+		Set<InstanceID> users;
+	};
+
+	struct OccluderInstance {
+		RID occluder;
+		LocalVector<Vector3> xformed_vertices;
+		LocalVector<uint32_t> indices;
+		AABB aabb;
+		Transform3D xform;
+		bool enabled = true;
+		bool removed = false;
+	};
+
+	struct Scenario {
+		HashMap<RID, OccluderInstance> instances;
+		Set<RID> dirty_instances; // To avoid duplicates
+		LocalVector<RID> dirty_instances_array; // To iterate and split into threads
+		LocalVector<RID> removed_instances;
+
+		// Instances that survived frustum culling in the last buffer update.
+		LocalVector<const OccluderInstance *> visible_instances;
+
+		void _update_dirty_instance(uint32_t p_idx, RID *p_instances);
+		void update(ThreadWorkPool &p_thread_pool);
+	};
+
+	struct SetupThreadData {
+		const Scenario *scenario;
+		Transform3D cam_inv_transform;
+		CameraMatrix cam_projection;
+		Size2i buffer_size;
+		float z_near;
+		bool orthogonal;
+		uint32_t thread_count;
+	};
+
+	static RasterOcclusionCull *raster_singleton;
+
+	RID_PtrOwner<Occluder> occluder_owner;
+	HashMap<RID, Scenario> scenarios;
+	HashMap<RID, RasterHZBuffer> buffers;
+
+	// Projected occluder triangles and view space vertices, one list per thread of the setup pass.
+	LocalVector<LocalVector<ScreenTriangle>> thread_triangles;
+	LocalVector<LocalVector<Vector3>> thread_view_vertices;
+
+	void _setup_triangles_threaded(uint32_t p_thread, SetupThreadData *p_data);
+	void _setup_instance_triangles(const OccluderInstance *p_instance, const SetupThreadData *p_data, uint32_t p_thread);
+
+public:
+	virtual bool is_occluder(RID p_rid) override;
+	virtual RID occluder_allocate() override;
+	virtual void occluder_initialize(RID p_occluder) override;
+	virtual void occluder_set_mesh(RID p_occluder, const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices) override;
+	virtual void free_occluder(RID p_occluder) override;
+
+	virtual void add_scenario(RID p_scenario) override;
+	virtual void remove_scenario(RID p_scenario) override;
+	virtual void scenario_set_instance(RID p_scenario, RID p_instance, RID p_occluder, const Transform3D &p_xform, bool p_enabled) override;
+	virtual void scenario_remove_instance(RID p_scenario, RID p_instance) override;
+
+	virtual void add_buffer(RID p_buffer) override;
+	virtual void remove_buffer(RID p_buffer) override;
+	virtual HZBuffer *buffer_get_ptr(RID p_buffer) override;
+	virtual void buffer_set_scenario(RID p_buffer, RID p_scenario) override;
+	virtual void buffer_set_size(RID p_buffer, const Vector2i &p_size) override;
+	virtual void buffer_update(RID p_buffer, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, ThreadWorkPool &p_thread_pool) override;
+	virtual RID buffer_get_debug_texture(RID p_buffer) override;
+
+	RasterOcclusionCull();
+	~RasterOcclusionCull();
+};
+
+#endif // RASTER_OCCLUSION_CULL_H
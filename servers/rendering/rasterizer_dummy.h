@@ -318,8 +318,17 @@ public:
 
 	/* MESH API */
 
-	RID mesh_allocate() override { return RID(); }
-	void mesh_initialize(RID p_rid) override {}
+	struct DummyMesh {
+		AABB custom_aabb;
+	};
+	mutable RID_Owner<DummyMesh> mesh_owner;
+
+	RID mesh_allocate() override {
+		return mesh_owner.allocate_rid();
+	}
+	void mesh_initialize(RID p_rid) override {
+		mesh_owner.initialize_rid(p_rid, DummyMesh());
+	}
 	void mesh_set_blend_shape_count(RID p_mesh, int p_blend_shape_count) override {}
 	bool mesh_needs_instance(RID p_mesh, bool p_has_skeleton) override { return false; }
 	RID mesh_instance_create(RID p_base) override { return RID(); }
@@ -347,10 +356,19 @@ public:
 	RS::SurfaceData mesh_get_surface(RID p_mesh, int p_surface) const override { return RS::SurfaceData(); }
 	int mesh_get_surface_count(RID p_mesh) const override { return 0; }
 
-	void mesh_set_custom_aabb(RID p_mesh, const AABB &p_aabb) override {}
-	AABB mesh_get_custom_aabb(RID p_mesh) const override { return AABB(); }
+	void mesh_set_custom_aabb(RID p_mesh, const AABB &p_aabb) override {
+		DummyMesh *mesh = mesh_owner.get_or_null(p_mesh);
+		ERR_FAIL_COND(!mesh);
+		mesh->custom_aabb = p_aabb;
+	}
+	AABB mesh_get_custom_aabb(RID p_mesh) const override {
+		DummyMesh *mesh = mesh_owner.get_or_null(p_mesh);
+		ERR_FAIL_COND_V(!mesh, AABB());
+		return mesh->custom_aabb;
+	}
 
-	AABB mesh_get_aabb(RID p_mesh, RID p_skeleton = RID()) override { return AABB(); }
+	// Meshes have no surfaces here, so their bounds are the custom ones.
+	AABB mesh_get_aabb(RID p_mesh, RID p_skeleton = RID()) override { return mesh_get_custom_aabb(p_mesh); }
 	void mesh_set_shadow_mesh(RID p_mesh, RID p_shadow_mesh) override {}
 	void mesh_clear(RID p_mesh) override {}
 
@@ -677,8 +695,17 @@ public:
 	Rect2i render_target_get_sdf_rect(RID p_render_target) const override { return Rect2i(); }
 	void render_target_mark_sdf_enabled(RID p_render_target, bool p_enabled) override {}
 
-	RS::InstanceType get_base_type(RID p_rid) const override { return RS::INSTANCE_NONE; }
+	RS::InstanceType get_base_type(RID p_rid) const override {
+		if (mesh_owner.owns(p_rid)) {
+			return RS::INSTANCE_MESH;
+		}
+		return RS::INSTANCE_NONE;
+	}
 	bool free(RID p_rid) override {
+		if (mesh_owner.owns(p_rid)) {
+			mesh_owner.free(p_rid);
+			return true;
+		}
 		if (texture_owner.owns(p_rid)) {
 			// delete the texture
 			DummyTexture *texture = texture_owner.get_or_null(p_rid);
@@ -30,7 +30,9 @@
 
 #include "renderer_canvas_cull.h"
 
+#include "core/config/project_settings.h"
 #include "core/math/geometry_2d.h"
+#include "renderer_thread_pool.h"
 #include "renderer_viewport.h"
 #include "rendering_server_default.h"
 #include "rendering_server_globals.h"
@@ -40,32 +42,115 @@ static const int z_range = RS::CANVAS_ITEM_Z_MAX - RS::CANVAS_ITEM_Z_MIN + 1;
 void RendererCanvasCull::_render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, RenderingServer::CanvasItemTextureFilter p_default_filter, RenderingServer::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel) {
 	RENDER_TIMESTAMP("Cull CanvasItem Tree");
 
-	memset(z_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
-	memset(z_last_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
+	RendererCanvasRender::Item *list = nullptr;
+	RendererCanvasRender::Item *list_end = nullptr;
 
-	for (int i = 0; i < p_child_item_count; i++) {
-		_cull_canvas_item(p_child_items[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true);
-	}
-	if (p_canvas_item) {
-		_cull_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true);
+	bool split = use_threaded_cull && RendererThreadPool::singleton->thread_work_pool.get_thread_count() > 1;
+	bool threaded = false;
+
+	if (split) {
+		LocalVector<CullTask> &tasks = cull_tasks[0];
+		tasks.clear();
+		cull_task_list = 0;
+
+		for (int i = 0; i < p_child_item_count; i++) {
+			CullTask task;
+			task.item = p_child_items[i].item;
+			task.xform = p_transform;
+			task.modulate = Color(1, 1, 1, 1);
+			tasks.push_back(task);
+		}
+		if (p_canvas_item) {
+			CullTask task;
+			task.item = p_canvas_item;
+			task.xform = p_transform;
+			task.modulate = Color(1, 1, 1, 1);
+			tasks.push_back(task);
+		}
+
+		threaded = _split_cull_tasks(p_clip_rect);
 	}
 
-	RendererCanvasRender::Item *list = nullptr;
-	RendererCanvasRender::Item *list_end = nullptr;
+	if (threaded) {
+		const LocalVector<CullTask> &tasks = cull_tasks[cull_task_list];
+		uint32_t chunk_count = MIN(tasks.size() / CULL_TASKS_PER_CHUNK, (uint32_t)RendererThreadPool::singleton->thread_work_pool.get_thread_count() * CULL_CHUNKS_PER_THREAD);
+		chunk_count = MAX(chunk_count, 2u);
+
+		while (cull_chunks.size() < chunk_count) {
+			CullChunk chunk;
+			chunk.z_list = (RendererCanvasRender::Item **)memalloc(z_range * sizeof(RendererCanvasRender::Item *));
+			chunk.z_last_list = (RendererCanvasRender::Item **)memalloc(z_range * sizeof(RendererCanvasRender::Item *));
+			cull_chunks.push_back(chunk);
+		}
+
+		for (uint32_t i = 0; i < chunk_count; i++) {
+			cull_chunks[i].from = tasks.size() * i / chunk_count;
+			cull_chunks[i].to = tasks.size() * (i + 1) / chunk_count;
+		}
+
+		RendererThreadPool::singleton->thread_work_pool.do_work(chunk_count, this, &RendererCanvasCull::_cull_canvas_chunk, &p_clip_rect);
 
-	for (int i = 0; i < z_range; i++) {
-		if (!z_list[i]) {
-			continue;
+		int z_min = z_range;
+		int z_max = -1;
+		for (uint32_t i = 0; i < chunk_count; i++) {
+			z_min = MIN(z_min, cull_chunks[i].z_min);
+			z_max = MAX(z_max, cull_chunks[i].z_max);
 		}
-		if (!list) {
-			list = z_list[i];
-			list_end = z_last_list[i];
+
+		// Concatenate per z, in chunk order, which is the order the serial cull would have visited them in.
+		for (int i = z_min; i <= z_max; i++) {
+			for (uint32_t j = 0; j < chunk_count; j++) {
+				const CullChunk &chunk = cull_chunks[j];
+				if (i < chunk.z_min || i > chunk.z_max || !chunk.z_list[i]) {
+					continue;
+				}
+				if (!list) {
+					list = chunk.z_list[i];
+					list_end = chunk.z_last_list[i];
+				} else {
+					list_end->next = chunk.z_list[i];
+					list_end = chunk.z_last_list[i];
+				}
+			}
+		}
+	} else {
+		memset(z_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
+		memset(z_last_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
+
+		if (split) {
+			// Too little work to be worth threading, but the tree may have been partially split already.
+			const LocalVector<CullTask> &tasks = cull_tasks[cull_task_list];
+			for (uint32_t i = 0; i < tasks.size(); i++) {
+				_run_cull_task(tasks[i], p_clip_rect, z_list, z_last_list);
+			}
 		} else {
-			list_end->next = z_list[i];
-			list_end = z_last_list[i];
+			for (int i = 0; i < p_child_item_count; i++) {
+				_cull_canvas_item(p_child_items[i].item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true);
+			}
+			if (p_canvas_item) {
+				_cull_canvas_item(p_canvas_item, p_transform, p_clip_rect, Color(1, 1, 1, 1), 0, z_list, z_last_list, nullptr, nullptr, true);
+			}
+		}
+
+		for (int i = 0; i < z_range; i++) {
+			if (!z_list[i]) {
+				continue;
+			}
+			if (!list) {
+				list = z_list[i];
+				list_end = z_last_list[i];
+			} else {
+				list_end->next = z_list[i];
+				list_end = z_last_list[i];
+			}
 		}
 	}
 
+	if (redraw_requested.is_set()) {
+		redraw_requested.clear();
+		RenderingServerDefault::redraw_request();
+	}
+
 	RENDER_TIMESTAMP("Render Canvas Items");
 
 	bool sdf_flag;
@@ -176,7 +261,7 @@ void RendererCanvasCull::_attach_canvas_item_for_draw(RendererCanvasCull::Item *
 		//something to draw?
 
 		if (ci->update_when_visible) {
-			RenderingServerDefault::redraw_request();
+			redraw_requested.set();
 		}
 
 		if (ci->commands != nullptr) {
@@ -204,7 +289,9 @@ void RendererCanvasCull::_attach_canvas_item_for_draw(RendererCanvasCull::Item *
 
 		if (ci->visibility_notifier) {
 			if (!ci->visibility_notifier->visible_element.in_list()) {
+				visibility_notifier_lock.lock();
 				visibility_notifier_list.add(&ci->visibility_notifier->visible_element);
+				visibility_notifier_lock.unlock();
 				ci->visibility_notifier->just_visible = true;
 			}
 
@@ -213,11 +300,9 @@ void RendererCanvasCull::_attach_canvas_item_for_draw(RendererCanvasCull::Item *
 	}
 }
 
-void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort) {
-	Item *ci = p_canvas_item;
-
+bool RendererCanvasCull::_prepare_canvas_item(Item *ci, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, Item *p_canvas_clip, Transform2D &r_xform, Rect2 &r_global_rect, Color &r_modulate, int &r_z, Item *&r_material_owner) {
 	if (!ci->visible) {
-		return;
+		return false;
 	}
 
 	if (ci->children_order_dirty) {
@@ -233,36 +318,33 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 		}
 	}
 
-	Transform2D xform = ci->xform;
+	r_xform = ci->xform;
 	if (snapping_2d_transforms_to_pixel) {
-		xform.elements[2] = xform.elements[2].floor();
+		r_xform.elements[2] = r_xform.elements[2].floor();
 	}
-	xform = p_transform * xform;
+	r_xform = p_transform * r_xform;
 
-	Rect2 global_rect = xform.xform(rect);
-	global_rect.position += p_clip_rect.position;
+	r_global_rect = r_xform.xform(rect);
+	r_global_rect.position += p_clip_rect.position;
 
-	if (ci->use_parent_material && p_material_owner) {
-		ci->material_owner = p_material_owner;
+	if (ci->use_parent_material && r_material_owner) {
+		ci->material_owner = r_material_owner;
 	} else {
-		p_material_owner = ci;
+		r_material_owner = ci;
 		ci->material_owner = nullptr;
 	}
 
-	Color modulate(ci->modulate.r * p_modulate.r, ci->modulate.g * p_modulate.g, ci->modulate.b * p_modulate.b, ci->modulate.a * p_modulate.a);
+	r_modulate = Color(ci->modulate.r * p_modulate.r, ci->modulate.g * p_modulate.g, ci->modulate.b * p_modulate.b, ci->modulate.a * p_modulate.a);
 
-	if (modulate.a < 0.007) {
-		return;
+	if (r_modulate.a < 0.007) {
+		return false;
 	}
 
-	int child_item_count = ci->child_items.size();
-	Item **child_items = ci->child_items.ptrw();
-
 	if (ci->clip) {
 		if (p_canvas_clip != nullptr) {
-			ci->final_clip_rect = p_canvas_clip->final_clip_rect.intersection(global_rect);
+			ci->final_clip_rect = p_canvas_clip->final_clip_rect.intersection(r_global_rect);
 		} else {
-			ci->final_clip_rect = global_rect;
+			ci->final_clip_rect = r_global_rect;
 		}
 		ci->final_clip_rect.position = ci->final_clip_rect.position.round();
 		ci->final_clip_rect.size = ci->final_clip_rect.size.round();
@@ -273,11 +355,28 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 	}
 
 	if (ci->z_relative) {
-		p_z = CLAMP(p_z + ci->z_index, RS::CANVAS_ITEM_Z_MIN, RS::CANVAS_ITEM_Z_MAX);
+		r_z = CLAMP(r_z + ci->z_index, RS::CANVAS_ITEM_Z_MIN, RS::CANVAS_ITEM_Z_MAX);
 	} else {
-		p_z = ci->z_index;
+		r_z = ci->z_index;
 	}
 
+	return true;
+}
+
+void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort) {
+	Item *ci = p_canvas_item;
+
+	Transform2D xform;
+	Rect2 global_rect;
+	Color modulate;
+
+	if (!_prepare_canvas_item(ci, p_transform, p_clip_rect, p_modulate, p_canvas_clip, xform, global_rect, modulate, p_z, p_material_owner)) {
+		return;
+	}
+
+	int child_item_count = ci->child_items.size();
+	Item **child_items = ci->child_items.ptrw();
+
 	if (ci->sort_y) {
 		if (allow_y_sort) {
 			if (ci->ysort_children_count == -1) {
@@ -333,6 +432,117 @@ void RendererCanvasCull::_cull_canvas_item(Item *p_canvas_item, const Transform2
 	}
 }
 
+void RendererCanvasCull::_run_cull_task(const CullTask &p_task, const Rect2 &p_clip_rect, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list) {
+	if (p_task.attach) {
+		_attach_canvas_item_for_draw(p_task.item, p_task.canvas_clip, z_list, z_last_list, p_task.xform, p_clip_rect, p_task.global_rect, p_task.modulate, p_task.z, p_task.material_owner, false, nullptr, p_task.xform);
+	} else {
+		_cull_canvas_item(p_task.item, p_task.xform, p_clip_rect, p_task.modulate, p_task.z, z_list, z_last_list, p_task.canvas_clip, p_task.material_owner, true);
+	}
+}
+
+bool RendererCanvasCull::_split_cull_tasks(const Rect2 &p_clip_rect) {
+	uint32_t target = RendererThreadPool::singleton->thread_work_pool.get_thread_count() * CULL_CHUNKS_PER_THREAD * CULL_TASKS_PER_CHUNK;
+	uint32_t split_items = 0;
+
+	// Split level by level, so the tasks stay in traversal order. Y-sorted items and canvas groups need their
+	// whole subtree in the same z lists, so they are never split.
+	for (int depth = 0; depth < CULL_MAX_SPLIT_DEPTH && cull_tasks[cull_task_list].size() < target; depth++) {
+		const LocalVector<CullTask> &tasks = cull_tasks[cull_task_list];
+		LocalVector<CullTask> &split_tasks = cull_tasks[cull_task_list ^ 1];
+		split_tasks.clear();
+
+		bool split = false;
+
+		for (uint32_t i = 0; i < tasks.size(); i++) {
+			const CullTask &task = tasks[i];
+			Item *ci = task.item;
+
+			if (task.attach || !ci->visible || ci->sort_y || ci->canvas_group != nullptr || ci->child_items.is_empty()) {
+				split_tasks.push_back(task);
+				continue;
+			}
+
+			split = true;
+			split_items++;
+
+			CullTask self;
+			self.item = ci;
+			self.canvas_clip = task.canvas_clip;
+			self.material_owner = task.material_owner;
+			self.z = task.z;
+			self.attach = true;
+
+			if (!_prepare_canvas_item(ci, task.xform, p_clip_rect, task.modulate, task.canvas_clip, self.xform, self.global_rect, self.modulate, self.z, self.material_owner)) {
+				continue;
+			}
+
+			CullTask child;
+			child.canvas_clip = (Item *)ci->final_clip_owner;
+			child.material_owner = self.material_owner;
+			child.xform = self.xform;
+			child.modulate = self.modulate;
+			child.z = self.z;
+
+			int child_item_count = ci->child_items.size();
+			Item **child_items = ci->child_items.ptrw();
+
+			for (int j = 0; j < child_item_count; j++) {
+				if (child_items[j]->behind) {
+					child.item = child_items[j];
+					split_tasks.push_back(child);
+				}
+			}
+			split_tasks.push_back(self);
+			for (int j = 0; j < child_item_count; j++) {
+				if (!child_items[j]->behind) {
+					child.item = child_items[j];
+					split_tasks.push_back(child);
+				}
+			}
+		}
+
+		cull_task_list ^= 1;
+
+		if (!split) {
+			break;
+		}
+	}
+
+	const LocalVector<CullTask> &tasks = cull_tasks[cull_task_list];
+	if (tasks.size() < CULL_TASKS_PER_CHUNK * 2) {
+		return false;
+	}
+
+	// Rough lower bound of the items left to cull, to avoid threading small trees.
+	uint32_t item_count = split_items;
+	for (uint32_t i = 0; i < tasks.size(); i++) {
+		item_count += tasks[i].attach ? 1 : 1 + tasks[i].item->child_items.size();
+	}
+
+	return item_count >= thread_cull_threshold;
+}
+
+void RendererCanvasCull::_cull_canvas_chunk(uint32_t p_chunk, const Rect2 *p_clip_rect) {
+	CullChunk &chunk = cull_chunks[p_chunk];
+	const LocalVector<CullTask> &tasks = cull_tasks[cull_task_list];
+
+	memset(chunk.z_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
+	memset(chunk.z_last_list, 0, z_range * sizeof(RendererCanvasRender::Item *));
+
+	for (uint32_t i = chunk.from; i < chunk.to; i++) {
+		_run_cull_task(tasks[i], *p_clip_rect, chunk.z_list, chunk.z_last_list);
+	}
+
+	chunk.z_min = 0;
+	while (chunk.z_min < z_range && !chunk.z_list[chunk.z_min]) {
+		chunk.z_min++;
+	}
+	chunk.z_max = z_range - 1;
+	while (chunk.z_max >= chunk.z_min && !chunk.z_list[chunk.z_max]) {
+		chunk.z_max--;
+	}
+}
+
 void RendererCanvasCull::render_canvas(RID p_render_target, Canvas *p_canvas, const Transform2D &p_transform, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, const Rect2 &p_clip_rect, RenderingServer::CanvasItemTextureFilter p_default_filter, RenderingServer::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_transforms_to_pixel, bool p_snap_2d_vertices_to_pixel) {
 	RENDER_TIMESTAMP(">Render Canvas");
 
@@ -1717,9 +1927,17 @@ RendererCanvasCull::RendererCanvasCull() {
 	z_last_list = (RendererCanvasRender::Item **)memalloc(z_range * sizeof(RendererCanvasRender::Item *));
 
 	disable_scale = false;
+
+	use_threaded_cull = GLOBAL_GET("rendering/2d/options/use_threaded_culling");
+	thread_cull_threshold = GLOBAL_GET("rendering/2d/options/threaded_cull_minimum_items");
 }
 
 RendererCanvasCull::~RendererCanvasCull() {
 	memfree(z_list);
 	memfree(z_last_list);
+
+	for (uint32_t i = 0; i < cull_chunks.size(); i++) {
+		memfree(cull_chunks[i].z_list);
+		memfree(cull_chunks[i].z_last_list);
+	}
 }
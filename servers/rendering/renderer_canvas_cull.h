@@ -31,7 +31,10 @@
 #ifndef RENDERING_SERVER_CANVAS_CULL_H
 #define RENDERING_SERVER_CANVAS_CULL_H
 
+#include "core/os/spin_lock.h"
+#include "core/templates/local_vector.h"
 #include "core/templates/paged_allocator.h"
+#include "core/templates/safe_refcount.h"
 #include "renderer_compositor.h"
 #include "renderer_viewport.h"
 
@@ -173,16 +176,59 @@ public:
 
 	PagedAllocator<Item::VisibilityNotifierData> visibility_notifier_allocator;
 	SelfList<Item::VisibilityNotifierData>::List visibility_notifier_list;
+	SpinLock visibility_notifier_lock;
+	SafeFlag redraw_requested; // Set by the cull threads, raised once the tree is culled.
 
 	_FORCE_INLINE_ void _attach_canvas_item_for_draw(Item *ci, Item *p_canvas_clip, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, const Transform2D &xform, const Rect2 &p_clip_rect, Rect2 global_rect, const Color &modulate, int p_z, RendererCanvasCull::Item *p_material_owner, bool use_canvas_group, RendererCanvasRender::Item *canvas_group_from, const Transform2D &p_xform);
 
 private:
 	void _render_canvas_item_tree(RID p_to_render_target, Canvas::ChildItem *p_child_items, int p_child_item_count, Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel);
+	_FORCE_INLINE_ bool _prepare_canvas_item(Item *ci, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, Item *p_canvas_clip, Transform2D &r_xform, Rect2 &r_global_rect, Color &r_modulate, int &r_z, Item *&r_material_owner);
 	void _cull_canvas_item(Item *p_canvas_item, const Transform2D &p_transform, const Rect2 &p_clip_rect, const Color &p_modulate, int p_z, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list, Item *p_canvas_clip, Item *p_material_owner, bool allow_y_sort);
 
 	RendererCanvasRender::Item **z_list;
 	RendererCanvasRender::Item **z_last_list;
 
+	enum {
+		CULL_CHUNKS_PER_THREAD = 2,
+		CULL_TASKS_PER_CHUNK = 8,
+		CULL_MAX_SPLIT_DEPTH = 8,
+	};
+
+	// Either a subtree still to be culled, or the self draw of an item whose children were split into their own tasks.
+	// Running the tasks in order produces the same z lists as culling the whole tree recursively.
+	struct CullTask {
+		Item *item = nullptr;
+		Item *canvas_clip = nullptr;
+		Item *material_owner = nullptr;
+		Transform2D xform;
+		Rect2 global_rect;
+		Color modulate;
+		int z = 0;
+		bool attach = false;
+	};
+
+	// A run of consecutive tasks culled on one thread into its own z lists, merged in order afterwards.
+	struct CullChunk {
+		uint32_t from = 0;
+		uint32_t to = 0;
+		int z_min = 0;
+		int z_max = -1;
+		RendererCanvasRender::Item **z_list = nullptr;
+		RendererCanvasRender::Item **z_last_list = nullptr;
+	};
+
+	LocalVector<CullTask> cull_tasks[2];
+	uint32_t cull_task_list = 0;
+	LocalVector<CullChunk> cull_chunks;
+
+	bool use_threaded_cull = true;
+	uint32_t thread_cull_threshold = 1000;
+
+	_FORCE_INLINE_ void _run_cull_task(const CullTask &p_task, const Rect2 &p_clip_rect, RendererCanvasRender::Item **z_list, RendererCanvasRender::Item **z_last_list);
+	bool _split_cull_tasks(const Rect2 &p_clip_rect);
+	void _cull_canvas_chunk(uint32_t p_chunk, const Rect2 *p_clip_rect);
+
 public:
 	void render_canvas(RID p_render_target, Canvas *p_canvas, const Transform2D &p_transform, RendererCanvasRender::Light *p_lights, RendererCanvasRender::Light *p_directional_lights, const Rect2 &p_clip_rect, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_transforms_to_pixel, bool p_snap_2d_vertices_to_pixel);
 
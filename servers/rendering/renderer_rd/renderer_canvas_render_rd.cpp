@@ -393,6 +393,59 @@ void RendererCanvasRenderRD::_bind_canvas_texture(RD::DrawListID p_draw_list, RI
 	r_last_texture = p_texture;
 }
 
+uint32_t RendererCanvasRenderRD::_get_item_lights(const Item *p_item, Light *p_lights, uint32_t *r_lights) {
+	uint32_t light_count = 0;
+	Light *light = p_lights;
+
+	while (light) {
+		if (light->render_index_cache >= 0 && p_item->light_mask & light->item_mask && p_item->z_final >= light->z_min && p_item->z_final <= light->z_max && p_item->global_rect_cache.intersects_transformed(light->xform_cache, light->rect_cache)) {
+			uint32_t light_index = light->render_index_cache;
+			r_lights[light_count >> 2] |= light_index << ((light_count & 3) * 8);
+
+			light_count++;
+
+			if (light_count == MAX_LIGHTS_PER_ITEM) {
+				break;
+			}
+		}
+		light = light->next_ptr;
+	}
+
+	return light_count;
+}
+
+void RendererCanvasRenderRD::_get_rect_src_dst(const Item::CommandRect *p_rect, const Size2 &p_texpixel_size, Rect2 &r_src_rect, Rect2 &r_dst_rect) {
+	r_dst_rect = Rect2(p_rect->rect.position, p_rect->rect.size);
+
+	if (r_dst_rect.size.width < 0) {
+		r_dst_rect.position.x += r_dst_rect.size.width;
+		r_dst_rect.size.width *= -1;
+	}
+	if (r_dst_rect.size.height < 0) {
+		r_dst_rect.position.y += r_dst_rect.size.height;
+		r_dst_rect.size.height *= -1;
+	}
+
+	if (p_rect->texture == RID()) {
+		r_src_rect = Rect2(0, 0, 1, 1);
+		return;
+	}
+
+	r_src_rect = (p_rect->flags & CANVAS_RECT_REGION) ? Rect2(p_rect->source.position * p_texpixel_size, p_rect->source.size * p_texpixel_size) : Rect2(0, 0, 1, 1);
+
+	if (p_rect->flags & CANVAS_RECT_FLIP_H) {
+		r_src_rect.size.x *= -1;
+	}
+
+	if (p_rect->flags & CANVAS_RECT_FLIP_V) {
+		r_src_rect.size.y *= -1;
+	}
+
+	if (p_rect->flags & CANVAS_RECT_TRANSPOSE) {
+		r_dst_rect.size.x *= -1; // Encoding in the dst_rect.z uniform
+	}
+}
+
 void RendererCanvasRenderRD::_render_item(RD::DrawListID p_draw_list, RID p_render_target, const Item *p_item, RD::FramebufferFormatID p_framebuffer_format, const Transform2D &p_canvas_transform_inverse, Item *&current_clip, Light *p_lights, PipelineVariants *p_pipeline_variants) {
 	//create an empty push constant
 
@@ -424,8 +477,8 @@ void RendererCanvasRenderRD::_render_item(RD::DrawListID p_draw_list, RID p_rend
 	push_constant.color_texture_pixel_size[0] = 0;
 	push_constant.color_texture_pixel_size[1] = 0;
 
-	push_constant.pad[0] = 0;
-	push_constant.pad[1] = 0;
+	push_constant.instance_offset = 0;
+	push_constant.pad = 0;
 
 	push_constant.lights[0] = 0;
 	push_constant.lights[1] = 0;
@@ -434,28 +487,10 @@ void RendererCanvasRenderRD::_render_item(RD::DrawListID p_draw_list, RID p_rend
 
 	uint32_t base_flags = 0;
 
-	uint16_t light_count = 0;
+	uint32_t light_count = _get_item_lights(p_item, p_lights, push_constant.lights);
 	PipelineLightMode light_mode;
 
-	{
-		Light *light = p_lights;
-
-		while (light) {
-			if (light->render_index_cache >= 0 && p_item->light_mask & light->item_mask && p_item->z_final >= light->z_min && p_item->z_final <= light->z_max && p_item->global_rect_cache.intersects_transformed(light->xform_cache, light->rect_cache)) {
-				uint32_t light_index = light->render_index_cache;
-				push_constant.lights[light_count >> 2] |= light_index << ((light_count & 3) * 8);
-
-				light_count++;
-
-				if (light_count == MAX_LIGHTS_PER_ITEM) {
-					break;
-				}
-			}
-			light = light->next_ptr;
-		}
-
-		base_flags |= light_count << FLAGS_LIGHT_COUNT_SHIFT;
-	}
+	base_flags |= light_count << FLAGS_LIGHT_COUNT_SHIFT;
 
 	light_mode = (light_count > 0 || using_directional_lights) ? PIPELINE_LIGHT_MODE_ENABLED : PIPELINE_LIGHT_MODE_DISABLED;
 
@@ -485,6 +520,15 @@ void RendererCanvasRenderRD::_render_item(RD::DrawListID p_draw_list, RID p_rend
 					current_repeat = RenderingServer::CanvasItemTextureRepeat::CANVAS_ITEM_TEXTURE_REPEAT_ENABLED;
 				}
 
+				uint32_t batch_size = 1;
+				if (rect_batches.rect_index < rect_batches.rects.size()) {
+					batch_size = rect_batches.rects[rect_batches.rect_index++];
+				}
+
+				if (batch_size == 0) {
+					break; // Drawn with the batch it belongs to.
+				}
+
 				//bind pipeline
 				{
 					RID pipeline = pipeline_variants->variants[light_mode][PIPELINE_VARIANT_QUAD].get_render_pipeline(RD::INVALID_ID, p_framebuffer_format);
@@ -498,48 +542,10 @@ void RendererCanvasRenderRD::_render_item(RD::DrawListID p_draw_list, RID p_rend
 				Rect2 src_rect;
 				Rect2 dst_rect;
 
-				if (rect->texture != RID()) {
-					src_rect = (rect->flags & CANVAS_RECT_REGION) ? Rect2(rect->source.position * texpixel_size, rect->source.size * texpixel_size) : Rect2(0, 0, 1, 1);
-					dst_rect = Rect2(rect->rect.position, rect->rect.size);
-
-					if (dst_rect.size.width < 0) {
-						dst_rect.position.x += dst_rect.size.width;
-						dst_rect.size.width *= -1;
-					}
-					if (dst_rect.size.height < 0) {
-						dst_rect.position.y += dst_rect.size.height;
-						dst_rect.size.height *= -1;
-					}
-
-					if (rect->flags & CANVAS_RECT_FLIP_H) {
-						src_rect.size.x *= -1;
-					}
-
-					if (rect->flags & CANVAS_RECT_FLIP_V) {
-						src_rect.size.y *= -1;
-					}
-
-					if (rect->flags & CANVAS_RECT_TRANSPOSE) {
-						dst_rect.size.x *= -1; // Encoding in the dst_rect.z uniform
-					}
-
-					if (rect->flags & CANVAS_RECT_CLIP_UV) {
-						push_constant.flags |= FLAGS_CLIP_RECT_UV;
-					}
-
-				} else {
-					dst_rect = Rect2(rect->rect.position, rect->rect.size);
-
-					if (dst_rect.size.width < 0) {
-						dst_rect.position.x += dst_rect.size.width;
-						dst_rect.size.width *= -1;
-					}
-					if (dst_rect.size.height < 0) {
-						dst_rect.position.y += dst_rect.size.height;
-						dst_rect.size.height *= -1;
-					}
+				_get_rect_src_dst(rect, texpixel_size, src_rect, dst_rect);
 
-					src_rect = Rect2(0, 0, 1, 1);
+				if (rect->texture != RID() && (rect->flags & CANVAS_RECT_CLIP_UV)) {
+					push_constant.flags |= FLAGS_CLIP_RECT_UV;
 				}
 
 				if (rect->flags & CANVAS_RECT_MSDF) {
@@ -565,9 +571,36 @@ void RendererCanvasRenderRD::_render_item(RD::DrawListID p_draw_list, RID p_rend
 				push_constant.dst_rect[2] = dst_rect.size.width;
 				push_constant.dst_rect[3] = dst_rect.size.height;
 
-				RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
-				RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
-				RD::get_singleton()->draw_list_draw(p_draw_list, true);
+				if (batch_size > 1) {
+					// Transforms, modulation and rects come from the instances instead.
+					float world_backup[6];
+					for (int j = 0; j < 6; j++) {
+						world_backup[j] = push_constant.world[j];
+					}
+					_update_transform_2d_to_mat2x3(Transform2D(), push_constant.world);
+
+					for (int j = 0; j < 4; j++) {
+						push_constant.modulation[j] = 1.0;
+					}
+
+					push_constant.flags |= FLAGS_INSTANCING_RECTS;
+					push_constant.instance_offset = rect_batches.instance_index;
+					rect_batches.instance_index += batch_size;
+
+					RD::get_singleton()->draw_list_bind_uniform_set(p_draw_list, rect_batches.uniform_set, TRANSFORMS_UNIFORM_SET);
+					RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
+					RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
+					RD::get_singleton()->draw_list_draw(p_draw_list, true, batch_size);
+
+					for (int j = 0; j < 6; j++) {
+						push_constant.world[j] = world_backup[j];
+					}
+					push_constant.instance_offset = 0;
+				} else {
+					RD::get_singleton()->draw_list_set_push_constant(p_draw_list, &push_constant, sizeof(PushConstant));
+					RD::get_singleton()->draw_list_bind_index_array(p_draw_list, shader.quad_index_array);
+					RD::get_singleton()->draw_list_draw(p_draw_list, true);
+				}
 
 			} break;
 
@@ -1033,6 +1066,203 @@ RID RendererCanvasRenderRD::_create_base_uniform_set(RID p_to_render_target, boo
 	return uniform_set;
 }
 
+void RendererCanvasRenderRD::_prepare_rect_batches(int p_item_count, const Transform2D &p_canvas_transform_inverse, Light *p_lights) {
+	rect_batches.instances.clear();
+	rect_batches.rects.clear();
+	rect_batches.rect_index = 0;
+	rect_batches.instance_index = 0;
+
+	// Must visit the rects exactly like _render_item() does, so it finds them in the same order.
+	bool batching = false;
+	uint32_t batch_from = 0;
+	RID batch_texture;
+	RS::CanvasItemTextureFilter batch_filter = RS::CANVAS_ITEM_TEXTURE_FILTER_DEFAULT;
+	RS::CanvasItemTextureRepeat batch_repeat = RS::CANVAS_ITEM_TEXTURE_REPEAT_DEFAULT;
+	const Item *batch_clip = nullptr;
+	uint32_t batch_msdf = 0;
+	float batch_msdf_params[2] = { 0, 0 };
+
+	RID size_texture;
+	Size2 texpixel_size;
+	bool size_valid = false;
+
+	for (int i = 0; i < p_item_count; i++) {
+		const Item *ci = items[i];
+
+		RID material = ci->material_owner == nullptr ? ci->material : ci->material_owner->material;
+		bool item_batchable = material.is_null() && ci->canvas_group == nullptr && !using_directional_lights;
+
+		if (item_batchable && p_lights) {
+			uint32_t lights[4] = { 0, 0, 0, 0 };
+			item_batchable = _get_item_lights(ci, p_lights, lights) == 0;
+		}
+
+		RS::CanvasItemTextureFilter current_filter = ci->texture_filter != RS::CANVAS_ITEM_TEXTURE_FILTER_DEFAULT ? ci->texture_filter : default_filter;
+		RS::CanvasItemTextureRepeat current_repeat = ci->texture_repeat != RS::CANVAS_ITEM_TEXTURE_REPEAT_DEFAULT ? ci->texture_repeat : default_repeat;
+
+		Transform2D base_transform = p_canvas_transform_inverse * ci->final_transform;
+		Transform2D draw_transform = base_transform;
+
+		bool skipping = false;
+
+		const Item::Command *c = ci->commands;
+		while (c) {
+			if (skipping && c->type != Item::Command::TYPE_ANIMATION_SLICE) {
+				c = c->next;
+				continue;
+			}
+
+			switch (c->type) {
+				case Item::Command::TYPE_RECT: {
+					const Item::CommandRect *rect = static_cast<const Item::CommandRect *>(c);
+
+					if (rect->flags & CANVAS_RECT_TILE) {
+						current_repeat = RenderingServer::CanvasItemTextureRepeat::CANVAS_ITEM_TEXTURE_REPEAT_ENABLED;
+					}
+
+					bool rect_batchable = item_batchable && !(rect->flags & CANVAS_RECT_CLIP_UV);
+
+					RID texture = rect->texture.is_valid() ? rect->texture : default_canvas_texture;
+
+					if (rect_batchable && rect->texture.is_valid() && (rect->flags & CANVAS_RECT_REGION)) {
+						// Regions are normalized by the texture size.
+						if (texture != size_texture) {
+							RID uniform_set;
+							Size2i size;
+							Color specular_shininess;
+							bool use_normal;
+							bool use_specular;
+							size_valid = storage->canvas_texture_get_uniform_set(texture, current_filter, current_repeat, shader.default_version_rd_shader, CANVAS_TEXTURE_UNIFORM_SET, uniform_set, size, specular_shininess, use_normal, use_specular);
+							size_texture = texture;
+							texpixel_size = Size2(1.0 / float(size.x), 1.0 / float(size.y));
+						}
+						rect_batchable = size_valid; // Otherwise drawn with the default texture instead.
+					}
+
+					uint32_t msdf = rect->flags & CANVAS_RECT_MSDF;
+
+					if (batching && rect_batchable && texture == batch_texture && current_filter == batch_filter && current_repeat == batch_repeat && ci->final_clip_owner == batch_clip && msdf == batch_msdf && (!msdf || (rect->px_range == batch_msdf_params[0] && rect->outline == batch_msdf_params[1]))) {
+						rect_batches.rects[batch_from]++;
+						rect_batches.rects.push_back(0);
+					} else {
+						if (batching) {
+							rect_batches.end_batch(batch_from);
+						}
+
+						batching = rect_batchable;
+						batch_from = rect_batches.rects.size();
+						rect_batches.rects.push_back(1);
+
+						if (!batching) {
+							break;
+						}
+
+						batch_texture = texture;
+						batch_filter = current_filter;
+						batch_repeat = current_repeat;
+						batch_clip = ci->final_clip_owner;
+						batch_msdf = msdf;
+						batch_msdf_params[0] = rect->px_range;
+						batch_msdf_params[1] = rect->outline;
+					}
+
+					Rect2 src_rect;
+					Rect2 dst_rect;
+					_get_rect_src_dst(rect, texpixel_size, src_rect, dst_rect);
+
+					RectInstance instance;
+					_update_transform_2d_to_mat2x4(draw_transform, instance.xform);
+
+					Color modulation = rect->modulate * ci->final_modulate;
+					instance.modulation[0] = modulation.r;
+					instance.modulation[1] = modulation.g;
+					instance.modulation[2] = modulation.b;
+					instance.modulation[3] = modulation.a;
+
+					instance.src_rect[0] = src_rect.position.x;
+					instance.src_rect[1] = src_rect.position.y;
+					instance.src_rect[2] = src_rect.size.width;
+					instance.src_rect[3] = src_rect.size.height;
+
+					instance.dst_rect[0] = dst_rect.position.x;
+					instance.dst_rect[1] = dst_rect.position.y;
+					instance.dst_rect[2] = dst_rect.size.width;
+					instance.dst_rect[3] = dst_rect.size.height;
+
+					rect_batches.instances.push_back(instance);
+				} break;
+				case Item::Command::TYPE_TRANSFORM: {
+					const Item::CommandTransform *transform = static_cast<const Item::CommandTransform *>(c);
+					draw_transform = base_transform * transform->xform;
+				} break;
+				case Item::Command::TYPE_ANIMATION_SLICE: {
+					const Item::CommandAnimationSlice *as = static_cast<const Item::CommandAnimationSlice *>(c);
+					double current_time = RendererCompositorRD::singleton->get_total_time();
+					double local_time = Math::fposmod(current_time - as->offset, as->animation_length);
+					skipping = !(local_time >= as->slice_begin && local_time < as->slice_end);
+				} break;
+				case Item::Command::TYPE_CLIP_IGNORE: {
+					// Scissor changes end the batch, and may be reverted when the next item begins.
+					if (batching) {
+						rect_batches.end_batch(batch_from);
+					}
+					batching = false;
+					item_batchable = false;
+				} break;
+				default: {
+					// Anything else drawn ends the batch.
+					if (batching) {
+						rect_batches.end_batch(batch_from);
+					}
+					batching = false;
+				} break;
+			}
+
+			c = c->next;
+		}
+	}
+
+	if (batching) {
+		rect_batches.end_batch(batch_from);
+	}
+
+	if (rect_batches.instances.is_empty()) {
+		return;
+	}
+
+	if (rect_batches.last_frame != RendererCompositorRD::singleton->get_frame_number()) {
+		rect_batches.last_frame = RendererCompositorRD::singleton->get_frame_number();
+		rect_batches.frame_offset = 0;
+	}
+
+	if (rect_batches.instance_buffer_size < rect_batches.frame_offset + rect_batches.instances.size()) {
+		if (rect_batches.instance_buffer.is_valid()) {
+			// Freeing is deferred until the frame is done, so earlier draw lists of this frame can still use it.
+			RD::get_singleton()->free(rect_batches.instance_buffer); // Frees the uniform set by dependency.
+		}
+
+		// Sized for everything drawn so far this frame, so the next frames fit without growing again.
+		rect_batches.instance_buffer_size = next_power_of_2(rect_batches.frame_offset + rect_batches.instances.size());
+		rect_batches.frame_offset = 0;
+		rect_batches.instance_buffer = RD::get_singleton()->storage_buffer_create(sizeof(RectInstance) * rect_batches.instance_buffer_size);
+
+		Vector<RD::Uniform> uniforms;
+		{
+			RD::Uniform u;
+			u.uniform_type = RD::UNIFORM_TYPE_STORAGE_BUFFER;
+			u.binding = 0;
+			u.ids.push_back(rect_batches.instance_buffer);
+			uniforms.push_back(u);
+		}
+
+		rect_batches.uniform_set = RD::get_singleton()->uniform_set_create(uniforms, shader.default_version_rd_shader, TRANSFORMS_UNIFORM_SET);
+	}
+
+	RD::get_singleton()->buffer_update(rect_batches.instance_buffer, sizeof(RectInstance) * rect_batches.frame_offset, sizeof(RectInstance) * rect_batches.instances.size(), rect_batches.instances.ptr(), RD::BARRIER_MASK_RASTER);
+	rect_batches.instance_index = rect_batches.frame_offset;
+	rect_batches.frame_offset += rect_batches.instances.size();
+}
+
 void RendererCanvasRenderRD::_render_items(RID p_to_render_target, int p_item_count, const Transform2D &p_canvas_transform_inverse, Light *p_lights, bool p_to_backbuffer) {
 	Item *current_clip = nullptr;
 
@@ -1067,6 +1297,8 @@ void RendererCanvasRenderRD::_render_items(RID p_to_render_target, int p_item_co
 
 	RD::FramebufferFormatID fb_format = RD::get_singleton()->framebuffer_get_format(framebuffer);
 
+	_prepare_rect_batches(p_item_count, canvas_transform_inverse, p_lights);
+
 	RD::DrawListID draw_list = RD::get_singleton()->draw_list_begin(framebuffer, clear ? RD::INITIAL_ACTION_CLEAR : RD::INITIAL_ACTION_KEEP, RD::FINAL_ACTION_READ, RD::INITIAL_ACTION_KEEP, RD::FINAL_ACTION_DISCARD, clear_colors);
 
 	RD::get_singleton()->draw_list_bind_uniform_set(draw_list, fb_uniform_set, BASE_UNIFORM_SET);
@@ -2695,6 +2927,10 @@ RendererCanvasRenderRD::~RendererCanvasRenderRD() {
 		RD::get_singleton()->free(shader.quad_index_array);
 		RD::get_singleton()->free(shader.quad_index_buffer);
 		//primitives are erase by dependency
+
+		if (rect_batches.instance_buffer.is_valid()) {
+			RD::get_singleton()->free(rect_batches.instance_buffer);
+		}
 	}
 
 	if (state.shadow_fb.is_valid()) {
@@ -77,6 +77,7 @@ class RendererCanvasRenderRD : public RendererCanvasRender {
 
 		FLAGS_NINEPACH_DRAW_CENTER = (1 << 12),
 		FLAGS_USING_PARTICLES = (1 << 13),
+		FLAGS_INSTANCING_RECTS = (1 << 14),
 
 		FLAGS_USE_SKELETON = (1 << 15),
 		FLAGS_NINEPATCH_H_MODE_SHIFT = 16,
@@ -395,7 +396,8 @@ class RendererCanvasRenderRD : public RendererCanvasRender {
 				};
 				float dst_rect[4];
 				float src_rect[4];
-				float pad[2];
+				uint32_t instance_offset;
+				uint32_t pad;
 			};
 			//primitive
 			struct {
@@ -413,6 +415,43 @@ class RendererCanvasRenderRD : public RendererCanvasRender {
 		float skeleton_inverse[16];
 	};
 
+	/*****************/
+	/**** BATCHES ****/
+	/*****************/
+
+	// Consecutive rects that share texture, sampler, clip and shader state are drawn as one instanced quad.
+	// Buffers can't be updated while a draw list is recorded, so the instances are gathered before it begins.
+
+	struct RectInstance {
+		float xform[8];
+		float modulation[4];
+		float src_rect[4];
+		float dst_rect[4];
+	};
+
+	struct RectBatches {
+		LocalVector<RectInstance> instances;
+		// One entry per rect drawn, in draw order. The instance count of the batch it begins, or 0 if an earlier rect drew it.
+		LocalVector<uint32_t> rects;
+		uint32_t rect_index = 0;
+		uint32_t instance_index = 0;
+
+		// Each _render_items() call of a frame appends its instances after the previous one's, so draw lists
+		// recorded earlier in the frame keep reading what they were given.
+		RID instance_buffer;
+		RID uniform_set;
+		uint32_t instance_buffer_size = 0;
+		uint32_t frame_offset = 0;
+		uint64_t last_frame = 0;
+
+		_FORCE_INLINE_ void end_batch(uint32_t p_from) {
+			// A batch of one is drawn as a regular rect, so it needs no instance.
+			if (rects[p_from] == 1) {
+				instances.resize(instances.size() - 1);
+			}
+		}
+	} rect_batches;
+
 	Item *items[MAX_RENDER_ITEMS];
 
 	bool using_directional_lights = false;
@@ -426,6 +465,10 @@ class RendererCanvasRenderRD : public RendererCanvasRender {
 
 	RID _create_base_uniform_set(RID p_to_render_target, bool p_backbuffer);
 
+	_FORCE_INLINE_ uint32_t _get_item_lights(const Item *p_item, Light *p_lights, uint32_t *r_lights);
+	_FORCE_INLINE_ void _get_rect_src_dst(const Item::CommandRect *p_rect, const Size2 &p_texpixel_size, Rect2 &r_src_rect, Rect2 &r_dst_rect);
+	void _prepare_rect_batches(int p_item_count, const Transform2D &p_canvas_transform_inverse, Light *p_lights);
+
 	inline void _bind_canvas_texture(RD::DrawListID p_draw_list, RID p_texture, RS::CanvasItemTextureFilter p_base_filter, RS::CanvasItemTextureRepeat p_base_repeat, RID &r_last_texture, PushConstant &push_constant, Size2 &r_texpixel_size); //recursive, so regular inline used instead.
 	void _render_item(RenderingDevice::DrawListID p_draw_list, RID p_render_target, const Item *p_item, RenderingDevice::FramebufferFormatID p_framebuffer_format, const Transform2D &p_canvas_transform_inverse, Item *&current_clip, Light *p_lights, PipelineVariants *p_pipeline_variants);
 	void _render_items(RID p_to_render_target, int p_item_count, const Transform2D &p_canvas_transform_inverse, Light *p_lights, bool p_to_backbuffer = false);
@@ -75,9 +75,24 @@ void main() {
 	vec2 vertex_base_arr[4] = vec2[](vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0));
 	vec2 vertex_base = vertex_base_arr[gl_VertexIndex];
 
-	vec2 uv = draw_data.src_rect.xy + abs(draw_data.src_rect.zw) * ((draw_data.flags & FLAGS_TRANSPOSE_RECT) != 0 ? vertex_base.yx : vertex_base.xy);
+	vec4 src_rect = draw_data.src_rect;
+	vec4 dst_rect = draw_data.dst_rect;
 	vec4 color = draw_data.modulation;
-	vec2 vertex = draw_data.dst_rect.xy + abs(draw_data.dst_rect.zw) * mix(vertex_base, vec2(1.0, 1.0) - vertex_base, lessThan(draw_data.src_rect.zw, vec2(0.0, 0.0)));
+
+	uint rect_offset = (draw_data.instance_offset + uint(gl_InstanceIndex)) * 5;
+	if (bool(draw_data.flags & FLAGS_INSTANCING_RECTS)) {
+		// Batched rects, each instance stores its transform, modulation and rects.
+		color *= transforms.data[rect_offset + 2];
+		src_rect = transforms.data[rect_offset + 3];
+		dst_rect = transforms.data[rect_offset + 4];
+	}
+
+	vec2 uv = src_rect.xy + abs(src_rect.zw) * ((draw_data.flags & FLAGS_TRANSPOSE_RECT) != 0 ? vertex_base.yx : vertex_base.xy);
+	vec2 vertex = dst_rect.xy + abs(dst_rect.zw) * mix(vertex_base, vec2(1.0, 1.0) - vertex_base, lessThan(src_rect.zw, vec2(0.0, 0.0)));
+
+	if (bool(draw_data.flags & FLAGS_INSTANCING_RECTS)) {
+		vertex = (vec4(vertex, 0.0, 1.0) * mat4(transforms.data[rect_offset + 0], transforms.data[rect_offset + 1], vec4(0.0, 0.0, 1.0, 0.0), vec4(0.0, 0.0, 0.0, 1.0))).xy;
+	}
 	uvec4 bones = uvec4(0, 0, 0, 0);
 
 #endif
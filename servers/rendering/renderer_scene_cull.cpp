@@ -32,11 +32,17 @@
 
 #include "core/config/project_settings.h"
 #include "core/os/os.h"
+#include "raster_occlusion_cull.h"
 #include "rendering_server_default.h"
 #include "rendering_server_globals.h"
 
 #include <new>
 
+#if !defined(REAL_T_IS_DOUBLE) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define SCENE_CULL_SSE
+#endif
+
 /* CAMERA API */
 
 RID RendererSceneCull::camera_allocate() {
@@ -1583,21 +1589,7 @@ void RendererSceneCull::_update_instance(Instance *p_instance) {
 		return;
 	}
 
-	//quantize to improve moving object performance
-	AABB bvh_aabb = p_instance->transformed_aabb;
-
-	if (p_instance->indexer_id.is_valid() && bvh_aabb != p_instance->prev_transformed_aabb) {
-		//assume motion, see if bounds need to be quantized
-		AABB motion_aabb = bvh_aabb.merge(p_instance->prev_transformed_aabb);
-		float motion_longest_axis = motion_aabb.get_longest_axis_size();
-		float longest_axis = p_instance->transformed_aabb.get_longest_axis_size();
-
-		if (motion_longest_axis < longest_axis * 2) {
-			//moved but not a lot, use motion aabb quantizing
-			float quantize_size = Math::pow(2.0, Math::ceil(Math::log(motion_longest_axis) / Math::log(2.0))) * 0.5; //one fifth
-			bvh_aabb.quantize(quantize_size);
-		}
-	}
+	AABB bvh_aabb = _get_instance_indexer_aabb(p_instance);
 
 	if (!p_instance->indexer_id.is_valid()) {
 		if ((1 << p_instance->base_type) & RS::INSTANCE_GEOMETRY_MASK) {
@@ -1701,6 +1693,30 @@ void RendererSceneCull::_update_instance(Instance *p_instance) {
 		p_instance->scenario->instance_visibility[p_instance->visibility_index].position = p_instance->transformed_aabb.get_center();
 	}
 
+	_update_instance_pairs(p_instance);
+}
+
+AABB RendererSceneCull::_get_instance_indexer_aabb(const Instance *p_instance) const {
+	//quantize to improve moving object performance
+	AABB bvh_aabb = p_instance->transformed_aabb;
+
+	if (p_instance->indexer_id.is_valid() && bvh_aabb != p_instance->prev_transformed_aabb) {
+		//assume motion, see if bounds need to be quantized
+		AABB motion_aabb = bvh_aabb.merge(p_instance->prev_transformed_aabb);
+		float motion_longest_axis = motion_aabb.get_longest_axis_size();
+		float longest_axis = p_instance->transformed_aabb.get_longest_axis_size();
+
+		if (motion_longest_axis < longest_axis * 2) {
+			//moved but not a lot, use motion aabb quantizing
+			float quantize_size = Math::pow(2.0, Math::ceil(Math::log(motion_longest_axis) / Math::log(2.0))) * 0.5; //one fifth
+			bvh_aabb.quantize(quantize_size);
+		}
+	}
+
+	return bvh_aabb;
+}
+
+void RendererSceneCull::_update_instance_pairs(Instance *p_instance) {
 	//move instance and repair
 	pair_pass++;
 
@@ -2598,6 +2614,123 @@ bool RendererSceneCull::_visibility_parent_check(const CullData &p_cull_data, co
 	return ((parent_flags & InstanceData::FLAG_VISIBILITY_DEPENDENCY_NEEDS_CHECK) == InstanceData::FLAG_VISIBILITY_DEPENDENCY_HIDDEN_CLOSE_RANGE) || (parent_flags & InstanceData::FLAG_VISIBILITY_DEPENDENCY_FADE_CHILDREN);
 }
 
+void RendererSceneCull::CullVolumes::clear() {
+	plane_x.clear();
+	plane_y.clear();
+	plane_z.clear();
+	plane_d.clear();
+	plane_signs.clear();
+	volume_count = 0;
+}
+
+void RendererSceneCull::CullVolumes::add_frustum(const Frustum &p_frustum) {
+	ERR_FAIL_COND(volume_count == MAX_VOLUMES);
+
+	for (uint32_t i = 0; i < p_frustum.plane_count; i++) {
+		const Plane &plane = p_frustum.planes_ptr[i];
+		plane_x.push_back(plane.normal.x);
+		plane_y.push_back(plane.normal.y);
+		plane_z.push_back(plane.normal.z);
+		plane_d.push_back(plane.d);
+
+		const PlaneSign &sign = p_frustum.plane_signs_ptr[i];
+		plane_signs.push_back((sign.signs[0] == 0 ? PLANE_SIGN_X : 0) | (sign.signs[1] == 1 ? PLANE_SIGN_Y : 0) | (sign.signs[2] == 2 ? PLANE_SIGN_Z : 0));
+	}
+
+	volume_frustums[volume_count] = &p_frustum;
+	volume_plane_end[volume_count] = plane_x.size();
+	volume_count++;
+}
+
+void RendererSceneCull::CullVolumes::cull(const PagedArray<InstanceBounds> &p_bounds, uint64_t p_from, uint32_t p_count, uint64_t *r_masks) const {
+	ERR_FAIL_COND(p_count > BLOCK_SIZE);
+
+	for (uint32_t i = 0; i < p_count; i++) {
+		r_masks[i] = 0;
+	}
+
+#ifdef SCENE_CULL_SSE
+	// Transpose the block so every lane of a register holds the same bound of a different instance.
+	// Lanes past the end of the block are left empty and never written back.
+	alignas(16) float bounds[6][BLOCK_SIZE];
+	uint32_t padded_count = (p_count + 3) & ~3u;
+	for (uint32_t i = 0; i < padded_count; i++) {
+		if (i < p_count) {
+			const real_t *b = p_bounds[p_from + i].bounds;
+			for (uint32_t j = 0; j < 6; j++) {
+				bounds[j][i] = b[j];
+			}
+		} else {
+			for (uint32_t j = 0; j < 6; j++) {
+				bounds[j][i] = 0.0f;
+			}
+		}
+	}
+
+	const float *px = plane_x.ptr();
+	const float *py = plane_y.ptr();
+	const float *pz = plane_z.ptr();
+	const float *pd = plane_d.ptr();
+	const uint32_t *ps = plane_signs.ptr();
+	const __m128 zero = _mm_setzero_ps();
+
+	for (uint32_t i = 0; i < padded_count; i += 4) {
+		const __m128 min_x = _mm_load_ps(&bounds[0][i]);
+		const __m128 min_y = _mm_load_ps(&bounds[1][i]);
+		const __m128 min_z = _mm_load_ps(&bounds[2][i]);
+		const __m128 max_x = _mm_load_ps(&bounds[3][i]);
+		const __m128 max_y = _mm_load_ps(&bounds[4][i]);
+		const __m128 max_z = _mm_load_ps(&bounds[5][i]);
+
+		uint32_t plane = 0;
+		for (uint32_t v = 0; v < volume_count; v++) {
+			const uint32_t plane_end = volume_plane_end[v];
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+
+			// Same test as InstanceBounds::in_frustum(), for four instances per plane.
+			for (; plane < plane_end; plane++) {
+				const __m128 x = (ps[plane] & PLANE_SIGN_X) ? min_x : max_x;
+				const __m128 y = (ps[plane] & PLANE_SIGN_Y) ? min_y : max_y;
+				const __m128 z = (ps[plane] & PLANE_SIGN_Z) ? min_z : max_z;
+
+				__m128 distance = _mm_mul_ps(x, _mm_set1_ps(px[plane]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(py[plane])));
+				distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(pz[plane])));
+				distance = _mm_sub_ps(distance, _mm_set1_ps(pd[plane]));
+				inside = _mm_and_ps(inside, _mm_cmplt_ps(distance, zero));
+
+				if (_mm_movemask_ps(inside) == 0) {
+					break;
+				}
+			}
+			plane = plane_end;
+
+			int inside_mask = _mm_movemask_ps(inside);
+			if (inside_mask == 0) {
+				continue;
+			}
+
+			const uint64_t volume_bit = uint64_t(1) << v;
+			const uint32_t lane_count = MIN(4u, p_count - i);
+			for (uint32_t j = 0; j < lane_count; j++) {
+				if (inside_mask & (1 << j)) {
+					r_masks[i + j] |= volume_bit;
+				}
+			}
+		}
+	}
+#else
+	for (uint32_t i = 0; i < p_count; i++) {
+		const InstanceBounds &bounds = p_bounds[p_from + i];
+		for (uint32_t v = 0; v < volume_count; v++) {
+			if (bounds.in_frustum(*volume_frustums[v])) {
+				r_masks[i] |= uint64_t(1) << v;
+			}
+		}
+	}
+#endif
+}
+
 void RendererSceneCull::_scene_cull_threaded(uint32_t p_thread, CullData *cull_data) {
 	uint32_t cull_total = cull_data->scenario->instance_data.size();
 	uint32_t total_threads = RendererThreadPool::singleton->thread_work_pool.get_thread_count();
@@ -2619,7 +2752,19 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 	Transform3D inv_cam_transform = cull_data.cam_transform.inverse();
 	float z_near = cull_data.camera_matrix->get_z_near();
 
+	uint64_t volume_masks[CullVolumes::BLOCK_SIZE];
+	uint64_t block_from = p_from;
+	uint64_t block_to = p_from;
+
 	for (uint64_t i = p_from; i < p_to; i++) {
+		if (i == block_to) {
+			// Test the next block of instances against the camera frustum and every shadow cascade at once.
+			block_from = i;
+			block_to = MIN(i + CullVolumes::BLOCK_SIZE, p_to);
+			cull_data.cull->volumes.cull(cull_data.scenario->instance_aabbs, block_from, block_to - block_from, volume_masks);
+		}
+		const uint64_t volume_mask = volume_masks[i - block_from];
+
 		bool mesh_visible = false;
 
 		InstanceData &idata = cull_data.scenario->instance_data[i];
@@ -2628,14 +2773,14 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 
 #define HIDDEN_BY_VISIBILITY_CHECKS (visibility_flags == InstanceData::FLAG_VISIBILITY_DEPENDENCY_HIDDEN_CLOSE_RANGE || visibility_flags == InstanceData::FLAG_VISIBILITY_DEPENDENCY_HIDDEN)
 #define LAYER_CHECK (cull_data.visible_layers & idata.layer_mask)
-#define IN_FRUSTUM(f) (cull_data.scenario->instance_aabbs[i].in_frustum(f))
+#define IN_VOLUME(v) (volume_mask & (uint64_t(1) << (v)))
 #define VIS_RANGE_CHECK ((idata.visibility_index == -1) || _visibility_range_check<false>(cull_data.scenario->instance_visibility[idata.visibility_index], cull_data.cam_transform.origin, cull_data.visibility_viewport_mask) == 0)
 #define VIS_PARENT_CHECK (_visibility_parent_check(cull_data, idata))
 #define VIS_CHECK (visibility_check < 0 ? (visibility_check = (visibility_flags != InstanceData::FLAG_VISIBILITY_DEPENDENCY_NEEDS_CHECK || (VIS_RANGE_CHECK && VIS_PARENT_CHECK))) : visibility_check)
 #define OCCLUSION_CULLED (cull_data.occlusion_buffer != nullptr && (cull_data.scenario->instance_data[i].flags & InstanceData::FLAG_IGNORE_OCCLUSION_CULLING) == 0 && cull_data.occlusion_buffer->is_occluded(cull_data.scenario->instance_aabbs[i].bounds, cull_data.cam_transform.origin, inv_cam_transform, *cull_data.camera_matrix, z_near))
 
 		if (!HIDDEN_BY_VISIBILITY_CHECKS) {
-			if ((LAYER_CHECK && IN_FRUSTUM(cull_data.cull->frustum) && VIS_CHECK && !OCCLUSION_CULLED) || (cull_data.scenario->instance_data[i].flags & InstanceData::FLAG_IGNORE_ALL_CULLING)) {
+			if ((LAYER_CHECK && IN_VOLUME(0) && VIS_CHECK && !OCCLUSION_CULLED) || (cull_data.scenario->instance_data[i].flags & InstanceData::FLAG_IGNORE_ALL_CULLING)) {
 				uint32_t base_type = idata.flags & InstanceData::FLAG_BASE_TYPE_MASK;
 				if (base_type == RS::INSTANCE_LIGHT) {
 					cull_result.lights.push_back(idata.instance);
@@ -2812,9 +2957,11 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 				}
 			}
 
-			for (uint32_t j = 0; j < cull_data.cull->shadow_count; j++) {
-				for (uint32_t k = 0; k < cull_data.cull->shadows[j].cascade_count; k++) {
-					if (IN_FRUSTUM(cull_data.cull->shadows[j].cascades[k].frustum) && VIS_CHECK) {
+			// Cascades follow the camera frustum in the volume mask, in shadow order.
+			uint32_t cascade_volume = 1;
+			for (uint32_t j = 0; j < cull_data.cull->shadow_count && (volume_mask >> cascade_volume); j++) {
+				for (uint32_t k = 0; k < cull_data.cull->shadows[j].cascade_count; k++, cascade_volume++) {
+					if (IN_VOLUME(cascade_volume) && VIS_CHECK) {
 						uint32_t base_type = idata.flags & InstanceData::FLAG_BASE_TYPE_MASK;
 
 						if (((1 << base_type) & RS::INSTANCE_GEOMETRY_MASK) && idata.flags & InstanceData::FLAG_CAST_SHADOWS) {
@@ -2828,7 +2975,7 @@ void RendererSceneCull::_scene_cull(CullData &cull_data, InstanceCullResult &cul
 
 #undef HIDDEN_BY_VISIBILITY_CHECKS
 #undef LAYER_CHECK
-#undef IN_FRUSTUM
+#undef IN_VOLUME
 #undef VIS_RANGE_CHECK
 #undef VIS_PARENT_CHECK
 #undef VIS_CHECK
@@ -2974,6 +3121,14 @@ void RendererSceneCull::_render_scene(const RendererSceneRender::CameraData *p_c
 		}
 	}
 
+	cull.volumes.clear();
+	cull.volumes.add_frustum(cull.frustum);
+	for (uint32_t i = 0; i < cull.shadow_count; i++) {
+		for (uint32_t j = 0; j < cull.shadows[i].cascade_count; j++) {
+			cull.volumes.add_frustum(cull.shadows[i].cascades[j].frustum);
+		}
+	}
+
 	scene_cull_result.clear();
 
 	{
@@ -3837,11 +3992,145 @@ void RendererSceneCull::_update_dirty_instance(Instance *p_instance) {
 	p_instance->update_dependencies = false;
 }
 
+bool RendererSceneCull::_can_batch_dirty_instance(const Instance *p_instance) const {
+	// Only moved meshes that are already indexed, the rest of _update_instance() touches shared data.
+	if (p_instance->update_dependencies || p_instance->base_type != RS::INSTANCE_MESH) {
+		return false;
+	}
+	if (p_instance->scenario == nullptr || !p_instance->visible || !p_instance->indexer_id.is_valid()) {
+		return false;
+	}
+
+	const InstanceGeometryData *geom = static_cast<const InstanceGeometryData *>(p_instance->base_data);
+	return geom->lightmap_captures.is_empty() && p_instance->lightmap_sh.is_empty();
+}
+
+void RendererSceneCull::_update_batched_instance_transform(uint32_t p_index, Instance **p_instances) {
+	Instance *instance = p_instances[p_index];
+
+	if (instance->update_aabb) {
+		_update_instance_aabb(instance);
+	}
+
+	instance->version++;
+
+	if (instance->aabb.has_no_surface()) {
+		return;
+	}
+
+	instance->transformed_aabb = instance->transform.xform(instance->aabb);
+
+	InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(instance->base_data);
+	scene_render->geometry_instance_set_transform(geom->geometry_instance, instance->transform, instance->aabb, instance->transformed_aabb);
+
+	if (instance->transform.basis.determinant() == 0) {
+		return;
+	}
+
+	// Each instance owns its slot in these arrays.
+	instance->scenario->instance_aabbs[instance->array_index] = InstanceBounds(instance->transformed_aabb);
+	if (instance->visibility_index != -1) {
+		instance->scenario->instance_visibility[instance->visibility_index].position = instance->transformed_aabb.get_center();
+	}
+}
+
+void RendererSceneCull::_update_dirty_instance_batch() {
+	uint32_t count = dirty_instance_batch.size();
+	if (count == 0) {
+		return;
+	}
+
+	Instance **instances = dirty_instance_batch.ptr();
+
+	if (count > thread_cull_threshold) {
+		RendererThreadPool::singleton->thread_work_pool.do_work(count, this, &RendererSceneCull::_update_batched_instance_transform, instances);
+	} else {
+		for (uint32_t i = 0; i < count; i++) {
+			_update_batched_instance_transform(i, instances);
+		}
+	}
+
+	// Refit the indexer for the whole batch, then pair against the updated tree.
+	Scenario *refit_scenario = nullptr;
+	for (uint32_t i = 0; i < count; i++) {
+		Instance *instance = instances[i];
+		if (instance->aabb.has_no_surface()) {
+			continue;
+		}
+
+		InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(instance->base_data);
+		if (geom->can_cast_shadows) {
+			for (Set<Instance *>::Element *E = geom->lights.front(); E; E = E->next()) {
+				InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+				light->shadow_dirty = true;
+			}
+		}
+
+		if (instance->transform.basis.determinant() == 0) {
+			continue;
+		}
+
+		if (instance->scenario != refit_scenario) {
+			if (refit_scenario) {
+				refit_scenario->indexers[Scenario::INDEXER_GEOMETRY].refit(dirty_instance_batch_ids.ptr(), dirty_instance_batch_aabbs.ptr(), dirty_instance_batch_ids.size());
+				dirty_instance_batch_ids.clear();
+				dirty_instance_batch_aabbs.clear();
+			}
+			refit_scenario = instance->scenario;
+		}
+		dirty_instance_batch_ids.push_back(instance->indexer_id);
+		dirty_instance_batch_aabbs.push_back(_get_instance_indexer_aabb(instance));
+	}
+
+	if (refit_scenario) {
+		refit_scenario->indexers[Scenario::INDEXER_GEOMETRY].refit(dirty_instance_batch_ids.ptr(), dirty_instance_batch_aabbs.ptr(), dirty_instance_batch_ids.size());
+		dirty_instance_batch_ids.clear();
+		dirty_instance_batch_aabbs.clear();
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		Instance *instance = instances[i];
+		instance->update_aabb = false;
+		instance->update_batched = false;
+
+		if (instance->aabb.has_no_surface()) {
+			continue;
+		}
+
+		if (instance->transform.basis.determinant() == 0) {
+			instance->prev_transformed_aabb = instance->transformed_aabb;
+			continue;
+		}
+
+		_update_instance_pairs(instance);
+	}
+
+	dirty_instance_batch.clear();
+}
+
 void RendererSceneCull::update_dirty_instances() {
 	RSG::storage->update_dirty_resources();
 
 	while (_instance_update_list.first()) {
-		_update_dirty_instance(_instance_update_list.first()->self());
+		// Moved meshes are collected, their bounds and transforms are updated in parallel, and
+		// the indexer is refit for all of them at once. Other instances are updated one by one.
+		while (_instance_update_list.first()) {
+			Instance *instance = _instance_update_list.first()->self();
+			if (instance->update_batched) {
+				// Queued again while waiting in the batch, update it after the batch.
+				break;
+			}
+
+			if (_can_batch_dirty_instance(instance)) {
+				_instance_update_list.remove(&instance->update_item);
+				instance->update_batched = true;
+				dirty_instance_batch.push_back(instance);
+			} else {
+				_update_dirty_instance(instance);
+			}
+		}
+
+		_update_dirty_instance_batch();
 	}
 }
 
@@ -3976,7 +4265,11 @@ RendererSceneCull::RendererSceneCull() {
 	thread_cull_threshold = GLOBAL_GET("rendering/limits/spatial_indexer/threaded_cull_minimum_instances");
 	thread_cull_threshold = MAX(thread_cull_threshold, (uint32_t)RendererThreadPool::singleton->thread_work_pool.get_thread_count()); //make sure there is at least one thread per CPU
 
-	dummy_occlusion_culling = memnew(RendererSceneOcclusionCull);
+	if (int(GLOBAL_GET("rendering/occlusion_culling/backend")) == RendererSceneOcclusionCull::BACKEND_RASTER) {
+		default_occlusion_culling = memnew(RasterOcclusionCull);
+	} else {
+		default_occlusion_culling = memnew(RendererSceneOcclusionCull);
+	}
 }
 
 RendererSceneCull::~RendererSceneCull() {
@@ -3996,7 +4289,7 @@ RendererSceneCull::~RendererSceneCull() {
 	}
 	scene_cull_result_threads.clear();
 
-	if (dummy_occlusion_culling) {
-		memdelete(dummy_occlusion_culling);
+	if (default_occlusion_culling) {
+		memdelete(default_occlusion_culling);
 	}
 }
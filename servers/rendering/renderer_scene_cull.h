@@ -120,7 +120,8 @@ public:
 
 	/* VISIBILITY NOTIFIER API */
 
-	RendererSceneOcclusionCull *dummy_occlusion_culling;
+	// Occlusion culling used unless a module replaces it, either the software rasterizer or a dummy.
+	RendererSceneOcclusionCull *default_occlusion_culling;
 
 	/* SCENARIO API */
 
@@ -245,6 +246,38 @@ public:
 		}
 	};
 
+	struct CullVolumes {
+		// Every volume _scene_cull() tests instances against (the camera frustum first, then each
+		// directional shadow cascade), with their planes stored as structure of arrays so a block
+		// of instance bounds is tested against all of them in a single pass.
+		enum {
+			MAX_VOLUMES = 1 + RendererSceneRender::MAX_DIRECTIONAL_LIGHTS * RendererSceneRender::MAX_DIRECTIONAL_LIGHT_CASCADES,
+			BLOCK_SIZE = 64,
+		};
+
+		enum PlaneSignFlags {
+			PLANE_SIGN_X = 1,
+			PLANE_SIGN_Y = 2,
+			PLANE_SIGN_Z = 4,
+		};
+
+		LocalVector<float> plane_x;
+		LocalVector<float> plane_y;
+		LocalVector<float> plane_z;
+		LocalVector<float> plane_d;
+		LocalVector<uint32_t> plane_signs; // Set when the normal is positive on that axis, so the minimum bound is tested.
+
+		uint32_t volume_plane_end[MAX_VOLUMES];
+		const Frustum *volume_frustums[MAX_VOLUMES];
+		uint32_t volume_count = 0;
+
+		void clear();
+		void add_frustum(const Frustum &p_frustum);
+
+		// Sets bit `v` of `r_masks[n]` when instance `p_from + n` is inside volume `v`.
+		void cull(const PagedArray<InstanceBounds> &p_bounds, uint64_t p_from, uint32_t p_count, uint64_t *r_masks) const;
+	};
+
 	struct InstanceVisibilityNotifierData;
 
 	struct InstanceData {
@@ -456,6 +489,7 @@ public:
 		//aabb stuff
 		bool update_aabb;
 		bool update_dependencies;
+		bool update_batched; // taken off the update list by a batched update that hasn't finished yet
 
 		SelfList<Instance> update_item;
 
@@ -544,6 +578,7 @@ public:
 
 			update_aabb = false;
 			update_dependencies = false;
+			update_batched = false;
 
 			extra_margin = 0;
 
@@ -923,6 +958,11 @@ public:
 
 	uint32_t thread_cull_threshold = 200;
 
+	// Moved meshes whose bounds and transform are updated together, see update_dirty_instances().
+	LocalVector<Instance *> dirty_instance_batch;
+	LocalVector<DynamicBVH::ID> dirty_instance_batch_ids;
+	LocalVector<AABB> dirty_instance_batch_aabbs;
+
 	RID_Owner<Instance, true> instance_owner;
 
 	uint32_t geometry_instance_pair_mask; // used in traditional forward, unnecessary on clustered
@@ -975,8 +1015,13 @@ public:
 	virtual Variant instance_geometry_get_shader_parameter_default_value(RID p_instance, const StringName &p_parameter) const;
 
 	_FORCE_INLINE_ void _update_instance(Instance *p_instance);
+	_FORCE_INLINE_ AABB _get_instance_indexer_aabb(const Instance *p_instance) const;
+	_FORCE_INLINE_ void _update_instance_pairs(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_aabb(Instance *p_instance);
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
+	_FORCE_INLINE_ bool _can_batch_dirty_instance(const Instance *p_instance) const;
+	void _update_batched_instance_transform(uint32_t p_index, Instance **p_instances);
+	void _update_dirty_instance_batch();
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
 	void _unpair_instance(Instance *p_instance);
 
@@ -1022,6 +1067,7 @@ public:
 		SpinLock lock;
 
 		Frustum frustum;
+		CullVolumes volumes;
 	} cull;
 
 	struct VisibilityCullData {
@@ -40,6 +40,11 @@ protected:
 	static RendererSceneOcclusionCull *singleton;
 
 public:
+	enum Backend {
+		BACKEND_RAYCAST, // Embree ray-caster from the raycast module.
+		BACKEND_RASTER, // Software rasterizer, always available.
+	};
+
 	class HZBuffer {
 	protected:
 		static const Vector3 corners[8];
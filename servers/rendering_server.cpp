@@ -2930,6 +2930,8 @@ RenderingServer::RenderingServer() {
 	GLOBAL_DEF("rendering/textures/light_projectors/filter", LIGHT_PROJECTOR_FILTER_LINEAR_MIPMAPS);
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/textures/light_projectors/filter", PropertyInfo(Variant::INT, "rendering/textures/light_projectors/filter", PROPERTY_HINT_ENUM, "Nearest (Fast),Nearest+Mipmaps,Linear,Linear+Mipmaps,Linear+Mipmaps Anisotropic (Slow)"));
 
+	GLOBAL_DEF_RST("rendering/occlusion_culling/backend", 0);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/occlusion_culling/backend", PropertyInfo(Variant::INT, "rendering/occlusion_culling/backend", PROPERTY_HINT_ENUM, "Raycast (Embree),Software Rasterizer"));
 	GLOBAL_DEF_RST("rendering/occlusion_culling/occlusion_rays_per_thread", 512);
 	GLOBAL_DEF_RST("rendering/occlusion_culling/bvh_build_quality", 2);
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/occlusion_culling/bvh_build_quality", PropertyInfo(Variant::INT, "rendering/occlusion_culling/bvh_build_quality", PROPERTY_HINT_ENUM, "Low,Medium,High"));
@@ -2983,6 +2985,9 @@ RenderingServer::RenderingServer() {
 	GLOBAL_DEF_RST("rendering/2d/options/use_software_skinning", true);
 	GLOBAL_DEF_RST("rendering/2d/options/ninepatch_mode", 1);
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/2d/options/ninepatch_mode", PropertyInfo(Variant::INT, "rendering/2d/options/ninepatch_mode", PROPERTY_HINT_ENUM, "Fixed,Scaling"));
+	GLOBAL_DEF_RST("rendering/2d/options/use_threaded_culling", true);
+	GLOBAL_DEF_RST("rendering/2d/options/threaded_cull_minimum_items", 1000);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/2d/options/threaded_cull_minimum_items", PropertyInfo(Variant::INT, "rendering/2d/options/threaded_cull_minimum_items", PROPERTY_HINT_RANGE, "32,65536,1"));
 
 	GLOBAL_DEF_RST("rendering/2d/opengl/batching_send_null", 0);
 	ProjectSettings::get_singleton()->set_custom_property_info("rendering/2d/opengl/batching_send_null", PropertyInfo(Variant::INT, "rendering/2d/opengl/batching_send_null", PROPERTY_HINT_ENUM, "Default (On),Off,On"));
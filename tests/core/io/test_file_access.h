@@ -31,7 +31,12 @@
 #ifndef TEST_FILE_ACCESS_H
 #define TEST_FILE_ACCESS_H
 
+#include "core/io/dir_access.h"
 #include "core/io/file_access.h"
+#include "core/io/file_access_compressed.h"
+#include "core/io/marshalls.h"
+#include "core/os/os.h"
+#include "core/templates/task_scheduler.h"
 #include "tests/test_macros.h"
 #include "tests/test_utils.h"
 
@@ -80,6 +85,186 @@ TEST_CASE("[FileAccess] CSV read") {
 
 	f->close();
 }
+
+static Vector<uint8_t> make_compressible_data(int p_size) {
+	Vector<uint8_t> data;
+	data.resize(p_size);
+	uint8_t *w = data.ptrw();
+	uint32_t seed = 1234;
+	for (int i = 0; i < p_size; i++) {
+		// Short random runs, so the data compresses but isn't trivial.
+		if ((i & 7) == 0) {
+			seed = seed * 1103515245 + 12345;
+		}
+		w[i] = (seed >> 16) & 0x3F;
+	}
+	return data;
+}
+
+static Error write_compressed(const String &p_path, const Vector<uint8_t> &p_data, Compression::Mode p_mode, uint32_t p_block_size) {
+	FileAccessCompressed *fac = memnew(FileAccessCompressed);
+	fac->configure("TFAC", p_mode, p_block_size);
+	Error err = fac->_open(p_path, FileAccess::WRITE);
+	if (err == OK) {
+		fac->store_buffer(p_data.ptr(), p_data.size());
+		fac->close();
+	}
+	memdelete(fac);
+	return err;
+}
+
+TEST_CASE("[FileAccess] Compressed read and seek") {
+	const String path = OS::get_singleton()->get_cache_path().plus_file("compressed.bin");
+	const uint32_t block_sizes[] = { 4096, 65536 };
+	const int sizes[] = { 0, 1000, 4096 * 20, 300000 };
+
+	for (int b = 0; b < 2; b++) {
+		for (int s = 0; s < 4; s++) {
+			const Vector<uint8_t> data = make_compressible_data(sizes[s]);
+			REQUIRE(write_compressed(path, data, Compression::MODE_ZSTD, block_sizes[b]) == OK);
+
+			FileAccessCompressed *fac = memnew(FileAccessCompressed);
+			fac->configure("TFAC");
+			REQUIRE(fac->_open(path, FileAccess::READ) == OK);
+			CHECK(fac->get_length() == uint64_t(data.size()));
+
+			// Whole file in one call, going through the parallel path when it spans enough blocks.
+			Vector<uint8_t> read;
+			read.resize(data.size() + 16);
+			CHECK(fac->get_buffer(read.ptrw(), read.size()) == uint64_t(data.size()));
+			read.resize(data.size());
+			CHECK_MESSAGE(read == data, vformat("Data should survive a round trip with %d bytes in blocks of %d.", sizes[s], block_sizes[b]));
+			CHECK(fac->eof_reached());
+			CHECK(fac->get_position() == uint64_t(data.size()));
+
+			if (data.size() > 2000) {
+				// Seek back across blocks, then read a few bytes that straddle a block boundary.
+				const uint64_t pos = block_sizes[b] * MAX(uint64_t(1), uint64_t(data.size()) / block_sizes[b] / 2) - 3;
+				fac->seek(pos);
+				CHECK(!fac->eof_reached());
+				CHECK(fac->get_position() == pos);
+				uint8_t bytes[6];
+				CHECK(fac->get_buffer(bytes, 6) == 6);
+				bool same = true;
+				for (int i = 0; i < 6; i++) {
+					same = same && bytes[i] == data[pos + i];
+				}
+				CHECK(same);
+				CHECK(fac->get_8() == data[pos + 6]);
+				CHECK(fac->get_position() == pos + 7);
+			}
+
+			fac->close();
+			memdelete(fac);
+		}
+	}
+
+	DirAccess::remove_file_or_error(path);
+}
+
+TEST_CASE("[FileAccess] Compressed read of a corrupted file") {
+	const String path = OS::get_singleton()->get_cache_path().plus_file("compressed_corrupted.bin");
+	const Vector<uint8_t> data = make_compressible_data(300000);
+	REQUIRE(write_compressed(path, data, Compression::MODE_ZSTD, 4096) == OK);
+	const Vector<uint8_t> file = FileAccess::get_file_as_array(path);
+	// Magic, mode, zero block size, version, block size and total size come before the blocks.
+	const uint64_t data_ofs = 28;
+	const uint64_t index_ofs = decode_uint64(&file[file.size() - 12]);
+	REQUIRE(index_ofs < uint64_t(file.size()));
+
+	SUBCASE("Corrupted block") {
+		// Zero the second block, reads stop after the first one.
+		Vector<uint8_t> corrupted = file;
+		const uint64_t block_ofs = data_ofs + decode_uint32(&file[index_ofs]);
+		const uint32_t block_csize = decode_uint32(&file[index_ofs + 4]);
+		memset(corrupted.ptrw() + block_ofs, 0, block_csize);
+		{
+			FileAccessRef f = FileAccess::open(path, FileAccess::WRITE);
+			f->store_buffer(corrupted.ptr(), corrupted.size());
+		}
+
+		FileAccessCompressed *fac = memnew(FileAccessCompressed);
+		fac->configure("TFAC");
+		REQUIRE(fac->_open(path, FileAccess::READ) == OK);
+		Vector<uint8_t> read;
+		read.resize(data.size());
+		ERR_PRINT_OFF;
+		CHECK(fac->get_buffer(read.ptrw(), read.size()) == 4096);
+		ERR_PRINT_ON;
+		CHECK(fac->eof_reached());
+		CHECK(fac->get_error() == ERR_FILE_CORRUPT);
+		fac->close();
+		memdelete(fac);
+	}
+
+	SUBCASE("Blocks overlapping the block index") {
+		// Point the index at the first block, its sizes then run past the index.
+		Vector<uint8_t> corrupted = file;
+		encode_uint64(data_ofs, corrupted.ptrw() + corrupted.size() - 12);
+		{
+			FileAccessRef f = FileAccess::open(path, FileAccess::WRITE);
+			f->store_buffer(corrupted.ptr(), corrupted.size());
+		}
+
+		FileAccessCompressed *fac = memnew(FileAccessCompressed);
+		fac->configure("TFAC");
+		ERR_PRINT_OFF;
+		CHECK(fac->_open(path, FileAccess::READ) == ERR_FILE_UNRECOGNIZED);
+		ERR_PRINT_ON;
+		memdelete(fac);
+	}
+
+	DirAccess::remove_file_or_error(path);
+}
+
+// Usage: `mesh --test file-access-compressed-benchmark`.
+static void benchmark_compressed() {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	ERR_FAIL_COND(scheduler == nullptr);
+
+	const String path = OS::get_singleton()->get_cache_path().plus_file("compressed_benchmark.bin");
+	const int size = 64 * 1024 * 1024;
+	const Compression::Mode modes[] = { Compression::MODE_ZSTD, Compression::MODE_DEFLATE, Compression::MODE_GZIP };
+	const char *mode_names[] = { "ZSTD", "DEFLATE", "GZIP" };
+	const uint32_t block_sizes[] = { 4096, 65536, 1024 * 1024 };
+	const int thread_counts[] = { 1, 4, 16 };
+
+	const Vector<uint8_t> data = make_compressible_data(size);
+	Vector<uint8_t> read;
+	read.resize(size);
+
+	print_line(vformat("Writing and reading %d MiB of compressed data:", size / (1024 * 1024)));
+	for (int m = 0; m < 3; m++) {
+		for (int b = 0; b < 3; b++) {
+			for (int t = 0; t < 3; t++) {
+				// The calling thread takes part in the work, so it counts as one of them.
+				scheduler->finish();
+				scheduler->init(thread_counts[t] - 1);
+
+				uint64_t begin = OS::get_singleton()->get_ticks_usec();
+				write_compressed(path, data, modes[m], block_sizes[b]);
+				uint64_t write_usec = OS::get_singleton()->get_ticks_usec() - begin;
+
+				FileAccessCompressed *fac = memnew(FileAccessCompressed);
+				fac->configure("TFAC");
+				fac->_open(path, FileAccess::READ);
+				begin = OS::get_singleton()->get_ticks_usec();
+				fac->get_buffer(read.ptrw(), size);
+				uint64_t read_usec = OS::get_singleton()->get_ticks_usec() - begin;
+				fac->close();
+				memdelete(fac);
+
+				print_line(vformat("  %s, %d KiB blocks, %d thread(s): write %.1f MB/s, read %.1f MB/s", mode_names[m], block_sizes[b] / 1024, thread_counts[t], double(size) / MAX(write_usec, 1), double(size) / MAX(read_usec, 1)));
+			}
+		}
+	}
+
+	DirAccess::remove_file_or_error(path);
+	scheduler->finish();
+	scheduler->init();
+}
+
+REGISTER_TEST_COMMAND("file-access-compressed-benchmark", &benchmark_compressed);
 } // namespace TestFileAccess
 
 #endif // TEST_FILE_ACCESS_H
@@ -203,6 +203,108 @@ TEST_CASE("[Image] Resizing") {
 			"get_size() should return the correct size after resize_to_po2().");
 }
 
+TEST_CASE("[Image] Resizing and mipmaps of large images") {
+	// Large enough for the rows to be split across threads.
+	const int width = 1024;
+	const int height = 512;
+	Vector<uint8_t> data;
+	data.resize(width * height * 4);
+	uint8_t *w = data.ptrw();
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			uint8_t *pixel = &w[(y * width + x) * 4];
+			pixel[0] = x * 255 / (width - 1);
+			pixel[1] = y * 255 / (height - 1);
+			pixel[2] = 128 + int(Math::sin(x * 0.01) * 64.0);
+			pixel[3] = 255;
+		}
+	}
+	Ref<Image> image = memnew(Image(width, height, false, Image::FORMAT_RGBA8, data));
+	Ref<Image> image_float = image->duplicate();
+	image_float->convert(Image::FORMAT_RGBAF);
+
+	// 8-bit and float images go through different kernels, but should look the same.
+	for (int i = 0; i < 5; i++) {
+		Image::Interpolation interpolation = static_cast<Image::Interpolation>(i);
+		Ref<Image> resized = image->duplicate();
+		resized->resize(601, 301, interpolation);
+		Ref<Image> resized_float = image_float->duplicate();
+		resized_float->resize(601, 301, interpolation);
+
+		float max_difference = 0.0;
+		for (int y = 0; y < 301; y += 3) {
+			for (int x = 0; x < 601; x += 3) {
+				Color a = resized->get_pixel(x, y);
+				Color b = resized_float->get_pixel(x, y);
+				max_difference = MAX(max_difference, MAX(MAX(Math::abs(a.r - b.r), Math::abs(a.g - b.g)), MAX(Math::abs(a.b - b.b), Math::abs(a.a - b.a))));
+			}
+		}
+		CHECK_MESSAGE(
+				max_difference < 0.02,
+				"Resizing 8-bit and float images should give the same result.");
+	}
+
+	// Every pixel of a mipmap is the rounded average of the 2x2 pixels above it.
+	image->generate_mipmaps();
+	Vector<uint8_t> mipmapped = image->get_data();
+	const uint8_t *r = mipmapped.ptr();
+	const uint8_t *mipmap = r + image->get_mipmap_offset(1);
+	bool mipmap_matches = true;
+	for (int y = 0; y < height / 2; y++) {
+		for (int x = 0; x < width / 2; x++) {
+			for (int c = 0; c < 4; c++) {
+				int sum = r[((y * 2) * width + x * 2) * 4 + c] + r[((y * 2) * width + x * 2 + 1) * 4 + c] + r[((y * 2 + 1) * width + x * 2) * 4 + c] + r[((y * 2 + 1) * width + x * 2 + 1) * 4 + c];
+				mipmap_matches = mipmap_matches && mipmap[(y * (width / 2) + x) * 4 + c] == (sum + 2) >> 2;
+			}
+		}
+	}
+	CHECK_MESSAGE(
+			mipmap_matches,
+			"generate_mipmaps() should average every 2x2 block of 8-bit pixels.");
+
+	image_float->generate_mipmaps();
+	Vector<uint8_t> mipmapped_float = image_float->get_data();
+	const float *rf = reinterpret_cast<const float *>(mipmapped_float.ptr());
+	const float *mipmap_float = reinterpret_cast<const float *>(mipmapped_float.ptr() + image_float->get_mipmap_offset(1));
+	mipmap_matches = true;
+	for (int y = 0; y < height / 2; y++) {
+		for (int x = 0; x < width / 2; x++) {
+			for (int c = 0; c < 4; c++) {
+				float sum = rf[((y * 2) * width + x * 2) * 4 + c] + rf[((y * 2) * width + x * 2 + 1) * 4 + c] + rf[((y * 2 + 1) * width + x * 2) * 4 + c] + rf[((y * 2 + 1) * width + x * 2 + 1) * 4 + c];
+				mipmap_matches = mipmap_matches && mipmap_float[(y * (width / 2) + x) * 4 + c] == sum * 0.25f;
+			}
+		}
+	}
+	CHECK_MESSAGE(
+			mipmap_matches,
+			"generate_mipmaps() should average every 2x2 block of float pixels.");
+
+	// Half float cubic scaling should weight the samples like the float version, not pick one of them.
+	Ref<Image> gradient_half = memnew(Image(8, 8, false, Image::FORMAT_RGBAH));
+	Ref<Image> gradient_float = memnew(Image(8, 8, false, Image::FORMAT_RGBAF));
+	for (int y = 0; y < 8; y++) {
+		for (int x = 0; x < 8; x++) {
+			Color color(x / 7.0, y / 7.0, ((x + y) % 2) * 0.5, 1.0);
+			gradient_half->set_pixel(x, y, color);
+			gradient_float->set_pixel(x, y, color);
+		}
+	}
+	gradient_half->resize(13, 13, Image::INTERPOLATE_CUBIC);
+	gradient_float->resize(13, 13, Image::INTERPOLATE_CUBIC);
+
+	float max_difference = 0.0;
+	for (int y = 0; y < 13; y++) {
+		for (int x = 0; x < 13; x++) {
+			Color a = gradient_half->get_pixel(x, y);
+			Color b = gradient_float->get_pixel(x, y);
+			max_difference = MAX(max_difference, MAX(MAX(Math::abs(a.r - b.r), Math::abs(a.g - b.g)), Math::abs(a.b - b.b)));
+		}
+	}
+	CHECK_MESSAGE(
+			max_difference < 0.01,
+			"Cubic scaling of a half float image should give the same result as with a float image.");
+}
+
 TEST_CASE("[Image] Modifying pixels of an image") {
 	Ref<Image> image = memnew(Image(3, 3, false, Image::FORMAT_RGBA8));
 	image->set_pixel(0, 0, Color(1, 1, 1, 1));
@@ -117,6 +117,51 @@ TEST_CASE("[PCKPacker] Pack a PCK file with some files and directories") {
 			f->get_length() <= 35000,
 			"The generated non-empty PCK file shouldn't be too large.");
 }
+
+TEST_CASE("[PCKPacker] Read files from a loaded PCK file") {
+	const String source_path = OS::get_singleton()->get_cache_path().plus_file("pck_source.bin");
+	Vector<uint8_t> data;
+	for (int i = 0; i < 1000; i++) {
+		data.push_back(i * 7);
+	}
+	{
+		FileAccessRef f = FileAccess::open(source_path, FileAccess::WRITE);
+		REQUIRE(f);
+		f->store_buffer(data.ptr(), data.size());
+	}
+
+	PCKPacker pck_packer;
+	const String output_pck_path = OS::get_singleton()->get_cache_path().plus_file("output_read.pck");
+	REQUIRE(pck_packer.pck_start(output_pck_path) == OK);
+	REQUIRE(pck_packer.add_file("res://pck_packer_test/first/data.bin", source_path) == OK);
+	REQUIRE(pck_packer.add_file("res://pck_packer_test/second/data.bin", source_path) == OK);
+	REQUIRE(pck_packer.flush() == OK);
+
+	REQUIRE(PackedData::get_singleton()->add_pack(output_pck_path, false, 0) == OK);
+	CHECK(FileAccess::exists("res://pck_packer_test/first/data.bin"));
+	CHECK(DirAccess::exists("res://pck_packer_test/second"));
+
+	Error err;
+	FileAccessRef f = FileAccess::open("res://pck_packer_test/second/data.bin", FileAccess::READ, &err);
+	REQUIRE(err == OK);
+	CHECK(f->get_length() == uint64_t(data.size()));
+
+	Vector<uint8_t> read;
+	read.resize(data.size());
+	CHECK(f->get_buffer(read.ptrw(), read.size()) == uint64_t(data.size()));
+	CHECK_MESSAGE(read == data, "The file read from the PCK should match the packed file.");
+
+	f->seek(10);
+	CHECK(f->get_8() == data[10]);
+
+	f->seek(0);
+	const uint8_t *mapped = f->get_mapped_buffer(data.size());
+	if (mapped) {
+		CHECK_MESSAGE(memcmp(mapped, data.ptr(), data.size()) == 0, "The mapped file should match the packed file.");
+		CHECK(f->get_position() == uint64_t(data.size()));
+		CHECK(f->get_mapped_buffer(1) == nullptr);
+	}
+}
 } // namespace TestPCKPacker
 
 #endif // TEST_PCK_PACKER_H
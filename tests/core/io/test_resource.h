@@ -109,6 +109,58 @@ TEST_CASE("[Resource] Saving and loading") {
 			loaded_child_resource_text->get_name() == "I'm a child resource",
 			"The loaded child resource name should be equal to the expected value.");
 }
+
+TEST_CASE("[Resource] Threaded loading with external dependencies") {
+	const String child_path = OS::get_singleton()->get_cache_path().plus_file("resource_threaded_child.tres");
+	const String shared_path = OS::get_singleton()->get_cache_path().plus_file("resource_threaded_shared.res");
+	const String save_path = OS::get_singleton()->get_cache_path().plus_file("resource_threaded.tres");
+	{
+		Ref<Resource> shared_resource = memnew(Resource);
+		shared_resource->set_name("I'm shared");
+		ResourceSaver::save(shared_path, shared_resource, ResourceSaver::FLAG_CHANGE_PATH);
+
+		Ref<Resource> child_resource = memnew(Resource);
+		child_resource->set_name("I'm an external resource");
+		child_resource->set_meta("shared", shared_resource);
+		ResourceSaver::save(child_path, child_resource, ResourceSaver::FLAG_CHANGE_PATH);
+
+		Ref<Resource> resource = memnew(Resource);
+		resource->set_name("Hello world");
+		resource->set_meta("child", child_resource);
+		resource->set_meta("shared", shared_resource);
+		ResourceSaver::save(save_path, resource);
+	}
+
+	REQUIRE(ResourceLoader::load_threaded_request(save_path) == OK);
+	// Requesting the same resource again shares the load in progress.
+	REQUIRE(ResourceLoader::load_threaded_request(save_path) == OK);
+
+	float progress = -1.0;
+	ResourceLoader::ThreadLoadStatus status = ResourceLoader::load_threaded_get_status(save_path, &progress);
+	CHECK(status != ResourceLoader::THREAD_LOAD_INVALID_RESOURCE);
+	CHECK(progress >= 0.0);
+	CHECK(progress <= 1.0);
+
+	Error error = FAILED;
+	const Ref<Resource> loaded_resource = ResourceLoader::load_threaded_get(save_path, &error);
+	CHECK(error == OK);
+	REQUIRE(loaded_resource.is_valid());
+	CHECK(loaded_resource->get_name() == "Hello world");
+
+	const Ref<Resource> loaded_child = loaded_resource->get_meta("child");
+	REQUIRE(loaded_child.is_valid());
+	CHECK(loaded_child->get_name() == "I'm an external resource");
+	const Ref<Resource> loaded_shared = loaded_resource->get_meta("shared");
+	CHECK_MESSAGE(
+			loaded_shared == Ref<Resource>(loaded_child->get_meta("shared")),
+			"Resources used by several dependencies should only be loaded once.");
+
+	const Ref<Resource> second_resource = ResourceLoader::load_threaded_get(save_path, &error);
+	CHECK(second_resource == loaded_resource);
+	CHECK_MESSAGE(
+			ResourceLoader::load_threaded_get_status(save_path) == ResourceLoader::THREAD_LOAD_INVALID_RESOURCE,
+			"The load should be released once every request got its resource.");
+}
 } // namespace TestResource
 
 #endif // TEST_RESOURCE
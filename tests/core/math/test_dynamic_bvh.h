@@ -0,0 +1,99 @@
+/*************************************************************************/
+/*  test_dynamic_bvh.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_DYNAMIC_BVH_H
+#define TEST_DYNAMIC_BVH_H
+
+#include "core/math/dynamic_bvh.h"
+
+#include "tests/test_macros.h"
+
+namespace TestDynamicBVH {
+
+struct CollectResult {
+	LocalVector<int> found;
+
+	bool operator()(void *p_data) {
+		found.push_back((int)(intptr_t)p_data);
+		return false;
+	}
+};
+
+static bool query_matches_boxes(DynamicBVH &p_bvh, const AABB &p_query, const AABB *p_boxes, int p_count) {
+	CollectResult result;
+	p_bvh.aabb_query(p_query, result);
+
+	int expected = 0;
+	for (int i = 0; i < p_count; i++) {
+		if (p_boxes[i].intersects_inclusive(p_query)) {
+			expected++;
+			if (result.found.find(i) < 0) {
+				return false;
+			}
+		}
+	}
+	return int(result.found.size()) == expected;
+}
+
+TEST_CASE("[DynamicBVH] Refitting many leaves keeps queries exact") {
+	const int count = 64;
+	DynamicBVH bvh;
+	DynamicBVH::ID ids[count];
+	AABB boxes[count];
+	for (int i = 0; i < count; i++) {
+		boxes[i] = AABB(Vector3((i % 8) * 4, 0, (i / 8) * 4), Vector3(1, 1, 1));
+		ids[i] = bvh.insert(boxes[i], (void *)(intptr_t)i);
+	}
+
+	// Most boxes move a little and stay in place in the tree, every fourth one moves far away and is reinserted.
+	for (int i = 0; i < count; i++) {
+		if (i % 4 == 0) {
+			boxes[i].position += Vector3(100, 0, 0);
+		} else {
+			boxes[i].position += Vector3(0.5, (i % 3) * 0.25, -0.5);
+			boxes[i].size = Vector3(1 + (i % 2), 1, 1);
+		}
+	}
+	bvh.refit(ids, boxes, count);
+
+	CHECK(bvh.get_leaf_count() == count);
+	for (int i = 0; i < count; i++) {
+		CHECK_MESSAGE(query_matches_boxes(bvh, boxes[i], boxes, count), "Each moved box should be found at its new place, and only the boxes overlapping it.");
+	}
+	CHECK(query_matches_boxes(bvh, AABB(Vector3(-1, -1, -1), Vector3(40, 4, 40)), boxes, count));
+	CHECK(query_matches_boxes(bvh, AABB(Vector3(90, -1, -1), Vector3(40, 4, 40)), boxes, count));
+
+	bvh.optimize_incremental(count);
+	CHECK(query_matches_boxes(bvh, AABB(Vector3(-10, -10, -10), Vector3(200, 20, 200)), boxes, count));
+}
+
+} // namespace TestDynamicBVH
+
+#endif // TEST_DYNAMIC_BVH_H
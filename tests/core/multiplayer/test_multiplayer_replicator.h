@@ -0,0 +1,300 @@
+/*************************************************************************/
+/*  test_multiplayer_replicator.h                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MULTIPLAYER_REPLICATOR_H
+#define TEST_MULTIPLAYER_REPLICATOR_H
+
+#include "core/io/resource_uid.h"
+#include "core/multiplayer/multiplayer_api.h"
+#include "core/multiplayer/multiplayer_peer.h"
+#include "core/multiplayer/multiplayer_replicator.h"
+#include "scene/3d/node_3d.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMultiplayerReplicator {
+
+// Delivers packets straight to the other end, unreliable ones can be dropped.
+class LoopbackMultiplayerPeer : public MultiplayerPeer {
+	struct Packet {
+		int from = 0;
+		Vector<uint8_t> data;
+	};
+
+	int unique_id = 0;
+	int target_peer = 0;
+	List<Packet> queue;
+	Packet current;
+
+public:
+	LoopbackMultiplayerPeer *remote = nullptr;
+	bool drop_unreliable = false;
+	int sent_packets = 0;
+	int last_packet_size = 0;
+
+	virtual int get_available_packet_count() const override { return queue.size(); }
+	virtual Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) override {
+		ERR_FAIL_COND_V(queue.is_empty(), ERR_UNAVAILABLE);
+		current = queue.front()->get();
+		queue.pop_front();
+		*r_buffer = current.data.ptr();
+		r_buffer_size = current.data.size();
+		return OK;
+	}
+	virtual Error put_packet(const uint8_t *p_buffer, int p_buffer_size) override {
+		sent_packets++;
+		last_packet_size = p_buffer_size;
+		if (drop_unreliable && get_transfer_mode() == Multiplayer::TRANSFER_MODE_UNRELIABLE) {
+			return OK;
+		}
+		Packet packet;
+		packet.from = unique_id;
+		packet.data.resize(p_buffer_size);
+		memcpy(packet.data.ptrw(), p_buffer, p_buffer_size);
+		remote->queue.push_back(packet);
+		return OK;
+	}
+	virtual int get_max_packet_size() const override { return 1 << 24; }
+
+	virtual void set_target_peer(int p_peer_id) override { target_peer = p_peer_id; }
+	virtual int get_packet_peer() const override { return queue.is_empty() ? 0 : queue.front()->get().from; }
+	virtual bool is_server() const override { return unique_id == 1; }
+	virtual void poll() override {}
+	virtual int get_unique_id() const override { return unique_id; }
+	virtual ConnectionStatus get_connection_status() const override { return CONNECTION_CONNECTED; }
+
+	LoopbackMultiplayerPeer(int p_unique_id) {
+		unique_id = p_unique_id;
+	}
+};
+
+class DeltaSyncRelevancy : public Object {
+public:
+	ObjectID hidden;
+
+	bool is_relevant(int p_peer, Object *p_obj) {
+		return p_obj->get_instance_id() != hidden;
+	}
+};
+
+struct DeltaSyncTest {
+	static const int OBJECT_COUNT = 3;
+
+	ResourceUID::ID scene_id = ResourceUID::INVALID_ID;
+	Ref<LoopbackMultiplayerPeer> server_peer;
+	Ref<LoopbackMultiplayerPeer> client_peer;
+	Ref<MultiplayerAPI> server;
+	Ref<MultiplayerAPI> client;
+	Node *server_root = nullptr;
+	Node *client_root = nullptr;
+	Node3D *server_objects[OBJECT_COUNT] = {};
+	Node3D *client_objects[OBJECT_COUNT] = {};
+
+	// Both ends track the same objects in the same order, as custom mode requires.
+	DeltaSyncTest(const Callable &p_relevancy = Callable()) {
+		scene_id = ResourceUID::get_singleton()->create_id();
+		ResourceUID::get_singleton()->add_id(scene_id, "res://delta_sync_test.tscn");
+
+		server_peer = Ref<LoopbackMultiplayerPeer>(memnew(LoopbackMultiplayerPeer(1)));
+		client_peer = Ref<LoopbackMultiplayerPeer>(memnew(LoopbackMultiplayerPeer(2)));
+		server_peer->remote = client_peer.ptr();
+		client_peer->remote = server_peer.ptr();
+
+		server_root = memnew(Node);
+		client_root = memnew(Node);
+		server.instantiate();
+		client.instantiate();
+		server->set_root_node(server_root);
+		client->set_root_node(client_root);
+		server->set_multiplayer_peer(server_peer);
+		client->set_multiplayer_peer(client_peer);
+		server->_add_peer(2);
+
+		TypedArray<StringName> props;
+		props.push_back("position");
+		props.push_back("visible");
+		props.push_back("process_priority");
+		PackedFloat32Array quantization;
+		quantization.push_back(0.01);
+		quantization.push_back(0);
+		quantization.push_back(0);
+
+		MultiplayerAPI *apis[2] = { server.ptr(), client.ptr() };
+		Node **roots[2] = { &server_root, &client_root };
+		Node3D **objects[2] = { server_objects, client_objects };
+		for (int i = 0; i < 2; i++) {
+			// Custom callables so no scene has to be loaded, they are never called.
+			Callable unused(*roots[i], "get_name");
+			MultiplayerReplicator *replicator = apis[i]->get_replicator();
+			CHECK(replicator->spawn_config(scene_id, MultiplayerReplicator::REPLICATION_MODE_CUSTOM, TypedArray<StringName>(), unused, unused) == OK);
+			CHECK(replicator->sync_delta_config(scene_id, 0, props, quantization, p_relevancy) == OK);
+			for (int j = 0; j < OBJECT_COUNT; j++) {
+				objects[i][j] = memnew(Node3D);
+				replicator->track(scene_id, objects[i][j]);
+			}
+		}
+	}
+
+	~DeltaSyncTest() {
+		server->set_multiplayer_peer(Ref<MultiplayerPeer>());
+		client->set_multiplayer_peer(Ref<MultiplayerPeer>());
+		for (int i = 0; i < OBJECT_COUNT; i++) {
+			memdelete(server_objects[i]);
+			memdelete(client_objects[i]);
+		}
+		memdelete(server_root);
+		memdelete(client_root);
+		ResourceUID::get_singleton()->remove_id(scene_id);
+	}
+
+	// Sends the server state and delivers the update and its ack.
+	void sync() {
+		CHECK(server->get_replicator()->sync_all(scene_id, 0) == OK);
+		client->poll();
+		server->poll();
+	}
+
+	bool client_matches_server() const {
+		for (int i = 0; i < OBJECT_COUNT; i++) {
+			if (!client_objects[i]->get_position().is_equal_approx(server_objects[i]->get_position()) ||
+					client_objects[i]->is_visible() != server_objects[i]->is_visible() ||
+					client_objects[i]->get_process_priority() != server_objects[i]->get_process_priority()) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+TEST_CASE("[MultiplayerReplicator] Delta sync replicates and quantizes values") {
+	DeltaSyncTest test;
+	test.server_objects[0]->set_position(Vector3(1.234, -5.678, 100.001));
+	test.server_objects[1]->set_visible(false);
+	test.server_objects[2]->set_process_priority(-42);
+	test.sync();
+
+	CHECK(test.client_objects[0]->get_position().is_equal_approx(Vector3(1.23, -5.68, 100.0)));
+	CHECK_FALSE(test.client_objects[1]->is_visible());
+	CHECK(test.client_objects[2]->get_process_priority() == -42);
+
+	// Changes smaller than the quantization step aren't worth a packet.
+	int sent = test.server_peer->sent_packets;
+	test.server_objects[0]->set_position(Vector3(1.232, -5.679, 100.002));
+	CHECK(test.server->get_replicator()->sync_all(test.scene_id, 0) == OK);
+	CHECK(test.server_peer->sent_packets == sent);
+}
+
+TEST_CASE("[MultiplayerReplicator] Delta sync only sends what changed since the acked state") {
+	DeltaSyncTest test;
+	for (int i = 0; i < DeltaSyncTest::OBJECT_COUNT; i++) {
+		test.server_objects[i]->set_position(Vector3(i, i * 2, i * 3));
+		test.server_objects[i]->set_process_priority(i + 1);
+	}
+	test.sync();
+	const int full_size = test.server_peer->last_packet_size;
+	CHECK(test.client_matches_server());
+
+	test.server_objects[1]->set_visible(false);
+	test.sync();
+	CHECK(test.server_peer->last_packet_size < full_size);
+	CHECK(test.client_matches_server());
+
+	// Nothing changed, nothing is sent.
+	int sent = test.server_peer->sent_packets;
+	CHECK(test.server->get_replicator()->sync_all(test.scene_id, 0) == OK);
+	CHECK(test.server_peer->sent_packets == sent);
+}
+
+TEST_CASE("[MultiplayerReplicator] Delta sync skips objects that aren't relevant to the peer") {
+	DeltaSyncRelevancy relevancy;
+	DeltaSyncTest test(callable_mp(&relevancy, &DeltaSyncRelevancy::is_relevant));
+	relevancy.hidden = test.server_objects[1]->get_instance_id();
+
+	for (int i = 0; i < DeltaSyncTest::OBJECT_COUNT; i++) {
+		test.server_objects[i]->set_process_priority(10 + i);
+	}
+	test.sync();
+	CHECK(test.client_objects[0]->get_process_priority() == 10);
+	CHECK(test.client_objects[1]->get_process_priority() == 0);
+	CHECK(test.client_objects[2]->get_process_priority() == 12);
+
+	// Becoming relevant sends the full state of the object.
+	relevancy.hidden = ObjectID();
+	test.sync();
+	CHECK(test.client_matches_server());
+}
+
+TEST_CASE("[MultiplayerReplicator] Delta sync converges after lost updates and acks") {
+	DeltaSyncTest test;
+	test.sync();
+
+	// Lost acks: updates keep using the last acked state, and a full state once it's too old.
+	test.client_peer->drop_unreliable = true;
+	for (int i = 0; i < 40; i++) {
+		test.server_objects[i % DeltaSyncTest::OBJECT_COUNT]->set_process_priority(i);
+		test.sync();
+		CHECK(test.client_matches_server());
+	}
+	test.client_peer->drop_unreliable = false;
+	test.server_objects[0]->set_process_priority(100);
+	test.sync();
+	CHECK(test.client_matches_server());
+
+	// Lost updates: the next one still applies on top of the acked state.
+	test.server_peer->drop_unreliable = true;
+	test.server_objects[0]->set_position(Vector3(4, 5, 6));
+	test.server_objects[1]->set_visible(false);
+	test.sync();
+	CHECK_FALSE(test.client_matches_server());
+	test.server_peer->drop_unreliable = false;
+
+	test.server_objects[2]->set_process_priority(-1);
+	test.sync();
+	CHECK(test.client_matches_server());
+
+	// Tracking a new object invalidates the client's snapshots, it asks for a full state.
+	Node3D *server_extra = memnew(Node3D);
+	Node3D *client_extra = memnew(Node3D);
+	test.server->get_replicator()->track(test.scene_id, server_extra);
+	test.client->get_replicator()->track(test.scene_id, client_extra);
+	server_extra->set_position(Vector3(7, 8, 9));
+	test.sync();
+	CHECK(client_extra->get_position().is_equal_approx(Vector3(7, 8, 9)));
+	CHECK(test.client_matches_server());
+
+	test.server->get_replicator()->untrack(test.scene_id, server_extra);
+	test.client->get_replicator()->untrack(test.scene_id, client_extra);
+	memdelete(server_extra);
+	memdelete(client_extra);
+}
+
+} // namespace TestMultiplayerReplicator
+
+#endif // TEST_MULTIPLAYER_REPLICATOR_H
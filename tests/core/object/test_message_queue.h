@@ -0,0 +1,174 @@
+/*************************************************************************/
+/*  test_message_queue.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESSAGE_QUEUE_H
+#define TEST_MESSAGE_QUEUE_H
+
+#include "core/config/project_settings.h"
+#include "core/object/message_queue.h"
+#include "core/os/thread.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMessageQueue {
+
+class Recorder : public Object {
+	GDCLASS(Recorder, Object);
+
+public:
+	LocalVector<int> calls;
+	int requeue = 0;
+
+	void record(int p_value) {
+		calls.push_back(p_value);
+		if (requeue > 0) {
+			requeue--;
+			MessageQueue::get_singleton()->push_callable(callable_mp(this, &Recorder::record), p_value + 1);
+		}
+	}
+};
+
+struct Producer {
+	Recorder *recorder = nullptr;
+	int first = 0;
+	int count = 0;
+
+	static void run(void *p_userdata) {
+		Producer *producer = (Producer *)p_userdata;
+		for (int i = 0; i < producer->count; i++) {
+			MessageQueue::get_singleton()->push_callable(callable_mp(producer->recorder, &Recorder::record), producer->first + i);
+		}
+	}
+};
+
+TEST_CASE("[MessageQueue] Calls run in push order, including calls pushed while flushing") {
+	MessageQueue *queue = memnew(MessageQueue);
+	Recorder *recorder = memnew(Recorder);
+
+	recorder->requeue = 2;
+	queue->push_callable(callable_mp(recorder, &Recorder::record), 10);
+	queue->push_callable(callable_mp(recorder, &Recorder::record), 20);
+	queue->flush();
+
+	REQUIRE(recorder->calls.size() == 4);
+	CHECK(recorder->calls[0] == 10);
+	CHECK(recorder->calls[1] == 20);
+	CHECK(recorder->calls[2] == 11);
+	CHECK(recorder->calls[3] == 21);
+	CHECK(queue->get_max_buffer_usage() > 0);
+
+	memdelete(recorder);
+	memdelete(queue);
+}
+
+TEST_CASE("[MessageQueue] Calls pushed from other threads are flushed in per-thread order") {
+	MessageQueue *queue = memnew(MessageQueue);
+	Recorder *recorder = memnew(Recorder);
+
+	const int thread_count = 4;
+	const int per_thread = 1000;
+	Producer producers[thread_count];
+	Thread threads[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		producers[i].recorder = recorder;
+		producers[i].first = i * per_thread;
+		producers[i].count = per_thread;
+		threads[i].start(&Producer::run, &producers[i]);
+	}
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].wait_to_finish();
+	}
+	queue->flush();
+
+	REQUIRE(recorder->calls.size() == thread_count * per_thread);
+	int last[thread_count] = { -1, -1, -1, -1 };
+	bool ordered = true;
+	for (uint32_t i = 0; i < recorder->calls.size(); i++) {
+		int thread = recorder->calls[i] / per_thread;
+		ordered = ordered && recorder->calls[i] > last[thread];
+		last[thread] = recorder->calls[i];
+	}
+	CHECK_MESSAGE(ordered, "Calls from the same thread should keep their order.");
+	CHECK(queue->get_overflow_count() == 0);
+
+	memdelete(recorder);
+	memdelete(queue);
+}
+
+TEST_CASE("[MessageQueue] Calls pushed from different threads run in global push order") {
+	MessageQueue *queue = memnew(MessageQueue);
+	Recorder *recorder = memnew(Recorder);
+
+	// Each producer pushes after the main thread's previous call and before its next one.
+	const int round_count = 4;
+	Producer producers[round_count];
+	Thread threads[round_count];
+	for (int i = 0; i < round_count; i++) {
+		queue->push_callable(callable_mp(recorder, &Recorder::record), i * 2);
+		producers[i].recorder = recorder;
+		producers[i].first = i * 2 + 1;
+		producers[i].count = 1;
+		threads[i].start(&Producer::run, &producers[i]);
+		threads[i].wait_to_finish();
+	}
+	queue->flush();
+
+	REQUIRE(recorder->calls.size() == round_count * 2);
+	for (uint32_t i = 0; i < recorder->calls.size(); i++) {
+		CHECK(recorder->calls[i] == int(i));
+	}
+
+	memdelete(recorder);
+	memdelete(queue);
+}
+
+TEST_CASE("[MessageQueue] Exceeding the size limit grows the queue instead of dropping calls") {
+	ProjectSettings::get_singleton()->set_setting("memory/limits/message_queue/max_size_kb", 1);
+	MessageQueue *queue = memnew(MessageQueue);
+	Recorder *recorder = memnew(Recorder);
+
+	ERR_PRINT_OFF;
+	for (int i = 0; i < 1000; i++) {
+		queue->push_callable(callable_mp(recorder, &Recorder::record), i);
+	}
+	ERR_PRINT_ON;
+	CHECK(queue->get_overflow_count() > 0);
+
+	queue->flush();
+	CHECK(recorder->calls.size() == 1000);
+
+	memdelete(recorder);
+	memdelete(queue);
+	ProjectSettings::get_singleton()->set_setting("memory/limits/message_queue/max_size_kb", Variant());
+}
+
+} // namespace TestMessageQueue
+
+#endif // TEST_MESSAGE_QUEUE_H
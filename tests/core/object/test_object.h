@@ -275,6 +275,73 @@ TEST_CASE("[Object] Absent name getter") {
 			actual_value == Variant(),
 			"The returned value should equal nil variant.");
 }
+
+class _SignalReceiver : public Object {
+public:
+	Object *emitter = nullptr;
+	_SignalReceiver *other = nullptr;
+	int calls = 0;
+
+	void count() { calls++; }
+	void disconnect_other() {
+		calls++;
+		emitter->disconnect("test_signal", callable_mp(other, &_SignalReceiver::count));
+	}
+};
+
+TEST_CASE("[Object] Signal emission to native methods") {
+	Object emitter;
+	Object receiver;
+	emitter.add_user_signal(MethodInfo("test_signal", PropertyInfo(Variant::NIL, "name"), PropertyInfo(Variant::NIL, "value")));
+	emitter.connect("test_signal", Callable(&receiver, "set_meta"));
+
+	// Exact argument types.
+	emitter.emit_signal("test_signal", StringName("key"), 5);
+	CHECK(int(receiver.get_meta("key")) == 5);
+
+	// Arguments that need converting.
+	emitter.emit_signal("test_signal", String("key"), 6);
+	CHECK(int(receiver.get_meta("key")) == 6);
+}
+
+TEST_CASE("[Object] Disconnecting during signal emission") {
+	Object emitter;
+	_SignalReceiver first;
+	_SignalReceiver second;
+	emitter.add_user_signal(MethodInfo("test_signal"));
+	first.emitter = &emitter;
+	first.other = &second;
+
+	emitter.connect("test_signal", callable_mp(&first, &_SignalReceiver::disconnect_other));
+	emitter.connect("test_signal", callable_mp(&second, &_SignalReceiver::count));
+
+	emitter.emit_signal("test_signal");
+	CHECK(first.calls == 1);
+	CHECK_MESSAGE(second.calls == 0, "Slots disconnected during the emission should not be called anymore.");
+	CHECK(!emitter.is_connected("test_signal", callable_mp(&second, &_SignalReceiver::count)));
+
+	// Reconnecting reuses the compacted slots.
+	emitter.disconnect("test_signal", callable_mp(&first, &_SignalReceiver::disconnect_other));
+	emitter.connect("test_signal", callable_mp(&second, &_SignalReceiver::count));
+	emitter.emit_signal("test_signal");
+	CHECK(second.calls == 1);
+
+	List<Object::Connection> connections;
+	emitter.get_signal_connection_list("test_signal", &connections);
+	CHECK(connections.size() == 1);
+}
+
+TEST_CASE("[Object] One shot signal connections") {
+	Object emitter;
+	_SignalReceiver receiver;
+	emitter.add_user_signal(MethodInfo("test_signal"));
+	emitter.connect("test_signal", callable_mp(&receiver, &_SignalReceiver::count), varray(), Object::CONNECT_ONESHOT);
+
+	emitter.emit_signal("test_signal");
+	emitter.emit_signal("test_signal");
+	CHECK(receiver.calls == 1);
+	CHECK(!emitter.is_connected("test_signal", callable_mp(&receiver, &_SignalReceiver::count)));
+}
 } // namespace TestObject
 
 #endif // TEST_OBJECT_H
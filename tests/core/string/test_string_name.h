@@ -0,0 +1,165 @@
+/*************************************************************************/
+/*  test_string_name.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_STRING_NAME_H
+#define TEST_STRING_NAME_H
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string/string_name.h"
+
+#include "tests/test_macros.h"
+
+namespace TestStringName {
+
+struct InternJob {
+	int first = 0;
+	int count = 0;
+	int rounds = 0;
+	Vector<String> strings;
+	Vector<StringName> names;
+
+	void prepare() {
+		strings.resize(count);
+		names.resize(count);
+		for (int i = 0; i < count; i++) {
+			strings.write[i] = "string_name_test_" + itos(first + i);
+		}
+	}
+
+	static void run(void *p_userdata) {
+		InternJob *job = (InternJob *)p_userdata;
+		for (int round = 0; round < job->rounds; round++) {
+			for (int i = 0; i < job->count; i++) {
+				job->names.write[i] = StringName(job->strings[i]);
+			}
+		}
+	}
+};
+
+TEST_CASE("[StringName] Interning") {
+	StringName a = "string_name_interning";
+	StringName b = String("string_name_interning");
+	StringName c = SNAME("string_name_interning");
+
+	CHECK(a == b);
+	CHECK(b == c);
+	CHECK(a.data_unique_pointer() == c.data_unique_pointer());
+	CHECK(StringName::search("string_name_interning") == a);
+	CHECK(StringName::search(U"string_name_interning") == a);
+	CHECK(StringName::search("string_name_not_interned") == StringName());
+}
+
+TEST_CASE("[StringName] Released names are removed, even after the table grows") {
+	const int count = 10000;
+	{
+		Vector<StringName> names;
+		for (int i = 0; i < count; i++) {
+			names.push_back(StringName("string_name_grow_" + itos(i)));
+		}
+		bool found = true;
+		for (int i = 0; i < count; i++) {
+			found = found && StringName::search("string_name_grow_" + itos(i)) == names[i];
+		}
+		CHECK_MESSAGE(found, "Every name should still be found after the buckets were resized.");
+	}
+	CHECK(StringName::search("string_name_grow_0") == StringName());
+	CHECK(StringName::search("string_name_grow_" + itos(count - 1)) == StringName());
+}
+
+TEST_CASE("[StringName] Concurrent interning yields a single entry per string") {
+	const int thread_count = 4;
+	InternJob jobs[thread_count];
+	Thread threads[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		// Overlapping ranges, so threads race on the same strings.
+		jobs[i].first = i * 500;
+		jobs[i].count = 2000;
+		jobs[i].rounds = 4;
+		jobs[i].prepare();
+		threads[i].start(&InternJob::run, &jobs[i]);
+	}
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].wait_to_finish();
+	}
+
+	bool unique = true;
+	for (int i = 0; i < thread_count; i++) {
+		for (int j = 0; j < jobs[i].count; j++) {
+			StringName expected = StringName::search("string_name_test_" + itos(jobs[i].first + j));
+			unique = unique && expected == jobs[i].names[j];
+		}
+	}
+	CHECK_MESSAGE(unique, "Every thread should get the same interned entry for the same string.");
+}
+
+// Usage: `mesh --test string-name-benchmark`.
+static void benchmark_intern() {
+	const int thread_counts[] = { 1, 2, 4, 8 };
+	const int strings = 20000;
+	const int rounds = 10;
+
+	print_line(vformat("Interning %d strings %d times per thread:", strings, rounds));
+	for (int t = 0; t < 4; t++) {
+		const int thread_count = thread_counts[t];
+		InternJob *jobs = memnew_arr(InternJob, thread_count);
+		Thread *threads = memnew_arr(Thread, thread_count);
+
+		// Keep a reference to every string, so the measured loop only looks up interned names.
+		InternJob warmup;
+		warmup.count = strings;
+		warmup.rounds = 1;
+		warmup.prepare();
+		InternJob::run(&warmup);
+		for (int i = 0; i < thread_count; i++) {
+			jobs[i].count = strings;
+			jobs[i].rounds = rounds;
+			jobs[i].prepare();
+		}
+
+		uint64_t begin = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < thread_count; i++) {
+			threads[i].start(&InternJob::run, &jobs[i]);
+		}
+		for (int i = 0; i < thread_count; i++) {
+			threads[i].wait_to_finish();
+		}
+		uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+		print_line(vformat("  %d thread(s): %.3f ms, %.1f ns per StringName", thread_count, elapsed / 1000.0, elapsed * 1000.0 / (double(thread_count) * strings * rounds)));
+
+		memdelete_arr(threads);
+		memdelete_arr(jobs);
+	}
+}
+
+REGISTER_TEST_COMMAND("string-name-benchmark", &benchmark_intern);
+} // namespace TestStringName
+
+#endif // TEST_STRING_NAME_H
@@ -0,0 +1,155 @@
+/*************************************************************************/
+/*  test_task_scheduler.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_TASK_SCHEDULER_H
+#define TEST_TASK_SCHEDULER_H
+
+#include "core/templates/task_scheduler.h"
+#include "core/templates/thread_work_pool.h"
+
+#include "tests/test_macros.h"
+
+namespace TestTaskScheduler {
+
+struct Counter {
+	std::atomic<uint32_t> count = { 0 };
+	std::atomic<uint32_t> sequence = { 0 };
+	uint32_t first_order = 0;
+	uint32_t second_order = 0;
+	LocalVector<uint32_t> visits;
+	TaskScheduler::Group *root = nullptr;
+	ThreadWorkPool *pool = nullptr;
+
+	void visit(uint32_t p_index, int p_unused) {
+		visits[p_index]++;
+		count.fetch_add(1);
+	}
+
+	void first(int p_unused) {
+		first_order = sequence.fetch_add(1) + 1;
+	}
+
+	void second(int p_unused) {
+		second_order = sequence.fetch_add(1) + 1;
+	}
+
+	void spawn(int p_depth) {
+		count.fetch_add(1);
+		if (p_depth == 0) {
+			return;
+		}
+		TaskScheduler *scheduler = TaskScheduler::get_singleton();
+		TaskScheduler::Group child(root);
+		for (int i = 0; i < 3; i++) {
+			scheduler->release_task(scheduler->add_task(this, &Counter::spawn, p_depth - 1, &child));
+		}
+		scheduler->wait_for_group(&child);
+	}
+
+	void increment(uint32_t p_index, int p_unused) {
+		count.fetch_add(1);
+	}
+
+	void nested_work(uint32_t p_index, int p_unused) {
+		pool->do_work(16, this, &Counter::increment, 0);
+	}
+};
+
+TEST_CASE("[TaskScheduler] Parallel for visits every element once") {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	REQUIRE(scheduler != nullptr);
+
+	Counter counter;
+	counter.visits.resize(10000);
+	for (uint32_t i = 0; i < counter.visits.size(); i++) {
+		counter.visits[i] = 0;
+	}
+
+	scheduler->parallel_for(counter.visits.size(), &counter, &Counter::visit, 0);
+
+	bool all_once = true;
+	for (uint32_t i = 0; i < counter.visits.size(); i++) {
+		all_once = all_once && counter.visits[i] == 1;
+	}
+	CHECK(all_once);
+	CHECK(counter.count.load() == 10000);
+}
+
+TEST_CASE("[TaskScheduler] Dependencies") {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	Counter counter;
+
+	TaskScheduler::TaskID first = scheduler->add_task(&counter, &Counter::first, 0);
+	TaskScheduler::TaskID second = scheduler->add_task(&counter, &Counter::second, 0, nullptr, &first, 1);
+	scheduler->wait_for_task(second);
+	CHECK(scheduler->is_task_completed(first));
+	scheduler->wait_for_task(first);
+
+	CHECK(counter.first_order == 1);
+	CHECK(counter.second_order == 2);
+}
+
+TEST_CASE("[TaskScheduler] Nested groups") {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	Counter counter;
+	TaskScheduler::Group root;
+	counter.root = &root;
+
+	scheduler->release_task(scheduler->add_task(&counter, &Counter::spawn, 3, &root));
+	scheduler->wait_for_group(&root);
+
+	CHECK(root.is_done());
+	CHECK(counter.count.load() == 1 + 3 + 9 + 27);
+}
+
+TEST_CASE("[TaskScheduler] ThreadWorkPool shares the scheduler") {
+	ThreadWorkPool pool;
+	pool.init();
+	CHECK(pool.get_thread_count() > 0);
+
+	Counter counter;
+	counter.pool = &pool;
+
+	// Nested do_work() on the same pool used to be rejected.
+	pool.do_work(8, &counter, &Counter::nested_work, 0);
+	CHECK(counter.count.load() == 8 * 16);
+
+	counter.count.store(0);
+	pool.begin_work(100, &counter, &Counter::increment, 0);
+	CHECK(pool.is_working());
+	pool.end_work();
+	CHECK(!pool.is_working());
+	CHECK(counter.count.load() == 100);
+
+	pool.finish();
+}
+} // namespace TestTaskScheduler
+
+#endif // TEST_TASK_SCHEDULER_H
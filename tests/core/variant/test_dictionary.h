@@ -500,6 +500,122 @@ TEST_CASE("[Dictionary] Recursive self comparison") {
 	d2.clear();
 }
 
+TEST_CASE("[Dictionary] StringName and String keys are the same key") {
+	Dictionary map;
+	map[StringName("name")] = 1;
+	CHECK(map.has("name"));
+	CHECK(int(map[String("name")]) == 1);
+	map["name"] = 2;
+	CHECK(map.size() == 1);
+	CHECK(int(map[StringName("name")]) == 2);
+	// The stored key is a String.
+	CHECK(map.get_key_at_index(0).get_type() == Variant::STRING);
+	CHECK(map.erase(StringName("name")));
+	CHECK(map.is_empty());
+
+	// Also once the dictionary is large enough to be indexed.
+	for (int i = 0; i < 100; i++) {
+		map[itos(i)] = i;
+	}
+	map[StringName()] = -1;
+	CHECK(map.has(""));
+	CHECK(int(map[String()]) == -1);
+	map[String::utf8("ñandú")] = -2;
+	CHECK(map.has(StringName(String::utf8("ñandú"))));
+	CHECK(map.size() == 102);
+}
+
+TEST_CASE("[Dictionary] Insertion order is kept through growth and erasure") {
+	Dictionary map;
+	const int count = 1000;
+	for (int i = 0; i < count; i++) {
+		map[i] = i * 2;
+	}
+	Variant *first = map.getptr(0);
+	for (int i = count; i < count * 2; i++) {
+		map[i] = i * 2;
+	}
+	// Adding entries does not move existing ones.
+	CHECK(map.getptr(0) == first);
+
+	for (int i = 0; i < count * 2; i += 3) {
+		map.erase(i);
+	}
+	CHECK(map.size() == count * 2 - (count * 2 + 2) / 3);
+
+	bool ordered = true;
+	bool found = true;
+	int previous = -1;
+	for (const Variant *key = map.next(); key; key = map.next(key)) {
+		int k = *key;
+		ordered = ordered && k > previous && k % 3 != 0;
+		found = found && int(map[k]) == k * 2;
+		previous = k;
+	}
+	CHECK(ordered);
+	CHECK(found);
+	CHECK(int(map.get_key_at_index(0)) == 1);
+	CHECK(int(map.get_value_at_index(1)) == 4);
+
+	// Erasing other entries does not move the remaining ones.
+	Variant *last = map.getptr(count * 2 - 1);
+	for (int i = 1; i < count * 2 - 1; i += 3) {
+		map.erase(i);
+	}
+	CHECK(map.getptr(count * 2 - 1) == last);
+	CHECK(int(*last) == (count * 2 - 1) * 2);
+
+	// Re-adding an erased key appends it.
+	map[0] = 0;
+	CHECK(int(map.get_key_at_index(map.size() - 1)) == 0);
+	CHECK_FALSE(map.has(3));
+}
+
+TEST_CASE("[Dictionary] Memory stays bounded when keys are used as a queue") {
+	Dictionary map;
+	const int live = 100;
+	int oldest = 0;
+	int newest = 0;
+	for (; newest < live; newest++) {
+		map[newest] = newest;
+	}
+
+	// Insert new keys and erase the oldest, so erased entries are never at the end.
+	uint64_t mem_usage = 0;
+	for (int round = 0; round < 2; round++) {
+		for (int i = 0; i < 50000; i++) {
+			map[newest] = newest;
+			newest++;
+			map.erase(oldest);
+			oldest++;
+		}
+		if (round == 0) {
+			mem_usage = Memory::get_mem_usage();
+		}
+	}
+	CHECK(Memory::get_mem_usage() <= mem_usage);
+
+	CHECK(map.size() == live);
+	CHECK(int(map.get_key_at_index(0)) == oldest);
+	CHECK(int(map.get_value_at_index(live - 1)) == newest - 1);
+	bool ordered = true;
+	int expected = oldest;
+	for (const Variant *key = map.next(); key; key = map.next(key)) {
+		ordered = ordered && int(*key) == expected;
+		expected++;
+	}
+	CHECK(ordered);
+	CHECK(expected == newest);
+
+	// Compacting the order on erase doesn't move the entries.
+	Variant *newest_value = map.getptr(newest - 1);
+	for (int i = 0; i < live - 1; i++) {
+		map.erase(oldest + i);
+	}
+	CHECK(map.getptr(newest - 1) == newest_value);
+	CHECK(int(map.get_key_at_index(0)) == newest - 1);
+}
+
 } // namespace TestDictionary
 
 #endif // TEST_DICTIONARY_H
@@ -0,0 +1,94 @@
+/*************************************************************************/
+/*  test_animation.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_ANIMATION_H
+#define TEST_ANIMATION_H
+
+#include "scene/resources/animation.h"
+
+#include "tests/test_macros.h"
+
+namespace TestAnimation {
+
+TEST_CASE("[Animation] Compressed tracks sampled together match the per track interpolation") {
+	Ref<Animation> animation;
+	animation.instantiate();
+	animation->set_length(4.0);
+
+	const int position_track = animation->add_track(Animation::TYPE_POSITION_3D);
+	const int rotation_track = animation->add_track(Animation::TYPE_ROTATION_3D);
+	const int scale_track = animation->add_track(Animation::TYPE_SCALE_3D);
+	const int blend_shape_track = animation->add_track(Animation::TYPE_BLEND_SHAPE);
+	const int value_track = animation->add_track(Animation::TYPE_VALUE);
+	for (int i = 0; i <= 40; i++) {
+		const double time = i * 0.1;
+		animation->position_track_insert_key(position_track, time, Vector3(Math::sin(time), time, -2.0 * time));
+		animation->rotation_track_insert_key(rotation_track, time, Quaternion(Vector3(0, 1, 0), time));
+		animation->scale_track_insert_key(scale_track, time, Vector3(1, 1, 1) * (1.0 + 0.25 * Math::cos(time)));
+		animation->blend_shape_track_insert_key(blend_shape_track, time, Math::sin(time));
+		animation->track_insert_key(value_track, time, i);
+	}
+
+	// Small pages, so sampling crosses several of them.
+	animation->compress(256);
+	REQUIRE(animation->is_compressed());
+
+	LocalVector<Animation::TrackSample> samples;
+	for (int i = 0; i <= 57; i++) {
+		const double time = i * 0.07;
+		animation->sample_compressed_tracks(time, samples);
+		REQUIRE(samples.size() == 5);
+		CHECK_FALSE(samples[value_track].valid);
+
+		Vector3 position;
+		REQUIRE(animation->position_track_interpolate(position_track, time, &position) == OK);
+		CHECK(samples[position_track].valid);
+		CHECK(samples[position_track].vector.is_equal_approx(position));
+
+		Quaternion rotation;
+		REQUIRE(animation->rotation_track_interpolate(rotation_track, time, &rotation) == OK);
+		CHECK(samples[rotation_track].valid);
+		CHECK(samples[rotation_track].rotation.is_equal_approx(rotation));
+
+		Vector3 scale;
+		REQUIRE(animation->scale_track_interpolate(scale_track, time, &scale) == OK);
+		CHECK(samples[scale_track].valid);
+		CHECK(samples[scale_track].vector.is_equal_approx(scale));
+
+		float blend = 0.0;
+		REQUIRE(animation->blend_shape_track_interpolate(blend_shape_track, time, &blend) == OK);
+		CHECK(samples[blend_shape_track].valid);
+		CHECK(Math::is_equal_approx(samples[blend_shape_track].blend_shape, blend));
+	}
+}
+
+} // namespace TestAnimation
+
+#endif // TEST_ANIMATION_H
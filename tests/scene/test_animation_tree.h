@@ -0,0 +1,120 @@
+/*************************************************************************/
+/*  test_animation_tree.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_ANIMATION_TREE_H
+#define TEST_ANIMATION_TREE_H
+
+#include "core/config/project_settings.h"
+#include "core/object/message_queue.h"
+#include "scene/animation/animation_blend_tree.h"
+#include "scene/animation/animation_tree.h"
+
+#include "tests/test_macros.h"
+
+namespace TestAnimationTree {
+
+// A scene with a Node3D moving from (1, 2, 3) to (11, 2, 3) in one second, played by an AnimationTree.
+static Node3D *create_scene(AnimationTree **r_tree, Node3D **r_target) {
+	Node3D *root = memnew(Node3D);
+
+	Node3D *target = memnew(Node3D);
+	target->set_name("target");
+	root->add_child(target);
+
+	Ref<Animation> animation;
+	animation.instantiate();
+	animation->set_length(1.0);
+	int track = animation->add_track(Animation::TYPE_POSITION_3D);
+	animation->track_set_path(track, NodePath("target"));
+	animation->position_track_insert_key(track, 0.0, Vector3(1, 2, 3));
+	animation->position_track_insert_key(track, 1.0, Vector3(11, 2, 3));
+
+	AnimationPlayer *player = memnew(AnimationPlayer);
+	player->set_name("player");
+	player->add_animation("move", animation);
+	root->add_child(player);
+
+	Ref<AnimationNodeAnimation> node;
+	node.instantiate();
+	node->set_animation("move");
+
+	AnimationTree *tree = memnew(AnimationTree);
+	tree->set_tree_root(node);
+	tree->set_animation_player(NodePath("../player"));
+	root->add_child(tree);
+
+	*r_tree = tree;
+	*r_target = target;
+	return root;
+}
+
+TEST_CASE("[AnimationTree] Advancing blends the pose immediately") {
+	AnimationTree *tree = nullptr;
+	Node3D *target = nullptr;
+	Node3D *root = create_scene(&tree, &target);
+
+	tree->advance(0.5);
+	CHECK(target->get_position().is_equal_approx(Vector3(6, 2, 3)));
+
+	tree->advance(0.25);
+	CHECK(target->get_position().is_equal_approx(Vector3(8.5, 2, 3)));
+
+	memdelete(root);
+}
+
+TEST_CASE("[SceneTree][AnimationTree] Threaded blending writes the pose back when the message queue is flushed") {
+	ProjectSettings::get_singleton()->set_setting("animation/animation_tree/threaded_blending", true);
+	AnimationTree *tree = nullptr;
+	Node3D *target = nullptr;
+	Node3D *root = create_scene(&tree, &target);
+	ProjectSettings::get_singleton()->set_setting("animation/animation_tree/threaded_blending", false);
+
+	tree->set_active(true);
+	tree->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+	CHECK(target->get_position().is_equal_approx(Vector3()));
+
+	MessageQueue::get_singleton()->flush();
+	CHECK(target->get_position().is_equal_approx(Vector3(1, 2, 3)));
+
+	// Processing again before the flush finishes the pending pose first.
+	target->set_position(Vector3());
+	tree->notification(Node::NOTIFICATION_INTERNAL_PROCESS);
+	tree->advance(0.5);
+	CHECK(target->get_position().is_equal_approx(Vector3(6, 2, 3)));
+
+	MessageQueue::get_singleton()->flush();
+	CHECK(target->get_position().is_equal_approx(Vector3(6, 2, 3)));
+
+	memdelete(root);
+}
+
+} // namespace TestAnimationTree
+
+#endif // TEST_ANIMATION_TREE_H
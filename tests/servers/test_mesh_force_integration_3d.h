@@ -0,0 +1,132 @@
+/*************************************************************************/
+/*  test_mesh_force_integration_3d.h                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_MESH_FORCE_INTEGRATION_3D_H
+#define TEST_MESH_FORCE_INTEGRATION_3D_H
+
+#include "core/config/project_settings.h"
+#include "servers/physics_server_3d.h"
+
+#include "tests/test_macros.h"
+
+namespace TestMeshForceIntegration3D {
+
+// Bodies are far apart and never touch, so each step only integrates them.
+static RID create_space_with_bodies(PhysicsServer3D *p_ps, RID p_shape, bool p_parallel, LocalVector<RID> &r_bodies) {
+	ProjectSettings::get_singleton()->set_setting("physics/3d/solver/parallel_force_integration", p_parallel);
+	RID space = p_ps->space_create();
+	p_ps->space_set_active(space, true);
+
+	for (int i = 0; i < 600; i++) {
+		RID body = p_ps->body_create();
+		p_ps->body_set_mode(body, i % 5 == 4 ? PhysicsServer3D::BODY_MODE_DYNAMIC_LINEAR : PhysicsServer3D::BODY_MODE_DYNAMIC);
+		p_ps->body_set_space(body, space);
+		p_ps->body_add_shape(body, p_shape);
+		p_ps->body_set_state(body, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+		p_ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(Vector3(1, 2, 3).normalized(), i * 0.1), Vector3(i % 30, 0, i / 30) * 10.0));
+		p_ps->body_set_state(body, PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY, Vector3(i % 3, 1, -1));
+		p_ps->body_set_state(body, PhysicsServer3D::BODY_STATE_ANGULAR_VELOCITY, Vector3(0, 0.5, i % 4));
+		p_ps->body_set_param(body, PhysicsServer3D::BODY_PARAM_MASS, 1.0 + i % 7);
+		p_ps->body_set_param(body, PhysicsServer3D::BODY_PARAM_GRAVITY_SCALE, (i % 4) * 0.5);
+		p_ps->body_set_param(body, PhysicsServer3D::BODY_PARAM_LINEAR_DAMP_MODE, i % 2 ? PhysicsServer3D::BODY_DAMP_MODE_REPLACE : PhysicsServer3D::BODY_DAMP_MODE_COMBINE);
+		p_ps->body_set_param(body, PhysicsServer3D::BODY_PARAM_ANGULAR_DAMP_MODE, i % 3 ? PhysicsServer3D::BODY_DAMP_MODE_COMBINE : PhysicsServer3D::BODY_DAMP_MODE_REPLACE);
+		p_ps->body_set_param(body, PhysicsServer3D::BODY_PARAM_LINEAR_DAMP, (i % 5) * 0.3);
+		p_ps->body_set_param(body, PhysicsServer3D::BODY_PARAM_ANGULAR_DAMP, (i % 6) * 0.2);
+		p_ps->body_set_constant_force(body, Vector3(i % 11, 0, -2));
+		p_ps->body_set_constant_torque(body, Vector3(1, i % 5, 0));
+		if (i % 10 == 0) {
+			// Not integrated in parallel, it goes through the regular integration.
+			p_ps->body_set_omit_force_integration(body, true);
+		}
+		r_bodies.push_back(body);
+	}
+	return space;
+}
+
+TEST_CASE("[MeshStep3D] Parallel force integration matches serial integration") {
+	PhysicsServer3D *ps = PhysicsServer3DManager::new_server("MeshPhysics3D");
+	ps->init();
+
+	RID shape = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+	ps->shape_set_data(shape, Vector3(0.5, 1.0, 1.5));
+
+	LocalVector<RID> bodies;
+	LocalVector<RID> parallel_bodies;
+	RID space = create_space_with_bodies(ps, shape, false, bodies);
+	RID parallel_space = create_space_with_bodies(ps, shape, true, parallel_bodies);
+	ProjectSettings::get_singleton()->set_setting("physics/3d/solver/parallel_force_integration", false);
+
+	const real_t step = 1.0 / 60.0;
+	for (int s = 0; s < 30; s++) {
+		for (uint32_t i = 0; i < bodies.size(); i += 3) {
+			// Applied forces only last for one step.
+			ps->body_apply_central_force(bodies[i], Vector3(0, s, 1));
+			ps->body_apply_central_force(parallel_bodies[i], Vector3(0, s, 1));
+			ps->body_apply_torque(bodies[i], Vector3(s % 2, 0, 1));
+			ps->body_apply_torque(parallel_bodies[i], Vector3(s % 2, 0, 1));
+		}
+		ps->step(step);
+	}
+
+	bool same_velocities = true;
+	bool same_transforms = true;
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		Vector3 linear_velocity = ps->body_get_state(bodies[i], PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY);
+		Vector3 parallel_linear_velocity = ps->body_get_state(parallel_bodies[i], PhysicsServer3D::BODY_STATE_LINEAR_VELOCITY);
+		Vector3 angular_velocity = ps->body_get_state(bodies[i], PhysicsServer3D::BODY_STATE_ANGULAR_VELOCITY);
+		Vector3 parallel_angular_velocity = ps->body_get_state(parallel_bodies[i], PhysicsServer3D::BODY_STATE_ANGULAR_VELOCITY);
+		same_velocities = same_velocities && linear_velocity.is_equal_approx(parallel_linear_velocity) && angular_velocity.is_equal_approx(parallel_angular_velocity);
+
+		Transform3D transform = ps->body_get_state(bodies[i], PhysicsServer3D::BODY_STATE_TRANSFORM);
+		Transform3D parallel_transform = ps->body_get_state(parallel_bodies[i], PhysicsServer3D::BODY_STATE_TRANSFORM);
+		same_transforms = same_transforms && transform.is_equal_approx(parallel_transform);
+	}
+	CHECK_MESSAGE(same_velocities, "Bodies integrated in parallel should have the same velocities as bodies integrated serially.");
+	CHECK_MESSAGE(same_transforms, "Bodies integrated in parallel should end up where bodies integrated serially do.");
+
+	// The bodies did move, so the comparison isn't between untouched states.
+	Transform3D moved = ps->body_get_state(parallel_bodies[1], PhysicsServer3D::BODY_STATE_TRANSFORM);
+	CHECK_FALSE(moved.origin.is_equal_approx(Vector3(10, 0, 0)));
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		ps->free(bodies[i]);
+		ps->free(parallel_bodies[i]);
+	}
+	ps->free(shape);
+	ps->free(space);
+	ps->free(parallel_space);
+
+	ps->finish();
+	memdelete(ps);
+}
+
+} // namespace TestMeshForceIntegration3D
+
+#endif // TEST_MESH_FORCE_INTEGRATION_3D_H
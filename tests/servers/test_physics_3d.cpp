@@ -30,12 +30,17 @@
 
 #include "test_physics_3d.h"
 
+#include "core/config/project_settings.h"
 #include "core/math/convex_hull.h"
 #include "core/math/geometry_3d.h"
 #include "core/os/main_loop.h"
+#include "core/os/os.h"
+#include "core/templates/task_scheduler.h"
 #include "servers/physics_server_3d.h"
 #include "servers/rendering_server.h"
 
+#include "tests/test_macros.h"
+
 class TestPhysics3DMainLoop : public MainLoop {
 	GDCLASS(TestPhysics3DMainLoop, MainLoop);
 
@@ -407,4 +412,189 @@ namespace TestPhysics3D {
 MainLoop *test() {
 	return memnew(TestPhysics3DMainLoop);
 }
+
+// Builds a block of touching boxes resting on the ground, which the solver sees as a single island,
+// and returns the average step time in microseconds. `r_top_drift` receives how far the last box
+// of the top layer moved from where it was placed.
+static double stack_step_usec(int p_width, int p_depth, int p_layers, int p_steps, real_t *r_top_drift = nullptr) {
+	PhysicsServer3D *ps = PhysicsServer3DManager::new_server("MeshPhysics3D");
+	ps->init();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	RID ground_shape = ps->shape_create(PhysicsServer3D::SHAPE_WORLD_BOUNDARY);
+	ps->shape_set_data(ground_shape, Plane(Vector3(0, 1, 0), 0));
+	RID ground = ps->body_create();
+	ps->body_set_mode(ground, PhysicsServer3D::BODY_MODE_STATIC);
+	ps->body_set_space(ground, space);
+	ps->body_add_shape(ground, ground_shape);
+
+	RID box_shape = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+	ps->shape_set_data(box_shape, Vector3(0.5, 0.5, 0.5));
+
+	LocalVector<RID> boxes;
+	for (int y = 0; y < p_layers; y++) {
+		for (int z = 0; z < p_depth; z++) {
+			for (int x = 0; x < p_width; x++) {
+				RID body = ps->body_create();
+				ps->body_set_mode(body, PhysicsServer3D::BODY_MODE_DYNAMIC);
+				ps->body_set_space(body, space);
+				ps->body_add_shape(body, box_shape);
+				ps->body_set_state(body, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+				ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(x, 0.5 + y, z)));
+				boxes.push_back(body);
+			}
+		}
+	}
+
+	const real_t step = 1.0 / 60.0;
+
+	// Let the contacts settle before measuring.
+	for (int i = 0; i < 10; i++) {
+		ps->step(step);
+	}
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_steps; i++) {
+		ps->step(step);
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+	if (r_top_drift) {
+		Transform3D top = ps->body_get_state(boxes[boxes.size() - 1], PhysicsServer3D::BODY_STATE_TRANSFORM);
+		*r_top_drift = top.origin.distance_to(Vector3(p_width - 1, p_layers - 0.5, p_depth - 1));
+	}
+
+	for (uint32_t i = 0; i < boxes.size(); i++) {
+		ps->free(boxes[i]);
+	}
+	ps->free(ground);
+	ps->free(box_shape);
+	ps->free(ground_shape);
+	ps->free(space);
+
+	ps->finish();
+	memdelete(ps);
+
+	return double(elapsed) / p_steps;
+}
+
+// Usage: `mesh --test physics-3d-island-benchmark`.
+static void benchmark_island_solve() {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	ERR_FAIL_COND(scheduler == nullptr);
+
+	const int thread_counts[] = { 1, 4, 16 };
+	const bool solve_modes[] = { false, true };
+
+	print_line("Step time for a single island of 5000 boxes (20x25x10):");
+	for (int mode = 0; mode < 2; mode++) {
+		ProjectSettings::get_singleton()->set_setting("physics/3d/solver/parallel_island_solve", solve_modes[mode]);
+		for (int i = 0; i < 3; i++) {
+			// The calling thread takes part in the work, so it counts as one of them.
+			scheduler->finish();
+			scheduler->init(thread_counts[i] - 1);
+
+			double usec = stack_step_usec(20, 25, 10, 30);
+			print_line(vformat("  %s, %d thread(s): %.3f ms/step", solve_modes[mode] ? "parallel island" : "serial island", thread_counts[i], usec / 1000.0));
+		}
+	}
+
+	ProjectSettings::get_singleton()->set_setting("physics/3d/solver/parallel_island_solve", false);
+	scheduler->finish();
+	scheduler->init();
+}
+
+REGISTER_TEST_COMMAND("physics-3d-island-benchmark", &benchmark_island_solve);
+
+// Usage: `mesh --test physics-3d-stacking-benchmark`.
+static void benchmark_stacking() {
+	const int sizes[][3] = { { 1, 1, 20 }, { 10, 10, 10 }, { 20, 20, 5 } };
+	const bool persistence_modes[] = { false, true };
+
+	print_line("Step time and top box drift for resting stacks of boxes:");
+	for (int i = 0; i < 3; i++) {
+		for (int mode = 0; mode < 2; mode++) {
+			ProjectSettings::get_singleton()->set_setting("physics/3d/solver/persistent_contacts", persistence_modes[mode]);
+
+			real_t drift = 0.0;
+			double usec = stack_step_usec(sizes[i][0], sizes[i][1], sizes[i][2], 120, &drift);
+			String size = vformat("%dx%dx%d", sizes[i][0], sizes[i][1], sizes[i][2]);
+			print_line(vformat("  %s, %s: %.3f ms/step, drift %.4f", size, persistence_modes[mode] ? "persistent contacts" : "narrowphase every step", usec / 1000.0, drift));
+		}
+	}
+
+	ProjectSettings::get_singleton()->set_setting("physics/3d/solver/persistent_contacts", false);
+}
+
+REGISTER_TEST_COMMAND("physics-3d-stacking-benchmark", &benchmark_stacking);
+
+// Builds free falling bodies without shapes, so the step is mostly force and velocity integration,
+// and returns the average step time in microseconds.
+static double free_bodies_step_usec(int p_count, int p_steps) {
+	PhysicsServer3D *ps = PhysicsServer3DManager::new_server("MeshPhysics3D");
+	ps->init();
+
+	RID space = ps->space_create();
+	ps->space_set_active(space, true);
+
+	LocalVector<RID> bodies;
+	for (int i = 0; i < p_count; i++) {
+		RID body = ps->body_create();
+		ps->body_set_mode(body, PhysicsServer3D::BODY_MODE_DYNAMIC);
+		ps->body_set_space(body, space);
+		ps->body_set_state(body, PhysicsServer3D::BODY_STATE_CAN_SLEEP, false);
+		ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), Vector3(i % 100, 0, i / 100) * 2.0));
+		ps->body_set_constant_torque(body, Vector3(0, 1, 0));
+		bodies.push_back(body);
+	}
+
+	const real_t step = 1.0 / 60.0;
+	ps->step(step);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_steps; i++) {
+		ps->step(step);
+	}
+	uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - begin;
+
+	for (uint32_t i = 0; i < bodies.size(); i++) {
+		ps->free(bodies[i]);
+	}
+	ps->free(space);
+
+	ps->finish();
+	memdelete(ps);
+
+	return double(elapsed) / p_steps;
+}
+
+// Usage: `mesh --test physics-3d-parallel-force-integration-benchmark`.
+static void benchmark_parallel_force_integration() {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	ERR_FAIL_COND(scheduler == nullptr);
+
+	const int thread_counts[] = { 1, 4, 16 };
+	const bool parallel_modes[] = { false, true };
+
+	print_line("Step time for 20000 free bodies:");
+	for (int mode = 0; mode < 2; mode++) {
+		ProjectSettings::get_singleton()->set_setting("physics/3d/solver/parallel_force_integration", parallel_modes[mode]);
+		for (int i = 0; i < 3; i++) {
+			// The calling thread takes part in the work, so it counts as one of them.
+			scheduler->finish();
+			scheduler->init(thread_counts[i] - 1);
+
+			double usec = free_bodies_step_usec(20000, 60);
+			print_line(vformat("  %s, %d thread(s): %.3f ms/step", parallel_modes[mode] ? "parallel force integration" : "serial force integration", thread_counts[i], usec / 1000.0));
+		}
+	}
+
+	ProjectSettings::get_singleton()->set_setting("physics/3d/solver/parallel_force_integration", false);
+	scheduler->finish();
+	scheduler->init();
+}
+
+REGISTER_TEST_COMMAND("physics-3d-parallel-force-integration-benchmark", &benchmark_parallel_force_integration);
 } // namespace TestPhysics3D
@@ -0,0 +1,120 @@
+/*************************************************************************/
+/*  test_raster_occlusion_cull.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RASTER_OCCLUSION_CULL_H
+#define TEST_RASTER_OCCLUSION_CULL_H
+
+#include "servers/rendering/raster_occlusion_cull.h"
+
+#include "tests/test_macros.h"
+
+namespace TestRasterOcclusionCull {
+
+static bool is_box_occluded(const RendererSceneOcclusionCull::HZBuffer *p_buffer, const AABB &p_box, const Transform3D &p_cam_transform, const CameraMatrix &p_cam_projection) {
+	const real_t bounds[6] = { p_box.position.x, p_box.position.y, p_box.position.z, p_box.position.x + p_box.size.x, p_box.position.y + p_box.size.y, p_box.position.z + p_box.size.z };
+	return p_buffer->is_occluded(bounds, p_cam_transform.origin, p_cam_transform.affine_inverse(), p_cam_projection, p_cam_projection.get_z_near());
+}
+
+TEST_CASE("[RasterOcclusionCull] Wall hides what is behind it") {
+	RasterOcclusionCull occlusion_cull;
+	ThreadWorkPool thread_pool;
+	thread_pool.init(2);
+
+	// A 4x4 wall facing the camera, 10 units in front of it.
+	PackedVector3Array vertices;
+	vertices.push_back(Vector3(-2, -2, -10));
+	vertices.push_back(Vector3(2, -2, -10));
+	vertices.push_back(Vector3(2, 2, -10));
+	vertices.push_back(Vector3(-2, 2, -10));
+	PackedInt32Array indices;
+	indices.push_back(0);
+	indices.push_back(1);
+	indices.push_back(2);
+	indices.push_back(0);
+	indices.push_back(2);
+	indices.push_back(3);
+
+	RID occluder = occlusion_cull.occluder_allocate();
+	occlusion_cull.occluder_initialize(occluder);
+	occlusion_cull.occluder_set_mesh(occluder, vertices, indices);
+
+	RID scenario = RID::from_uint64(1);
+	RID instance = RID::from_uint64(2);
+	RID viewport = RID::from_uint64(3);
+	occlusion_cull.add_scenario(scenario);
+	occlusion_cull.scenario_set_instance(scenario, instance, occluder, Transform3D(), true);
+
+	occlusion_cull.add_buffer(viewport);
+	occlusion_cull.buffer_set_scenario(viewport, scenario);
+	occlusion_cull.buffer_set_size(viewport, Size2i(64, 48));
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 64.0 / 48.0, 0.1, 100);
+	Transform3D cam_transform;
+	occlusion_cull.buffer_update(viewport, cam_transform, projection, false, thread_pool);
+
+	const RendererSceneOcclusionCull::HZBuffer *buffer = occlusion_cull.buffer_get_ptr(viewport);
+	REQUIRE(buffer != nullptr);
+
+	CHECK_MESSAGE(
+			is_box_occluded(buffer, AABB(Vector3(-1, -1, -30), Vector3(2, 2, 2)), cam_transform, projection),
+			"A box behind the wall should be occluded.");
+	CHECK_MESSAGE(
+			!is_box_occluded(buffer, AABB(Vector3(-1, -1, -6), Vector3(2, 2, 2)), cam_transform, projection),
+			"A box in front of the wall should be visible.");
+	CHECK_MESSAGE(
+			!is_box_occluded(buffer, AABB(Vector3(60, -1, -80), Vector3(2, 2, 2)), cam_transform, projection),
+			"A box behind the wall but beside it on screen should be visible.");
+
+	// Walking past the wall, half of it is behind the near plane and gets clipped.
+	cam_transform.origin = Vector3(0, 0, -10);
+	cam_transform.basis = Basis(Vector3(0, 1, 0), Math_PI * 0.5);
+	occlusion_cull.buffer_update(viewport, cam_transform, projection, false, thread_pool);
+	CHECK_MESSAGE(
+			!is_box_occluded(buffer, AABB(Vector3(-30, -1, -10), Vector3(2, 2, 2)), cam_transform, projection),
+			"Nothing should be occluded by a wall seen edge on.");
+
+	occlusion_cull.scenario_set_instance(scenario, instance, occluder, Transform3D(), false);
+	cam_transform = Transform3D();
+	occlusion_cull.buffer_update(viewport, cam_transform, projection, false, thread_pool);
+	CHECK_MESSAGE(
+			!is_box_occluded(buffer, AABB(Vector3(-1, -1, -30), Vector3(2, 2, 2)), cam_transform, projection),
+			"Disabled occluders should not occlude anything.");
+
+	occlusion_cull.remove_buffer(viewport);
+	occlusion_cull.scenario_remove_instance(scenario, instance);
+	occlusion_cull.remove_scenario(scenario);
+	occlusion_cull.free_occluder(occluder);
+	thread_pool.finish();
+}
+
+} // namespace TestRasterOcclusionCull
+
+#endif // TEST_RASTER_OCCLUSION_CULL_H
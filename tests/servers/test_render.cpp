@@ -30,10 +30,21 @@
 
 #include "test_render.h"
 
+#include "core/config/project_settings.h"
+#include "core/math/camera_matrix.h"
 #include "core/math/convex_hull.h"
+#include "core/math/random_number_generator.h"
 #include "core/os/main_loop.h"
+#include "core/os/os.h"
+#include "servers/rendering/rasterizer_dummy.h"
+#include "servers/rendering/renderer_canvas_cull.h"
+#include "servers/rendering/renderer_scene_cull.h"
+#include "servers/rendering/rendering_server_default.h"
+#include "servers/rendering/rendering_server_globals.h"
 #include "servers/rendering_server.h"
 
+#include "tests/test_macros.h"
+
 #define OBJECT_COUNT 50
 
 namespace TestRender {
@@ -229,4 +240,210 @@ public:
 MainLoop *test() {
 	return memnew(TestMainLoop);
 }
+
+// Returns the average frame setup time (dirty instance update included), in microseconds,
+// of moving every one of `p_count` mesh instances each frame on the dummy rasterizer.
+static double move_instances_usec(int p_count, int p_frames) {
+	RasterizerDummy::make_current();
+	RenderingServerDefault *rs = memnew(RenderingServerDefault);
+	rs->init();
+	rs->set_render_loop_enabled(false);
+
+	RID scenario = rs->scenario_create();
+	// The dummy rasterizer has no surfaces, so the mesh gets its bounds from a custom AABB.
+	RID mesh = rs->mesh_create();
+	rs->mesh_set_custom_aabb(mesh, AABB(Vector3(-0.5, -0.5, -0.5), Vector3(1, 1, 1)));
+
+	LocalVector<RID> instances;
+	instances.resize(p_count);
+	const int side = Math::ceil(Math::pow(double(p_count), 1.0 / 3.0));
+	for (int i = 0; i < p_count; i++) {
+		instances[i] = rs->instance_create2(mesh, scenario);
+		rs->instance_set_transform(instances[i], Transform3D(Basis(), Vector3(i % side, (i / side) % side, i / (side * side)) * 2.0));
+	}
+	rs->draw(false, 1.0 / 60.0);
+
+	double total = 0.0;
+	for (int f = 0; f < p_frames; f++) {
+		for (int i = 0; i < p_count; i++) {
+			Vector3 origin = Vector3(i % side, (i / side) % side, i / (side * side)) * 2.0;
+			origin.y += Math::sin((f + i) * 0.1) * 0.5;
+			rs->instance_set_transform(instances[i], Transform3D(Basis(Vector3(0, 1, 0), f * 0.01), origin));
+		}
+		rs->draw(false, 1.0 / 60.0);
+		total += rs->get_frame_setup_time_cpu() * 1000.0;
+	}
+
+	for (int i = 0; i < p_count; i++) {
+		rs->free(instances[i]);
+	}
+	rs->free(mesh);
+	rs->free(scenario);
+
+	rs->sync();
+	rs->finish();
+	memdelete(rs);
+
+	return total / p_frames;
+}
+
+// Usage: `mesh --test render-instance-update-benchmark`.
+static void benchmark_instance_update() {
+	const int thresholds[] = { INT32_MAX, 1000 };
+
+	print_line("Frame setup time when moving 50000 mesh instances every frame (dummy rasterizer):");
+	for (int i = 0; i < 2; i++) {
+		// The threshold is read when the scene cull is created, so every run gets its own server.
+		ProjectSettings::get_singleton()->set_setting("rendering/limits/spatial_indexer/threaded_cull_minimum_instances", thresholds[i]);
+		double usec = move_instances_usec(50000, 30);
+		print_line(vformat("  %s: %.3f ms/frame", i == 0 ? "serial update" : "parallel update", usec / 1000.0));
+	}
+
+	ProjectSettings::get_singleton()->set_setting("rendering/limits/spatial_indexer/threaded_cull_minimum_instances", 1000);
+}
+
+REGISTER_TEST_COMMAND("render-instance-update-benchmark", &benchmark_instance_update);
+
+// Usage: `mesh --test render-frustum-cull-benchmark`.
+static void benchmark_frustum_cull() {
+	typedef RendererSceneCull::Frustum Frustum;
+	typedef RendererSceneCull::InstanceBounds InstanceBounds;
+	typedef RendererSceneCull::CullVolumes CullVolumes;
+
+	const uint32_t instance_count = 200000;
+	const int cascade_count = 4;
+	const int runs = 20;
+
+	Ref<RandomNumberGenerator> rng;
+	rng.instantiate();
+	rng->set_seed(1234);
+
+	PagedArrayPool<InstanceBounds> pool;
+	PagedArray<InstanceBounds> bounds;
+	bounds.set_page_pool(&pool);
+	for (uint32_t i = 0; i < instance_count; i++) {
+		Vector3 position(rng->randf_range(-500, 500), rng->randf_range(-20, 20), rng->randf_range(-500, 500));
+		bounds.push_back(InstanceBounds(AABB(position, Vector3(1, 1, 1) * rng->randf_range(0.5, 4.0))));
+	}
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, 400);
+	Frustum frustums[1 + cascade_count];
+	frustums[0] = Frustum(projection.get_projection_planes(Transform3D()));
+
+	// Cascades as boxes of growing size in front of the camera, the shape they take for a light pointing down.
+	for (int i = 0; i < cascade_count; i++) {
+		real_t extent = 25.0 * (1 << (i * 2));
+		Vector<Plane> planes;
+		planes.push_back(Plane(Vector3(1, 0, 0), extent));
+		planes.push_back(Plane(Vector3(-1, 0, 0), extent));
+		planes.push_back(Plane(Vector3(0, 1, 0), 1e6));
+		planes.push_back(Plane(Vector3(0, -1, 0), 100));
+		planes.push_back(Plane(Vector3(0, 0, 1), extent * 0.25));
+		planes.push_back(Plane(Vector3(0, 0, -1), extent));
+		frustums[1 + i] = Frustum(planes);
+	}
+
+	CullVolumes volumes;
+	volumes.clear();
+	for (int i = 0; i < 1 + cascade_count; i++) {
+		volumes.add_frustum(frustums[i]);
+	}
+
+	LocalVector<uint64_t> scalar_masks;
+	scalar_masks.resize(instance_count);
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < runs; r++) {
+		for (uint32_t i = 0; i < instance_count; i++) {
+			uint64_t mask = 0;
+			for (int v = 0; v < 1 + cascade_count; v++) {
+				if (bounds[i].in_frustum(frustums[v])) {
+					mask |= uint64_t(1) << v;
+				}
+			}
+			scalar_masks[i] = mask;
+		}
+	}
+	double scalar_usec = double(OS::get_singleton()->get_ticks_usec() - begin) / runs;
+
+	LocalVector<uint64_t> block_masks;
+	block_masks.resize(instance_count);
+	begin = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < runs; r++) {
+		for (uint32_t i = 0; i < instance_count; i += CullVolumes::BLOCK_SIZE) {
+			volumes.cull(bounds, i, MIN(uint32_t(CullVolumes::BLOCK_SIZE), instance_count - i), &block_masks[i]);
+		}
+	}
+	double block_usec = double(OS::get_singleton()->get_ticks_usec() - begin) / runs;
+
+	print_line(vformat("Culling %d instances against the camera frustum and %d shadow cascades:", instance_count, cascade_count));
+	print_line(vformat("  per instance and volume: %.3f ms", scalar_usec / 1000.0));
+	print_line(vformat("  block of %d against all volumes: %.3f ms", CullVolumes::BLOCK_SIZE, block_usec / 1000.0));
+
+	bounds.reset();
+	pool.reset();
+}
+
+REGISTER_TEST_COMMAND("render-frustum-cull-benchmark", &benchmark_frustum_cull);
+
+// Returns the average time, in microseconds, of culling a canvas holding `p_groups` nested
+// groups of `p_rects` rects each on the dummy rasterizer.
+static double cull_canvas_usec(int p_groups, int p_rects, int p_frames) {
+	RasterizerDummy::make_current();
+	RenderingServerDefault *rs = memnew(RenderingServerDefault);
+	rs->init();
+	rs->set_render_loop_enabled(false);
+
+	RID canvas = rs->canvas_create();
+	LocalVector<RID> items;
+	for (int i = 0; i < p_groups; i++) {
+		RID group = rs->canvas_item_create();
+		rs->canvas_item_set_parent(group, canvas);
+		rs->canvas_item_set_transform(group, Transform2D(0.0, Vector2((i % 16) * 64, (i / 16) * 64)));
+		items.push_back(group);
+		for (int j = 0; j < p_rects; j++) {
+			RID rect = rs->canvas_item_create();
+			rs->canvas_item_set_parent(rect, group);
+			rs->canvas_item_set_transform(rect, Transform2D(j * 0.01, Vector2(j % 8, j / 8)));
+			rs->canvas_item_add_rect(rect, Rect2(0, 0, 4, 4), Color(1, 1, 1));
+			items.push_back(rect);
+		}
+	}
+
+	RendererCanvasCull::Canvas *canvas_ptr = RSG::canvas->canvas_owner.get_or_null(canvas);
+	const Rect2 clip_rect(0, 0, 1024, 1024);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+	for (int f = 0; f < p_frames; f++) {
+		RSG::canvas->render_canvas(RID(), canvas_ptr, Transform2D(), nullptr, nullptr, clip_rect, RS::CANVAS_ITEM_TEXTURE_FILTER_LINEAR, RS::CANVAS_ITEM_TEXTURE_REPEAT_DISABLED, false, false);
+	}
+	double usec = double(OS::get_singleton()->get_ticks_usec() - begin) / p_frames;
+
+	// Children before their parents.
+	for (int i = items.size() - 1; i >= 0; i--) {
+		rs->free(items[i]);
+	}
+	rs->free(canvas);
+
+	rs->sync();
+	rs->finish();
+	memdelete(rs);
+
+	return usec;
+}
+
+// Usage: `mesh --test render-canvas-cull-benchmark`.
+static void benchmark_canvas_cull() {
+	print_line("Canvas cull time for 256 groups of 256 rects (dummy rasterizer):");
+	for (int i = 0; i < 2; i++) {
+		// The setting is read when the canvas cull is created, so every run gets its own server.
+		ProjectSettings::get_singleton()->set_setting("rendering/2d/options/use_threaded_culling", i == 1);
+		double usec = cull_canvas_usec(256, 256, 30);
+		print_line(vformat("  %s: %.3f ms/frame", i == 0 ? "serial cull" : "parallel cull", usec / 1000.0));
+	}
+
+	ProjectSettings::get_singleton()->set_setting("rendering/2d/options/use_threaded_culling", true);
+}
+
+REGISTER_TEST_COMMAND("render-canvas-cull-benchmark", &benchmark_canvas_cull);
 } // namespace TestRender
@@ -0,0 +1,174 @@
+/*************************************************************************/
+/*  test_renderer_canvas_cull.h                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RENDERER_CANVAS_CULL_H
+#define TEST_RENDERER_CANVAS_CULL_H
+
+#include "core/config/project_settings.h"
+#include "core/math/random_number_generator.h"
+#include "servers/rendering/rasterizer_dummy.h"
+#include "servers/rendering/renderer_canvas_cull.h"
+#include "servers/rendering/rendering_server_default.h"
+#include "servers/rendering/rendering_server_globals.h"
+
+#include "tests/test_macros.h"
+
+namespace TestRendererCanvasCull {
+
+// Keeps the items in the order they are sent to be drawn.
+class RecordingCanvasRender : public RasterizerCanvasDummy {
+public:
+	LocalVector<Color> drawn;
+
+	void canvas_render_items(RID p_to_render_target, Item *p_item_list, const Color &p_modulate, Light *p_light_list, Light *p_directional_list, const Transform2D &p_canvas_transform, RS::CanvasItemTextureFilter p_default_filter, RS::CanvasItemTextureRepeat p_default_repeat, bool p_snap_2d_vertices_to_pixel, bool &r_sdf_used) override {
+		for (Item *ci = p_item_list; ci; ci = ci->next) {
+			drawn.push_back(ci->final_modulate);
+		}
+	}
+};
+
+// Culls the same canvas with or without threads, and returns the drawn items, identified by their self modulate.
+static LocalVector<Color> cull_canvas(bool p_threaded) {
+	// The settings are read when the canvas cull is created, so every run gets its own server.
+	ProjectSettings::get_singleton()->set_setting("rendering/2d/options/use_threaded_culling", p_threaded);
+	ProjectSettings::get_singleton()->set_setting("rendering/2d/options/threaded_cull_minimum_items", 32);
+
+	RasterizerDummy::make_current();
+	RenderingServerDefault *rs = memnew(RenderingServerDefault);
+	rs->init();
+	rs->set_render_loop_enabled(false);
+
+	Ref<RandomNumberGenerator> rng;
+	rng.instantiate();
+	rng->set_seed(42);
+
+	RID canvas = rs->canvas_create();
+	LocalVector<RID> items;
+	int index = 1;
+
+	for (int i = 0; i < 48; i++) {
+		RID group = rs->canvas_item_create();
+		rs->canvas_item_set_parent(group, canvas);
+		rs->canvas_item_set_transform(group, Transform2D(0.0, Vector2((i % 8) * 128, (i / 8) * 128)));
+		rs->canvas_item_add_rect(group, Rect2(0, 0, 8, 8), Color(1, 1, 1));
+		rs->canvas_item_set_self_modulate(group, Color((index % 256) / 255.0, (index / 256) / 255.0, 0, 1));
+		index++;
+		if (i % 5 == 0) {
+			rs->canvas_item_set_z_index(group, i % 3 - 1);
+		}
+		if (i % 7 == 0) {
+			rs->canvas_item_set_sort_children_by_y(group, true);
+		}
+		if (i % 11 == 0) {
+			rs->canvas_item_set_visible(group, false);
+		}
+		items.push_back(group);
+
+		for (int j = 0; j < 24; j++) {
+			RID child = rs->canvas_item_create();
+			rs->canvas_item_set_parent(child, group);
+			// Some of them end up outside of the clip rect.
+			rs->canvas_item_set_transform(child, Transform2D(0.0, Vector2(rng->randf_range(-64, 192), rng->randf_range(-64, 192))));
+			rs->canvas_item_add_rect(child, Rect2(0, 0, 4, 4), Color(1, 1, 1));
+			rs->canvas_item_set_self_modulate(child, Color((index % 256) / 255.0, (index / 256) / 255.0, 0, 1));
+			index++;
+			if (j % 6 == 0) {
+				rs->canvas_item_set_z_index(child, rng->randi_range(-2, 2));
+			}
+			items.push_back(child);
+
+			if (j % 9 == 0) {
+				for (int k = 0; k < 3; k++) {
+					RID grandchild = rs->canvas_item_create();
+					rs->canvas_item_set_parent(grandchild, child);
+					rs->canvas_item_set_transform(grandchild, Transform2D(0.0, Vector2(k * 4, 0)));
+					rs->canvas_item_add_rect(grandchild, Rect2(0, 0, 2, 2), Color(1, 1, 1));
+					rs->canvas_item_set_self_modulate(grandchild, Color((index % 256) / 255.0, (index / 256) / 255.0, 0, 1));
+					index++;
+					if (k == 1) {
+						rs->canvas_item_set_z_index(grandchild, 1);
+					}
+					items.push_back(grandchild);
+				}
+			}
+		}
+	}
+
+	RendererCanvasRender *canvas_render = RSG::canvas_render;
+	RecordingCanvasRender recorder;
+	RSG::canvas_render = &recorder;
+
+	RendererCanvasCull::Canvas *canvas_ptr = RSG::canvas->canvas_owner.get_or_null(canvas);
+	RSG::canvas->render_canvas(RID(), canvas_ptr, Transform2D(), nullptr, nullptr, Rect2(0, 0, 1024, 768), RS::CANVAS_ITEM_TEXTURE_FILTER_LINEAR, RS::CANVAS_ITEM_TEXTURE_REPEAT_DISABLED, false, false);
+
+	RSG::canvas_render = canvas_render;
+	RendererCanvasRender::singleton = canvas_render;
+
+	// Children before their parents.
+	for (int i = items.size() - 1; i >= 0; i--) {
+		rs->free(items[i]);
+	}
+	rs->free(canvas);
+
+	rs->sync();
+	rs->finish();
+	memdelete(rs);
+
+	ProjectSettings::get_singleton()->set_setting("rendering/2d/options/use_threaded_culling", true);
+	ProjectSettings::get_singleton()->set_setting("rendering/2d/options/threaded_cull_minimum_items", 1000);
+
+	return recorder.drawn;
+}
+
+TEST_CASE("[RendererCanvasCull] Threaded culling draws the same items in the same order") {
+	LocalVector<Color> serial = cull_canvas(false);
+	LocalVector<Color> threaded = cull_canvas(true);
+
+	CHECK_MESSAGE(
+			serial.size() > 0,
+			"Some items should be drawn.");
+	REQUIRE_MESSAGE(
+			threaded.size() == serial.size(),
+			"Threaded culling should draw as many items as serial culling.");
+
+	uint32_t mismatches = 0;
+	for (uint32_t i = 0; i < serial.size(); i++) {
+		if (threaded[i] != serial[i]) {
+			mismatches++;
+		}
+	}
+	CHECK_MESSAGE(
+			mismatches == 0,
+			"Threaded culling should draw the items in the same order as serial culling.");
+}
+
+} // namespace TestRendererCanvasCull
+
+#endif // TEST_RENDERER_CANVAS_CULL_H
@@ -0,0 +1,257 @@
+/*************************************************************************/
+/*  test_renderer_scene_cull.h                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           MESH ENGINE                                */
+/*                      https://mesh-engine.com                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2021 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2021 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef TEST_RENDERER_SCENE_CULL_H
+#define TEST_RENDERER_SCENE_CULL_H
+
+#include "core/config/project_settings.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/random_number_generator.h"
+#include "servers/rendering/rasterizer_dummy.h"
+#include "servers/rendering/renderer_scene_cull.h"
+#include "servers/rendering/rendering_server_default.h"
+#include "servers/rendering/rendering_server_globals.h"
+
+#include "tests/test_macros.h"
+
+namespace TestRendererSceneCull {
+
+typedef RendererSceneCull::Frustum Frustum;
+typedef RendererSceneCull::InstanceBounds InstanceBounds;
+typedef RendererSceneCull::CullVolumes CullVolumes;
+
+TEST_CASE("[RendererSceneCull] Culling blocks of instances matches culling them one by one") {
+	// Not a multiple of the block size, so the last block is partial.
+	const uint32_t instance_count = CullVolumes::BLOCK_SIZE * 40 + 7;
+	const int cascade_count = 4;
+
+	Ref<RandomNumberGenerator> rng;
+	rng.instantiate();
+	rng->set_seed(1234);
+
+	PagedArrayPool<InstanceBounds> pool;
+	PagedArray<InstanceBounds> bounds;
+	bounds.set_page_pool(&pool);
+	for (uint32_t i = 0; i < instance_count; i++) {
+		Vector3 position(rng->randf_range(-200, 200), rng->randf_range(-20, 20), rng->randf_range(-200, 200));
+		bounds.push_back(InstanceBounds(AABB(position, Vector3(1, 1, 1) * rng->randf_range(0.5, 8.0))));
+	}
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, 150);
+	Frustum frustums[1 + cascade_count];
+	frustums[0] = Frustum(projection.get_projection_planes(Transform3D()));
+
+	// Cascades as boxes of growing size in front of the camera, the shape they take for a light pointing down.
+	for (int i = 0; i < cascade_count; i++) {
+		real_t extent = 10.0 * (1 << (i * 2));
+		Vector<Plane> planes;
+		planes.push_back(Plane(Vector3(1, 0, 0), extent));
+		planes.push_back(Plane(Vector3(-1, 0, 0), extent));
+		planes.push_back(Plane(Vector3(0, 1, 0), 1e6));
+		planes.push_back(Plane(Vector3(0, -1, 0), 100));
+		planes.push_back(Plane(Vector3(0, 0, 1), extent * 0.25));
+		planes.push_back(Plane(Vector3(0, 0, -1), extent));
+		frustums[1 + i] = Frustum(planes);
+	}
+
+	CullVolumes volumes;
+	volumes.clear();
+	for (int i = 0; i < 1 + cascade_count; i++) {
+		volumes.add_frustum(frustums[i]);
+	}
+
+	LocalVector<uint64_t> block_masks;
+	block_masks.resize(instance_count);
+	for (uint32_t i = 0; i < instance_count; i += CullVolumes::BLOCK_SIZE) {
+		volumes.cull(bounds, i, MIN(uint32_t(CullVolumes::BLOCK_SIZE), instance_count - i), &block_masks[i]);
+	}
+
+	uint32_t mismatches = 0;
+	uint32_t visible = 0;
+	for (uint32_t i = 0; i < instance_count; i++) {
+		uint64_t mask = 0;
+		for (int v = 0; v < 1 + cascade_count; v++) {
+			if (bounds[i].in_frustum(frustums[v])) {
+				mask |= uint64_t(1) << v;
+			}
+		}
+		if (mask != block_masks[i]) {
+			mismatches++;
+		}
+		if (mask != 0) {
+			visible++;
+		}
+	}
+
+	CHECK_MESSAGE(
+			visible > 0,
+			"Some instances should be inside the culling volumes.");
+	CHECK_MESSAGE(
+			visible < instance_count,
+			"Some instances should be outside the culling volumes.");
+	CHECK_MESSAGE(
+			mismatches == 0,
+			"Culling blocks of instances against all volumes should give the same masks as culling them one by one.");
+
+	bounds.reset();
+	pool.reset();
+}
+
+// Collects the instances found by an indexer query, identified by their attached object.
+struct IndexerQuery {
+	LocalVector<uint64_t> found;
+
+	bool operator()(void *p_data) {
+		found.push_back(uint64_t(static_cast<RendererSceneCull::Instance *>(p_data)->object_id));
+		return false;
+	}
+};
+
+TEST_CASE("[RendererSceneCull] Batched instance updates match updating instances one by one") {
+	// Low enough for the batch to be updated in parallel. It is read when the scene cull is created.
+	ProjectSettings::get_singleton()->set_setting("rendering/limits/spatial_indexer/threaded_cull_minimum_instances", 64);
+
+	RasterizerDummy::make_current();
+	RenderingServerDefault *rs = memnew(RenderingServerDefault);
+	rs->init();
+	rs->set_render_loop_enabled(false);
+	RendererSceneCull *scene_cull = static_cast<RendererSceneCull *>(RSG::scene);
+
+	RID mesh = rs->mesh_create();
+	rs->mesh_set_custom_aabb(mesh, AABB(Vector3(-0.5, -1, -0.5), Vector3(1, 2, 1)));
+
+	// The same instances in two scenarios, one updated in a batch and the other one by one.
+	const int count = 500;
+	RID scenarios[2];
+	LocalVector<RID> instances[2];
+	for (int s = 0; s < 2; s++) {
+		scenarios[s] = rs->scenario_create();
+		instances[s].resize(count);
+		for (int i = 0; i < count; i++) {
+			instances[s][i] = rs->instance_create2(mesh, scenarios[s]);
+			rs->instance_attach_object_instance_id(instances[s][i], ObjectID(uint64_t(i + 1)));
+			rs->instance_set_transform(instances[s][i], Transform3D(Basis(), Vector3(i % 10, (i / 10) % 10, i / 100) * 3.0));
+		}
+	}
+	scene_cull->update_dirty_instances();
+
+	for (int s = 0; s < 2; s++) {
+		for (int i = 0; i < count; i++) {
+			Basis basis = Basis(Vector3(0, 1, 0), i * 0.1).scaled(Vector3(1, 1, 1) * (0.5 + (i % 7) * 0.25));
+			if (i % 50 == 0) {
+				// Flattened instances keep their place in the indexer.
+				basis = Basis().scaled(Vector3());
+			}
+			rs->instance_set_transform(instances[s][i], Transform3D(basis, Vector3(i % 10, (i / 10) % 10, i / 100) * 3.0 + Vector3(i % 3, 0, 1)));
+		}
+	}
+
+	int batched = 0;
+	for (int i = 0; i < count; i++) {
+		RendererSceneCull::Instance *instance = scene_cull->instance_owner.get_or_null(instances[1][i]);
+		// Instances with dependencies to update aren't batched.
+		instance->update_dependencies = true;
+		if (scene_cull->_can_batch_dirty_instance(scene_cull->instance_owner.get_or_null(instances[0][i]))) {
+			batched++;
+		}
+	}
+	CHECK_MESSAGE(
+			batched == count,
+			"Every moved instance of the first scenario should be updated in the batch.");
+
+	scene_cull->update_dirty_instances();
+
+	int aabb_mismatches = 0;
+	for (int i = 0; i < count; i++) {
+		const RendererSceneCull::Instance *a = scene_cull->instance_owner.get_or_null(instances[0][i]);
+		const RendererSceneCull::Instance *b = scene_cull->instance_owner.get_or_null(instances[1][i]);
+		bool same = a->aabb == b->aabb && a->transformed_aabb == b->transformed_aabb;
+		const RendererSceneCull::InstanceBounds &bounds_a = a->scenario->instance_aabbs[a->array_index];
+		const RendererSceneCull::InstanceBounds &bounds_b = b->scenario->instance_aabbs[b->array_index];
+		for (int j = 0; j < 6; j++) {
+			same = same && bounds_a.bounds[j] == bounds_b.bounds[j];
+		}
+		if (!same) {
+			aabb_mismatches++;
+		}
+	}
+	CHECK_MESSAGE(
+			aabb_mismatches == 0,
+			"Batched updates should leave the same bounds as updating instances one by one.");
+
+	int query_mismatches = 0;
+	int found = 0;
+	for (int x = 0; x < 8; x++) {
+		for (int y = 0; y < 8; y++) {
+			const AABB box(Vector3(x, y, 0) * 4.0 - Vector3(2, 2, 2), Vector3(5, 5, 20));
+			IndexerQuery queries[2];
+			for (int s = 0; s < 2; s++) {
+				scene_cull->scenario_owner.get_or_null(scenarios[s])->indexers[RendererSceneCull::Scenario::INDEXER_GEOMETRY].aabb_query(box, queries[s]);
+				queries[s].found.sort();
+			}
+			if (queries[0].found.size() != queries[1].found.size()) {
+				query_mismatches++;
+				continue;
+			}
+			for (uint32_t i = 0; i < queries[0].found.size(); i++) {
+				if (queries[0].found[i] != queries[1].found[i]) {
+					query_mismatches++;
+					break;
+				}
+			}
+			found += queries[0].found.size();
+		}
+	}
+	CHECK_MESSAGE(
+			found > 0,
+			"The indexer queries should find instances.");
+	CHECK_MESSAGE(
+			query_mismatches == 0,
+			"Batched updates should leave the indexer in the same state as updating instances one by one.");
+
+	for (int s = 0; s < 2; s++) {
+		for (int i = 0; i < count; i++) {
+			rs->free(instances[s][i]);
+		}
+		rs->free(scenarios[s]);
+	}
+	rs->free(mesh);
+
+	rs->sync();
+	rs->finish();
+	memdelete(rs);
+
+	ProjectSettings::get_singleton()->set_setting("rendering/limits/spatial_indexer/threaded_cull_minimum_instances", 1000);
+}
+
+} // namespace TestRendererSceneCull
+
+#endif // TEST_RENDERER_SCENE_CULL_H
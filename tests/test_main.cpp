@@ -42,17 +42,21 @@
 #include "tests/core/math/test_astar.h"
 #include "tests/core/math/test_basis.h"
 #include "tests/core/math/test_color.h"
+#include "tests/core/math/test_dynamic_bvh.h"
 #include "tests/core/math/test_expression.h"
 #include "tests/core/math/test_geometry_2d.h"
 #include "tests/core/math/test_geometry_3d.h"
 #include "tests/core/math/test_math.h"
 #include "tests/core/math/test_random_number_generator.h"
 #include "tests/core/math/test_rect2.h"
+#include "tests/core/multiplayer/test_multiplayer_replicator.h"
 #include "tests/core/object/test_class_db.h"
+#include "tests/core/object/test_message_queue.h"
 #include "tests/core/object/test_method_bind.h"
 #include "tests/core/object/test_object.h"
 #include "tests/core/string/test_node_path.h"
 #include "tests/core/string/test_string.h"
+#include "tests/core/string/test_string_name.h"
 #include "tests/core/string/test_translation.h"
 #include "tests/core/templates/test_command_queue.h"
 #include "tests/core/templates/test_list.h"
@@ -61,6 +65,7 @@
 #include "tests/core/templates/test_oa_hash_map.h"
 #include "tests/core/templates/test_ordered_hash_map.h"
 #include "tests/core/templates/test_paged_array.h"
+#include "tests/core/templates/test_task_scheduler.h"
 #include "tests/core/templates/test_vector.h"
 #include "tests/core/test_crypto.h"
 #include "tests/core/test_hashing_context.h"
@@ -68,14 +73,20 @@
 #include "tests/core/variant/test_array.h"
 #include "tests/core/variant/test_dictionary.h"
 #include "tests/core/variant/test_variant.h"
+#include "tests/scene/test_animation.h"
+#include "tests/scene/test_animation_tree.h"
 #include "tests/scene/test_code_edit.h"
 #include "tests/scene/test_curve.h"
 #include "tests/scene/test_gradient.h"
 #include "tests/scene/test_gui.h"
 #include "tests/scene/test_path_3d.h"
+#include "tests/servers/test_mesh_force_integration_3d.h"
 #include "tests/servers/test_physics_2d.h"
 #include "tests/servers/test_physics_3d.h"
+#include "tests/servers/test_raster_occlusion_cull.h"
 #include "tests/servers/test_render.h"
+#include "tests/servers/test_renderer_canvas_cull.h"
+#include "tests/servers/test_renderer_scene_cull.h"
 #include "tests/servers/test_shader_lang.h"
 #include "tests/servers/test_text_server.h"
 #include "tests/test_validate_testing.h"
@@ -48,6 +48,8 @@ void KdTree::buildAgentTree(std::vector<Agent *> agents) {
     if (!agents_.empty()) {
         agentTree_.resize(2 * agents_.size() - 1);
         buildAgentTreeRecursive(0, agents_.size(), 0);
+    } else {
+        agentTree_.clear();
 	}
 }
 
@@ -116,8 +118,44 @@ void KdTree::buildAgentTreeRecursive(size_t begin, size_t end, size_t node) {
 	}
 }
 
+void KdTree::refitAgentTree() {
+    if (!agents_.empty()) {
+        refitAgentTreeRecursive(0);
+    }
+}
+
+void KdTree::refitAgentTreeRecursive(size_t node) {
+    AgentTreeNode &treeNode = agentTree_[node];
+
+    if (treeNode.end - treeNode.begin > RVO_MAX_LEAF_SIZE) {
+        refitAgentTreeRecursive(treeNode.left);
+        refitAgentTreeRecursive(treeNode.right);
+
+        const AgentTreeNode &left = agentTree_[treeNode.left];
+        const AgentTreeNode &right = agentTree_[treeNode.right];
+        for (size_t i = 0; i < 3; ++i) {
+            treeNode.minCoord[i] = std::min(left.minCoord[i], right.minCoord[i]);
+            treeNode.maxCoord[i] = std::max(left.maxCoord[i], right.maxCoord[i]);
+        }
+    } else {
+        treeNode.minCoord = agents_[treeNode.begin]->position_;
+        treeNode.maxCoord = agents_[treeNode.begin]->position_;
+
+        for (size_t i = treeNode.begin + 1; i < treeNode.end; ++i) {
+            treeNode.maxCoord[0] = std::max(treeNode.maxCoord[0], agents_[i]->position_.x());
+            treeNode.minCoord[0] = std::min(treeNode.minCoord[0], agents_[i]->position_.x());
+            treeNode.maxCoord[1] = std::max(treeNode.maxCoord[1], agents_[i]->position_.y());
+            treeNode.minCoord[1] = std::min(treeNode.minCoord[1], agents_[i]->position_.y());
+            treeNode.maxCoord[2] = std::max(treeNode.maxCoord[2], agents_[i]->position_.z());
+            treeNode.minCoord[2] = std::min(treeNode.minCoord[2], agents_[i]->position_.z());
+        }
+    }
+}
+
 void KdTree::computeAgentNeighbors(Agent *agent, float rangeSq) const {
-    queryAgentTreeRecursive(agent, rangeSq, 0);
+    if (!agentTree_.empty()) {
+        queryAgentTreeRecursive(agent, rangeSq, 0);
+    }
 }
 
 void KdTree::queryAgentTreeRecursive(Agent *agent, float &rangeSq, size_t node) const {
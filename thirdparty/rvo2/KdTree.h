@@ -46,6 +46,7 @@
 // Note: Slightly modified to work better with Mesh.
 // - Removed `sim_`.
 // - KdTree things are public
+// - Added `refitAgentTree` to update the node bounds without rebuilding the tree.
 namespace RVO {
 class Agent;
 class RVOSimulator;
@@ -104,6 +105,14 @@ public:
 
     void buildAgentTreeRecursive(size_t begin, size_t end, size_t node);
 
+    /**
+		 * \brief   Updates the node bounds to the current agent positions,
+		 *          keeping the tree structure of the last build.
+		 */
+    void refitAgentTree();
+
+    void refitAgentTreeRecursive(size_t node);
+
     /**
 		 * \brief   Computes the agent neighbors of the specified agent.
 		 * \param   agent    A pointer to the agent for which agent neighbors are to be computed.